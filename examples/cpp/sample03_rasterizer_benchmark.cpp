@@ -0,0 +1,109 @@
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#define NOVASVG_IMPLEMENTATION
+#include <novasvg/novasvg.h>
+
+// Compares the gray (cell-based) and sparse (analytic-coverage) rasterizers on a few
+// representative workloads. Pass a TrueType font file as the first argument to include
+// the text workload.
+
+namespace {
+    using Workload = std::function<void(plutovg_canvas_t*)>;
+
+    double run(plutovg_rasterizer_t rasterizer, int size, int iterations, const Workload& workload) {
+        auto surface = plutovg_surface_create(size, size);
+        auto canvas = plutovg_canvas_create(surface);
+        plutovg_canvas_set_rasterizer(canvas, rasterizer);
+        plutovg_canvas_set_rgba(canvas, 0.2f, 0.4f, 0.8f, 0.9f);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            workload(canvas);
+        }
+
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        plutovg_canvas_destroy(canvas);
+        plutovg_surface_destroy(surface);
+        return std::chrono::duration<double, std::milli>(elapsed).count() / iterations;
+    }
+
+    void report(const std::string& name, int size, int iterations, const Workload& workload) {
+        auto gray = run(PLUTOVG_RASTERIZER_GRAY, size, iterations, workload);
+        auto sparse = run(PLUTOVG_RASTERIZER_SPARSE, size, iterations, workload);
+        std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(3)
+                  << std::setw(12) << gray << " ms" << std::setw(12) << sparse << " ms"
+                  << std::setw(10) << std::setprecision(2) << gray / sparse << "x\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << std::left << std::setw(24) << "workload" << std::right
+              << std::setw(15) << "gray" << std::setw(15) << "sparse" << std::setw(11) << "speedup" << "\n";
+
+    report("large fill", 2048, 20, [](plutovg_canvas_t* canvas) {
+        plutovg_canvas_circle(canvas, 1024.f, 1024.f, 1000.f);
+        plutovg_canvas_fill(canvas);
+    });
+
+    report("large polygon", 2048, 20, [](plutovg_canvas_t* canvas) {
+        plutovg_canvas_move_to(canvas, 10.f, 10.f);
+        plutovg_canvas_line_to(canvas, 2040.f, 300.f);
+        plutovg_canvas_line_to(canvas, 1800.f, 2030.f);
+        plutovg_canvas_line_to(canvas, 100.f, 1500.f);
+        plutovg_canvas_close_path(canvas);
+        plutovg_canvas_fill(canvas);
+    });
+
+    report("many small paths", 1024, 5, [](plutovg_canvas_t* canvas) {
+        for (int y = 0; y < 100; ++y) {
+            for (int x = 0; x < 100; ++x) {
+                plutovg_canvas_circle(canvas, x * 10.f + 5.f, y * 10.f + 5.f, 4.f);
+                plutovg_canvas_fill(canvas);
+            }
+        }
+    });
+
+    report("thick stroke", 1024, 20, [](plutovg_canvas_t* canvas) {
+        plutovg_canvas_set_line_width(canvas, 24.f);
+        plutovg_canvas_move_to(canvas, 20.f, 20.f);
+        plutovg_canvas_cubic_to(canvas, 1000.f, 0.f, 0.f, 1000.f, 1000.f, 1000.f);
+        plutovg_canvas_stroke(canvas);
+    });
+
+    report("thin polylines", 1024, 5, [](plutovg_canvas_t* canvas) {
+        plutovg_canvas_set_line_width(canvas, 1.f);
+        for (int line = 0; line < 200; ++line) {
+            plutovg_canvas_move_to(canvas, 0.f, line * 5.f);
+            for (int i = 1; i < 500; ++i) {
+                plutovg_canvas_line_to(canvas, i * 2.f, line * 5.f + 4.f * std::sin(i * 0.3f + line));
+            }
+
+            plutovg_canvas_stroke(canvas);
+        }
+    });
+
+    if (argc > 1) {
+        auto face = plutovg_font_face_load_from_file(argv[1], 0);
+        if (face == nullptr) {
+            std::cerr << "Failed to load font: " << argv[1] << "\n";
+            return 1;
+        }
+
+        report("text", 1024, 5, [face](plutovg_canvas_t* canvas) {
+            static const char text[] = "The quick brown fox jumps over the lazy dog 0123456789";
+            plutovg_canvas_set_font(canvas, face, 14.f);
+            for (int line = 0; line < 60; ++line) {
+                plutovg_canvas_fill_text(canvas, text, -1, PLUTOVG_TEXT_ENCODING_UTF8, 4.f, 16.f + line * 16.f);
+            }
+        });
+
+        plutovg_font_face_destroy(face);
+    }
+
+    return 0;
+}
@@ -0,0 +1,54 @@
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+
+#define NOVASVG_IMPLEMENTATION
+#include <novasvg/novasvg.h>
+
+// Renders an SVG with each quality preset and reports the speedup relative to the
+// normal preset. Pass an SVG file as the first argument and, optionally, the output
+// width as the second; defaults to data/tiger.svg at 1024 pixels.
+
+namespace {
+    std::filesystem::path project_root() {
+        return std::filesystem::path(__FILE__).parent_path().parent_path().parent_path();
+    }
+
+    double run(const novasvg::Document& document, int width, novasvg::RenderQuality quality, int iterations) {
+        const novasvg::RenderOptions options(quality);
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            document.renderToBitmap(width, -1, 0x00000000, options);
+        }
+
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration<double, std::milli>(elapsed).count() / iterations;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const auto input = argc > 1 ? std::filesystem::path(argv[1]) : project_root() / "data" / "tiger.svg";
+    const int width = argc > 2 ? std::atoi(argv[2]) : 1024;
+
+    auto document = novasvg::Document::loadFromFile(input.string());
+    if (!document) {
+        std::cerr << "Failed to load SVG: " << input << "\n";
+        return 1;
+    }
+
+    constexpr int iterations = 20;
+    run(*document, width, novasvg::RenderQuality::Normal, 1);
+
+    const auto normal = run(*document, width, novasvg::RenderQuality::Normal, iterations);
+    const auto draft = run(*document, width, novasvg::RenderQuality::Draft, iterations);
+    const auto high = run(*document, width, novasvg::RenderQuality::High, iterations);
+
+    std::cout << std::left << std::setw(10) << "preset" << std::right << std::setw(15) << "time" << std::setw(11) << "speedup" << "\n";
+    for (const auto& [name, time] : { std::pair{"draft", draft}, std::pair{"normal", normal}, std::pair{"high", high} }) {
+        std::cout << std::left << std::setw(10) << name << std::right << std::fixed << std::setprecision(3)
+                  << std::setw(12) << time << " ms" << std::setw(10) << std::setprecision(2) << normal / time << "x\n";
+    }
+
+    return 0;
+}
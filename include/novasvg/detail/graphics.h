@@ -8,6 +8,16 @@
 #include <vector>
 #include <array>
 #include <string>
+#include <functional>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <chrono>
+
+#include "tracing.h"
 
 namespace novasvg {
 
@@ -325,6 +335,15 @@ enum class PathCommand {
     Close = PLUTOVG_PATH_COMMAND_CLOSE
 };
 
+// Latches the first cancellation or missed deadline of one render, shared by all of its canvases.
+struct RenderInterrupt {
+    const std::atomic<bool>* cancel = nullptr;
+    std::chrono::steady_clock::time_point deadline;
+    RenderStatus status = RenderStatus::Complete;
+
+    bool check();
+};
+
 class Path {
 public:
     Path() = default;
@@ -361,6 +380,7 @@ public:
     plutovg_path_t* data() const { return m_data; }
 
     bool parse(const char* data, size_t length);
+    bool setData(const uint8_t* commands, int commandCount, const plutovg_point_t* points, int pointCount);
 
 private:
     plutovg_path_t* release();
@@ -387,7 +407,8 @@ public:
     void next();
 
 private:
-    const plutovg_path_element_t* m_elements;
+    const uint8_t* m_commands;
+    const plutovg_point_t* m_points;
     const int m_size;
     int m_index;
 };
@@ -462,8 +483,12 @@ enum class TextureType {
 enum class BlendMode {
     Src = PLUTOVG_OPERATOR_SRC,
     Src_Over = PLUTOVG_OPERATOR_SRC_OVER,
+    Src_In = PLUTOVG_OPERATOR_SRC_IN,
     Dst_In = PLUTOVG_OPERATOR_DST_IN,
-    Dst_Out = PLUTOVG_OPERATOR_DST_OUT
+    Src_Out = PLUTOVG_OPERATOR_SRC_OUT,
+    Dst_Out = PLUTOVG_OPERATOR_DST_OUT,
+    Src_Atop = PLUTOVG_OPERATOR_SRC_ATOP,
+    Xor = PLUTOVG_OPERATOR_XOR
 };
 
 using DashArray = std::vector<float>;
@@ -504,12 +529,22 @@ using GradientStops = std::vector<GradientStop>;
 
 class Bitmap;
 
+// Bytes held by the offscreen canvases of one render, checked against RenderOptions::memoryBudget.
+struct CanvasMemory {
+    size_t used = 0;
+    size_t peak = 0;
+};
+
 class Canvas {
 public:
     static std::shared_ptr<Canvas> create(const Bitmap& bitmap);
     static std::shared_ptr<Canvas> create(float x, float y, float width, float height);
     static std::shared_ptr<Canvas> create(const Rect& extents);
 
+    // Layers share the render options and memory accounting of the canvas they are created from.
+    bool canCreateLayer(const Rect& extents, size_t count = 1) const;
+    std::shared_ptr<Canvas> createLayer(const Rect& extents) const;
+
     void setColor(const Color& color);
     void setColor(float r, float g, float b, float a);
     void setLinearGradient(float x1, float y1, float x2, float y2, SpreadMethod spread, const GradientStops& stops, const Transform& transform);
@@ -527,12 +562,20 @@ public:
 
     void drawImage(const Bitmap& image, const Rect& dstRect, const Rect& srcRect, const Transform& transform);
     void blendCanvas(const Canvas& canvas, BlendMode blendMode, float opacity);
+    void clear();
 
     void save();
     void restore();
 
     void convertToLuminanceMask();
 
+    void setRenderOptions(const RenderOptions& options);
+    const RenderOptions& renderOptions() const { return m_renderOptions; }
+
+    RenderInterrupt* interrupt() const { return m_interrupt.get(); }
+    bool interrupted() const { return m_interrupt && m_interrupt->check(); }
+    RenderStatus status() const { return m_interrupt ? m_interrupt->status : RenderStatus::Complete; }
+
     int x() const { return m_x; }
     int y() const { return m_y; }
     int width() const;
@@ -551,10 +594,66 @@ private:
     plutovg_surface_t* m_surface;
     plutovg_canvas_t* m_canvas;
     plutovg_matrix_t m_translation;
+    plutovg_canvas_stats_t m_stats{};
+    RenderOptions m_renderOptions;
+    std::shared_ptr<CanvasMemory> m_memory;
+    std::shared_ptr<RenderInterrupt> m_interrupt;
     const int m_x;
     const int m_y;
+    const bool m_offscreen;
+};
+
+// Adds the seconds spent in the enclosing scope to one of the timers of `stats`, if any.
+class StatsTimer {
+public:
+    StatsTimer(RenderStats* stats, double RenderStats::*counter)
+        : m_counter(stats ? &(stats->*counter) : nullptr)
+    {
+        if(m_counter) {
+            m_start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~StatsTimer()
+    {
+        if(m_counter) {
+            *m_counter += std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+        }
+    }
+
+private:
+    StatsTimer(const StatsTimer&) = delete;
+    StatsTimer& operator=(const StatsTimer&) = delete;
+    double* m_counter;
+    std::chrono::steady_clock::time_point m_start;
 };
 
+class WorkerPool {
+public:
+    // Runs `task` for every index in [0, count) on up to `maxThreads` threads, the caller included, and waits for all of them.
+    // If tasks throw, the first exception is rethrown on the calling thread once every task has finished.
+    void parallelFor(int count, int maxThreads, const std::function<void(int)>& task);
+
+    int concurrency() const { return static_cast<int>(m_threads.size()) + 1; }
+
+    ~WorkerPool();
+
+private:
+    struct Job;
+    WorkerPool();
+    void run();
+    static void execute(Job& job);
+    std::vector<std::thread> m_threads;
+    std::deque<std::shared_ptr<Job>> m_jobs;
+    std::mutex m_mutex;
+    std::condition_variable m_pending;
+    std::condition_variable m_finished;
+    bool m_stopped = false;
+    friend WorkerPool* workerPool();
+};
+
+WorkerPool* workerPool();
+
 } // namespace novasvg
 
 #endif // NOVASVG_GRAPHICS_H
@@ -286,6 +286,24 @@ void Path::reset()
     }
 }
 
+bool RenderInterrupt::check()
+{
+    if(status == RenderStatus::Complete) {
+        if(cancel && cancel->load(std::memory_order_relaxed)) {
+            status = RenderStatus::Cancelled;
+        } else if(deadline != std::chrono::steady_clock::time_point::max() && std::chrono::steady_clock::now() >= deadline) {
+            status = RenderStatus::DeadlineExceeded;
+        }
+    }
+
+    return status != RenderStatus::Complete;
+}
+
+static bool canvasInterrupted(void* closure)
+{
+    return static_cast<RenderInterrupt*>(closure)->check();
+}
+
 Rect Path::boundingRect() const
 {
     if(m_data == nullptr)
@@ -298,7 +316,7 @@ Rect Path::boundingRect() const
 bool Path::isEmpty() const
 {
     if(m_data)
-        return plutovg_path_get_elements(m_data, nullptr) == 0;
+        return plutovg_path_get_commands(m_data, nullptr) == 0;
     return true;
 }
 
@@ -313,6 +331,12 @@ bool Path::parse(const char* data, size_t length)
     return plutovg_path_parse(m_data, data, length);
 }
 
+bool Path::setData(const uint8_t* commands, int commandCount, const plutovg_point_t* points, int pointCount)
+{
+    plutovg_path_reset(ensure());
+    return plutovg_path_add_data(m_data, commands, commandCount, points, pointCount);
+}
+
 plutovg_path_t* Path::ensure()
 {
     if(isNull()) {
@@ -326,28 +350,29 @@ plutovg_path_t* Path::ensure()
 }
 
 PathIterator::PathIterator(const Path& path)
-    : m_size(plutovg_path_get_elements(path.data(), &m_elements))
+    : m_size(plutovg_path_get_commands(path.data(), &m_commands))
     , m_index(0)
 {
+    plutovg_path_get_points(path.data(), &m_points);
 }
 
 PathCommand PathIterator::currentSegment(std::array<Point, 3>& points) const
 {
-    auto command = m_elements[m_index].header.command;
+    auto command = plutovg_path_command_t(m_commands[m_index]);
     switch(command) {
     case PLUTOVG_PATH_COMMAND_MOVE_TO:
-        points[0] = m_elements[m_index + 1].point;
+        points[0] = m_points[0];
         break;
     case PLUTOVG_PATH_COMMAND_LINE_TO:
-        points[0] = m_elements[m_index + 1].point;
+        points[0] = m_points[0];
         break;
     case PLUTOVG_PATH_COMMAND_CUBIC_TO:
-        points[0] = m_elements[m_index + 1].point;
-        points[1] = m_elements[m_index + 2].point;
-        points[2] = m_elements[m_index + 3].point;
+        points[0] = m_points[0];
+        points[1] = m_points[1];
+        points[2] = m_points[2];
         break;
     case PLUTOVG_PATH_COMMAND_CLOSE:
-        points[0] = m_elements[m_index + 1].point;
+        points[0] = m_points[0];
         break;
     }
 
@@ -356,7 +381,7 @@ PathCommand PathIterator::currentSegment(std::array<Point, 3>& points) const
 
 void PathIterator::next()
 {
-    m_index += m_elements[m_index].header.length;
+    m_points += m_commands[m_index++] == PLUTOVG_PATH_COMMAND_CUBIC_TO ? 3 : 1;
 }
 
 FontFace::FontFace(plutovg_font_face_t* face)
@@ -509,6 +534,43 @@ std::shared_ptr<Canvas> Canvas::create(const Rect& extents)
     return create(extents.x, extents.y, extents.w, extents.h);
 }
 
+static size_t canvasBytes(const Rect& extents)
+{
+    constexpr int kMaxSize = 1 << 15;
+    if(extents.w <= 0 || extents.h <= 0 || extents.w >= kMaxSize || extents.h >= kMaxSize)
+        return 4;
+    auto width = std::ceil(extents.right()) - std::floor(extents.x);
+    auto height = std::ceil(extents.bottom()) - std::floor(extents.y);
+    return static_cast<size_t>(width) * static_cast<size_t>(height) * 4;
+}
+
+bool Canvas::canCreateLayer(const Rect& extents, size_t count) const
+{
+    auto budget = m_renderOptions.memoryBudget;
+    if(budget == 0 || m_memory->used + count * canvasBytes(extents) <= budget)
+        return true;
+    if(auto stats = m_renderOptions.stats)
+        stats->effectsSkipped++;
+    return false;
+}
+
+std::shared_ptr<Canvas> Canvas::createLayer(const Rect& extents) const
+{
+    auto canvas = create(extents);
+    canvas->m_memory = m_memory;
+    canvas->m_interrupt = m_interrupt;
+    canvas->setRenderOptions(m_renderOptions);
+    m_memory->used += plutovg_surface_get_stride(canvas->m_surface) * plutovg_surface_get_height(canvas->m_surface);
+    if(m_memory->used > m_memory->peak) {
+        m_memory->peak = m_memory->used;
+        if(auto stats = m_renderOptions.stats) {
+            stats->peakOffscreenBytes = std::max<uint64_t>(stats->peakOffscreenBytes, m_memory->peak);
+        }
+    }
+
+    return canvas;
+}
+
 void Canvas::setColor(const Color& color)
 {
     setColor(color.redF(), color.greenF(), color.blueF(), color.alphaF());
@@ -536,6 +598,9 @@ void Canvas::setTexture(const Canvas& source, TextureType type, float opacity, c
 
 void Canvas::fillPath(const Path& path, FillRule fillRule, const Transform& transform)
 {
+    NOVASVG_TRACE_SCOPE("fillPath");
+    if(m_renderOptions.stats)
+        m_renderOptions.stats->fills++;
     plutovg_canvas_set_matrix(m_canvas, &m_translation);
     plutovg_canvas_transform(m_canvas, &transform.matrix());
     plutovg_canvas_set_fill_rule(m_canvas, static_cast<plutovg_fill_rule_t>(fillRule));
@@ -545,6 +610,9 @@ void Canvas::fillPath(const Path& path, FillRule fillRule, const Transform& tran
 
 void Canvas::strokePath(const Path& path, const StrokeData& strokeData, const Transform& transform)
 {
+    NOVASVG_TRACE_SCOPE("strokePath");
+    if(m_renderOptions.stats)
+        m_renderOptions.stats->strokes++;
     plutovg_canvas_set_matrix(m_canvas, &m_translation);
     plutovg_canvas_transform(m_canvas, &transform.matrix());
     plutovg_canvas_set_line_width(m_canvas, strokeData.lineWidth());
@@ -559,6 +627,9 @@ void Canvas::strokePath(const Path& path, const StrokeData& strokeData, const Tr
 
 void Canvas::fillText(const std::u32string_view& text, const Font& font, const Point& origin, const Transform& transform)
 {
+    NOVASVG_TRACE_SCOPE("fillText", std::string_view(), text.length());
+    if(m_renderOptions.stats)
+        m_renderOptions.stats->glyphs += text.length();
     plutovg_canvas_set_matrix(m_canvas, &m_translation);
     plutovg_canvas_transform(m_canvas, &transform.matrix());
     plutovg_canvas_set_fill_rule(m_canvas, PLUTOVG_FILL_RULE_NON_ZERO);
@@ -569,6 +640,9 @@ void Canvas::fillText(const std::u32string_view& text, const Font& font, const P
 
 void Canvas::strokeText(const std::u32string_view& text, float strokeWidth, const Font& font, const Point& origin, const Transform& transform)
 {
+    NOVASVG_TRACE_SCOPE("strokeText", std::string_view(), text.length());
+    if(m_renderOptions.stats)
+        m_renderOptions.stats->glyphs += text.length();
     plutovg_canvas_set_matrix(m_canvas, &m_translation);
     plutovg_canvas_transform(m_canvas, &transform.matrix());
     plutovg_canvas_set_line_width(m_canvas, strokeWidth);
@@ -600,6 +674,9 @@ void Canvas::clipRect(const Rect& rect, FillRule clipRule, const Transform& tran
 
 void Canvas::drawImage(const Bitmap& image, const Rect& dstRect, const Rect& srcRect, const Transform& transform)
 {
+    NOVASVG_TRACE_SCOPE("drawImage", std::string_view(), int64_t(image.width()) * image.height());
+    if(m_renderOptions.stats)
+        m_renderOptions.stats->images++;
     auto xScale = dstRect.w / srcRect.w;
     auto yScale = dstRect.h / srcRect.h;
     plutovg_matrix_t matrix = { xScale, 0, 0, yScale, -srcRect.x * xScale, -srcRect.y * yScale };
@@ -614,6 +691,7 @@ void Canvas::drawImage(const Bitmap& image, const Rect& dstRect, const Rect& src
 
 void Canvas::blendCanvas(const Canvas& canvas, BlendMode blendMode, float opacity)
 {
+    NOVASVG_TRACE_SCOPE("blendCanvas", std::string_view(), int64_t(canvas.width()) * canvas.height());
     plutovg_matrix_t matrix = { 1, 0, 0, 1, static_cast<float>(canvas.x()), static_cast<float>(canvas.y()) };
     plutovg_canvas_set_matrix(m_canvas, &m_translation);
     plutovg_canvas_set_operator(m_canvas, static_cast<plutovg_operator_t>(blendMode));
@@ -621,6 +699,12 @@ void Canvas::blendCanvas(const Canvas& canvas, BlendMode blendMode, float opacit
     plutovg_canvas_paint(m_canvas);
 }
 
+void Canvas::clear()
+{
+    plutovg_color_t color = { 0, 0, 0, 0 };
+    plutovg_surface_clear(m_surface, &color);
+}
+
 void Canvas::save()
 {
     plutovg_canvas_save(m_canvas);
@@ -667,8 +751,46 @@ void Canvas::convertToLuminanceMask()
     }
 }
 
+void Canvas::setRenderOptions(const RenderOptions& options)
+{
+    plutovg_canvas_set_antialias(m_canvas, options.antialias);
+    plutovg_canvas_set_image_smoothing(m_canvas, options.smoothImages);
+    plutovg_canvas_set_curve_tolerance(m_canvas, options.curveTolerance);
+    plutovg_canvas_set_gradient_table_size(m_canvas, options.gradientTableSize);
+    plutovg_canvas_set_rasterizer(m_canvas, static_cast<plutovg_rasterizer_t>(options.rasterizer));
+    plutovg_canvas_set_stats(m_canvas, options.stats ? &m_stats : nullptr);
+    if(options.cancel || options.deadline != std::chrono::steady_clock::time_point::max()) {
+        if(m_interrupt == nullptr)
+            m_interrupt = std::make_shared<RenderInterrupt>();
+        m_interrupt->cancel = options.cancel;
+        m_interrupt->deadline = options.deadline;
+        plutovg_canvas_set_interrupt(m_canvas, canvasInterrupted, m_interrupt.get());
+    } else {
+        m_interrupt.reset();
+        plutovg_canvas_set_interrupt(m_canvas, nullptr, nullptr);
+    }
+
+    m_renderOptions = options;
+}
+
 Canvas::~Canvas()
 {
+    if(auto stats = m_renderOptions.stats) {
+        stats->spans += m_stats.spans;
+        for(size_t index = 0; index < std::size(m_stats.pixels); ++index) {
+            stats->pixelsBlended[index] += m_stats.pixels[index];
+        }
+
+        if(m_offscreen) {
+            stats->offscreenCanvases++;
+            stats->offscreenBytes += uint64_t(plutovg_surface_get_stride(m_surface)) * plutovg_surface_get_height(m_surface);
+        }
+    }
+
+    if(m_offscreen) {
+        m_memory->used -= std::min<size_t>(m_memory->used, plutovg_surface_get_stride(m_surface) * plutovg_surface_get_height(m_surface));
+    }
+
     plutovg_canvas_destroy(m_canvas);
     plutovg_surface_destroy(m_surface);
 }
@@ -677,7 +799,9 @@ Canvas::Canvas(const Bitmap& bitmap)
     : m_surface(plutovg_surface_reference(bitmap.surface()))
     , m_canvas(plutovg_canvas_create(m_surface))
     , m_translation({1, 0, 0, 1, 0, 0})
+    , m_memory(std::make_shared<CanvasMemory>())
     , m_x(0), m_y(0)
+    , m_offscreen(false)
 {
 }
 
@@ -685,8 +809,111 @@ Canvas::Canvas(int x, int y, int width, int height)
     : m_surface(plutovg_surface_create(width, height))
     , m_canvas(plutovg_canvas_create(m_surface))
     , m_translation({1, 0, 0, 1, -static_cast<float>(x), -static_cast<float>(y)})
+    , m_memory(std::make_shared<CanvasMemory>())
     , m_x(x), m_y(y)
+    , m_offscreen(true)
+{
+}
+
+struct WorkerPool::Job {
+    const std::function<void(int)>* task;
+    int count;
+    int helpers;
+    std::atomic<int> next{0};
+    std::atomic<int> done{0};
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+};
+
+void WorkerPool::parallelFor(int count, int maxThreads, const std::function<void(int)>& task)
+{
+    auto helpers = std::min(std::min(maxThreads, concurrency()), count) - 1;
+    if(helpers <= 0) {
+        for(int index = 0; index < count; ++index)
+            task(index);
+        return;
+    }
+
+    auto job = std::make_shared<Job>();
+    job->task = &task;
+    job->count = count;
+    job->helpers = helpers;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.push_back(job);
+    }
+
+    m_pending.notify_all();
+    execute(*job);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_jobs.erase(std::remove(m_jobs.begin(), m_jobs.end(), job), m_jobs.end());
+    m_finished.wait(lock, [&job] { return job->done.load() == job->count; });
+    if(job->error) {
+        std::rethrow_exception(job->error);
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopped = true;
+    }
+
+    m_pending.notify_all();
+    for(auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+WorkerPool::WorkerPool()
+{
+    auto count = static_cast<int>(std::thread::hardware_concurrency());
+    for(int index = 1; index < count; ++index) {
+        m_threads.emplace_back(&WorkerPool::run, this);
+    }
+}
+
+void WorkerPool::run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while(true) {
+        m_pending.wait(lock, [this] { return m_stopped || !m_jobs.empty(); });
+        if(m_stopped)
+            return;
+        auto job = m_jobs.front();
+        if(--job->helpers == 0)
+            m_jobs.pop_front();
+        lock.unlock();
+        execute(*job);
+        lock.lock();
+        if(job->done.load() == job->count) {
+            m_finished.notify_all();
+        }
+    }
+}
+
+void WorkerPool::execute(Job& job)
+{
+    int index;
+    while((index = job.next.fetch_add(1)) < job.count) {
+        try {
+            (*job.task)(index);
+        } catch(...) {
+            if(!job.failed.exchange(true)) {
+                job.error = std::current_exception();
+            }
+        }
+
+        job.done.fetch_add(1);
+    }
+}
+
+WorkerPool* workerPool()
 {
+    static WorkerPool pool;
+    return &pool;
 }
 
 } // namespace novasvg
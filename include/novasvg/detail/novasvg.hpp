@@ -158,6 +158,35 @@ Box Box::transformed(const Matrix& matrix) const
     return Transform(matrix).mapRect(*this);
 }
 
+RenderOptions::RenderOptions(RenderQuality quality)
+{
+    switch(quality) {
+    case RenderQuality::Draft:
+        antialias = false;
+        smoothImages = false;
+        curveTolerance = 1.f;
+        gradientTableSize = 256;
+        rasterizer = Rasterizer::Sparse;
+        break;
+    case RenderQuality::Normal:
+        break;
+    case RenderQuality::High:
+        curveTolerance = 0.025f;
+        break;
+    }
+}
+
+static_assert(std::size(RenderStats().pixelsBlended) == PLUTOVG_OPERATOR_XOR + 1, "one counter per compositing operator");
+static_assert(static_cast<int>(BlendOperator::Xor) == PLUTOVG_OPERATOR_XOR, "BlendOperator mirrors plutovg_operator_t");
+
+uint64_t RenderStats::totalPixelsBlended() const
+{
+    uint64_t total = 0;
+    for(auto pixels : pixelsBlended)
+        total += pixels;
+    return total;
+}
+
 Matrix::Matrix(float a, float b, float c, float d, float e, float f)
     : a(a), b(b), c(c), d(d), e(e), f(f)
 {
@@ -329,16 +358,20 @@ void Element::setAttribute(const std::string& name, const std::string& value)
     }
 }
 
-void Element::render(Bitmap& bitmap, const Matrix& matrix) const
+RenderStatus Element::render(Bitmap& bitmap, const Matrix& matrix, const RenderOptions& options) const
 {
     if(m_node == nullptr || bitmap.isNull())
-        return;
+        return RenderStatus::Complete;
     auto canvas = Canvas::create(bitmap);
+    canvas->setRenderOptions(options);
     SVGRenderState state(nullptr, nullptr, matrix, SVGRenderMode::Painting, canvas);
-    element(true)->render(state);
+    auto renderElement = element(true);
+    StatsTimer timer(options.stats, &RenderStats::renderTime);
+    renderElement->render(state);
+    return canvas->status();
 }
 
-Bitmap Element::renderToBitmap(int width, int height, uint32_t backgroundColor) const
+Bitmap Element::renderToBitmap(int width, int height, uint32_t backgroundColor, const RenderOptions& options) const
 {
     if(m_node == nullptr)
         return Bitmap();
@@ -360,7 +393,7 @@ Bitmap Element::renderToBitmap(int width, int height, uint32_t backgroundColor)
     Matrix matrix(xScale, 0, 0, yScale, -elementBounds.x * xScale, -elementBounds.y * yScale);
     Bitmap bitmap(width, height);
     if(backgroundColor) bitmap.clear(backgroundColor);
-    render(bitmap, matrix);
+    render(bitmap, matrix, options);
     return bitmap;
 }
 
@@ -439,8 +472,14 @@ std::unique_ptr<Document> Document::loadFromData(const char* data)
 }
 
 std::unique_ptr<Document> Document::loadFromData(const char* data, size_t length)
+{
+    return loadFromData(data, length, 0);
+}
+
+std::unique_ptr<Document> Document::loadFromData(const char* data, size_t length, size_t memoryBudget)
 {
     std::unique_ptr<Document> document(new Document);
+    document->m_memoryBudget = memoryBudget;
     if(!document->parse(data, length))
         return nullptr;
     return document;
@@ -471,18 +510,93 @@ void Document::forceLayout()
     m_rootElement->forceLayout();
 }
 
-void Document::render(Bitmap& bitmap, const Matrix& matrix) const
+RenderStatus Document::render(Bitmap& bitmap, const Matrix& matrix, const RenderOptions& options) const
 {
     if(bitmap.isNull())
-        return;
+        return RenderStatus::Complete;
+    NOVASVG_TRACE_SCOPE("render", std::string_view(), int64_t(bitmap.width()) * bitmap.height());
     auto canvas = Canvas::create(bitmap);
+    canvas->setRenderOptions(options);
     SVGRenderState state(nullptr, nullptr, matrix, SVGRenderMode::Painting, canvas);
-    rootElement(true)->render(state);
+    auto root = layoutRootElement(options.stats);
+    StatsTimer timer(options.stats, &RenderStats::renderTime);
+    root->render(state);
+    return canvas->status();
+}
+
+Box Document::renderDamaged(Bitmap& bitmap, const Matrix& matrix, uint32_t backgroundColor, const RenderOptions& options)
+{
+    NOVASVG_TRACE_SCOPE("renderDamaged");
+    auto root = layoutRootElement(options.stats);
+    if(bitmap.isNull() || !root->hasDamage())
+        return Box();
+    Rect extents(0, 0, bitmap.width(), bitmap.height());
+    if(!root->isFullyDamaged()) {
+        auto damagedRect = root->damagedRect();
+        if(damagedRect.isEmpty()) {
+            root->clearDamage();
+            return Box();
+        }
+
+        damagedRect = Transform(matrix).mapRect(damagedRect);
+        damagedRect.inflate(1.f);
+        extents = extents.intersected(damagedRect);
+    }
+
+    root->clearDamage();
+    auto x0 = static_cast<int>(std::floor(extents.x));
+    auto y0 = static_cast<int>(std::floor(extents.y));
+    auto x1 = std::min(bitmap.width(), static_cast<int>(std::ceil(extents.right())));
+    auto y1 = std::min(bitmap.height(), static_cast<int>(std::ceil(extents.bottom())));
+    if(x0 >= x1 || y0 >= y1)
+        return Box();
+    // Coverage along a layer's clipped edge can round differently from a full render, so
+    // render a slightly larger area and copy back only the damaged pixels.
+    constexpr int kMargin = 2;
+    auto left = std::max(0, x0 - kMargin);
+    auto top = std::max(0, y0 - kMargin);
+    auto right = std::min(bitmap.width(), x1 + kMargin);
+    auto bottom = std::min(bitmap.height(), y1 + kMargin);
+    Bitmap region(right - left, bottom - top);
+    if(backgroundColor) region.clear(backgroundColor);
+    if(render(region, Matrix::translated(-left, -top) * matrix, options) != RenderStatus::Complete) {
+        // Whatever was left undrawn has to be repainted next time.
+        root->addFullDamage();
+    }
+
+    auto rowSize = (x1 - x0) * 4;
+    for(int y = y0; y < y1; ++y) {
+        auto source = region.data() + (y - top) * region.stride() + (x0 - left) * 4;
+        std::memcpy(bitmap.data() + y * bitmap.stride() + x0 * 4, source, rowSize);
+    }
+
+    return Box(x0, y0, x1 - x0, y1 - y0);
+}
+
+bool Document::hasAnimations() const
+{
+    return m_rootElement->hasAnimations();
+}
+
+float Document::animationDuration() const
+{
+    return m_rootElement->animationDuration();
+}
+
+void Document::setAnimationTime(float time)
+{
+    m_rootElement->setAnimationTime(time);
+}
+
+RenderStatus Document::renderFrame(float time, Bitmap& bitmap, const Matrix& matrix, const RenderOptions& options)
+{
+    setAnimationTime(time);
+    return render(bitmap, matrix, options);
 }
 
-Bitmap Document::renderToBitmap(int width, int height, uint32_t backgroundColor) const
+Bitmap Document::renderToBitmap(int width, int height, uint32_t backgroundColor, const RenderOptions& options) const
 {
-    auto intrinsicWidth = rootElement(true)->intrinsicWidth();
+    auto intrinsicWidth = layoutRootElement(options.stats)->intrinsicWidth();
     auto intrinsicHeight = rootElement()->intrinsicHeight();
     if(intrinsicWidth == 0.f || intrinsicHeight == 0.f)
         return Bitmap();
@@ -501,7 +615,7 @@ Bitmap Document::renderToBitmap(int width, int height, uint32_t backgroundColor)
     Matrix matrix(xScale, 0, 0, yScale, 0, 0);
     Bitmap bitmap(width, height);
     if(backgroundColor) bitmap.clear(backgroundColor);
-    render(bitmap, matrix);
+    render(bitmap, matrix, options);
     return bitmap;
 }
 
@@ -527,6 +641,12 @@ SVGRootElement* Document::rootElement(bool layoutIfNeeded) const
     return m_rootElement.get();
 }
 
+SVGRootElement* Document::layoutRootElement(RenderStats* stats) const
+{
+    StatsTimer timer(stats, &RenderStats::layoutTime);
+    return rootElement(true);
+}
+
 Document::Document(Document&&) = default;
 Document& Document::operator=(Document&&) = default;
 
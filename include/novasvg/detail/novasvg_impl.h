@@ -36,6 +36,7 @@ extern "C" {
 #include "plutovg/plutovg-paint.h"
 #include "plutovg/plutovg-path.h"
 #include "plutovg/plutovg-rasterize.h"
+#include "plutovg/plutovg-sparse-raster.h"
 #include "plutovg/plutovg-surface.h"
 
 #ifdef __cplusplus
@@ -44,7 +45,10 @@ extern "C" {
 
 #include "graphics.hpp"
 #include "novasvg.hpp"
+#include "svganimationelement.hpp"
+#include "svgbinary.hpp"
 #include "svgelement.hpp"
+#include "svgfilterelement.hpp"
 #include "svggeometryelement.hpp"
 #include "svglayoutstate.hpp"
 #include "svgpaintelement.hpp"
@@ -52,4 +56,5 @@ extern "C" {
 #include "svgproperty.hpp"
 #include "svgrenderstate.hpp"
 #include "svgtextelement.hpp"
+#include "tracing.hpp"
 
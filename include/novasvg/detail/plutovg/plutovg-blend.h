@@ -11,6 +11,7 @@ typedef struct {
     plutovg_matrix_t matrix;
     plutovg_spread_method_t spread;
     uint32_t colortable[COLOR_TABLE_SIZE];
+    int colortable_size;
     union {
         struct {
             float x1, y1;
@@ -165,19 +166,20 @@ void plutovg_memfill32(unsigned int* dest, int length, unsigned int value)
 
 static inline int gradient_clamp(const gradient_data_t* gradient, int ipos)
 {
+    const int size = gradient->colortable_size;
     if(gradient->spread == PLUTOVG_SPREAD_METHOD_REPEAT) {
-        ipos = ipos % COLOR_TABLE_SIZE;
-        ipos = ipos < 0 ? COLOR_TABLE_SIZE + ipos : ipos;
+        ipos = ipos % size;
+        ipos = ipos < 0 ? size + ipos : ipos;
     } else if(gradient->spread == PLUTOVG_SPREAD_METHOD_REFLECT) {
-        const int limit = COLOR_TABLE_SIZE * 2;
+        const int limit = size * 2;
         ipos = ipos % limit;
         ipos = ipos < 0 ? limit + ipos : ipos;
-        ipos = ipos >= COLOR_TABLE_SIZE ? limit - 1 - ipos : ipos;
+        ipos = ipos >= size ? limit - 1 - ipos : ipos;
     } else {
         if(ipos < 0) {
             ipos = 0;
-        } else if(ipos >= COLOR_TABLE_SIZE) {
-            ipos = COLOR_TABLE_SIZE - 1;
+        } else if(ipos >= size) {
+            ipos = size - 1;
         }
     }
 
@@ -194,7 +196,7 @@ static inline uint32_t gradient_pixel_fixed(const gradient_data_t* gradient, int
 
 static inline uint32_t gradient_pixel(const gradient_data_t* gradient, float pos)
 {
-    int ipos = (int)(pos * (COLOR_TABLE_SIZE - 1) + 0.5f);
+    int ipos = (int)(pos * (gradient->colortable_size - 1) + 0.5f);
     return gradient->colortable[gradient_clamp(gradient, ipos)];
 }
 
@@ -210,8 +212,8 @@ static void fetch_linear_gradient(uint32_t* buffer, const linear_gradient_values
         ry = gradient->matrix.d * (y + 0.5f) + gradient->matrix.b * (x + 0.5f) + gradient->matrix.f;
         t = v->dx * rx + v->dy * ry + v->off;
         inc = v->dx * gradient->matrix.a + v->dy * gradient->matrix.b;
-        t *= (COLOR_TABLE_SIZE - 1);
-        inc *= (COLOR_TABLE_SIZE - 1);
+        t *= (gradient->colortable_size - 1);
+        inc *= (gradient->colortable_size - 1);
     }
 
     const uint32_t* end = buffer + length;
@@ -228,7 +230,7 @@ static void fetch_linear_gradient(uint32_t* buffer, const linear_gradient_values
             }
         } else {
             while(buffer < end) {
-                *buffer = gradient_pixel(gradient, t / COLOR_TABLE_SIZE);
+                *buffer = gradient_pixel(gradient, t / gradient->colortable_size);
                 t += inc;
                 ++buffer;
             }
@@ -651,8 +653,47 @@ static const composition_function_t composition_table[] = {
     composition_xor
 };
 
+static void blend_solid_source(plutovg_surface_t* surface, uint32_t solid, const plutovg_span_buffer_t* span_buffer)
+{
+    /*
+     * Opaque source-over fills reach here as source. Fully covered spans are plain stores,
+     * merged with any abutting full spans on the row so interiors become one long fill;
+     * edge spans are interpolated in place instead of going through the composition table.
+     */
+    int count = span_buffer->spans.size;
+    const plutovg_span_t* spans = span_buffer->spans.data;
+    while(count--) {
+        const int x = spans->x;
+        const int y = spans->y;
+        uint32_t* target = (uint32_t*)(surface->data + y * surface->stride) + x;
+        int length = spans->len;
+        if(spans->coverage == 255) {
+            while(count && spans[1].coverage == 255 && spans[1].y == y && spans[1].x == x + length) {
+                length += spans[1].len;
+                ++spans;
+                --count;
+            }
+
+            plutovg_memfill32(target, length, solid);
+        } else {
+            uint32_t color = BYTE_MUL(solid, spans->coverage);
+            uint32_t ialpha = 255 - spans->coverage;
+            for(int i = 0; i < length; i++) {
+                target[i] = color + BYTE_MUL(target[i], ialpha);
+            }
+        }
+
+        ++spans;
+    }
+}
+
 static void blend_solid(plutovg_surface_t* surface, plutovg_operator_t op, uint32_t solid, const plutovg_span_buffer_t* span_buffer)
 {
+    if(op == PLUTOVG_OPERATOR_SRC) {
+        blend_solid_source(surface, solid, span_buffer);
+        return;
+    }
+
     composition_solid_function_t func = composition_solid_table[op];
     int count = span_buffer->spans.size;
     const plutovg_span_t* spans = span_buffer->spans.data;
@@ -1002,30 +1043,41 @@ static void blend_transformed_bilinear_tiled_argb(plutovg_surface_t* surface, pl
     }
 }
 
-static void plutovg_blend_color(plutovg_canvas_t* canvas, const plutovg_color_t* color, const plutovg_span_buffer_t* span_buffer)
-{
-    plutovg_state_t* state = canvas->state;
-    uint32_t solid = premultiply_color_with_opacity(color, state->opacity);
-    uint32_t alpha = plutovg_alpha(solid);
+typedef void(*texture_blend_function_t)(plutovg_surface_t* surface, plutovg_operator_t op, const texture_data_t* texture, const plutovg_span_buffer_t* span_buffer);
 
-    if(alpha == 255 && state->op == PLUTOVG_OPERATOR_SRC_OVER) {
-        blend_solid(canvas->surface, PLUTOVG_OPERATOR_SRC, solid, span_buffer);
-    } else {
-        blend_solid(canvas->surface, state->op, solid, span_buffer);
-    }
+typedef struct {
+    plutovg_surface_t* surface;
+    plutovg_operator_t op;
+    plutovg_paint_type_t type;
+    uint32_t solid;
+    plutovg_gradient_type_t gradient_type;
+    gradient_data_t gradient;
+    texture_data_t texture;
+    texture_blend_function_t texture_func;
+    plutovg_canvas_stats_t* stats;
+    const plutovg_raster_options_t* raster_options;
+} plutovg_blender_t;
+
+static bool plutovg_blender_init_color(plutovg_blender_t* blender, const plutovg_state_t* state, const plutovg_color_t* color)
+{
+    blender->type = PLUTOVG_PAINT_TYPE_COLOR;
+    blender->solid = premultiply_color_with_opacity(color, state->opacity);
+    if(plutovg_alpha(blender->solid) == 255 && state->op == PLUTOVG_OPERATOR_SRC_OVER)
+        blender->op = PLUTOVG_OPERATOR_SRC;
+    return true;
 }
 
-static void plutovg_blend_gradient(plutovg_canvas_t* canvas, const plutovg_gradient_paint_t* gradient, const plutovg_span_buffer_t* span_buffer)
+static bool plutovg_blender_init_gradient(plutovg_blender_t* blender, const plutovg_state_t* state, const plutovg_gradient_paint_t* gradient, int table_size)
 {
     if(gradient->nstops == 0)
-        return;
-    plutovg_state_t* state = canvas->state;
-    gradient_data_t data;
-    data.spread = gradient->spread;
-    data.matrix = gradient->matrix;
-    plutovg_matrix_multiply(&data.matrix, &data.matrix, &state->matrix);
-    if(!plutovg_matrix_invert(&data.matrix, &data.matrix))
-        return;
+        return false;
+    gradient_data_t* data = &blender->gradient;
+    data->spread = gradient->spread;
+    data->colortable_size = table_size;
+    data->matrix = gradient->matrix;
+    plutovg_matrix_multiply(&data->matrix, &data->matrix, &state->matrix);
+    if(!plutovg_matrix_invert(&data->matrix, &data->matrix))
+        return false;
     int i, pos = 0, nstops = gradient->nstops;
     const plutovg_gradient_stop_t *curr, *next, *start, *last;
     uint32_t curr_color, next_color, last_color;
@@ -1037,12 +1089,12 @@ static void plutovg_blend_gradient(plutovg_canvas_t* canvas, const plutovg_gradi
     curr = start;
     curr_color = premultiply_color_with_opacity(&curr->color, opacity);
 
-    data.colortable[pos++] = curr_color;
-    incr = 1.0f / COLOR_TABLE_SIZE;
+    data->colortable[pos++] = curr_color;
+    incr = 1.0f / table_size;
     fpos = 1.5f * incr;
 
     while(fpos <= curr->offset) {
-        data.colortable[pos] = data.colortable[pos - 1];
+        data->colortable[pos] = data->colortable[pos - 1];
         ++pos;
         fpos += incr;
     }
@@ -1054,11 +1106,11 @@ static void plutovg_blend_gradient(plutovg_canvas_t* canvas, const plutovg_gradi
             continue;
         delta = 1.f / (next->offset - curr->offset);
         next_color = premultiply_color_with_opacity(&next->color, opacity);
-        while(fpos < next->offset && pos < COLOR_TABLE_SIZE) {
+        while(fpos < next->offset && pos < table_size) {
             t = (fpos - curr->offset) * delta;
             dist = (uint32_t)(255 * t);
             idist = 255 - dist;
-            data.colortable[pos] = INTERPOLATE_PIXEL_255(curr_color, idist, next_color, dist);
+            data->colortable[pos] = INTERPOLATE_PIXEL_255(curr_color, idist, next_color, dist);
             ++pos;
             fpos += incr;
         }
@@ -1068,58 +1120,136 @@ static void plutovg_blend_gradient(plutovg_canvas_t* canvas, const plutovg_gradi
 
     last = start + nstops - 1;
     last_color = premultiply_color_with_opacity(&last->color, opacity);
-    for(; pos < COLOR_TABLE_SIZE; ++pos) {
-        data.colortable[pos] = last_color;
+    for(; pos < table_size; ++pos) {
+        data->colortable[pos] = last_color;
     }
 
+    blender->type = PLUTOVG_PAINT_TYPE_GRADIENT;
+    blender->gradient_type = gradient->type;
     if(gradient->type == PLUTOVG_GRADIENT_TYPE_LINEAR) {
-        data.values.linear.x1 = gradient->values[0];
-        data.values.linear.y1 = gradient->values[1];
-        data.values.linear.x2 = gradient->values[2];
-        data.values.linear.y2 = gradient->values[3];
-        blend_linear_gradient(canvas->surface, state->op, &data, span_buffer);
+        data->values.linear.x1 = gradient->values[0];
+        data->values.linear.y1 = gradient->values[1];
+        data->values.linear.x2 = gradient->values[2];
+        data->values.linear.y2 = gradient->values[3];
     } else {
-        data.values.radial.cx = gradient->values[0];
-        data.values.radial.cy = gradient->values[1];
-        data.values.radial.cr = gradient->values[2];
-        data.values.radial.fx = gradient->values[3];
-        data.values.radial.fy = gradient->values[4];
-        data.values.radial.fr = gradient->values[5];
-        blend_radial_gradient(canvas->surface, state->op, &data, span_buffer);
+        data->values.radial.cx = gradient->values[0];
+        data->values.radial.cy = gradient->values[1];
+        data->values.radial.cr = gradient->values[2];
+        data->values.radial.fx = gradient->values[3];
+        data->values.radial.fy = gradient->values[4];
+        data->values.radial.fr = gradient->values[5];
     }
+
+    return true;
 }
 
-static void plutovg_blend_texture(plutovg_canvas_t* canvas, const plutovg_texture_paint_t* texture, const plutovg_span_buffer_t* span_buffer)
+static bool plutovg_blender_init_texture(plutovg_blender_t* blender, const plutovg_state_t* state, const plutovg_texture_paint_t* texture, bool smoothing)
 {
     if(texture->surface == NULL)
-        return;
-    plutovg_state_t* state = canvas->state;
-    texture_data_t data;
-    data.matrix = texture->matrix;
-    data.data = texture->surface->data;
-    data.width = texture->surface->width;
-    data.height = texture->surface->height;
-    data.stride = texture->surface->stride;
-    data.const_alpha = lroundf(state->opacity * texture->opacity * 256);
-
-    plutovg_matrix_multiply(&data.matrix, &data.matrix, &state->matrix);
-    if(!plutovg_matrix_invert(&data.matrix, &data.matrix))
-        return;
-    const plutovg_matrix_t* matrix = &data.matrix;
+        return false;
+    texture_data_t* data = &blender->texture;
+    data->matrix = texture->matrix;
+    data->data = texture->surface->data;
+    data->width = texture->surface->width;
+    data->height = texture->surface->height;
+    data->stride = texture->surface->stride;
+    data->const_alpha = lroundf(state->opacity * texture->opacity * 256);
+
+    plutovg_matrix_multiply(&data->matrix, &data->matrix, &state->matrix);
+    if(!plutovg_matrix_invert(&data->matrix, &data->matrix))
+        return false;
+    const plutovg_matrix_t* matrix = &data->matrix;
     if(matrix->a == 1 && matrix->b == 0 && matrix->c == 0 && matrix->d == 1) {
         if(texture->type == PLUTOVG_TEXTURE_TYPE_PLAIN) {
-            blend_untransformed_argb(canvas->surface, state->op, &data, span_buffer);
+            blender->texture_func = blend_untransformed_argb;
         } else {
-            blend_untransformed_tiled_argb(canvas->surface, state->op, &data, span_buffer);
+            blender->texture_func = blend_untransformed_tiled_argb;
         }
     } else {
         if(texture->type == PLUTOVG_TEXTURE_TYPE_PLAIN) {
-            blend_transformed_argb(canvas->surface, state->op, &data, span_buffer);
-        } else if(fabsf(matrix->b) > 1e-6f || fabsf(matrix->c) > 1e-6f) {
-            blend_transformed_bilinear_tiled_argb(canvas->surface, state->op, &data, span_buffer);
+            blender->texture_func = blend_transformed_argb;
+        } else if(smoothing && (fabsf(matrix->b) > 1e-6f || fabsf(matrix->c) > 1e-6f)) {
+            blender->texture_func = blend_transformed_bilinear_tiled_argb;
+        } else {
+            blender->texture_func = blend_transformed_tiled_argb;
+        }
+    }
+
+    blender->type = PLUTOVG_PAINT_TYPE_TEXTURE;
+    return true;
+}
+
+static bool plutovg_blender_init(plutovg_blender_t* blender, plutovg_canvas_t* canvas)
+{
+    const plutovg_state_t* state = canvas->state;
+    blender->surface = canvas->surface;
+    blender->op = state->op;
+    blender->stats = canvas->stats;
+    blender->raster_options = &canvas->raster_options;
+    if(state->paint == NULL)
+        return plutovg_blender_init_color(blender, state, &state->color);
+    const plutovg_paint_t* paint = state->paint;
+    if(paint->type == PLUTOVG_PAINT_TYPE_COLOR) {
+        const plutovg_solid_paint_t* solid = (const plutovg_solid_paint_t*)(paint);
+        return plutovg_blender_init_color(blender, state, &solid->color);
+    }
+
+    if(paint->type == PLUTOVG_PAINT_TYPE_GRADIENT) {
+        const plutovg_gradient_paint_t* gradient = (const plutovg_gradient_paint_t*)(paint);
+        return plutovg_blender_init_gradient(blender, state, gradient, canvas->gradient_table_size);
+    }
+
+    const plutovg_texture_paint_t* texture = (const plutovg_texture_paint_t*)(paint);
+    return plutovg_blender_init_texture(blender, state, texture, canvas->image_smoothing);
+}
+
+static void plutovg_blender_blend_spans(const plutovg_blender_t* blender, const plutovg_span_buffer_t* span_buffer)
+{
+    if(blender->stats) {
+        const plutovg_span_t* spans = span_buffer->spans.data;
+        unsigned long long pixels = 0;
+        for(int i = 0; i < span_buffer->spans.size; i++)
+            pixels += spans[i].len;
+        blender->stats->spans += span_buffer->spans.size;
+        blender->stats->pixels[blender->op] += pixels;
+    }
+
+    switch(blender->type) {
+    case PLUTOVG_PAINT_TYPE_COLOR:
+        blend_solid(blender->surface, blender->op, blender->solid, span_buffer);
+        break;
+    case PLUTOVG_PAINT_TYPE_GRADIENT:
+        if(blender->gradient_type == PLUTOVG_GRADIENT_TYPE_LINEAR) {
+            blend_linear_gradient(blender->surface, blender->op, &blender->gradient, span_buffer);
         } else {
-            blend_transformed_tiled_argb(canvas->surface, state->op, &data, span_buffer);
+            blend_radial_gradient(blender->surface, blender->op, &blender->gradient, span_buffer);
         }
+
+        break;
+    case PLUTOVG_PAINT_TYPE_TEXTURE:
+        blender->texture_func(blender->surface, blender->op, &blender->texture, span_buffer);
+        break;
+    }
+}
+
+/* The number of spans composited between two polls of the interrupt callback. */
+#define PLUTOVG_BLEND_INTERRUPT_INTERVAL 256
+
+static void plutovg_blender_blend(const plutovg_blender_t* blender, const plutovg_span_buffer_t* span_buffer)
+{
+    if(blender->raster_options->interrupt == NULL) {
+        plutovg_blender_blend_spans(blender, span_buffer);
+        return;
+    }
+
+    plutovg_span_buffer_t batch = *span_buffer;
+    for(int offset = 0; offset < span_buffer->spans.size; offset += PLUTOVG_BLEND_INTERRUPT_INTERVAL) {
+        if(plutovg_raster_interrupted(blender->raster_options))
+            return;
+        batch.spans.data = span_buffer->spans.data + offset;
+        batch.spans.size = plutovg_min(PLUTOVG_BLEND_INTERRUPT_INTERVAL, span_buffer->spans.size - offset);
+        batch.spans.capacity = batch.spans.size;
+        plutovg_blender_blend_spans(blender, &batch);
     }
 }
 
@@ -1127,20 +1257,29 @@ void plutovg_blend(plutovg_canvas_t* canvas, const plutovg_span_buffer_t* span_b
 {
     if(span_buffer->spans.size == 0)
         return;
-    if(canvas->state->paint == NULL) {
-        plutovg_blend_color(canvas, &canvas->state->color, span_buffer);
-        return;
+    plutovg_blender_t blender;
+    if(plutovg_blender_init(&blender, canvas)) {
+        plutovg_blender_blend(&blender, span_buffer);
     }
+}
 
-    plutovg_paint_t* paint = canvas->state->paint;
-    if(paint->type == PLUTOVG_PAINT_TYPE_COLOR) {
-        plutovg_solid_paint_t* solid = (plutovg_solid_paint_t*)(paint);
-        plutovg_blend_color(canvas, &solid->color, span_buffer);
-    } else if(paint->type == PLUTOVG_PAINT_TYPE_GRADIENT) {
-        plutovg_gradient_paint_t* gradient = (plutovg_gradient_paint_t*)(paint);
-        plutovg_blend_gradient(canvas, gradient, span_buffer);
-    } else {
-        plutovg_texture_paint_t* texture = (plutovg_texture_paint_t*)(paint);
-        plutovg_blend_texture(canvas, texture, span_buffer);
+static void blend_spans_callback(int count, const plutovg_span_t* spans, void* closure)
+{
+    plutovg_span_buffer_t span_buffer;
+    span_buffer.spans.data = const_cast<plutovg_span_t*>(spans);
+    span_buffer.spans.size = count;
+    span_buffer.spans.capacity = count;
+    span_buffer.x = 0;
+    span_buffer.y = 0;
+    span_buffer.w = -1;
+    span_buffer.h = -1;
+    plutovg_blender_blend(static_cast<const plutovg_blender_t*>(closure), &span_buffer);
+}
+
+void plutovg_blend_path(plutovg_canvas_t* canvas, const plutovg_stroke_data_t* stroke_data, plutovg_fill_rule_t winding)
+{
+    plutovg_blender_t blender;
+    if(plutovg_blender_init(&blender, canvas)) {
+        plutovg_rasterize_spans(blend_spans_callback, &blender, canvas->path, &canvas->state->matrix, &canvas->clip_rect, stroke_data, winding, &canvas->raster_options);
     }
 }
@@ -15,6 +15,53 @@ const char* plutovg_version_string(void)
 
 #define PLUTOVG_DEFAULT_STROKE_STYLE ((plutovg_stroke_style_t){1.f, PLUTOVG_LINE_CAP_BUTT, PLUTOVG_LINE_JOIN_MITER, 10.f})
 
+static plutovg_clip_spans_t* plutovg_clip_spans_create(void)
+{
+    plutovg_clip_spans_t* clip = static_cast<plutovg_clip_spans_t*>(malloc(sizeof(plutovg_clip_spans_t)));
+    plutovg_init_reference(clip);
+    plutovg_span_buffer_init(&clip->spans);
+    return clip;
+}
+
+static plutovg_clip_spans_t* plutovg_clip_spans_reference(plutovg_clip_spans_t* clip)
+{
+    plutovg_increment_reference(clip);
+    return clip;
+}
+
+static void plutovg_clip_spans_destroy(plutovg_clip_spans_t* clip)
+{
+    if(plutovg_destroy_reference(clip)) {
+        plutovg_span_buffer_destroy(&clip->spans);
+        free(clip);
+    }
+}
+
+static plutovg_dash_array_t* plutovg_dash_array_create(const float* dashes, int ndashes)
+{
+    if(dashes == NULL || ndashes <= 0)
+        return NULL;
+    plutovg_dash_array_t* array = static_cast<plutovg_dash_array_t*>(malloc(sizeof(plutovg_dash_array_t) + ndashes * sizeof(float)));
+    plutovg_init_reference(array);
+    array->size = ndashes;
+    array->data = reinterpret_cast<float*>(array + 1);
+    memcpy(array->data, dashes, ndashes * sizeof(float));
+    return array;
+}
+
+static plutovg_dash_array_t* plutovg_dash_array_reference(plutovg_dash_array_t* array)
+{
+    plutovg_increment_reference(array);
+    return array;
+}
+
+static void plutovg_dash_array_destroy(plutovg_dash_array_t* array)
+{
+    if(plutovg_destroy_reference(array)) {
+        free(array);
+    }
+}
+
 static plutovg_state_t* plutovg_state_create(void)
 {
     plutovg_state_t* state = static_cast<plutovg_state_t*>(malloc(sizeof(plutovg_state_t)));
@@ -24,13 +71,12 @@ static plutovg_state_t* plutovg_state_create(void)
     state->matrix = PLUTOVG_IDENTITY_MATRIX;
     state->stroke.style = PLUTOVG_DEFAULT_STROKE_STYLE;
     state->stroke.dash.offset = 0.f;
-    plutovg_array_init(state->stroke.dash.array);
-    plutovg_span_buffer_init(&state->clip_spans);
+    state->stroke.dash.array = NULL;
+    state->clip = NULL;
     state->winding = PLUTOVG_FILL_RULE_NON_ZERO;
     state->op = PLUTOVG_OPERATOR_SRC_OVER;
     state->font_size = 12.f;
     state->opacity = 1.f;
-    state->clipping = false;
     state->next = NULL;
     return state;
 }
@@ -45,13 +91,14 @@ static void plutovg_state_reset(plutovg_state_t* state)
     state->matrix = PLUTOVG_IDENTITY_MATRIX;
     state->stroke.style = PLUTOVG_DEFAULT_STROKE_STYLE;
     state->stroke.dash.offset = 0.f;
-    plutovg_array_clear(state->stroke.dash.array);
-    plutovg_span_buffer_reset(&state->clip_spans);
+    plutovg_dash_array_destroy(state->stroke.dash.array);
+    plutovg_clip_spans_destroy(state->clip);
+    state->stroke.dash.array = NULL;
+    state->clip = NULL;
     state->winding = PLUTOVG_FILL_RULE_NON_ZERO;
     state->op = PLUTOVG_OPERATOR_SRC_OVER;
     state->font_size = 12.f;
     state->opacity = 1.f;
-    state->clipping = false;
 }
 
 static void plutovg_state_copy(plutovg_state_t* state, const plutovg_state_t* source)
@@ -62,22 +109,20 @@ static void plutovg_state_copy(plutovg_state_t* state, const plutovg_state_t* so
     state->matrix = source->matrix;
     state->stroke.style = source->stroke.style;
     state->stroke.dash.offset = source->stroke.dash.offset;
-    plutovg_array_clear(state->stroke.dash.array);
-    plutovg_array_append(state->stroke.dash.array, source->stroke.dash.array);
-    plutovg_span_buffer_copy(&state->clip_spans, &source->clip_spans);
+    state->stroke.dash.array = plutovg_dash_array_reference(source->stroke.dash.array);
+    state->clip = plutovg_clip_spans_reference(source->clip);
     state->winding = source->winding;
     state->op = source->op;
     state->font_size = source->font_size;
     state->opacity = source->opacity;
-    state->clipping = source->clipping;
 }
 
 static void plutovg_state_destroy(plutovg_state_t* state)
 {
     plutovg_paint_destroy(state->paint);
     plutovg_font_face_destroy(state->font_face);
-    plutovg_array_destroy(state->stroke.dash.array);
-    plutovg_span_buffer_destroy(&state->clip_spans);
+    plutovg_dash_array_destroy(state->stroke.dash.array);
+    plutovg_clip_spans_destroy(state->clip);
     free(state);
 }
 
@@ -91,6 +136,14 @@ plutovg_canvas_t* plutovg_canvas_create(plutovg_surface_t* surface)
     canvas->freed_state = NULL;
     canvas->face_cache = NULL;
     canvas->clip_rect = PLUTOVG_MAKE_RECT(0, 0, surface->width, surface->height);
+    canvas->raster_options.rasterizer = PLUTOVG_RASTERIZER_GRAY;
+    canvas->raster_options.tolerance = PLUTOVG_DEFAULT_CURVE_TOLERANCE;
+    canvas->raster_options.antialias = true;
+    canvas->raster_options.interrupt = NULL;
+    canvas->raster_options.interrupt_closure = NULL;
+    canvas->image_smoothing = true;
+    canvas->gradient_table_size = 1024;
+    canvas->stats = NULL;
     plutovg_span_buffer_init(&canvas->clip_spans);
     plutovg_span_buffer_init(&canvas->fill_spans);
     return canvas;
@@ -295,6 +348,72 @@ plutovg_operator_t plutovg_canvas_get_operator(const plutovg_canvas_t* canvas)
     return canvas->state->op;
 }
 
+void plutovg_canvas_set_rasterizer(plutovg_canvas_t* canvas, plutovg_rasterizer_t rasterizer)
+{
+    canvas->raster_options.rasterizer = rasterizer;
+}
+
+plutovg_rasterizer_t plutovg_canvas_get_rasterizer(const plutovg_canvas_t* canvas)
+{
+    return canvas->raster_options.rasterizer;
+}
+
+void plutovg_canvas_set_curve_tolerance(plutovg_canvas_t* canvas, float tolerance)
+{
+    canvas->raster_options.tolerance = plutovg_clamp(tolerance, 1.f / 64.f, 64.f);
+}
+
+float plutovg_canvas_get_curve_tolerance(const plutovg_canvas_t* canvas)
+{
+    return canvas->raster_options.tolerance;
+}
+
+void plutovg_canvas_set_antialias(plutovg_canvas_t* canvas, bool antialias)
+{
+    canvas->raster_options.antialias = antialias;
+}
+
+bool plutovg_canvas_get_antialias(const plutovg_canvas_t* canvas)
+{
+    return canvas->raster_options.antialias;
+}
+
+void plutovg_canvas_set_image_smoothing(plutovg_canvas_t* canvas, bool smoothing)
+{
+    canvas->image_smoothing = smoothing;
+}
+
+bool plutovg_canvas_get_image_smoothing(const plutovg_canvas_t* canvas)
+{
+    return canvas->image_smoothing;
+}
+
+void plutovg_canvas_set_gradient_table_size(plutovg_canvas_t* canvas, int size)
+{
+    canvas->gradient_table_size = plutovg_clamp(size, 2, 1024);
+}
+
+int plutovg_canvas_get_gradient_table_size(const plutovg_canvas_t* canvas)
+{
+    return canvas->gradient_table_size;
+}
+
+void plutovg_canvas_set_stats(plutovg_canvas_t* canvas, plutovg_canvas_stats_t* stats)
+{
+    canvas->stats = stats;
+}
+
+plutovg_canvas_stats_t* plutovg_canvas_get_stats(const plutovg_canvas_t* canvas)
+{
+    return canvas->stats;
+}
+
+void plutovg_canvas_set_interrupt(plutovg_canvas_t* canvas, plutovg_interrupt_func_t func, void* closure)
+{
+    canvas->raster_options.interrupt = func;
+    canvas->raster_options.interrupt_closure = closure;
+}
+
 void plutovg_canvas_set_opacity(plutovg_canvas_t* canvas, float opacity)
 {
     canvas->state->opacity = plutovg_clamp(opacity, 0.f, 1.f);
@@ -363,15 +482,17 @@ float plutovg_canvas_get_dash_offset(const plutovg_canvas_t* canvas)
 
 void plutovg_canvas_set_dash_array(plutovg_canvas_t* canvas, const float* dashes, int ndashes)
 {
-    plutovg_array_clear(canvas->state->stroke.dash.array);
-    plutovg_array_append_data(canvas->state->stroke.dash.array, dashes, ndashes);
+    plutovg_dash_array_t* array = plutovg_dash_array_create(dashes, ndashes);
+    plutovg_dash_array_destroy(canvas->state->stroke.dash.array);
+    canvas->state->stroke.dash.array = array;
 }
 
 int plutovg_canvas_get_dash_array(const plutovg_canvas_t* canvas, const float** dashes)
 {
+    const plutovg_dash_array_t* array = canvas->state->stroke.dash.array;
     if(dashes)
-        *dashes = canvas->state->stroke.dash.array.data;
-    return canvas->state->stroke.dash.array.size;
+        *dashes = array ? array->data : NULL;
+    return array ? array->size : 0;
 }
 
 void plutovg_canvas_translate(plutovg_canvas_t* canvas, float tx, float ty)
@@ -506,20 +627,20 @@ plutovg_path_t* plutovg_canvas_get_path(const plutovg_canvas_t* canvas)
 
 bool plutovg_canvas_fill_contains(plutovg_canvas_t* canvas, float x, float y)
 {
-    plutovg_rasterize(&canvas->fill_spans, canvas->path, &canvas->state->matrix, NULL, NULL, canvas->state->winding);
+    plutovg_rasterize(&canvas->fill_spans, canvas->path, &canvas->state->matrix, NULL, NULL, canvas->state->winding, &canvas->raster_options);
     return plutovg_span_buffer_contains(&canvas->fill_spans, x, y);
 }
 
 bool plutovg_canvas_stroke_contains(plutovg_canvas_t* canvas, float x, float y)
 {
-    plutovg_rasterize(&canvas->fill_spans, canvas->path, &canvas->state->matrix, NULL, NULL, canvas->state->winding);
+    plutovg_rasterize(&canvas->fill_spans, canvas->path, &canvas->state->matrix, NULL, NULL, canvas->state->winding, &canvas->raster_options);
     return plutovg_span_buffer_contains(&canvas->fill_spans, x, y);
 }
 
 bool plutovg_canvas_clip_contains(plutovg_canvas_t* canvas, float x, float y)
 {
-    if(canvas->state->clipping) {
-        return plutovg_span_buffer_contains(&canvas->state->clip_spans, x, y);
+    if(canvas->state->clip) {
+        return plutovg_span_buffer_contains(&canvas->state->clip->spans, x, y);
     }
 
     float l = canvas->clip_rect.x;
@@ -532,20 +653,20 @@ bool plutovg_canvas_clip_contains(plutovg_canvas_t* canvas, float x, float y)
 
 void plutovg_canvas_fill_extents(plutovg_canvas_t *canvas, plutovg_rect_t* extents)
 {
-    plutovg_rasterize(&canvas->fill_spans, canvas->path, &canvas->state->matrix, NULL, NULL, canvas->state->winding);
+    plutovg_rasterize(&canvas->fill_spans, canvas->path, &canvas->state->matrix, NULL, NULL, canvas->state->winding, &canvas->raster_options);
     plutovg_span_buffer_extents(&canvas->fill_spans, extents);
 }
 
 void plutovg_canvas_stroke_extents(plutovg_canvas_t *canvas, plutovg_rect_t* extents)
 {
-    plutovg_rasterize(&canvas->fill_spans, canvas->path, &canvas->state->matrix, NULL, &canvas->state->stroke, PLUTOVG_FILL_RULE_NON_ZERO);
+    plutovg_rasterize(&canvas->fill_spans, canvas->path, &canvas->state->matrix, NULL, &canvas->state->stroke, PLUTOVG_FILL_RULE_NON_ZERO, &canvas->raster_options);
     plutovg_span_buffer_extents(&canvas->fill_spans, extents);
 }
 
 void plutovg_canvas_clip_extents(plutovg_canvas_t* canvas, plutovg_rect_t* extents)
 {
-    if(canvas->state->clipping) {
-        plutovg_span_buffer_extents(&canvas->state->clip_spans, extents);
+    if(canvas->state->clip) {
+        plutovg_span_buffer_extents(&canvas->state->clip->spans, extents);
     } else {
         extents->x = canvas->clip_rect.x;
         extents->y = canvas->clip_rect.y;
@@ -574,8 +695,8 @@ void plutovg_canvas_clip(plutovg_canvas_t* canvas)
 
 void plutovg_canvas_paint(plutovg_canvas_t* canvas)
 {
-    if(canvas->state->clipping) {
-        plutovg_blend(canvas, &canvas->state->clip_spans);
+    if(canvas->state->clip) {
+        plutovg_blend(canvas, &canvas->state->clip->spans);
     } else {
         plutovg_span_buffer_init_rect(&canvas->clip_spans, 0, 0, canvas->surface->width, canvas->surface->height);
         plutovg_blend(canvas, &canvas->clip_spans);
@@ -584,36 +705,50 @@ void plutovg_canvas_paint(plutovg_canvas_t* canvas)
 
 void plutovg_canvas_fill_preserve(plutovg_canvas_t* canvas)
 {
-    plutovg_rasterize(&canvas->fill_spans, canvas->path, &canvas->state->matrix, &canvas->clip_rect, NULL, canvas->state->winding);
-    if(canvas->state->clipping) {
-        plutovg_span_buffer_intersect(&canvas->clip_spans, &canvas->fill_spans, &canvas->state->clip_spans);
-        plutovg_blend(canvas, &canvas->clip_spans);
-    } else {
-        plutovg_blend(canvas, &canvas->fill_spans);
+    if(canvas->state->clip == NULL) {
+        plutovg_blend_path(canvas, NULL, canvas->state->winding);
+        return;
     }
+
+    plutovg_rasterize(&canvas->fill_spans, canvas->path, &canvas->state->matrix, &canvas->clip_rect, NULL, canvas->state->winding, &canvas->raster_options);
+    plutovg_span_buffer_intersect(&canvas->clip_spans, &canvas->fill_spans, &canvas->state->clip->spans);
+    plutovg_blend(canvas, &canvas->clip_spans);
 }
 
 void plutovg_canvas_stroke_preserve(plutovg_canvas_t* canvas)
 {
-    plutovg_rasterize(&canvas->fill_spans, canvas->path, &canvas->state->matrix, &canvas->clip_rect, &canvas->state->stroke, PLUTOVG_FILL_RULE_NON_ZERO);
-    if(canvas->state->clipping) {
-        plutovg_span_buffer_intersect(&canvas->clip_spans, &canvas->fill_spans, &canvas->state->clip_spans);
-        plutovg_blend(canvas, &canvas->clip_spans);
-    } else {
-        plutovg_blend(canvas, &canvas->fill_spans);
+    if(canvas->state->clip == NULL) {
+        plutovg_blend_path(canvas, &canvas->state->stroke, PLUTOVG_FILL_RULE_NON_ZERO);
+        return;
     }
+
+    /* Bound the stroke by the clip extents so that subpaths and dashes outside them are skipped. */
+    plutovg_rect_t clip_rect;
+    plutovg_span_buffer_extents(&canvas->state->clip->spans, &clip_rect);
+    plutovg_rasterize(&canvas->fill_spans, canvas->path, &canvas->state->matrix, &clip_rect, &canvas->state->stroke, PLUTOVG_FILL_RULE_NON_ZERO, &canvas->raster_options);
+    plutovg_span_buffer_intersect(&canvas->clip_spans, &canvas->fill_spans, &canvas->state->clip->spans);
+    plutovg_blend(canvas, &canvas->clip_spans);
 }
 
 void plutovg_canvas_clip_preserve(plutovg_canvas_t* canvas)
 {
-    if(canvas->state->clipping) {
-        plutovg_rasterize(&canvas->fill_spans, canvas->path, &canvas->state->matrix, &canvas->clip_rect, NULL, canvas->state->winding);
-        plutovg_span_buffer_intersect(&canvas->clip_spans, &canvas->fill_spans, &canvas->state->clip_spans);
-        plutovg_span_buffer_copy(&canvas->state->clip_spans, &canvas->clip_spans);
-    } else {
-        plutovg_rasterize(&canvas->state->clip_spans, canvas->path, &canvas->state->matrix, &canvas->clip_rect, NULL, canvas->state->winding);
-        canvas->state->clipping = true;
+    plutovg_state_t* state = canvas->state;
+    if(state->clip == NULL) {
+        state->clip = plutovg_clip_spans_create();
+        plutovg_rasterize(&state->clip->spans, canvas->path, &state->matrix, &canvas->clip_rect, NULL, state->winding, &canvas->raster_options);
+        return;
+    }
+
+    plutovg_rasterize(&canvas->fill_spans, canvas->path, &state->matrix, &canvas->clip_rect, NULL, state->winding, &canvas->raster_options);
+    plutovg_span_buffer_intersect(&canvas->clip_spans, &canvas->fill_spans, &state->clip->spans);
+    if(plutovg_get_reference_count(state->clip) > 1) {
+        plutovg_clip_spans_destroy(state->clip);
+        state->clip = plutovg_clip_spans_create();
     }
+
+    plutovg_span_buffer_t spans = state->clip->spans;
+    state->clip->spans = canvas->clip_spans;
+    canvas->clip_spans = spans;
 }
 
 void plutovg_canvas_fill_rect(plutovg_canvas_t* canvas, float x, float y, float w, float h)
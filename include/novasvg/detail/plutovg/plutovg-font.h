@@ -132,6 +132,20 @@ typedef mtx_t plutovg_mutex_t;
 #define plutovg_mutex_unlock(mutex) mtx_unlock(mutex)
 #define plutovg_mutex_destroy(mutex) mtx_destroy(mutex)
 
+#elif defined(__cplusplus)
+
+extern "C++" {
+#include <mutex>
+#include <new>
+}
+
+typedef std::recursive_mutex plutovg_mutex_t;
+
+#define plutovg_mutex_init(mutex) (void)(new (mutex) plutovg_mutex_t)
+#define plutovg_mutex_lock(mutex) (mutex)->lock()
+#define plutovg_mutex_unlock(mutex) (mutex)->unlock()
+#define plutovg_mutex_destroy(mutex) (mutex)->~plutovg_mutex_t()
+
 #else
 
 typedef int plutovg_mutex_t;
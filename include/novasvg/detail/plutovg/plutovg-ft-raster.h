@@ -305,6 +305,10 @@ typedef void
 
 #define PVG_FT_Raster_Span_Func  PVG_FT_SpanFunc
 
+  /* Polled between bands; a nonzero result stops the rendering early. */
+typedef int
+    (*PVG_FT_InterruptFunc)( void*  user );
+
 
 
 /*************************************************************************/
@@ -386,6 +390,15 @@ typedef void
 /*                   should be expressed in _integer_ pixels (and not in */
 /*                   26.6 fixed-point units).                            */
 /*                                                                       */
+/*    tolerance   :: The maximum distance, in 26.6 fixed-point units,    */
+/*                   between a curve and the line segments approximating */
+/*                   it.  A value of zero selects a tolerance of 1/16    */
+/*                   pixel.                                              */
+/*                                                                       */
+/*    interrupt   :: An optional callback, polled with `user' between    */
+/*                   bands, that abandons the remaining bands when it    */
+/*                   returns nonzero.                                    */
+/*                                                                       */
 /* <Note>                                                                */
 /*    An anti-aliased glyph bitmap is drawn if the @PVG_FT_RASTER_FLAG_AA    */
 /*    bit flag is set in the `flags' field, otherwise a monochrome       */
@@ -410,6 +423,8 @@ typedef struct  PVG_FT_Raster_Params_
     PVG_FT_SpanFunc          gray_spans;
     void*                   user;
     PVG_FT_BBox              clip_box;
+    PVG_FT_Pos               tolerance;
+    PVG_FT_InterruptFunc     interrupt;
 
 } PVG_FT_Raster_Params;
 
@@ -560,6 +575,10 @@ PVG_FT_END_STMNT
   /* maximal number of gray spans in a call to the span callback */
 #define PVG_FT_MAX_GRAY_SPANS  256
 
+  /* maximal number of segments a single curve is flattened into; */
+  /* 14 bisections fit in the conic and cubic bisection stacks    */
+#define PVG_FT_MAX_CURVE_SEGMENTS  ( 1 << 14 )
+
 
   typedef struct TCell_*  PCell;
 
@@ -596,12 +615,17 @@ PVG_FT_END_STMNT
     int clip_flags;
     int clipping;
 
+    TPos    conic_limit;
+    TPos    cubic_limit;
+
     PVG_FT_Span     gray_spans[PVG_FT_MAX_GRAY_SPANS];
     int         num_gray_spans;
     int         skip_spans;
 
     PVG_FT_Raster_Span_Func  render_span;
     void*                render_span_data;
+    PVG_FT_InterruptFunc     interrupt;
+    int                  interrupted;
 
     int  band_size;
     int  band_shoot;
@@ -1429,9 +1453,9 @@ PVG_FT_END_STMNT
 
     /* We can calculate the number of necessary bisections because  */
     /* each bisection predictably reduces deviation exactly 4-fold. */
-    /* Even 32-bit deviation would vanish after 16 bisections.      */
+    /* The count is capped to keep within the bisection stack.      */
     draw = 1;
-    while ( dx > ONE_PIXEL / 4 )
+    while ( dx > ras.conic_limit && draw < PVG_FT_MAX_CURVE_SEGMENTS )
     {
       dx >>= 2;
       draw <<= 1;
@@ -1492,10 +1516,8 @@ PVG_FT_END_STMNT
   {
     PVG_FT_Vector   bez_stack[16 * 3 + 1];  /* enough to accommodate bisections */
     PVG_FT_Vector*  arc = bez_stack;
-    PVG_FT_Vector*  limit = bez_stack + 45;
-    TPos        dx, dy, dx_, dy_;
-    TPos        dx1, dy1, dx2, dy2;
-    TPos        L, s, s_limit;
+    TPos        dx, dy, dx1, dy1;
+    int         draw, split;
 
 
     arc[0].x = UPSCALE( to->x );
@@ -1524,64 +1546,42 @@ PVG_FT_END_STMNT
       return;
     }
 
-    for (;;)
-    {
-      /* Decide whether to split or draw. See `Rapid Termination          */
-      /* Evaluation for Recursive Subdivision of Bezier Curves' by Thomas */
-      /* F. Hain, at                                                      */
-      /* http://www.cis.southalabama.edu/~hain/general/Publications/Bezier/Camera-ready%20CISST02%202.pdf */
-
-
-      /* dx and dy are x and y components of the P0-P3 chord vector. */
-      dx = dx_ = arc[3].x - arc[0].x;
-      dy = dy_ = arc[3].y - arc[0].y;
-
-      L = PVG_FT_HYPOT( dx_, dy_ );
-
-      /* Avoid possible arithmetic overflow below by splitting. */
-      if ( L >= (1 << 23) )
-        goto Split;
-
-      /* Max deviation may be as much as (s/L) * 3/4 (if Hain's v = 1). */
-      s_limit = L * (TPos)( ONE_PIXEL / 6 );
-
-      /* s is L * the perpendicular distance from P1 to the line P0-P3. */
-      dx1 = arc[1].x - arc[0].x;
-      dy1 = arc[1].y - arc[0].y;
-      s = PVG_FT_ABS( dy * dx1 - dx * dy1 );
-
-      if ( s > s_limit )
-        goto Split;
-
-      /* s is L * the perpendicular distance from P2 to the line P0-P3. */
-      dx2 = arc[2].x - arc[0].x;
-      dy2 = arc[2].y - arc[0].y;
-      s = PVG_FT_ABS( dy * dx2 - dx * dy2 );
+    /* The deviation of a cubic from its chords is bounded by 3/4 of  */
+    /* its largest second difference (Wang's formula).  As with the   */
+    /* conic, each bisection reduces the second differences exactly   */
+    /* 4-fold, so the number of uniform segments is known up front.   */
+    dx  = PVG_FT_ABS( arc[0].x - 2 * arc[1].x + arc[2].x );
+    dy  = PVG_FT_ABS( arc[0].y - 2 * arc[1].y + arc[2].y );
+    dx1 = PVG_FT_ABS( arc[1].x - 2 * arc[2].x + arc[3].x );
+    dy1 = PVG_FT_ABS( arc[1].y - 2 * arc[2].y + arc[3].y );
+    if ( dx < dy )
+      dx = dy;
+    if ( dx < dx1 )
+      dx = dx1;
+    if ( dx < dy1 )
+      dx = dy1;
 
-      if ( s > s_limit )
-        goto Split;
+    draw = 1;
+    while ( dx > ras.cubic_limit && draw < PVG_FT_MAX_CURVE_SEGMENTS )
+    {
+      dx >>= 2;
+      draw <<= 1;
+    }
 
-      /* Split super curvy segments where the off points are so far
-         from the chord that the angles P0-P1-P3 or P0-P2-P3 become
-         acute as detected by appropriate dot products. */
-      if ( dx1 * ( dx1 - dx ) + dy1 * ( dy1 - dy ) > 0 ||
-           dx2 * ( dx2 - dx ) + dy2 * ( dy2 - dy ) > 0 )
-        goto Split;
+    do
+    {
+      split = 1;
+      while ( ( draw & split ) == 0 )
+      {
+        gray_split_cubic( arc );
+        arc += 3;
+        split <<= 1;
+      }
 
       gray_line_to( RAS_VAR_ arc[0].x, arc[0].y );
-
-      if ( arc == bez_stack )
-        return;
-
       arc -= 3;
-      continue;
 
-    Split:
-      if( arc == limit )
-        return;
-      gray_split_cubic( arc );
-      arc += 3;
-    }
+    } while ( --draw );
   }
 
 
@@ -2131,6 +2131,12 @@ void PVG_FT_Outline_Get_CBox(const PVG_FT_Outline* outline, PVG_FT_BBox* acbox)
 
     for ( n = 0; n < num_bands; n++, min = max )
     {
+      if ( ras.interrupt && ras.interrupt( ras.render_span_data ) )
+      {
+        ras.interrupted = 1;
+        break;
+      }
+
       max = min + ras.band_size;
       if ( n == num_bands - 1 || max > max_y )
         max = max_y;
@@ -2237,6 +2243,8 @@ void PVG_FT_Outline_Get_CBox(const PVG_FT_Outline* outline, PVG_FT_BBox* acbox)
                       const PVG_FT_Raster_Params*  params )
   {
     const PVG_FT_Outline*  outline    = (const PVG_FT_Outline*)params->source;
+    TPos                   tolerance;
+
     if ( outline == NULL )
       return ErrRaster_Invalid_Outline;
 
@@ -2280,6 +2288,15 @@ void PVG_FT_Outline_Get_CBox(const PVG_FT_Outline* outline, PVG_FT_BBox* acbox)
 
     ras.render_span      = (PVG_FT_Raster_Span_Func)params->gray_spans;
     ras.render_span_data = params->user;
+    ras.interrupt        = params->interrupt;
+    ras.interrupted      = 0;
+
+    /* a conic deviates by a quarter of its second difference, a */
+    /* cubic by three quarters of its largest one                */
+    tolerance = params->tolerance > 0 ? UPSCALE( params->tolerance )
+                                      : ONE_PIXEL / 16;
+    ras.conic_limit = 4 * tolerance;
+    ras.cubic_limit = PVG_FT_MAX( 1, 4 * tolerance / 3 );
 
     return gray_convert_glyph( RAS_VAR );
   }
@@ -2292,9 +2309,10 @@ void PVG_FT_Outline_Get_CBox(const PVG_FT_Outline* outline, PVG_FT_BBox* acbox)
 
       TWorker worker;
       worker.skip_spans = 0;
+      worker.interrupted = 0;
       int rendered_spans = 0;
       int error = gray_raster_render(&worker, stack, length, params);
-      while(error == ErrRaster_OutOfMemory) {
+      while(error == ErrRaster_OutOfMemory && !worker.interrupted) {
           if(worker.skip_spans < 0)
               rendered_spans += -worker.skip_spans;
           worker.skip_spans = rendered_spans;
@@ -245,6 +245,44 @@ PVG_FT_Stroker_ParseOutline( PVG_FT_Stroker   stroker,
     const PVG_FT_Outline*  outline);
 
 
+/**************************************************************
+ *
+ * @function:
+ *   PVG_FT_Stroker_ParsePolyline
+ *
+ * @description:
+ *   A variant of @PVG_FT_Stroker_ParseOutline that strokes a single
+ *   polyline and appends it to the borders already in the stroker.
+ *   It lets callers stream sub-paths, such as the dashes of a dashed
+ *   path, without building an intermediate outline.
+ *
+ * @input:
+ *   stroker ::
+ *     The target stroker handle.
+ *
+ *   points ::
+ *     The polyline vertices.
+ *
+ *   count ::
+ *     The number of vertices; at least~2.
+ *
+ *   open ::
+ *     A boolean.  If~0, the polyline is treated as a closed path.
+ *
+ * @return:
+ *   FreeType error code.  0~means success.
+ *
+ * @note:
+ *   Unlike @PVG_FT_Stroker_ParseOutline, this function does not
+ *   rewind the stroker.
+ */
+PVG_FT_Error
+PVG_FT_Stroker_ParsePolyline( PVG_FT_Stroker       stroker,
+    PVG_FT_Vector*       points,
+    PVG_FT_Int           count,
+    PVG_FT_Bool          open );
+
+
 /**************************************************************
  *
  * @function:
@@ -2007,6 +2045,39 @@ void PVG_FT_Stroker_Export(PVG_FT_Stroker stroker, PVG_FT_Outline* outline)
 
 /* documentation is in ftstroke.h */
 
+PVG_FT_Error PVG_FT_Stroker_ParsePolyline(PVG_FT_Stroker stroker,
+                                        PVG_FT_Vector* points,
+                                        PVG_FT_Int     count,
+                                        PVG_FT_Bool    open)
+{
+    PVG_FT_Error error;
+    PVG_FT_Int   n;
+
+    if (!stroker || count < 2) return -1;  // PVG_FT_THROW( Invalid_Argument );
+
+    error = PVG_FT_Stroker_BeginSubPath(stroker, points, open);
+    if (error) goto Exit;
+
+    for (n = 1; n < count; n++) {
+        error = PVG_FT_Stroker_LineTo(stroker, points + n);
+        if (error) goto Exit;
+    }
+
+    /* a degenerate polyline is stroked as a dot, as in ParseOutline */
+    if (stroker->first_point) {
+        stroker->subpath_open = TRUE;
+        error = ft_stroker_subpath_start(stroker, 0, 0);
+        if (error) goto Exit;
+    }
+
+    error = PVG_FT_Stroker_EndSubPath(stroker);
+
+Exit:
+    return error;
+}
+
+/* documentation is in ftstroke.h */
+
 /*
  *  The following is very similar to PVG_FT_Outline_Decompose, except
  *  that we do support opened paths, and do not scale the outline.
@@ -94,6 +94,15 @@ bool plutovg_matrix_invert(const plutovg_matrix_t* matrix, plutovg_matrix_t* inv
     return true;
 }
 
+float plutovg_matrix_get_max_scale(const plutovg_matrix_t* matrix)
+{
+    /* The largest singular value of the linear part: how far a unit vector can be stretched. */
+    float p = 0.5f * (matrix->a * matrix->a + matrix->b * matrix->b + matrix->c * matrix->c + matrix->d * matrix->d);
+    float q = 0.5f * (matrix->a * matrix->a + matrix->b * matrix->b - matrix->c * matrix->c - matrix->d * matrix->d);
+    float r = matrix->a * matrix->c + matrix->b * matrix->d;
+    return sqrtf(p + sqrtf(q * q + r * r));
+}
+
 void plutovg_matrix_map(const plutovg_matrix_t* matrix, float x, float y, float* xx, float* yy)
 {
     *xx = x * matrix->a + y * matrix->c + matrix->e;
@@ -105,6 +114,34 @@ void plutovg_matrix_map_point(const plutovg_matrix_t* matrix, const plutovg_poin
     plutovg_matrix_map(matrix, src->x, src->y, &dst->x, &dst->y);
 }
 
+#ifdef __SSE2__
+
+#include <emmintrin.h>
+
+void plutovg_matrix_map_points(const plutovg_matrix_t* matrix, const plutovg_point_t* src, plutovg_point_t* dst, int count)
+{
+    /*
+     * Two points per register as (x0, y0, x1, y1). Multiplying by (a, d, a, d) and the
+     * pair-swapped vector by (c, b, c, b) gives the same products, added in the same
+     * order, as plutovg_matrix_map, so the results are bit-identical.
+     */
+    const __m128 ad = _mm_setr_ps(matrix->a, matrix->d, matrix->a, matrix->d);
+    const __m128 cb = _mm_setr_ps(matrix->c, matrix->b, matrix->c, matrix->b);
+    const __m128 ef = _mm_setr_ps(matrix->e, matrix->f, matrix->e, matrix->f);
+    int i = 0;
+    for(; i + 2 <= count; i += 2) {
+        __m128 xy = _mm_loadu_ps(&src[i].x);
+        __m128 yx = _mm_shuffle_ps(xy, xy, _MM_SHUFFLE(2, 3, 0, 1));
+        _mm_storeu_ps(&dst[i].x, _mm_add_ps(_mm_add_ps(_mm_mul_ps(xy, ad), _mm_mul_ps(yx, cb)), ef));
+    }
+
+    for(; i < count; ++i) {
+        plutovg_matrix_map_point(matrix, &src[i], &dst[i]);
+    }
+}
+
+#else
+
 void plutovg_matrix_map_points(const plutovg_matrix_t* matrix, const plutovg_point_t* src, plutovg_point_t* dst, int count)
 {
     for(int i = 0; i < count; ++i) {
@@ -112,6 +149,8 @@ void plutovg_matrix_map_points(const plutovg_matrix_t* matrix, const plutovg_poi
     }
 }
 
+#endif // __SSE2__
+
 void plutovg_matrix_map_rect(const plutovg_matrix_t* matrix, const plutovg_rect_t* src, plutovg_rect_t* dst)
 {
     plutovg_point_t p[4];
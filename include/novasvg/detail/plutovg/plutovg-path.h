@@ -5,10 +5,16 @@
 
 #include <assert.h>
 
+static inline int plutovg_path_command_length(int command)
+{
+    return command == PLUTOVG_PATH_COMMAND_CUBIC_TO ? 3 : 1;
+}
+
 void plutovg_path_iterator_init(plutovg_path_iterator_t* it, const plutovg_path_t* path)
 {
-    it->elements = path->elements.data;
-    it->size = path->elements.size;
+    it->commands = path->commands.data;
+    it->points = path->points.data;
+    it->size = path->commands.size;
     it->index = 0;
 }
 
@@ -19,33 +25,34 @@ bool plutovg_path_iterator_has_next(const plutovg_path_iterator_t* it)
 
 plutovg_path_command_t plutovg_path_iterator_next(plutovg_path_iterator_t* it, plutovg_point_t points[3])
 {
-    const plutovg_path_element_t* elements = it->elements + it->index;
-    switch(elements[0].header.command) {
+    plutovg_path_command_t command = (plutovg_path_command_t)(it->commands[it->index++]);
+    switch(command) {
     case PLUTOVG_PATH_COMMAND_MOVE_TO:
     case PLUTOVG_PATH_COMMAND_LINE_TO:
     case PLUTOVG_PATH_COMMAND_CLOSE:
-        points[0] = elements[1].point;
+        points[0] = it->points[0];
+        it->points += 1;
         break;
     case PLUTOVG_PATH_COMMAND_CUBIC_TO:
-        points[0] = elements[1].point;
-        points[1] = elements[2].point;
-        points[2] = elements[3].point;
+        points[0] = it->points[0];
+        points[1] = it->points[1];
+        points[2] = it->points[2];
+        it->points += 3;
         break;
     }
 
-    it->index += elements[0].header.length;
-    return elements[0].header.command;
+    return command;
 }
 
 plutovg_path_t* plutovg_path_create(void)
 {
     plutovg_path_t* path = static_cast<plutovg_path_t*>(malloc(sizeof(plutovg_path_t)));
     plutovg_init_reference(path);
-    path->num_points = 0;
     path->num_contours = 0;
     path->num_curves = 0;
     path->start_point = PLUTOVG_EMPTY_POINT;
-    plutovg_array_init(path->elements);
+    plutovg_array_init(path->commands);
+    plutovg_array_init(path->points);
     return path;
 }
 
@@ -58,7 +65,8 @@ plutovg_path_t* plutovg_path_reference(plutovg_path_t* path)
 void plutovg_path_destroy(plutovg_path_t* path)
 {
     if(plutovg_destroy_reference(path)) {
-        plutovg_array_destroy(path->elements);
+        plutovg_array_destroy(path->commands);
+        plutovg_array_destroy(path->points);
         free(path);
     }
 }
@@ -68,39 +76,44 @@ int plutovg_path_get_reference_count(const plutovg_path_t* path)
     return plutovg_get_reference_count(path);
 }
 
-int plutovg_path_get_elements(const plutovg_path_t* path, const plutovg_path_element_t** elements)
+int plutovg_path_get_commands(const plutovg_path_t* path, const uint8_t** commands)
 {
-    if(elements)
-        *elements = path->elements.data;
-    return path->elements.size;
+    if(commands)
+        *commands = path->commands.data;
+    return path->commands.size;
 }
 
-static plutovg_path_element_t* plutovg_path_add_command(plutovg_path_t* path, plutovg_path_command_t command, int npoints)
+int plutovg_path_get_points(const plutovg_path_t* path, const plutovg_point_t** points)
 {
-    const int length = npoints + 1;
-    plutovg_array_ensure(path->elements, length);
-    plutovg_path_element_t* elements = path->elements.data + path->elements.size;
-    elements->header.command = command;
-    elements->header.length = length;
-    path->elements.size += length;
-    path->num_points += npoints;
-    return elements + 1;
+    if(points)
+        *points = path->points.data;
+    return path->points.size;
+}
+
+static plutovg_point_t* plutovg_path_add_command(plutovg_path_t* path, plutovg_path_command_t command, int npoints)
+{
+    plutovg_array_ensure(path->commands, 1);
+    plutovg_array_ensure(path->points, npoints);
+    path->commands.data[path->commands.size++] = (uint8_t)(command);
+    plutovg_point_t* points = path->points.data + path->points.size;
+    path->points.size += npoints;
+    return points;
 }
 
 void plutovg_path_move_to(plutovg_path_t* path, float x, float y)
 {
-    plutovg_path_element_t* elements = plutovg_path_add_command(path, PLUTOVG_PATH_COMMAND_MOVE_TO, 1);
-    elements[0].point = PLUTOVG_MAKE_POINT(x, y);
+    plutovg_point_t* points = plutovg_path_add_command(path, PLUTOVG_PATH_COMMAND_MOVE_TO, 1);
+    points[0] = PLUTOVG_MAKE_POINT(x, y);
     path->start_point = PLUTOVG_MAKE_POINT(x, y);
     path->num_contours += 1;
 }
 
 void plutovg_path_line_to(plutovg_path_t* path, float x, float y)
 {
-    if(path->elements.size == 0)
+    if(path->commands.size == 0)
         plutovg_path_move_to(path, 0, 0);
-    plutovg_path_element_t* elements = plutovg_path_add_command(path, PLUTOVG_PATH_COMMAND_LINE_TO, 1);
-    elements[0].point = PLUTOVG_MAKE_POINT(x, y);
+    plutovg_point_t* points = plutovg_path_add_command(path, PLUTOVG_PATH_COMMAND_LINE_TO, 1);
+    points[0] = PLUTOVG_MAKE_POINT(x, y);
 }
 
 void plutovg_path_quad_to(plutovg_path_t* path, float x1, float y1, float x2, float y2)
@@ -116,12 +129,12 @@ void plutovg_path_quad_to(plutovg_path_t* path, float x1, float y1, float x2, fl
 
 void plutovg_path_cubic_to(plutovg_path_t* path, float x1, float y1, float x2, float y2, float x3, float y3)
 {
-    if(path->elements.size == 0)
+    if(path->commands.size == 0)
         plutovg_path_move_to(path, 0, 0);
-    plutovg_path_element_t* elements = plutovg_path_add_command(path, PLUTOVG_PATH_COMMAND_CUBIC_TO, 3);
-    elements[0].point = PLUTOVG_MAKE_POINT(x1, y1);
-    elements[1].point = PLUTOVG_MAKE_POINT(x2, y2);
-    elements[2].point = PLUTOVG_MAKE_POINT(x3, y3);
+    plutovg_point_t* points = plutovg_path_add_command(path, PLUTOVG_PATH_COMMAND_CUBIC_TO, 3);
+    points[0] = PLUTOVG_MAKE_POINT(x1, y1);
+    points[1] = PLUTOVG_MAKE_POINT(x2, y2);
+    points[2] = PLUTOVG_MAKE_POINT(x3, y3);
     path->num_curves += 1;
 }
 
@@ -213,19 +226,19 @@ void plutovg_path_arc_to(plutovg_path_t* path, float rx, float ry, float angle,
 
 void plutovg_path_close(plutovg_path_t* path)
 {
-    if(path->elements.size == 0)
+    if(path->commands.size == 0)
         return;
-    plutovg_path_element_t* elements = plutovg_path_add_command(path, PLUTOVG_PATH_COMMAND_CLOSE, 1);
-    elements[0].point = path->start_point;
+    plutovg_point_t* points = plutovg_path_add_command(path, PLUTOVG_PATH_COMMAND_CLOSE, 1);
+    points[0] = path->start_point;
 }
 
 void plutovg_path_get_current_point(const plutovg_path_t* path, float* x, float* y)
 {
     float xx = 0.f;
     float yy = 0.f;
-    if(path->num_points > 0) {
-        xx = path->elements.data[path->elements.size - 1].point.x;
-        yy = path->elements.data[path->elements.size - 1].point.y;
+    if(path->points.size > 0) {
+        xx = path->points.data[path->points.size - 1].x;
+        yy = path->points.data[path->points.size - 1].y;
     }
 
     if(x) *x = xx;
@@ -234,21 +247,22 @@ void plutovg_path_get_current_point(const plutovg_path_t* path, float* x, float*
 
 void plutovg_path_reserve(plutovg_path_t* path, int count)
 {
-    plutovg_array_ensure(path->elements, count);
+    plutovg_array_ensure(path->commands, count);
+    plutovg_array_ensure(path->points, count);
 }
 
 void plutovg_path_reset(plutovg_path_t* path)
 {
-    plutovg_array_clear(path->elements);
+    plutovg_array_clear(path->commands);
+    plutovg_array_clear(path->points);
     path->start_point = PLUTOVG_EMPTY_POINT;
-    path->num_points = 0;
     path->num_contours = 0;
     path->num_curves = 0;
 }
 
 void plutovg_path_add_rect(plutovg_path_t* path, float x, float y, float w, float h)
 {
-    plutovg_path_reserve(path, 6 * 2);
+    plutovg_path_reserve(path, 6);
     plutovg_path_move_to(path, x, y);
     plutovg_path_line_to(path, x + w, y);
     plutovg_path_line_to(path, x + w, y + h);
@@ -272,7 +286,7 @@ void plutovg_path_add_round_rect(plutovg_path_t* path, float x, float y, float w
     float cpx = rx * PLUTOVG_KAPPA;
     float cpy = ry * PLUTOVG_KAPPA;
 
-    plutovg_path_reserve(path, 6 * 2 + 4 * 4);
+    plutovg_path_reserve(path, 6 + 4 * 3);
     plutovg_path_move_to(path, x, y+ry);
     plutovg_path_cubic_to(path, x, y+ry-cpy, x+rx-cpx, y, x+rx, y);
     plutovg_path_line_to(path, right-rx, y);
@@ -295,7 +309,7 @@ void plutovg_path_add_ellipse(plutovg_path_t* path, float cx, float cy, float rx
     float cpx = rx * PLUTOVG_KAPPA;
     float cpy = ry * PLUTOVG_KAPPA;
 
-    plutovg_path_reserve(path, 2 * 2 + 4 * 4);
+    plutovg_path_reserve(path, 2 + 4 * 3);
     plutovg_path_move_to(path, cx, top);
     plutovg_path_cubic_to(path, cx+cpx, top, right, cy-cpy, right, cy);
     plutovg_path_cubic_to(path, right, cy+cpy, cx+cpx, bottom, cx, bottom);
@@ -330,8 +344,8 @@ void plutovg_path_add_arc(plutovg_path_t* path, float cx, float cy, float r, flo
     float dx = -sinf(a) * d;
     float dy = cosf(a) * d;
 
-    plutovg_path_reserve(path, 2 + 4 * seg_n);
-    if(path->elements.size == 0) {
+    plutovg_path_reserve(path, 1 + 3 * seg_n);
+    if(path->commands.size == 0) {
         plutovg_path_move_to(path, ax, ay);
     } else {
         plutovg_path_line_to(path, ax, ay);
@@ -357,58 +371,60 @@ void plutovg_path_add_arc(plutovg_path_t* path, float cx, float cy, float r, flo
 
 void plutovg_path_transform(plutovg_path_t* path, const plutovg_matrix_t* matrix)
 {
-    plutovg_path_element_t* elements = path->elements.data;
-    for(int i = 0; i < path->elements.size; i += elements[i].header.length) {
-        switch(elements[i].header.command) {
-        case PLUTOVG_PATH_COMMAND_MOVE_TO:
-        case PLUTOVG_PATH_COMMAND_LINE_TO:
-        case PLUTOVG_PATH_COMMAND_CLOSE:
-            plutovg_matrix_map_point(matrix, &elements[i + 1].point, &elements[i + 1].point);
-            break;
-        case PLUTOVG_PATH_COMMAND_CUBIC_TO:
-            plutovg_matrix_map_point(matrix, &elements[i + 1].point, &elements[i + 1].point);
-            plutovg_matrix_map_point(matrix, &elements[i + 2].point, &elements[i + 2].point);
-            plutovg_matrix_map_point(matrix, &elements[i + 3].point, &elements[i + 3].point);
-            break;
-        }
-    }
+    plutovg_matrix_map_points(matrix, path->points.data, path->points.data, path->points.size);
 }
 
 void plutovg_path_add_path(plutovg_path_t* path, const plutovg_path_t* source, const plutovg_matrix_t* matrix)
 {
+    if(source->commands.size == 0)
+        return;
+    plutovg_array_append(path->commands, source->commands);
+    plutovg_array_ensure(path->points, source->points.size);
+    plutovg_point_t* points = path->points.data + path->points.size;
     if(matrix == NULL) {
-        plutovg_array_append(path->elements, source->elements);
+        memcpy(points, source->points.data, source->points.size * sizeof(plutovg_point_t));
         path->start_point = source->start_point;
-        path->num_points += source->num_points;
-        path->num_contours += source->num_contours;
-        path->num_curves += source->num_curves;
-        return;
+    } else {
+        plutovg_matrix_map_points(matrix, source->points.data, points, source->points.size);
+        plutovg_matrix_map_point(matrix, &source->start_point, &path->start_point);
     }
 
-    plutovg_path_iterator_t it;
-    plutovg_path_iterator_init(&it, source);
+    path->points.size += source->points.size;
+    path->num_contours += source->num_contours;
+    path->num_curves += source->num_curves;
+}
 
-    plutovg_point_t points[3];
-    plutovg_array_ensure(path->elements, source->elements.size);
-    while(plutovg_path_iterator_has_next(&it)) {
-        switch(plutovg_path_iterator_next(&it, points)) {
-        case PLUTOVG_PATH_COMMAND_MOVE_TO:
-            plutovg_matrix_map_points(matrix, points, points, 1);
-            plutovg_path_move_to(path, points[0].x, points[0].y);
-            break;
-        case PLUTOVG_PATH_COMMAND_LINE_TO:
-            plutovg_matrix_map_points(matrix, points, points, 1);
-            plutovg_path_line_to(path, points[0].x, points[0].y);
-            break;
-        case PLUTOVG_PATH_COMMAND_CUBIC_TO:
-            plutovg_matrix_map_points(matrix, points, points, 3);
-            plutovg_path_cubic_to(path, points[0].x, points[0].y, points[1].x, points[1].y, points[2].x, points[2].y);
-            break;
-        case PLUTOVG_PATH_COMMAND_CLOSE:
-            plutovg_path_close(path);
-            break;
+bool plutovg_path_add_data(plutovg_path_t* path, const uint8_t* commands, int ncommands, const plutovg_point_t* points, int npoints)
+{
+    if(ncommands < 0 || npoints < 0)
+        return false;
+    int num_points = 0;
+    int num_contours = 0;
+    int num_curves = 0;
+    plutovg_point_t start_point = path->start_point;
+    if(ncommands > 0 && path->commands.size == 0 && commands[0] != PLUTOVG_PATH_COMMAND_MOVE_TO)
+        return false;
+    for(int i = 0; i < ncommands; i++) {
+        if(commands[i] > PLUTOVG_PATH_COMMAND_CLOSE || num_points >= npoints)
+            return false;
+        if(commands[i] == PLUTOVG_PATH_COMMAND_MOVE_TO) {
+            start_point = points[num_points];
+            num_contours += 1;
+        } else if(commands[i] == PLUTOVG_PATH_COMMAND_CUBIC_TO) {
+            num_curves += 1;
         }
+
+        num_points += plutovg_path_command_length(commands[i]);
     }
+
+    if(num_points != npoints)
+        return false;
+    plutovg_array_append_data(path->commands, commands, ncommands);
+    plutovg_array_append_data(path->points, points, npoints);
+    path->start_point = start_point;
+    path->num_contours += num_contours;
+    path->num_curves += num_curves;
+    return true;
 }
 
 void plutovg_path_traverse(const plutovg_path_t* path, plutovg_path_traverse_func_t traverse_func, void* closure)
@@ -435,47 +451,53 @@ void plutovg_path_traverse(const plutovg_path_t* path, plutovg_path_traverse_fun
     }
 }
 
-typedef struct {
-    float x1; float y1;
-    float x2; float y2;
-    float x3; float y3;
-    float x4; float y4;
-} bezier_t;
-
-static inline void split_bezier(const bezier_t* b, bezier_t* first, bezier_t* second)
-{
-    float c = (b->x2 + b->x3) * 0.5f;
-    first->x2 = (b->x1 + b->x2) * 0.5f;
-    second->x3 = (b->x3 + b->x4) * 0.5f;
-    first->x1 = b->x1;
-    second->x4 = b->x4;
-    first->x3 = (first->x2 + c) * 0.5f;
-    second->x2 = (second->x3 + c) * 0.5f;
-    first->x4 = second->x1 = (first->x3 + second->x2) * 0.5f;
-
-    c = (b->y2 + b->y3) * 0.5f;
-    first->y2 = (b->y1 + b->y2) * 0.5f;
-    second->y3 = (b->y3 + b->y4) * 0.5f;
-    first->y1 = b->y1;
-    second->y4 = b->y4;
-    first->y3 = (first->y2 + c) * 0.5f;
-    second->y2 = (second->y3 + c) * 0.5f;
-    first->y4 = second->y1 = (first->y3 + second->y2) * 0.5f;
+#define PLUTOVG_MAX_CURVE_SEGMENTS 1024
+
+static int plutovg_cubic_segment_count(const plutovg_point_t* p0, const plutovg_point_t* points, float tolerance)
+{
+    /*
+     * Wang's formula: a cubic split into n uniform parameter steps deviates from its
+     * chords by at most 3/4 * max|P[i] - 2P[i+1] + P[i+2]| / n^2.
+     */
+    float ddx = plutovg_max(fabsf(p0->x - 2.f * points[0].x + points[1].x), fabsf(points[0].x - 2.f * points[1].x + points[2].x));
+    float ddy = plutovg_max(fabsf(p0->y - 2.f * points[0].y + points[1].y), fabsf(points[0].y - 2.f * points[1].y + points[2].y));
+    float count = ceilf(sqrtf(0.75f * sqrtf(ddx * ddx + ddy * ddy) / tolerance));
+    if(!(count < PLUTOVG_MAX_CURVE_SEGMENTS))
+        return PLUTOVG_MAX_CURVE_SEGMENTS;
+    return plutovg_max(1, (int)count);
 }
 
-void plutovg_path_traverse_flatten(const plutovg_path_t* path, plutovg_path_traverse_func_t traverse_func, void* closure)
+static void plutovg_cubic_flatten(const plutovg_point_t* p0, const plutovg_point_t* points, float tolerance, plutovg_path_traverse_func_t traverse_func, void* closure)
+{
+    int count = plutovg_cubic_segment_count(p0, points, tolerance);
+    for(int i = 1; i < count; i++) {
+        float t = (float)i / count;
+        float mt = 1.f - t;
+        float a = mt * mt * mt;
+        float b = 3.f * mt * mt * t;
+        float c = 3.f * mt * t * t;
+        float d = t * t * t;
+        plutovg_point_t p = {
+            a * p0->x + b * points[0].x + c * points[1].x + d * points[2].x,
+            a * p0->y + b * points[0].y + c * points[1].y + d * points[2].y
+        };
+
+        traverse_func(closure, PLUTOVG_PATH_COMMAND_LINE_TO, &p, 1);
+    }
+
+    traverse_func(closure, PLUTOVG_PATH_COMMAND_LINE_TO, &points[2], 1);
+}
+
+void plutovg_path_traverse_flatten_tolerance(const plutovg_path_t* path, float tolerance, plutovg_path_traverse_func_t traverse_func, void* closure)
 {
     if(path->num_curves == 0) {
         plutovg_path_traverse(path, traverse_func, closure);
         return;
     }
 
-    const float threshold = 0.25f;
-
     plutovg_path_iterator_t it;
     plutovg_path_iterator_init(&it, path);
 
-    bezier_t beziers[32];
     plutovg_point_t points[3];
     plutovg_point_t current_point = {0, 0};
     while(plutovg_path_iterator_has_next(&it)) {
@@ -488,43 +510,18 @@ void plutovg_path_traverse_flatten(const plutovg_path_t* path, plutovg_path_trav
             current_point = points[0];
             break;
         case PLUTOVG_PATH_COMMAND_CUBIC_TO:
-            beziers[0].x1 = current_point.x;
-            beziers[0].y1 = current_point.y;
-            beziers[0].x2 = points[0].x;
-            beziers[0].y2 = points[0].y;
-            beziers[0].x3 = points[1].x;
-            beziers[0].y3 = points[1].y;
-            beziers[0].x4 = points[2].x;
-            beziers[0].y4 = points[2].y;
-            bezier_t* b = beziers;
-            while(b >= beziers) {
-                float y4y1 = b->y4 - b->y1;
-                float x4x1 = b->x4 - b->x1;
-                float l = fabsf(x4x1) + fabsf(y4y1);
-                float d;
-                if(l > 1.f) {
-                    d = fabsf((x4x1)*(b->y1 - b->y2) - (y4y1)*(b->x1 - b->x2)) + fabsf((x4x1)*(b->y1 - b->y3) - (y4y1)*(b->x1 - b->x3));
-                } else {
-                    d = fabsf(b->x1 - b->x2) + fabsf(b->y1 - b->y2) + fabsf(b->x1 - b->x3) + fabsf(b->y1 - b->y3);
-                    l = 1.f;
-                }
-
-                if(d < threshold*l || b == beziers + 31) {
-                    plutovg_point_t p = { b->x4, b->y4 };
-                    traverse_func(closure, PLUTOVG_PATH_COMMAND_LINE_TO, &p, 1);
-                    --b;
-                } else {
-                    split_bezier(b, b + 1, b);
-                    ++b;
-                }
-            }
-
+            plutovg_cubic_flatten(&current_point, points, tolerance, traverse_func, closure);
             current_point = points[2];
             break;
         }
     }
 }
 
+void plutovg_path_traverse_flatten(const plutovg_path_t* path, plutovg_path_traverse_func_t traverse_func, void* closure)
+{
+    plutovg_path_traverse_flatten_tolerance(path, PLUTOVG_DEFAULT_CURVE_TOLERANCE, traverse_func, closure);
+}
+
 typedef struct {
     const float* dashes; int ndashes;
     float start_phase; float phase;
@@ -533,11 +530,30 @@ typedef struct {
     plutovg_point_t current_point;
     plutovg_path_traverse_func_t traverse_func;
     void* closure;
+    plutovg_interrupt_func_t interrupt;
+    void* interrupt_closure;
+    int dashes_since_poll;
+    bool interrupted;
 } dasher_t;
 
+/* The number of dashes emitted between two polls of the interrupt callback. */
+#define PLUTOVG_DASH_INTERRUPT_INTERVAL 4096
+
+static bool dasher_interrupted(dasher_t* dasher)
+{
+    if(dasher->interrupt && !dasher->interrupted && ++dasher->dashes_since_poll == PLUTOVG_DASH_INTERRUPT_INTERVAL) {
+        dasher->dashes_since_poll = 0;
+        dasher->interrupted = dasher->interrupt(dasher->interrupt_closure);
+    }
+
+    return dasher->interrupted;
+}
+
 static void dash_traverse_func(void* closure, plutovg_path_command_t command, const plutovg_point_t* points, int npoints)
 {
     dasher_t* dasher = (dasher_t*)(closure);
+    if(dasher->interrupted)
+        return;
     if(command == PLUTOVG_PATH_COMMAND_MOVE_TO) {
         if(dasher->start_toggle)
             dasher->traverse_func(dasher->closure, PLUTOVG_PATH_COMMAND_MOVE_TO, points, npoints);
@@ -568,6 +584,9 @@ static void dash_traverse_func(void* closure, plutovg_path_command_t command, co
         dasher->phase = 0.f;
         dasher->toggle = !dasher->toggle;
         dasher->index++;
+        if(dasher_interrupted(dasher)) {
+            return;
+        }
     }
 
     if(dasher->toggle) {
@@ -578,7 +597,7 @@ static void dash_traverse_func(void* closure, plutovg_path_command_t command, co
     dasher->current_point = p1;
 }
 
-void plutovg_path_traverse_dashed(const plutovg_path_t* path, float offset, const float* dashes, int ndashes, plutovg_path_traverse_func_t traverse_func, void* closure)
+void plutovg_path_traverse_dashed_tolerance(const plutovg_path_t* path, float offset, const float* dashes, int ndashes, float tolerance, plutovg_path_traverse_func_t traverse_func, void* closure, plutovg_interrupt_func_t interrupt, void* interrupt_closure)
 {
     float dash_sum = 0.f;
     for(int i = 0; i < ndashes; ++i)
@@ -610,15 +629,24 @@ void plutovg_path_traverse_dashed(const plutovg_path_t* path, float offset, cons
     dasher.current_point = PLUTOVG_EMPTY_POINT;
     dasher.traverse_func = traverse_func;
     dasher.closure = closure;
-    plutovg_path_traverse_flatten(path, dash_traverse_func, &dasher);
+    dasher.interrupt = interrupt;
+    dasher.interrupt_closure = interrupt_closure;
+    dasher.dashes_since_poll = 0;
+    dasher.interrupted = false;
+    plutovg_path_traverse_flatten_tolerance(path, tolerance, dash_traverse_func, &dasher);
+}
+
+void plutovg_path_traverse_dashed(const plutovg_path_t* path, float offset, const float* dashes, int ndashes, plutovg_path_traverse_func_t traverse_func, void* closure)
+{
+    plutovg_path_traverse_dashed_tolerance(path, offset, dashes, ndashes, PLUTOVG_DEFAULT_CURVE_TOLERANCE, traverse_func, closure, NULL, NULL);
 }
 
 plutovg_path_t* plutovg_path_clone(const plutovg_path_t* path)
 {
     plutovg_path_t* clone = plutovg_path_create();
-    plutovg_array_append(clone->elements, path->elements);
+    plutovg_array_append(clone->commands, path->commands);
+    plutovg_array_append(clone->points, path->points);
     clone->start_point = path->start_point;
-    clone->num_points = path->num_points;
     clone->num_contours = path->num_contours;
     clone->num_curves = path->num_curves;
     return clone;
@@ -643,22 +671,32 @@ static void clone_traverse_func(void* closure, plutovg_path_command_t command, c
     }
 }
 
-plutovg_path_t* plutovg_path_clone_flatten(const plutovg_path_t* path)
+plutovg_path_t* plutovg_path_clone_flatten_tolerance(const plutovg_path_t* path, float tolerance)
 {
     plutovg_path_t* clone = plutovg_path_create();
-    plutovg_path_reserve(clone, path->elements.size + path->num_curves * 32);
-    plutovg_path_traverse_flatten(path, clone_traverse_func, clone);
+    plutovg_path_reserve(clone, path->points.size + path->num_curves * 32);
+    plutovg_path_traverse_flatten_tolerance(path, tolerance, clone_traverse_func, clone);
     return clone;
 }
 
-plutovg_path_t* plutovg_path_clone_dashed(const plutovg_path_t* path, float offset, const float* dashes, int ndashes)
+plutovg_path_t* plutovg_path_clone_flatten(const plutovg_path_t* path)
+{
+    return plutovg_path_clone_flatten_tolerance(path, PLUTOVG_DEFAULT_CURVE_TOLERANCE);
+}
+
+plutovg_path_t* plutovg_path_clone_dashed_tolerance(const plutovg_path_t* path, float offset, const float* dashes, int ndashes, float tolerance, plutovg_interrupt_func_t interrupt, void* interrupt_closure)
 {
     plutovg_path_t* clone = plutovg_path_create();
-    plutovg_path_reserve(clone, path->elements.size + path->num_curves * 32);
-    plutovg_path_traverse_dashed(path, offset, dashes, ndashes, clone_traverse_func, clone);
+    plutovg_path_reserve(clone, path->points.size + path->num_curves * 32);
+    plutovg_path_traverse_dashed_tolerance(path, offset, dashes, ndashes, tolerance, clone_traverse_func, clone, interrupt, interrupt_closure);
     return clone;
 }
 
+plutovg_path_t* plutovg_path_clone_dashed(const plutovg_path_t* path, float offset, const float* dashes, int ndashes)
+{
+    return plutovg_path_clone_dashed_tolerance(path, offset, dashes, ndashes, PLUTOVG_DEFAULT_CURVE_TOLERANCE, NULL, NULL);
+}
+
 typedef struct {
     plutovg_point_t current_point;
     bool is_first_point;
@@ -701,7 +739,12 @@ float plutovg_path_extents(const plutovg_path_t* path, plutovg_rect_t* extents,
     if(tight) {
         plutovg_path_traverse_flatten(path, extents_traverse_func, &calculator);
     } else {
-        plutovg_path_traverse(path, extents_traverse_func, &calculator);
+        const plutovg_point_t* points = path->points.data;
+        for(int i = 0; i < path->commands.size; ++i) {
+            const int npoints = plutovg_path_command_length(path->commands.data[i]);
+            extents_traverse_func(&calculator, (plutovg_path_command_t)(path->commands.data[i]), points, npoints);
+            points += npoints;
+        }
     }
 
     if(extents) {
@@ -27,6 +27,20 @@ typedef atomic_int plutovg_ref_count_t;
 #define plutovg_destroy_reference(ob) (ob && atomic_fetch_sub(&(ob)->ref_count, 1) == 1)
 #define plutovg_get_reference_count(ob) ((ob) ? atomic_load(&(ob)->ref_count) : 0)
 
+#elif defined(__cplusplus)
+
+extern "C++" {
+#include <atomic>
+#include <new>
+}
+
+typedef std::atomic<int> plutovg_ref_count_t;
+
+#define plutovg_init_reference(ob) (void)(new (&(ob)->ref_count) plutovg_ref_count_t(1))
+#define plutovg_increment_reference(ob) (void)(ob && (ob)->ref_count.fetch_add(1, std::memory_order_relaxed))
+#define plutovg_destroy_reference(ob) (ob && (ob)->ref_count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+#define plutovg_get_reference_count(ob) ((ob) ? (ob)->ref_count.load(std::memory_order_acquire) : 0)
+
 #else
 
 typedef int plutovg_ref_count_t;
@@ -48,15 +62,19 @@ struct plutovg_surface {
 
 struct plutovg_path {
     plutovg_ref_count_t ref_count;
-    int num_points;
     int num_contours;
     int num_curves;
     plutovg_point_t start_point;
     struct {
-        plutovg_path_element_t* data;
+        uint8_t* data;
         int size;
         int capacity;
-    } elements;
+    } commands;
+    struct {
+        plutovg_point_t* data;
+        int size;
+        int capacity;
+    } points;
 };
 
 typedef enum {
@@ -118,13 +136,20 @@ typedef struct {
     int h;
 } plutovg_span_buffer_t;
 
+typedef struct {
+    plutovg_ref_count_t ref_count;
+    plutovg_span_buffer_t spans;
+} plutovg_clip_spans_t;
+
+typedef struct {
+    plutovg_ref_count_t ref_count;
+    int size;
+    float* data;
+} plutovg_dash_array_t;
+
 typedef struct {
     float offset;
-    struct {
-        float* data;
-        int size;
-        int capacity;
-    } array;
+    plutovg_dash_array_t* array;
 } plutovg_stroke_dash_t;
 
 typedef struct {
@@ -139,18 +164,30 @@ typedef struct {
     plutovg_stroke_dash_t dash;
 } plutovg_stroke_data_t;
 
+typedef struct {
+    plutovg_rasterizer_t rasterizer;
+    float tolerance;
+    bool antialias;
+    plutovg_interrupt_func_t interrupt;
+    void* interrupt_closure;
+} plutovg_raster_options_t;
+
+static inline bool plutovg_raster_interrupted(const plutovg_raster_options_t* options)
+{
+    return options->interrupt && options->interrupt(options->interrupt_closure);
+}
+
 typedef struct plutovg_state {
     plutovg_paint_t* paint;
     plutovg_font_face_t* font_face;
     plutovg_color_t color;
     plutovg_matrix_t matrix;
     plutovg_stroke_data_t stroke;
-    plutovg_span_buffer_t clip_spans;
+    plutovg_clip_spans_t* clip;
     plutovg_fill_rule_t winding;
     plutovg_operator_t op;
     float font_size;
     float opacity;
-    bool clipping;
     struct plutovg_state* next;
 } plutovg_state_t;
 
@@ -162,6 +199,10 @@ struct plutovg_canvas {
     plutovg_state_t* freed_state;
     plutovg_font_face_cache_t* face_cache;
     plutovg_rect_t clip_rect;
+    plutovg_raster_options_t raster_options;
+    bool image_smoothing;
+    int gradient_table_size;
+    plutovg_canvas_stats_t* stats;
     plutovg_span_buffer_t clip_spans;
     plutovg_span_buffer_t fill_spans;
 };
@@ -175,8 +216,18 @@ bool plutovg_span_buffer_contains(const plutovg_span_buffer_t* span_buffer, floa
 void plutovg_span_buffer_extents(plutovg_span_buffer_t* span_buffer, plutovg_rect_t* extents);
 void plutovg_span_buffer_intersect(plutovg_span_buffer_t* span_buffer, const plutovg_span_buffer_t* a, const plutovg_span_buffer_t* b);
 
-void plutovg_rasterize(plutovg_span_buffer_t* span_buffer, const plutovg_path_t* path, const plutovg_matrix_t* matrix, const plutovg_rect_t* clip_rect, const plutovg_stroke_data_t* stroke_data, plutovg_fill_rule_t winding);
+typedef void (*plutovg_span_func_t)(int count, const plutovg_span_t* spans, void* closure);
+
+void plutovg_rasterize_spans(plutovg_span_func_t func, void* closure, const plutovg_path_t* path, const plutovg_matrix_t* matrix, const plutovg_rect_t* clip_rect, const plutovg_stroke_data_t* stroke_data, plutovg_fill_rule_t winding, const plutovg_raster_options_t* options);
+void plutovg_rasterize(plutovg_span_buffer_t* span_buffer, const plutovg_path_t* path, const plutovg_matrix_t* matrix, const plutovg_rect_t* clip_rect, const plutovg_stroke_data_t* stroke_data, plutovg_fill_rule_t winding, const plutovg_raster_options_t* options);
+float plutovg_matrix_get_max_scale(const plutovg_matrix_t* matrix);
+void plutovg_path_traverse_flatten_tolerance(const plutovg_path_t* path, float tolerance, plutovg_path_traverse_func_t traverse_func, void* closure);
+void plutovg_path_traverse_dashed_tolerance(const plutovg_path_t* path, float offset, const float* dashes, int ndashes, float tolerance, plutovg_path_traverse_func_t traverse_func, void* closure, plutovg_interrupt_func_t interrupt, void* interrupt_closure);
+plutovg_path_t* plutovg_path_clone_flatten_tolerance(const plutovg_path_t* path, float tolerance);
+plutovg_path_t* plutovg_path_clone_dashed_tolerance(const plutovg_path_t* path, float offset, const float* dashes, int ndashes, float tolerance, plutovg_interrupt_func_t interrupt, void* interrupt_closure);
+
 void plutovg_blend(plutovg_canvas_t* canvas, const plutovg_span_buffer_t* span_buffer);
+void plutovg_blend_path(plutovg_canvas_t* canvas, const plutovg_stroke_data_t* stroke_data, plutovg_fill_rule_t winding);
 void plutovg_memfill32(unsigned int* dest, int length, unsigned int value);
 
 #endif // PLUTOVG_PRIVATE_H
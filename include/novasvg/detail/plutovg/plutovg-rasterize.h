@@ -5,9 +5,14 @@
 
 #include "plutovg-ft-raster.h"
 #include "plutovg-ft-stroker.h"
+#include "plutovg-sparse-raster.h"
 
 #include <limits.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 void plutovg_span_buffer_init(plutovg_span_buffer_t* span_buffer)
 {
     plutovg_array_init(span_buffer->spans);
@@ -191,7 +196,81 @@ static void ft_outline_destroy(PVG_FT_Outline* outline)
     free(outline);
 }
 
+static PVG_FT_Outline* ft_outline_grow(PVG_FT_Outline* outline, int points, int contours)
+{
+    PVG_FT_Outline* grown = ft_outline_create(points, contours);
+    memcpy(grown->points, outline->points, outline->n_points * sizeof(PVG_FT_Vector));
+    memcpy(grown->tags, outline->tags, outline->n_points * sizeof(char));
+    memcpy(grown->contours, outline->contours, outline->n_contours * sizeof(int));
+    memcpy(grown->contours_flag, outline->contours_flag, (outline->n_contours + 1) * sizeof(char));
+    grown->n_points = outline->n_points;
+    grown->n_contours = outline->n_contours;
+    grown->flags = outline->flags;
+    ft_outline_destroy(outline);
+    return grown;
+}
+
 #define FT_COORD(x) (PVG_FT_Pos)(roundf(x * 64))
+
+#ifdef __SSE2__
+
+static inline __m128i ft_coord_round(__m128 v)
+{
+    /* roundf semantics: truncate, then step away from zero when the remainder reaches one half. */
+    __m128i t = _mm_cvttps_epi32(v);
+    __m128 f = _mm_sub_ps(v, _mm_cvtepi32_ps(t));
+    t = _mm_sub_epi32(t, _mm_castps_si128(_mm_cmpge_ps(f, _mm_set1_ps(0.5f))));
+    t = _mm_add_epi32(t, _mm_castps_si128(_mm_cmple_ps(f, _mm_set1_ps(-0.5f))));
+    return t;
+}
+
+#endif // __SSE2__
+
+/*
+ * Maps points through an optional matrix and rounds them to 26.6 fixed point in one
+ * pass. The vector path matches plutovg_matrix_map and FT_COORD bit for bit; values too
+ * large for 32-bit lanes fall through to the scalar loop.
+ */
+static void ft_map_points(const plutovg_matrix_t* matrix, const plutovg_point_t* src, PVG_FT_Vector* dst, int count)
+{
+    int i = 0;
+#ifdef __SSE2__
+    const plutovg_matrix_t identity = {1, 0, 0, 1, 0, 0};
+    const plutovg_matrix_t* m = matrix ? matrix : &identity;
+    const __m128 ad = _mm_setr_ps(m->a, m->d, m->a, m->d);
+    const __m128 cb = _mm_setr_ps(m->c, m->b, m->c, m->b);
+    const __m128 ef = _mm_setr_ps(m->e, m->f, m->e, m->f);
+    const __m128 scale = _mm_set1_ps(64.f);
+    const __m128 limit = _mm_set1_ps(1073741824.f);
+    const __m128 sign = _mm_set1_ps(-0.f);
+    for(; i + 2 <= count; i += 2) {
+        __m128 xy = _mm_loadu_ps(&src[i].x);
+        if(matrix) {
+            __m128 yx = _mm_shuffle_ps(xy, xy, _MM_SHUFFLE(2, 3, 0, 1));
+            xy = _mm_add_ps(_mm_add_ps(_mm_mul_ps(xy, ad), _mm_mul_ps(yx, cb)), ef);
+        }
+
+        xy = _mm_mul_ps(xy, scale);
+        if(_mm_movemask_ps(_mm_cmpnlt_ps(_mm_andnot_ps(sign, xy), limit)))
+            break;
+        int32_t coords[4];
+        _mm_storeu_si128((__m128i*)(coords), ft_coord_round(xy));
+        dst[i].x = coords[0];
+        dst[i].y = coords[1];
+        dst[i + 1].x = coords[2];
+        dst[i + 1].y = coords[3];
+    }
+#endif // __SSE2__
+
+    for(; i < count; ++i) {
+        plutovg_point_t p = src[i];
+        if(matrix)
+            plutovg_matrix_map_point(matrix, &p, &p);
+        dst[i].x = FT_COORD(p.x);
+        dst[i].y = FT_COORD(p.y);
+    }
+}
+
 static void ft_outline_move_to(PVG_FT_Outline* ft, float x, float y)
 {
     ft->points[ft->n_points].x = FT_COORD(x);
@@ -214,24 +293,6 @@ static void ft_outline_line_to(PVG_FT_Outline* ft, float x, float y)
     ft->n_points++;
 }
 
-static void ft_outline_cubic_to(PVG_FT_Outline* ft, float x1, float y1, float x2, float y2, float x3, float y3)
-{
-    ft->points[ft->n_points].x = FT_COORD(x1);
-    ft->points[ft->n_points].y = FT_COORD(y1);
-    ft->tags[ft->n_points] = PVG_FT_CURVE_TAG_CUBIC;
-    ft->n_points++;
-
-    ft->points[ft->n_points].x = FT_COORD(x2);
-    ft->points[ft->n_points].y = FT_COORD(y2);
-    ft->tags[ft->n_points] = PVG_FT_CURVE_TAG_CUBIC;
-    ft->n_points++;
-
-    ft->points[ft->n_points].x = FT_COORD(x3);
-    ft->points[ft->n_points].y = FT_COORD(y3);
-    ft->tags[ft->n_points] = PVG_FT_CURVE_TAG_ON;
-    ft->n_points++;
-}
-
 static void ft_outline_close(PVG_FT_Outline* ft)
 {
     ft->contours_flag[ft->n_contours] = 0;
@@ -252,61 +313,436 @@ static void ft_outline_end(PVG_FT_Outline* ft)
     }
 }
 
-static PVG_FT_Outline* ft_outline_convert_stroke(const plutovg_path_t* path, const plutovg_matrix_t* matrix, const plutovg_stroke_data_t* stroke_data);
+static PVG_FT_Outline* ft_outline_convert_stroke(const plutovg_path_t* path, const plutovg_matrix_t* matrix, const plutovg_stroke_data_t* stroke_data, const plutovg_rect_t* clip_rect, const plutovg_raster_options_t* options);
 
-static PVG_FT_Outline* ft_outline_convert(const plutovg_path_t* path, const plutovg_matrix_t* matrix, const plutovg_stroke_data_t* stroke_data)
+static PVG_FT_Outline* ft_outline_convert(const plutovg_path_t* path, const plutovg_matrix_t* matrix, const plutovg_stroke_data_t* stroke_data, const plutovg_rect_t* clip_rect, const plutovg_raster_options_t* options)
 {
     if(stroke_data) {
-        return ft_outline_convert_stroke(path, matrix, stroke_data);
+        return ft_outline_convert_stroke(path, matrix, stroke_data, clip_rect, options);
     }
 
-    plutovg_path_iterator_t it;
-    plutovg_path_iterator_init(&it, path);
+    /*
+     * Path points map one to one onto outline points, close points included, so the
+     * whole array is transformed up front and the commands only supply tags and contours.
+     */
+    PVG_FT_Outline* outline = ft_outline_create(path->points.size, path->num_contours);
+    ft_map_points(matrix, path->points.data, outline->points, path->points.size);
 
-    plutovg_point_t points[3];
-    PVG_FT_Outline* outline = ft_outline_create(path->num_points, path->num_contours);
-    while(plutovg_path_iterator_has_next(&it)) {
-        switch(plutovg_path_iterator_next(&it, points)) {
+    const uint8_t* commands = path->commands.data;
+    for(int i = 0; i < path->commands.size; ++i) {
+        switch(commands[i]) {
         case PLUTOVG_PATH_COMMAND_MOVE_TO:
-            plutovg_matrix_map_points(matrix, points, points, 1);
-            ft_outline_move_to(outline, points[0].x, points[0].y);
+            if(outline->n_points) {
+                outline->contours[outline->n_contours] = outline->n_points - 1;
+                outline->n_contours++;
+            }
+
+            outline->contours_flag[outline->n_contours] = 1;
+            outline->tags[outline->n_points++] = PVG_FT_CURVE_TAG_ON;
             break;
         case PLUTOVG_PATH_COMMAND_LINE_TO:
-            plutovg_matrix_map_points(matrix, points, points, 1);
-            ft_outline_line_to(outline, points[0].x, points[0].y);
+            outline->tags[outline->n_points++] = PVG_FT_CURVE_TAG_ON;
             break;
         case PLUTOVG_PATH_COMMAND_CUBIC_TO:
-            plutovg_matrix_map_points(matrix, points, points, 3);
-            ft_outline_cubic_to(outline, points[0].x, points[0].y, points[1].x, points[1].y, points[2].x, points[2].y);
+            outline->tags[outline->n_points++] = PVG_FT_CURVE_TAG_CUBIC;
+            outline->tags[outline->n_points++] = PVG_FT_CURVE_TAG_CUBIC;
+            outline->tags[outline->n_points++] = PVG_FT_CURVE_TAG_ON;
             break;
-        case PLUTOVG_PATH_COMMAND_CLOSE:
-            ft_outline_close(outline);
+        case PLUTOVG_PATH_COMMAND_CLOSE: {
+            int start = outline->n_contours ? outline->contours[outline->n_contours - 1] + 1 : 0;
+            outline->contours_flag[outline->n_contours] = 0;
+            outline->points[outline->n_points] = outline->points[start];
+            outline->tags[outline->n_points++] = PVG_FT_CURVE_TAG_ON;
             break;
         }
+        }
     }
 
     ft_outline_end(outline);
     return outline;
 }
 
-static PVG_FT_Outline* ft_outline_convert_dash(const plutovg_path_t* path, const plutovg_matrix_t* matrix, const plutovg_stroke_dash_t* stroke_dash)
+/*
+ * The stroker subdivides curves by angle, regardless of the tolerance. At coarse
+ * tolerances it is cheaper to hand it the few line segments the curves flatten to.
+ */
+#define PLUTOVG_STROKE_FLATTEN_TOLERANCE 0.5f
+
+/*
+ * Strokes up to this device width with butt or square caps and miter or bevel joins skip
+ * the stroker. Their outline is built directly from the flattened polyline: one offset
+ * contour per side, with the same vertices the stroker produces; a miter over the limit
+ * is beveled, as the stroker's fixed miter join does. Round caps and joins need arcs, so
+ * those strokes go through the stroker instead.
+ */
+#define PLUTOVG_THIN_STROKE_WIDTH 2.f
+
+typedef struct {
+    PVG_FT_Outline* outline;
+    plutovg_line_cap_t cap;
+    plutovg_line_join_t join;
+    int point_capacity;
+    int contour_capacity;
+    float half_width;
+    float miter_limit;
+    bool started;
+} thin_stroker_t;
+
+static void thin_stroker_init(thin_stroker_t* stroker, const plutovg_stroke_data_t* stroke_data, float width, int capacity)
 {
-    if(stroke_dash->array.size == 0)
-        return ft_outline_convert(path, matrix, NULL);
-    plutovg_path_t* dashed = plutovg_path_clone_dashed(path, stroke_dash->offset, stroke_dash->array.data, stroke_dash->array.size);
-    PVG_FT_Outline* outline = ft_outline_convert(dashed, matrix, NULL);
-    plutovg_path_destroy(dashed);
-    return outline;
+    stroker->cap = stroke_data->style.cap;
+    stroker->join = stroke_data->style.join;
+    stroker->point_capacity = 8 * capacity + 8;
+    stroker->contour_capacity = 2 * capacity + 2;
+    stroker->outline = ft_outline_create(stroker->point_capacity, stroker->contour_capacity);
+    stroker->half_width = width * 0.5f;
+    stroker->miter_limit = stroke_data->style.miter_limit;
+    stroker->started = false;
+}
+
+static bool thin_stroker_supports(const plutovg_stroke_data_t* stroke_data)
+{
+    return stroke_data->style.cap != PLUTOVG_LINE_CAP_ROUND && stroke_data->style.join != PLUTOVG_LINE_JOIN_ROUND;
+}
+
+static void thin_stroker_reserve(thin_stroker_t* stroker, int count)
+{
+    /* A subpath adds at most three points per vertex and side, two caps and two contours. */
+    int points = stroker->outline->n_points + 6 * count + 8;
+    int contours = stroker->outline->n_contours + 3;
+    if(points <= stroker->point_capacity && contours <= stroker->contour_capacity)
+        return;
+    stroker->point_capacity = plutovg_max(points, 2 * stroker->point_capacity);
+    stroker->contour_capacity = plutovg_max(contours, 2 * stroker->contour_capacity);
+    stroker->outline = ft_outline_grow(stroker->outline, stroker->point_capacity, stroker->contour_capacity);
+}
+
+typedef struct {
+    plutovg_point_t direction;
+    plutovg_point_t normal;
+    float length;
+} thin_segment_t;
+
+/* |n0 + n1|^2 / hw^2 below which the stroker stops intersecting inner offsets, a turn of about 179.2 degrees. */
+#define PLUTOVG_THIN_REVERSAL 1.9e-4f
+
+static void thin_stroker_add_point(thin_stroker_t* stroker, float x, float y)
+{
+    if(stroker->started) {
+        ft_outline_line_to(stroker->outline, x, y);
+    } else {
+        ft_outline_move_to(stroker->outline, x, y);
+        stroker->started = true;
+    }
+}
+
+static void thin_stroker_close(thin_stroker_t* stroker)
+{
+    ft_outline_close(stroker->outline);
+    stroker->started = false;
+}
+
+static thin_segment_t thin_segment(const thin_stroker_t* stroker, plutovg_point_t a, plutovg_point_t b)
+{
+    thin_segment_t segment;
+    float dx = b.x - a.x;
+    float dy = b.y - a.y;
+    segment.length = sqrtf(dx * dx + dy * dy);
+    segment.direction = PLUTOVG_MAKE_POINT(dx / segment.length, dy / segment.length);
+    segment.normal = PLUTOVG_MAKE_POINT(-segment.direction.y * stroker->half_width, segment.direction.x * stroker->half_width);
+    return segment;
+}
+
+static void thin_stroker_add_join(thin_stroker_t* stroker, plutovg_point_t vertex, const thin_segment_t* in, const thin_segment_t* out)
+{
+    const plutovg_point_t n0 = in->normal;
+    const plutovg_point_t n1 = out->normal;
+    float cross = n0.x * n1.y - n0.y * n1.x;
+    float dot = n0.x * n1.x + n0.y * n1.y;
+    if(cross == 0.f && dot > 0.f) {
+        thin_stroker_add_point(stroker, vertex.x + n0.x, vertex.y + n0.y);
+        return;
+    }
+
+    /* The offset lines meet at vertex + k * (n0 + n1); the miter length over the width is 2 * hw / |n0 + n1|. */
+    float hw = stroker->half_width;
+    float ux = n0.x + n1.x;
+    float uy = n0.y + n1.y;
+    float length_squared = ux * ux + uy * uy;
+    float k = length_squared > 0.f ? 2.f * hw * hw / length_squared : 0.f;
+    if(cross > 0.f) {
+        /*
+         * Inner side: cut at the intersection when it lies within both segments and the
+         * turn is short of a reversal, as the stroker does; otherwise step across.
+         */
+        float along = k * fabsf(ux * in->direction.x + uy * in->direction.y);
+        if(length_squared > PLUTOVG_THIN_REVERSAL * hw * hw && along <= in->length && along <= out->length) {
+            thin_stroker_add_point(stroker, vertex.x + k * ux, vertex.y + k * uy);
+        } else {
+            thin_stroker_add_point(stroker, vertex.x + n0.x, vertex.y + n0.y);
+            thin_stroker_add_point(stroker, vertex.x + n1.x, vertex.y + n1.y);
+        }
+
+        return;
+    }
+
+    /* Outer side: the miter tip, or a bevel straight across when the miter is over the limit. */
+    thin_stroker_add_point(stroker, vertex.x + n0.x, vertex.y + n0.y);
+    if(stroker->join == PLUTOVG_LINE_JOIN_MITER && length_squared > 0.f && 4.f * hw * hw <= stroker->miter_limit * stroker->miter_limit * length_squared) {
+        thin_stroker_add_point(stroker, vertex.x + k * ux, vertex.y + k * uy);
+    }
+
+    thin_stroker_add_point(stroker, vertex.x + n1.x, vertex.y + n1.y);
+}
+
+static void thin_stroker_add_side(thin_stroker_t* stroker, const plutovg_point_t* points, int count, bool closed, bool reverse, float extension)
+{
+#define THIN_POINT(i) points[reverse ? count - 1 - (i) : (i)]
+    if(closed) {
+        thin_segment_t in = thin_segment(stroker, THIN_POINT(count - 1), THIN_POINT(0));
+        for(int i = 0; i < count; i++) {
+            thin_segment_t out = thin_segment(stroker, THIN_POINT(i), THIN_POINT((i + 1) % count));
+            thin_stroker_add_join(stroker, THIN_POINT(i), &in, &out);
+            in = out;
+        }
+
+        thin_stroker_close(stroker);
+        return;
+    }
+
+    thin_segment_t in = thin_segment(stroker, THIN_POINT(0), THIN_POINT(1));
+    plutovg_point_t start = THIN_POINT(0);
+    thin_stroker_add_point(stroker, start.x - in.direction.x * extension + in.normal.x, start.y - in.direction.y * extension + in.normal.y);
+    for(int i = 1; i < count - 1; i++) {
+        thin_segment_t out = thin_segment(stroker, THIN_POINT(i), THIN_POINT(i + 1));
+        thin_stroker_add_join(stroker, THIN_POINT(i), &in, &out);
+        in = out;
+    }
+
+    plutovg_point_t end = THIN_POINT(count - 1);
+    thin_stroker_add_point(stroker, end.x + in.direction.x * extension + in.normal.x, end.y + in.direction.y * extension + in.normal.y);
+#undef THIN_POINT
+}
+
+static void thin_stroker_add_subpath(thin_stroker_t* stroker, const plutovg_point_t* points, int count, bool closed)
+{
+    if(closed && count > 1 && points[0].x == points[count - 1].x && points[0].y == points[count - 1].y)
+        count--;
+    thin_stroker_reserve(stroker, count);
+    float hw = stroker->half_width;
+    if(count == 1) {
+        /* Zero-length subpaths only show their caps, a square facing along the x axis. */
+        if(stroker->cap == PLUTOVG_LINE_CAP_BUTT)
+            return;
+        thin_stroker_add_point(stroker, points[0].x - hw, points[0].y + hw);
+        thin_stroker_add_point(stroker, points[0].x + hw, points[0].y + hw);
+        thin_stroker_add_point(stroker, points[0].x + hw, points[0].y - hw);
+        thin_stroker_add_point(stroker, points[0].x - hw, points[0].y - hw);
+        thin_stroker_close(stroker);
+        return;
+    }
+
+    /*
+     * Both sides are walked along their own direction of travel, so an open subpath is a
+     * single contour and a closed one a pair of opposite rings with the same winding.
+     */
+    if(closed) {
+        thin_stroker_add_side(stroker, points, count, true, false, 0.f);
+        thin_stroker_add_side(stroker, points, count, true, true, 0.f);
+        return;
+    }
+
+    /* Square caps extend the end segments by half the width. */
+    float extension = stroker->cap == PLUTOVG_LINE_CAP_SQUARE ? hw : 0.f;
+    thin_stroker_add_side(stroker, points, count, false, false, extension);
+    thin_stroker_add_side(stroker, points, count, false, true, extension);
+    thin_stroker_close(stroker);
+}
+
+/*
+ * Strokes that reach the stroker as line segments, dashed ones included, are streamed:
+ * the path is flattened and dashed straight into the stroker one subpath at a time, and
+ * subpaths whose stroke lies entirely outside the clip are dropped before stroking.
+ */
+typedef struct {
+    const plutovg_matrix_t* matrix;
+    const plutovg_raster_options_t* options;
+    PVG_FT_Stroker stroker;
+    thin_stroker_t* thin_stroker;
+    plutovg_rect_t cull_rect;
+    plutovg_point_t current_point;
+    float tolerance;
+    bool cull;
+    bool drawn;
+    struct {
+        plutovg_point_t* data;
+        int size;
+        int capacity;
+    } points;
+
+    struct {
+        PVG_FT_Vector* data;
+        int size;
+        int capacity;
+    } vectors;
+} stroke_stream_t;
+
+static void stroke_stream_init(stroke_stream_t* stream, const plutovg_matrix_t* matrix, const plutovg_stroke_data_t* stroke_data, float width, const plutovg_rect_t* clip_rect, const plutovg_raster_options_t* options)
+{
+    stream->matrix = matrix;
+    stream->options = options;
+    stream->stroker = NULL;
+    stream->thin_stroker = NULL;
+    stream->cull = clip_rect != NULL;
+    if(clip_rect) {
+        float limit = 1.f;
+        if(stroke_data->style.join == PLUTOVG_LINE_JOIN_MITER)
+            limit = plutovg_max(limit, stroke_data->style.miter_limit);
+        if(stroke_data->style.cap == PLUTOVG_LINE_CAP_SQUARE)
+            limit = plutovg_max(limit, PLUTOVG_SQRT2);
+        float margin = width * 0.5f * limit + 1.f;
+        stream->cull_rect.x = clip_rect->x - margin;
+        stream->cull_rect.y = clip_rect->y - margin;
+        stream->cull_rect.w = clip_rect->w + 2.f * margin;
+        stream->cull_rect.h = clip_rect->h + 2.f * margin;
+    }
+
+    stream->current_point = PLUTOVG_EMPTY_POINT;
+    stream->tolerance = options->tolerance;
+    stream->drawn = false;
+    plutovg_array_init(stream->points);
+    plutovg_array_init(stream->vectors);
+}
+
+static void stroke_stream_destroy(stroke_stream_t* stream)
+{
+    plutovg_array_destroy(stream->points);
+    plutovg_array_destroy(stream->vectors);
+}
+
+static void stroke_stream_add_point(stroke_stream_t* stream, const plutovg_point_t* source)
+{
+    plutovg_point_t point;
+    plutovg_matrix_map_point(stream->matrix, source, &point);
+    stream->current_point = *source;
+    if(stream->points.size > 0) {
+        const plutovg_point_t* last = &stream->points.data[stream->points.size - 1];
+        if(last->x == point.x && last->y == point.y) {
+            return;
+        }
+    }
+
+    plutovg_array_append_data(stream->points, &point, 1);
+}
+
+static void stroke_stream_flush(stroke_stream_t* stream, bool closed)
+{
+    if(!stream->drawn)
+        return;
+    stream->drawn = false;
+
+    const plutovg_point_t* points = stream->points.data;
+    int count = stream->points.size;
+    if(stream->cull) {
+        float x1 = points[0].x;
+        float y1 = points[0].y;
+        float x2 = points[0].x;
+        float y2 = points[0].y;
+        for(int i = 1; i < count; i++) {
+            x1 = plutovg_min(x1, points[i].x);
+            y1 = plutovg_min(y1, points[i].y);
+            x2 = plutovg_max(x2, points[i].x);
+            y2 = plutovg_max(y2, points[i].y);
+        }
+
+        const plutovg_rect_t* rect = &stream->cull_rect;
+        if(x2 < rect->x || y2 < rect->y || x1 > rect->x + rect->w || y1 > rect->y + rect->h) {
+            return;
+        }
+    }
+
+    if(stream->thin_stroker) {
+        thin_stroker_add_subpath(stream->thin_stroker, points, count, closed);
+        return;
+    }
+
+    plutovg_array_clear(stream->vectors);
+    plutovg_array_ensure(stream->vectors, count + 1);
+    PVG_FT_Vector* vectors = stream->vectors.data;
+    ft_map_points(NULL, points, vectors, count);
+
+    /* A zero-length subpath still gets its caps. */
+    if(count == 1)
+        vectors[count++] = vectors[0];
+    PVG_FT_Stroker_ParsePolyline(stream->stroker, vectors, count, !closed);
+}
+
+static void stroke_stream_traverse_func(void* closure, plutovg_path_command_t command, const plutovg_point_t* points, int)
+{
+    stroke_stream_t* stream = (stroke_stream_t*)(closure);
+    switch(command) {
+    case PLUTOVG_PATH_COMMAND_MOVE_TO:
+        stroke_stream_flush(stream, false);
+        plutovg_array_clear(stream->points);
+        stroke_stream_add_point(stream, &points[0]);
+        break;
+    case PLUTOVG_PATH_COMMAND_LINE_TO:
+        stroke_stream_add_point(stream, &points[0]);
+        stream->drawn = true;
+        break;
+    case PLUTOVG_PATH_COMMAND_CUBIC_TO:
+        /* Sources flatten their curves first; one that still arrives is flattened here. */
+        plutovg_cubic_flatten(&stream->current_point, points, stream->tolerance, stroke_stream_traverse_func, stream);
+        break;
+    case PLUTOVG_PATH_COMMAND_CLOSE:
+        stroke_stream_add_point(stream, &points[0]);
+        stream->drawn = true;
+        stroke_stream_flush(stream, true);
+        plutovg_array_clear(stream->points);
+        stroke_stream_add_point(stream, &points[0]);
+        break;
+    }
+}
+
+static void stroke_stream_run(stroke_stream_t* stream, const plutovg_path_t* path, const plutovg_stroke_dash_t* stroke_dash, float tolerance)
+{
+    /* Curves are flattened in user space, so scale the device tolerance back through the matrix. */
+    float scale = plutovg_matrix_get_max_scale(stream->matrix);
+    float user_tolerance = scale > 0.f ? tolerance / scale : tolerance;
+    stream->tolerance = user_tolerance;
+    if(stroke_dash->array == NULL) {
+        plutovg_path_traverse_flatten_tolerance(path, user_tolerance, stroke_stream_traverse_func, stream);
+    } else {
+        plutovg_path_traverse_dashed_tolerance(path, stroke_dash->offset, stroke_dash->array->data, stroke_dash->array->size, user_tolerance, stroke_stream_traverse_func, stream, stream->options->interrupt, stream->options->interrupt_closure);
+    }
+
+    stroke_stream_flush(stream, false);
 }
 
-static PVG_FT_Outline* ft_outline_convert_stroke(const plutovg_path_t* path, const plutovg_matrix_t* matrix, const plutovg_stroke_data_t* stroke_data)
+static PVG_FT_Outline* ft_outline_convert_stroke(const plutovg_path_t* path, const plutovg_matrix_t* matrix, const plutovg_stroke_data_t* stroke_data, const plutovg_rect_t* clip_rect, const plutovg_raster_options_t* options)
 {
+    float tolerance = options->tolerance;
     double scale_x = sqrt(matrix->a * matrix->a + matrix->b * matrix->b);
     double scale_y = sqrt(matrix->c * matrix->c + matrix->d * matrix->d);
 
     double scale = hypot(scale_x, scale_y) / PLUTOVG_SQRT2;
     double width = stroke_data->style.width * scale;
 
+    /* Curves reach the stroker whole unless they are dashed or flattened coarsely anyway. */
+    bool streamed = stroke_data->dash.array || path->num_curves == 0 || tolerance >= PLUTOVG_STROKE_FLATTEN_TOLERANCE;
+
+    stroke_stream_t stream;
+    stroke_stream_init(&stream, matrix, stroke_data, (float)width, clip_rect, options);
+    if(streamed && width <= PLUTOVG_THIN_STROKE_WIDTH && thin_stroker_supports(stroke_data)) {
+        thin_stroker_t thin_stroker;
+        thin_stroker_init(&thin_stroker, stroke_data, (float)width, path->points.size);
+        stream.thin_stroker = &thin_stroker;
+        stroke_stream_run(&stream, path, &stroke_data->dash, tolerance);
+        stroke_stream_destroy(&stream);
+        ft_outline_end(thin_stroker.outline);
+        return thin_stroker.outline;
+    }
+
     PVG_FT_Fixed ftWidth = (PVG_FT_Fixed)(width * 0.5 * (1 << 6));
     PVG_FT_Fixed ftMiterLimit = (PVG_FT_Fixed)(stroke_data->style.miter_limit * (1 << 16));
 
@@ -339,9 +775,16 @@ static PVG_FT_Outline* ft_outline_convert_stroke(const plutovg_path_t* path, con
     PVG_FT_Stroker stroker;
     PVG_FT_Stroker_New(&stroker);
     PVG_FT_Stroker_Set(stroker, ftWidth, ftCap, ftJoin, ftMiterLimit);
+    if(!streamed) {
+        PVG_FT_Outline* outline = ft_outline_convert(path, matrix, NULL, NULL, options);
+        PVG_FT_Stroker_ParseOutline(stroker, outline);
+        ft_outline_destroy(outline);
+    } else {
+        stream.stroker = stroker;
+        stroke_stream_run(&stream, path, &stroke_data->dash, tolerance);
+    }
 
-    PVG_FT_Outline* outline = ft_outline_convert_dash(path, matrix, &stroke_data->dash);
-    PVG_FT_Stroker_ParseOutline(stroker, outline);
+    stroke_stream_destroy(&stream);
 
     PVG_FT_UInt points;
     PVG_FT_UInt contours;
@@ -351,19 +794,61 @@ static PVG_FT_Outline* ft_outline_convert_stroke(const plutovg_path_t* path, con
     PVG_FT_Stroker_Export(stroker, stroke_outline);
 
     PVG_FT_Stroker_Done(stroker);
-    ft_outline_destroy(outline);
     return stroke_outline;
 }
 
-static void spans_generation_callback(int count, const PVG_FT_Span* spans, void* user)
+typedef struct {
+    plutovg_span_func_t func;
+    void* closure;
+    const plutovg_raster_options_t* options;
+} spans_callback_data_t;
+
+static int interrupt_callback(void* user)
 {
-    plutovg_span_buffer_t* span_buffer = (plutovg_span_buffer_t*)(user);
-    plutovg_array_append_data(span_buffer->spans, spans, count);
+    const spans_callback_data_t* data = (const spans_callback_data_t*)(user);
+    return plutovg_raster_interrupted(data->options);
+}
+
+static void spans_callback(int count, const PVG_FT_Span* spans, void* user)
+{
+    const spans_callback_data_t* data = (const spans_callback_data_t*)(user);
+    data->func(count, (const plutovg_span_t*)(spans), data->closure);
+}
+
+static void aliased_spans_callback(int count, const PVG_FT_Span* spans, void* user)
+{
+    /* Snap coverage to fully on or off and merge the runs that become contiguous. */
+    plutovg_span_t aliased[PVG_FT_MAX_GRAY_SPANS];
+    int size = 0;
+    for(int i = 0; i < count && size < PVG_FT_MAX_GRAY_SPANS; i++) {
+        if(spans[i].coverage < 128)
+            continue;
+        if(size > 0) {
+            plutovg_span_t* last = &aliased[size - 1];
+            if(last->y == spans[i].y && last->x + last->len == spans[i].x) {
+                last->len += spans[i].len;
+                continue;
+            }
+        }
+
+        aliased[size].x = spans[i].x;
+        aliased[size].len = spans[i].len;
+        aliased[size].y = spans[i].y;
+        aliased[size].coverage = 255;
+        size += 1;
+    }
+
+    if(size > 0) {
+        const spans_callback_data_t* data = (const spans_callback_data_t*)(user);
+        data->func(size, aliased, data->closure);
+    }
 }
 
-void plutovg_rasterize(plutovg_span_buffer_t* span_buffer, const plutovg_path_t* path, const plutovg_matrix_t* matrix, const plutovg_rect_t* clip_rect, const plutovg_stroke_data_t* stroke_data, plutovg_fill_rule_t winding)
+void plutovg_rasterize_spans(plutovg_span_func_t func, void* closure, const plutovg_path_t* path, const plutovg_matrix_t* matrix, const plutovg_rect_t* clip_rect, const plutovg_stroke_data_t* stroke_data, plutovg_fill_rule_t winding, const plutovg_raster_options_t* options)
 {
-    PVG_FT_Outline* outline = ft_outline_convert(path, matrix, stroke_data);
+    if(plutovg_raster_interrupted(options))
+        return;
+    PVG_FT_Outline* outline = ft_outline_convert(path, matrix, stroke_data, clip_rect, options);
     if(stroke_data) {
         outline->flags = PVG_FT_OUTLINE_NONE;
     } else {
@@ -377,11 +862,15 @@ void plutovg_rasterize(plutovg_span_buffer_t* span_buffer, const plutovg_path_t*
         }
     }
 
+    spans_callback_data_t data = {func, closure, options};
+
     PVG_FT_Raster_Params params;
     params.flags = PVG_FT_RASTER_FLAG_DIRECT | PVG_FT_RASTER_FLAG_AA;
-    params.gray_spans = spans_generation_callback;
-    params.user = span_buffer;
+    params.gray_spans = options->antialias ? spans_callback : aliased_spans_callback;
+    params.user = &data;
     params.source = outline;
+    params.tolerance = (PVG_FT_Pos)(options->tolerance * 64.f);
+    params.interrupt = options->interrupt ? interrupt_callback : NULL;
     if(clip_rect) {
         params.flags |= PVG_FT_RASTER_FLAG_CLIP;
         params.clip_box.xMin = (PVG_FT_Pos)clip_rect->x;
@@ -390,7 +879,23 @@ void plutovg_rasterize(plutovg_span_buffer_t* span_buffer, const plutovg_path_t*
         params.clip_box.yMax = (PVG_FT_Pos)(clip_rect->y + clip_rect->h);
     }
 
-    plutovg_span_buffer_reset(span_buffer);
-    PVG_FT_Raster_Render(&params);
+    if(options->rasterizer == PLUTOVG_RASTERIZER_SPARSE) {
+        plutovg_sparse_raster_render(&params);
+    } else {
+        PVG_FT_Raster_Render(&params);
+    }
+
     ft_outline_destroy(outline);
 }
+
+static void spans_generation_callback(int count, const plutovg_span_t* spans, void* closure)
+{
+    plutovg_span_buffer_t* span_buffer = (plutovg_span_buffer_t*)(closure);
+    plutovg_array_append_data(span_buffer->spans, spans, count);
+}
+
+void plutovg_rasterize(plutovg_span_buffer_t* span_buffer, const plutovg_path_t* path, const plutovg_matrix_t* matrix, const plutovg_rect_t* clip_rect, const plutovg_stroke_data_t* stroke_data, plutovg_fill_rule_t winding, const plutovg_raster_options_t* options)
+{
+    plutovg_span_buffer_reset(span_buffer);
+    plutovg_rasterize_spans(spans_generation_callback, span_buffer, path, matrix, clip_rect, stroke_data, winding, options);
+}
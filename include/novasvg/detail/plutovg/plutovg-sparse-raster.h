@@ -0,0 +1,574 @@
+#pragma once
+
+#include "plutovg-private.h"
+#include "plutovg-utils.h"
+
+#include "plutovg-ft-raster.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/*
+ * Sparse-scanline analytic-coverage rasterizer.
+ *
+ * The outline is flattened into line segments which are accumulated, one strip of
+ * scanlines at a time, into a signed-area cell buffer. Every cell written to is
+ * flagged in a per-row bit mask, so the sweep visits only touched cells: the
+ * coverage between two touched cells is constant and is emitted as a single span.
+ * The cost of a fill is therefore proportional to the length of its edges rather
+ * than to its area, and no per-band cell pool has to be managed.
+ *
+ * Spans are delivered through the same PVG_FT_Raster_Params callback contract as
+ * PVG_FT_Raster_Render, in increasing y and x order.
+ */
+
+#define SPARSE_STRIP_HEIGHT 32
+#define SPARSE_MAX_WIDTH (1 << 15)
+#define SPARSE_MAX_CURVE_SEGMENTS 256
+#define SPARSE_STACK_CELLS 4096
+#define SPARSE_STACK_LINES 256
+#define SPARSE_INSERTION_SORT_LIMIT 32
+
+typedef struct {
+    float x0, y0;
+    float x1, y1;
+} sparse_line_t;
+
+typedef struct {
+    struct {
+        sparse_line_t* data;
+        int size;
+        int capacity;
+    } lines;
+
+    float width;
+    float height;
+    float origin_x;
+    float origin_y;
+    float tolerance;
+    float x;
+    float y;
+} sparse_raster_t;
+
+typedef struct {
+    float* cells;
+    uint32_t* masks;
+    int stride;
+    int mask_stride;
+    int top;
+    int rows;
+} sparse_strip_t;
+
+typedef struct {
+    PVG_FT_Span spans[PVG_FT_MAX_GRAY_SPANS];
+    int count;
+    int origin_x;
+    int origin_y;
+    int width;
+    bool even_odd;
+    PVG_FT_SpanFunc func;
+    void* user;
+} sparse_span_sink_t;
+
+static inline int sparse_ctz(uint32_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctz(value);
+#elif defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, value);
+    return (int)index;
+#else
+    int index = 0;
+    while((value & 1u) == 0) {
+        value >>= 1;
+        ++index;
+    }
+
+    return index;
+#endif
+}
+
+static void sparse_raster_add_line(sparse_raster_t* raster, float x0, float y0, float x1, float y1)
+{
+    if(y0 == y1)
+        return;
+    if((y0 <= 0.f && y1 <= 0.f) || (y0 >= raster->height && y1 >= raster->height)) {
+        return;
+    }
+
+    /*
+     * Portions left of the region still contribute cover to every cell on their
+     * scanlines, so they are projected onto x = 0; portions right of it contribute
+     * nothing visible and are projected onto x = width.
+     */
+    const float w = raster->width;
+    if(x0 <= 0.f && x1 <= 0.f) {
+        x0 = x1 = 0.f;
+    } else if(x0 >= w && x1 >= w) {
+        x0 = x1 = w;
+    } else if((x0 < 0.f) != (x1 < 0.f)) {
+        float y = y0 + (0.f - x0) * (y1 - y0) / (x1 - x0);
+        sparse_raster_add_line(raster, x0, y0, 0.f, y);
+        sparse_raster_add_line(raster, 0.f, y, x1, y1);
+        return;
+    } else if((x0 > w) != (x1 > w)) {
+        float y = y0 + (w - x0) * (y1 - y0) / (x1 - x0);
+        sparse_raster_add_line(raster, x0, y0, w, y);
+        sparse_raster_add_line(raster, w, y, x1, y1);
+        return;
+    }
+
+    plutovg_array_ensure(raster->lines, 1);
+    sparse_line_t* line = raster->lines.data + raster->lines.size;
+    line->x0 = x0;
+    line->y0 = y0;
+    line->x1 = x1;
+    line->y1 = y1;
+    raster->lines.size += 1;
+}
+
+static void sparse_raster_move_to(sparse_raster_t* raster, const PVG_FT_Vector* to)
+{
+    raster->x = to->x / 64.f - raster->origin_x;
+    raster->y = to->y / 64.f - raster->origin_y;
+}
+
+static void sparse_raster_line_to(sparse_raster_t* raster, float x, float y)
+{
+    sparse_raster_add_line(raster, raster->x, raster->y, x, y);
+    raster->x = x;
+    raster->y = y;
+}
+
+static int sparse_segment_count(const sparse_raster_t* raster, float ddx, float ddy, float factor)
+{
+    /* Wang's formula: the number of uniform segments keeping the chord error within tolerance. */
+    float dd = sqrtf(ddx * ddx + ddy * ddy);
+    float count = ceilf(sqrtf(dd * factor / raster->tolerance));
+    if(!(count < SPARSE_MAX_CURVE_SEGMENTS))
+        return SPARSE_MAX_CURVE_SEGMENTS;
+    return plutovg_max(1, (int)count);
+}
+
+static void sparse_raster_conic_to(sparse_raster_t* raster, const PVG_FT_Vector* control, const PVG_FT_Vector* to)
+{
+    float x0 = raster->x;
+    float y0 = raster->y;
+    float x1 = control->x / 64.f - raster->origin_x;
+    float y1 = control->y / 64.f - raster->origin_y;
+    float x2 = to->x / 64.f - raster->origin_x;
+    float y2 = to->y / 64.f - raster->origin_y;
+
+    int count = sparse_segment_count(raster, x0 - 2.f * x1 + x2, y0 - 2.f * y1 + y2, 0.25f);
+    for(int i = 1; i < count; i++) {
+        float t = (float)i / count;
+        float mt = 1.f - t;
+        float a = mt * mt;
+        float b = 2.f * mt * t;
+        float c = t * t;
+        sparse_raster_line_to(raster, a * x0 + b * x1 + c * x2, a * y0 + b * y1 + c * y2);
+    }
+
+    sparse_raster_line_to(raster, x2, y2);
+}
+
+static void sparse_raster_cubic_to(sparse_raster_t* raster, const PVG_FT_Vector* control1, const PVG_FT_Vector* control2, const PVG_FT_Vector* to)
+{
+    float x0 = raster->x;
+    float y0 = raster->y;
+    float x1 = control1->x / 64.f - raster->origin_x;
+    float y1 = control1->y / 64.f - raster->origin_y;
+    float x2 = control2->x / 64.f - raster->origin_x;
+    float y2 = control2->y / 64.f - raster->origin_y;
+    float x3 = to->x / 64.f - raster->origin_x;
+    float y3 = to->y / 64.f - raster->origin_y;
+
+    float ddx = plutovg_max(fabsf(x0 - 2.f * x1 + x2), fabsf(x1 - 2.f * x2 + x3));
+    float ddy = plutovg_max(fabsf(y0 - 2.f * y1 + y2), fabsf(y1 - 2.f * y2 + y3));
+    int count = sparse_segment_count(raster, ddx, ddy, 0.75f);
+    for(int i = 1; i < count; i++) {
+        float t = (float)i / count;
+        float mt = 1.f - t;
+        float a = mt * mt * mt;
+        float b = 3.f * mt * mt * t;
+        float c = 3.f * mt * t * t;
+        float d = t * t * t;
+        sparse_raster_line_to(raster, a * x0 + b * x1 + c * x2 + d * x3, a * y0 + b * y1 + c * y2 + d * y3);
+    }
+
+    sparse_raster_line_to(raster, x3, y3);
+}
+
+static void sparse_raster_decompose(sparse_raster_t* raster, const PVG_FT_Outline* outline)
+{
+    int first = 0;
+    for(int n = 0; n < outline->n_contours; n++) {
+        int last = outline->contours[n];
+        if(last < first)
+            return;
+        const PVG_FT_Vector* points = outline->points;
+        const char* tags = outline->tags;
+
+        PVG_FT_Vector start = points[first];
+        int index = first;
+        if(PVG_FT_CURVE_TAG(tags[first]) == PVG_FT_CURVE_TAG_CONIC) {
+            if(PVG_FT_CURVE_TAG(tags[last]) == PVG_FT_CURVE_TAG_ON) {
+                start = points[last];
+                last -= 1;
+            } else {
+                start.x = (start.x + points[last].x) / 2;
+                start.y = (start.y + points[last].y) / 2;
+            }
+
+            index -= 1;
+        }
+
+        sparse_raster_move_to(raster, &start);
+        const float start_x = raster->x;
+        const float start_y = raster->y;
+        while(index < last) {
+            index += 1;
+            switch(PVG_FT_CURVE_TAG(tags[index])) {
+            case PVG_FT_CURVE_TAG_ON:
+                sparse_raster_line_to(raster, points[index].x / 64.f - raster->origin_x, points[index].y / 64.f - raster->origin_y);
+                break;
+            case PVG_FT_CURVE_TAG_CONIC: {
+                PVG_FT_Vector control = points[index];
+                while(index < last) {
+                    index += 1;
+                    PVG_FT_Vector vec = points[index];
+                    if(PVG_FT_CURVE_TAG(tags[index]) == PVG_FT_CURVE_TAG_ON) {
+                        sparse_raster_conic_to(raster, &control, &vec);
+                        goto next_point;
+                    }
+
+                    PVG_FT_Vector middle;
+                    middle.x = (control.x + vec.x) / 2;
+                    middle.y = (control.y + vec.y) / 2;
+                    sparse_raster_conic_to(raster, &control, &middle);
+                    control = vec;
+                }
+
+                sparse_raster_conic_to(raster, &control, &start);
+                goto next_contour;
+            } default:
+                if(index + 1 > last)
+                    return;
+                if(index + 2 > last) {
+                    sparse_raster_cubic_to(raster, &points[index], &points[index + 1], &start);
+                    goto next_contour;
+                }
+
+                sparse_raster_cubic_to(raster, &points[index], &points[index + 1], &points[index + 2]);
+                index += 2;
+                break;
+            }
+
+        next_point:
+            continue;
+        }
+
+        sparse_raster_line_to(raster, start_x, start_y);
+    next_contour:
+        first = outline->contours[n] + 1;
+    }
+}
+
+static int sparse_line_compare(const void* a, const void* b)
+{
+    const sparse_line_t* la = static_cast<const sparse_line_t*>(a);
+    const sparse_line_t* lb = static_cast<const sparse_line_t*>(b);
+    float ya = plutovg_min(la->y0, la->y1);
+    float yb = plutovg_min(lb->y0, lb->y1);
+    return (ya > yb) - (ya < yb);
+}
+
+static void sparse_raster_sort_lines(sparse_line_t* lines, int count)
+{
+    if(count > SPARSE_INSERTION_SORT_LIMIT) {
+        qsort(lines, count, sizeof(sparse_line_t), sparse_line_compare);
+        return;
+    }
+
+    for(int i = 1; i < count; i++) {
+        sparse_line_t line = lines[i];
+        float y = plutovg_min(line.y0, line.y1);
+        int j = i - 1;
+        while(j >= 0 && plutovg_min(lines[j].y0, lines[j].y1) > y) {
+            lines[j + 1] = lines[j];
+            j -= 1;
+        }
+
+        lines[j + 1] = line;
+    }
+}
+
+static inline void sparse_strip_add(sparse_strip_t* strip, int row, int x, float value)
+{
+    strip->cells[row * strip->stride + x] += value;
+    strip->masks[row * strip->mask_stride + (x >> 5)] |= 1u << (x & 31);
+}
+
+static void sparse_strip_accumulate(sparse_strip_t* strip, const sparse_line_t* line, float width)
+{
+    float x0 = line->x0;
+    float y0 = line->y0;
+    float x1 = line->x1;
+    float y1 = line->y1;
+    float dir = 1.f;
+    if(y0 > y1) {
+        float t;
+        t = x0; x0 = x1; x1 = t;
+        t = y0; y0 = y1; y1 = t;
+        dir = -1.f;
+    }
+
+    const float top = (float)strip->top;
+    const float bottom = top + strip->rows;
+    const float ystart = plutovg_max(y0, top);
+    const float yend = plutovg_min(y1, bottom);
+    if(ystart >= yend)
+        return;
+    const float dxdy = (x1 - x0) / (y1 - y0);
+    float x = x0 + (ystart - y0) * dxdy;
+
+    const int ybegin = (int)floorf(ystart);
+    const int ylimit = (int)ceilf(yend);
+    for(int y = ybegin; y < ylimit; y++) {
+        const int row = y - strip->top;
+        const float dy = plutovg_min((float)(y + 1), yend) - plutovg_max((float)y, ystart);
+        const float xnext = x + dxdy * dy;
+        const float d = dy * dir;
+
+        float xa = plutovg_clamp(plutovg_min(x, xnext), 0.f, width);
+        float xb = plutovg_clamp(plutovg_max(x, xnext), 0.f, width);
+        const float xa_floor = floorf(xa);
+        const int xai = (int)xa_floor;
+        const float xb_ceil = ceilf(xb);
+        const int xbi = (int)xb_ceil;
+        if(xbi <= xai + 1) {
+            const float xmf = 0.5f * (xa + xb) - xa_floor;
+            sparse_strip_add(strip, row, xai, d - d * xmf);
+            sparse_strip_add(strip, row, xai + 1, d * xmf);
+        } else {
+            const float s = 1.f / (xb - xa);
+            const float xaf = xa - xa_floor;
+            const float a0 = 0.5f * s * (1.f - xaf) * (1.f - xaf);
+            const float xbf = xb - xb_ceil + 1.f;
+            const float am = 0.5f * s * xbf * xbf;
+            sparse_strip_add(strip, row, xai, d * a0);
+            if(xbi == xai + 2) {
+                sparse_strip_add(strip, row, xai + 1, d * (1.f - a0 - am));
+            } else {
+                const float a1 = s * (1.5f - xaf);
+                sparse_strip_add(strip, row, xai + 1, d * (a1 - a0));
+                for(int xi = xai + 2; xi < xbi - 1; xi++)
+                    sparse_strip_add(strip, row, xi, d * s);
+                const float a2 = a1 + (xbi - xai - 3) * s;
+                sparse_strip_add(strip, row, xbi - 1, d * (1.f - a2 - am));
+            }
+
+            sparse_strip_add(strip, row, xbi, d * am);
+        }
+
+        x = xnext;
+    }
+}
+
+static void sparse_sink_flush(sparse_span_sink_t* sink)
+{
+    if(sink->count > 0 && sink->func)
+        sink->func(sink->count, sink->spans, sink->user);
+    sink->count = 0;
+}
+
+static void sparse_sink_emit(sparse_span_sink_t* sink, int x, int len, int y, float cover)
+{
+    if(x >= sink->width)
+        return;
+    if(x + len > sink->width)
+        len = sink->width - x;
+    float alpha = fabsf(cover);
+    if(sink->even_odd) {
+        alpha = fmodf(alpha, 2.f);
+        if(alpha > 1.f) {
+            alpha = 2.f - alpha;
+        }
+    } else if(alpha > 1.f) {
+        alpha = 1.f;
+    }
+
+    int coverage = (int)(alpha * 255.f + 0.5f);
+    if(coverage == 0)
+        return;
+    x += sink->origin_x;
+    y += sink->origin_y;
+    if(sink->count > 0) {
+        PVG_FT_Span* last = sink->spans + sink->count - 1;
+        if(last->y == y && last->x + last->len == x && last->coverage == coverage) {
+            last->len += len;
+            return;
+        }
+    }
+
+    if(sink->count == PVG_FT_MAX_GRAY_SPANS)
+        sparse_sink_flush(sink);
+    PVG_FT_Span* span = sink->spans + sink->count;
+    span->x = x;
+    span->len = len;
+    span->y = y;
+    span->coverage = (unsigned char)coverage;
+    sink->count += 1;
+}
+
+static void sparse_strip_sweep(sparse_strip_t* strip, sparse_span_sink_t* sink)
+{
+    for(int row = 0; row < strip->rows; row++) {
+        float* cells = strip->cells + row * strip->stride;
+        uint32_t* masks = strip->masks + row * strip->mask_stride;
+        const int y = strip->top + row;
+
+        float cover = 0.f;
+        int run = 0;
+        for(int word = 0; word < strip->mask_stride; word++) {
+            uint32_t bits = masks[word];
+            if(bits == 0)
+                continue;
+            masks[word] = 0;
+            do {
+                const int x = (word << 5) + sparse_ctz(bits);
+                bits &= bits - 1;
+                if(x > run)
+                    sparse_sink_emit(sink, run, x - run, y, cover);
+                cover += cells[x];
+                cells[x] = 0.f;
+                sparse_sink_emit(sink, x, 1, y, cover);
+                run = x + 1;
+            } while(bits);
+        }
+    }
+}
+
+void plutovg_sparse_raster_render(const PVG_FT_Raster_Params* params)
+{
+    const PVG_FT_Outline* outline = (const PVG_FT_Outline*)(params->source);
+    if(outline == NULL || outline->n_points == 0 || outline->n_contours <= 0)
+        return;
+    PVG_FT_BBox cbox;
+    PVG_FT_Outline_Get_CBox(outline, &cbox);
+
+    PVG_FT_Pos min_x = cbox.xMin >> 6;
+    PVG_FT_Pos min_y = cbox.yMin >> 6;
+    PVG_FT_Pos max_x = (cbox.xMax + 63) >> 6;
+    PVG_FT_Pos max_y = (cbox.yMax + 63) >> 6;
+    if(params->flags & PVG_FT_RASTER_FLAG_CLIP) {
+        min_x = plutovg_max(min_x, params->clip_box.xMin);
+        min_y = plutovg_max(min_y, params->clip_box.yMin);
+        max_x = plutovg_min(max_x, params->clip_box.xMax);
+        max_y = plutovg_min(max_y, params->clip_box.yMax);
+    }
+
+    if(min_x >= max_x || min_y >= max_y)
+        return;
+    if(max_x - min_x > SPARSE_MAX_WIDTH) {
+        PVG_FT_Raster_Render(params);
+        return;
+    }
+
+    sparse_raster_t raster;
+    plutovg_array_init(raster.lines);
+    raster.width = (float)(max_x - min_x);
+    raster.height = (float)(max_y - min_y);
+    raster.origin_x = (float)min_x;
+    raster.origin_y = (float)min_y;
+    raster.tolerance = params->tolerance > 0 ? params->tolerance / 64.f : 1.f / 16.f;
+    raster.x = 0.f;
+    raster.y = 0.f;
+
+    plutovg_array_ensure(raster.lines, outline->n_points * 2);
+    sparse_raster_decompose(&raster, outline);
+    if(raster.lines.size == 0) {
+        plutovg_array_destroy(raster.lines);
+        return;
+    }
+
+    sparse_raster_sort_lines(raster.lines.data, raster.lines.size);
+
+    const int width = (int)(max_x - min_x);
+    const int height = (int)(max_y - min_y);
+
+    float stack_cells[SPARSE_STACK_CELLS];
+    uint32_t stack_masks[SPARSE_STACK_CELLS / 32];
+
+    sparse_strip_t strip;
+    strip.stride = width + 2;
+    strip.mask_stride = (strip.stride + 31) >> 5;
+    const int strip_height = plutovg_min(SPARSE_STRIP_HEIGHT, height);
+    const size_t num_cells = (size_t)strip.stride * strip_height;
+    const size_t num_masks = (size_t)strip.mask_stride * strip_height;
+    if(num_cells <= SPARSE_STACK_CELLS && num_masks <= SPARSE_STACK_CELLS / 32) {
+        memset(stack_cells, 0, num_cells * sizeof(float));
+        memset(stack_masks, 0, num_masks * sizeof(uint32_t));
+        strip.cells = stack_cells;
+        strip.masks = stack_masks;
+    } else {
+        strip.cells = static_cast<float*>(calloc(num_cells, sizeof(float)));
+        strip.masks = static_cast<uint32_t*>(calloc(num_masks, sizeof(uint32_t)));
+    }
+
+    sparse_span_sink_t sink;
+    sink.count = 0;
+    sink.origin_x = (int)min_x;
+    sink.origin_y = (int)min_y;
+    sink.width = width;
+    sink.even_odd = outline->flags & PVG_FT_OUTLINE_EVEN_ODD_FILL;
+    sink.func = params->gray_spans;
+    sink.user = params->user;
+
+    int stack_active[SPARSE_STACK_LINES];
+    int* active = stack_active;
+    if(raster.lines.size > SPARSE_STACK_LINES)
+        active = static_cast<int*>(malloc(raster.lines.size * sizeof(int)));
+    int num_active = 0;
+    int next_line = 0;
+    for(strip.top = 0; strip.top < height; strip.top += strip_height) {
+        if(params->interrupt && params->interrupt(params->user))
+            break;
+        strip.rows = plutovg_min(strip_height, height - strip.top);
+        const float top = (float)strip.top;
+        const float bottom = top + strip.rows;
+
+        int count = 0;
+        for(int i = 0; i < num_active; i++) {
+            const sparse_line_t* line = raster.lines.data + active[i];
+            if(plutovg_max(line->y0, line->y1) > top) {
+                active[count++] = active[i];
+            }
+        }
+
+        num_active = count;
+        while(next_line < raster.lines.size) {
+            const sparse_line_t* line = raster.lines.data + next_line;
+            if(plutovg_min(line->y0, line->y1) >= bottom)
+                break;
+            active[num_active++] = next_line++;
+        }
+
+        for(int i = 0; i < num_active; i++)
+            sparse_strip_accumulate(&strip, raster.lines.data + active[i], raster.width);
+        sparse_strip_sweep(&strip, &sink);
+    }
+
+    sparse_sink_flush(&sink);
+
+    if(active != stack_active)
+        free(active);
+    if(strip.cells != stack_cells) {
+        free(strip.masks);
+        free(strip.cells);
+    }
+
+    plutovg_array_destroy(raster.lines);
+}
@@ -24,6 +24,7 @@
 #define PLUTOVG_H
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -302,54 +303,20 @@ typedef enum plutovg_path_command {
 } plutovg_path_command_t;
 
 /**
- * @brief Union representing a path element.
+ * @brief Iterator for traversing the commands of a path.
  *
- * A path element can be a command with a length or a coordinate point.
- * Each command type in the path element array is followed by a specific number of points:
+ * Paths store their commands and their points in two separate arrays. Each
+ * command consumes a fixed number of points from the point array:
  * - `PLUTOVG_PATH_COMMAND_MOVE_TO`: 1 point
  * - `PLUTOVG_PATH_COMMAND_LINE_TO`: 1 point
  * - `PLUTOVG_PATH_COMMAND_CUBIC_TO`: 3 points
  * - `PLUTOVG_PATH_COMMAND_CLOSE`: 1 point
- *
- * @example
- * const plutovg_path_element_t* elements;
- * int count = plutovg_path_get_elements(path, &elements);
- * for(int i = 0; i < count; i += elements[i].header.length) {
- *     plutovg_path_command_t command = elements[i].header.command;
- *     switch(command) {
- *     case PLUTOVG_PATH_COMMAND_MOVE_TO:
- *         printf("MoveTo: %g %g\n", elements[i + 1].point.x, elements[i + 1].point.y);
- *         break;
- *     case PLUTOVG_PATH_COMMAND_LINE_TO:
- *         printf("LineTo: %g %g\n", elements[i + 1].point.x, elements[i + 1].point.y);
- *         break;
- *     case PLUTOVG_PATH_COMMAND_CUBIC_TO:
- *         printf("CubicTo: %g %g %g %g %g %g\n",
- *                elements[i + 1].point.x, elements[i + 1].point.y,
- *                elements[i + 2].point.x, elements[i + 2].point.y,
- *                elements[i + 3].point.x, elements[i + 3].point.y);
- *         break;
- *     case PLUTOVG_PATH_COMMAND_CLOSE:
- *         printf("Close: %g %g\n", elements[i + 1].point.x, elements[i + 1].point.y);
- *         break;
- *     }
- * }
- */
-typedef union plutovg_path_element {
-    struct {
-        plutovg_path_command_t command; ///< The path command.
-        int length; ///< Number of elements including the header.
-    } header; ///< Header for path commands.
-    plutovg_point_t point; ///< A coordinate point in the path.
-} plutovg_path_element_t;
-
-/**
- * @brief Iterator for traversing path elements in a path.
  */
 typedef struct plutovg_path_iterator {
-    const plutovg_path_element_t* elements; ///< Pointer to the array of path elements.
-    int size; ///< Total number of elements in the array.
-    int index; ///< Current position in the array.
+    const uint8_t* commands; ///< Pointer to the array of path commands.
+    const plutovg_point_t* points; ///< Pointer to the points of the current command.
+    int size; ///< Total number of commands in the array.
+    int index; ///< Current position in the command array.
 } plutovg_path_iterator_t;
 
 /**
@@ -361,10 +328,10 @@ typedef struct plutovg_path_iterator {
 PLUTOVG_API void plutovg_path_iterator_init(plutovg_path_iterator_t* it, const plutovg_path_t* path);
 
 /**
- * @brief Checks if there are more elements to iterate over.
+ * @brief Checks if there are more commands to iterate over.
  *
  * @param it The path iterator.
- * @return `true` if there are more elements; otherwise, `false`.
+ * @return `true` if there are more commands; otherwise, `false`.
  */
 PLUTOVG_API bool plutovg_path_iterator_has_next(const plutovg_path_iterator_t* it);
 
@@ -373,7 +340,7 @@ PLUTOVG_API bool plutovg_path_iterator_has_next(const plutovg_path_iterator_t* i
  *
  * @param it The path iterator.
  * @param points An array to store the points for the current command.
- * @return The path command for the current element.
+ * @return The path command for the current command.
  */
 PLUTOVG_API plutovg_path_command_t plutovg_path_iterator_next(plutovg_path_iterator_t* it, plutovg_point_t points[3]);
 
@@ -412,15 +379,55 @@ PLUTOVG_API void plutovg_path_destroy(plutovg_path_t* path);
 PLUTOVG_API int plutovg_path_get_reference_count(const plutovg_path_t* path);
 
 /**
- * @brief Retrieves the elements of a path.
+ * @brief Retrieves the commands of a path.
  *
- * Provides access to the array of path elements.
+ * Each entry is a `plutovg_path_command_t` stored in a single byte. The points
+ * the commands consume are stored in order in the array returned by
+ * `plutovg_path_get_points()`.
+ *
+ * @example
+ * const uint8_t* commands;
+ * const plutovg_point_t* points;
+ * int count = plutovg_path_get_commands(path, &commands);
+ * plutovg_path_get_points(path, &points);
+ * for(int i = 0; i < count; i++) {
+ *     switch(commands[i]) {
+ *     case PLUTOVG_PATH_COMMAND_MOVE_TO:
+ *         printf("MoveTo: %g %g\n", points[0].x, points[0].y);
+ *         points += 1;
+ *         break;
+ *     case PLUTOVG_PATH_COMMAND_LINE_TO:
+ *         printf("LineTo: %g %g\n", points[0].x, points[0].y);
+ *         points += 1;
+ *         break;
+ *     case PLUTOVG_PATH_COMMAND_CUBIC_TO:
+ *         printf("CubicTo: %g %g %g %g %g %g\n",
+ *                points[0].x, points[0].y,
+ *                points[1].x, points[1].y,
+ *                points[2].x, points[2].y);
+ *         points += 3;
+ *         break;
+ *     case PLUTOVG_PATH_COMMAND_CLOSE:
+ *         printf("Close: %g %g\n", points[0].x, points[0].y);
+ *         points += 1;
+ *         break;
+ *     }
+ * }
  *
  * @param path A pointer to a `plutovg_path_t` object.
- * @param elements A pointer to a pointer that will be set to the array of path elements.
- * @return The number of elements in the path.
+ * @param commands A pointer that will be set to the array of path commands.
+ * @return The number of commands in the path.
  */
-PLUTOVG_API int plutovg_path_get_elements(const plutovg_path_t* path, const plutovg_path_element_t** elements);
+PLUTOVG_API int plutovg_path_get_commands(const plutovg_path_t* path, const uint8_t** commands);
+
+/**
+ * @brief Retrieves the points of a path.
+ *
+ * @param path A pointer to a `plutovg_path_t` object.
+ * @param points A pointer that will be set to the array of path points.
+ * @return The number of points in the path.
+ */
+PLUTOVG_API int plutovg_path_get_points(const plutovg_path_t* path, const plutovg_point_t** points);
 
 /**
  * @brief Moves the current point to a new position.
@@ -521,13 +528,13 @@ PLUTOVG_API void plutovg_path_close(plutovg_path_t* path);
 PLUTOVG_API void plutovg_path_get_current_point(const plutovg_path_t* path, float* x, float* y);
 
 /**
- * @brief Reserves space for path elements.
+ * @brief Reserves space for path points.
  *
- * Reserves space for a specified number of elements in the path. This helps optimize
- * memory allocation for future path operations.
+ * Reserves space for a specified number of points, and as many commands, in the
+ * path. This helps optimize memory allocation for future path operations.
  *
  * @param path A pointer to a `plutovg_path_t` object.
- * @param count The number of path elements to reserve space for.
+ * @param count The number of path points to reserve space for.
  */
 PLUTOVG_API void plutovg_path_reserve(plutovg_path_t* path, int count);
 
@@ -622,6 +629,23 @@ PLUTOVG_API void plutovg_path_add_arc(plutovg_path_t* path, float cx, float cy,
  */
 PLUTOVG_API void plutovg_path_add_path(plutovg_path_t* path, const plutovg_path_t* source, const plutovg_matrix_t* matrix);
 
+/**
+ * @brief Appends raw command and point arrays to the path.
+ *
+ * The arrays use the layout returned by `plutovg_path_get_commands()` and
+ * `plutovg_path_get_points()`, so a path can be stored and restored without
+ * re-running its construction. Nothing is appended if a command is unknown or
+ * the number of points does not match the commands.
+ *
+ * @param path A pointer to a `plutovg_path_t` object.
+ * @param commands The path commands, one byte each.
+ * @param ncommands The number of commands.
+ * @param points The points consumed by the commands, in order.
+ * @param npoints The number of points.
+ * @return `true` if the data was appended, `false` if it was malformed.
+ */
+PLUTOVG_API bool plutovg_path_add_data(plutovg_path_t* path, const uint8_t* commands, int ncommands, const plutovg_point_t* points, int npoints);
+
 /**
  * @brief Applies a transformation matrix to the path.
  *
@@ -1486,6 +1510,24 @@ typedef enum {
     PLUTOVG_LINE_JOIN_BEVEL ///< Beveled join with a flattened corner.
 } plutovg_line_join_t;
 
+/**
+ * @brief Defines the scan converters available for turning outlines into coverage spans.
+ */
+typedef enum {
+    PLUTOVG_RASTERIZER_GRAY, ///< Cell-based gray raster derived from FreeType; well suited to glyphs and small paths.
+    PLUTOVG_RASTERIZER_SPARSE ///< Sparse-scanline analytic-coverage raster; well suited to large, simple shapes.
+} plutovg_rasterizer_t;
+
+/**
+ * @brief The default maximum distance, in device pixels, between a curve and its flattened approximation.
+ */
+#define PLUTOVG_DEFAULT_CURVE_TOLERANCE 0.1f
+
+/**
+ * @brief A coarse curve tolerance, in device pixels, trading accuracy for speed in previews.
+ */
+#define PLUTOVG_DRAFT_CURVE_TOLERANCE 1.f
+
 /**
  * @brief Represents a drawing context.
  */
@@ -1793,6 +1835,163 @@ PLUTOVG_API void plutovg_canvas_set_operator(plutovg_canvas_t* canvas, plutovg_o
  */
 PLUTOVG_API plutovg_operator_t plutovg_canvas_get_operator(const plutovg_canvas_t* canvas);
 
+/**
+ * @brief Selects the scan converter used by fill, stroke and clip operations.
+ *
+ * The rasterizer is a property of the canvas and is not affected by save/restore.
+ * If not set, the default rasterizer is `PLUTOVG_RASTERIZER_GRAY`.
+ *
+ * @param canvas A pointer to a `plutovg_canvas_t` object.
+ * @param rasterizer The rasterizer to use.
+ */
+PLUTOVG_API void plutovg_canvas_set_rasterizer(plutovg_canvas_t* canvas, plutovg_rasterizer_t rasterizer);
+
+/**
+ * @brief Retrieves the scan converter used by fill, stroke and clip operations.
+ *
+ * If not set, the default rasterizer is `PLUTOVG_RASTERIZER_GRAY`.
+ *
+ * @param canvas A pointer to a `plutovg_canvas_t` object.
+ * @return The current rasterizer.
+ */
+PLUTOVG_API plutovg_rasterizer_t plutovg_canvas_get_rasterizer(const plutovg_canvas_t* canvas);
+
+/**
+ * @brief Sets the maximum distance, in device pixels, between a curve and the line segments approximating it.
+ *
+ * Curves are subdivided according to their size after the current transformation, so
+ * the same tolerance yields few segments for thumbnails and enough segments for large
+ * zooms. Larger values render faster at the expense of accuracy; use
+ * `PLUTOVG_DRAFT_CURVE_TOLERANCE` for previews. The tolerance is a property of the canvas
+ * and is not affected by save/restore.
+ * If not set, the default tolerance is `PLUTOVG_DEFAULT_CURVE_TOLERANCE`.
+ *
+ * @param canvas A pointer to a `plutovg_canvas_t` object.
+ * @param tolerance The curve tolerance, in device pixels.
+ */
+PLUTOVG_API void plutovg_canvas_set_curve_tolerance(plutovg_canvas_t* canvas, float tolerance);
+
+/**
+ * @brief Retrieves the maximum distance, in device pixels, between a curve and its flattened approximation.
+ *
+ * @param canvas A pointer to a `plutovg_canvas_t` object.
+ * @return The current curve tolerance.
+ */
+PLUTOVG_API float plutovg_canvas_get_curve_tolerance(const plutovg_canvas_t* canvas);
+
+/**
+ * @brief Enables or disables anti-aliasing of fill, stroke and clip edges.
+ *
+ * When disabled, each pixel is either fully covered or untouched, depending on whether
+ * at least half of it lies inside the shape. The setting is a property of the canvas
+ * and is not affected by save/restore.
+ * If not set, anti-aliasing is enabled.
+ *
+ * @param canvas A pointer to a `plutovg_canvas_t` object.
+ * @param antialias `true` to enable anti-aliasing, `false` to disable it.
+ */
+PLUTOVG_API void plutovg_canvas_set_antialias(plutovg_canvas_t* canvas, bool antialias);
+
+/**
+ * @brief Checks whether anti-aliasing of edges is enabled.
+ *
+ * @param canvas A pointer to a `plutovg_canvas_t` object.
+ * @return `true` if anti-aliasing is enabled, `false` otherwise.
+ */
+PLUTOVG_API bool plutovg_canvas_get_antialias(const plutovg_canvas_t* canvas);
+
+/**
+ * @brief Enables or disables bilinear filtering of transformed texture paints.
+ *
+ * When disabled, textures are always sampled from the nearest pixel. The setting is a
+ * property of the canvas and is not affected by save/restore.
+ * If not set, image smoothing is enabled.
+ *
+ * @param canvas A pointer to a `plutovg_canvas_t` object.
+ * @param smoothing `true` to enable bilinear filtering, `false` to use nearest sampling.
+ */
+PLUTOVG_API void plutovg_canvas_set_image_smoothing(plutovg_canvas_t* canvas, bool smoothing);
+
+/**
+ * @brief Checks whether bilinear filtering of transformed texture paints is enabled.
+ *
+ * @param canvas A pointer to a `plutovg_canvas_t` object.
+ * @return `true` if image smoothing is enabled, `false` otherwise.
+ */
+PLUTOVG_API bool plutovg_canvas_get_image_smoothing(const plutovg_canvas_t* canvas);
+
+/**
+ * @brief Sets the number of entries in the color lookup table built for gradient paints.
+ *
+ * Smaller tables are cheaper to build for every gradient fill, at the cost of visible
+ * banding on long gradients. The size is clamped to the range [2, 1024] and is a
+ * property of the canvas, unaffected by save/restore.
+ * If not set, the table size is 1024.
+ *
+ * @param canvas A pointer to a `plutovg_canvas_t` object.
+ * @param size The number of color table entries.
+ */
+PLUTOVG_API void plutovg_canvas_set_gradient_table_size(plutovg_canvas_t* canvas, int size);
+
+/**
+ * @brief Retrieves the number of entries in the color lookup table built for gradient paints.
+ *
+ * @param canvas A pointer to a `plutovg_canvas_t` object.
+ * @return The gradient color table size.
+ */
+PLUTOVG_API int plutovg_canvas_get_gradient_table_size(const plutovg_canvas_t* canvas);
+
+/**
+ * @brief Counters accumulated by the compositor of a canvas.
+ */
+typedef struct plutovg_canvas_stats {
+    unsigned long long spans; ///< Coverage spans composited.
+    unsigned long long pixels[PLUTOVG_OPERATOR_XOR + 1]; ///< Pixels composited, indexed by the operator actually applied.
+} plutovg_canvas_stats_t;
+
+/**
+ * @brief Makes the canvas add its compositing work to the given counters.
+ *
+ * Counting costs one pass over the spans of each composite, so leave it off unless the
+ * numbers are wanted. The counters are a property of the canvas and are not affected by
+ * save/restore. If not set, nothing is counted.
+ *
+ * @param canvas A pointer to a `plutovg_canvas_t` object.
+ * @param stats The counters to add to, or `NULL` to stop counting. They must outlive their use by the canvas.
+ */
+PLUTOVG_API void plutovg_canvas_set_stats(plutovg_canvas_t* canvas, plutovg_canvas_stats_t* stats);
+
+/**
+ * @brief Retrieves the counters the canvas adds its compositing work to.
+ *
+ * @param canvas A pointer to a `plutovg_canvas_t` object.
+ * @return The counters, or `NULL` if nothing is counted.
+ */
+PLUTOVG_API plutovg_canvas_stats_t* plutovg_canvas_get_stats(const plutovg_canvas_t* canvas);
+
+/**
+ * @brief Callback type polled by a canvas to find out whether to abandon its drawing.
+ *
+ * @param closure A pointer to user-defined data.
+ * @return `true` to abandon the remaining work, `false` to continue.
+ */
+typedef bool (*plutovg_interrupt_func_t)(void* closure);
+
+/**
+ * @brief Lets long drawing operations on the canvas be interrupted.
+ *
+ * The callback is polled between bands of scanlines while rasterizing, every few thousand
+ * dashes while stroking and every few hundred spans while compositing. Once it returns
+ * `true` the operation in progress stops early, leaving a partial result on the surface,
+ * and later operations return as soon as they poll it. The callback should be cheap and,
+ * once it has returned `true`, keep doing so. If not set, drawing is never interrupted.
+ *
+ * @param canvas A pointer to a `plutovg_canvas_t` object.
+ * @param func The callback, or `NULL` to stop polling.
+ * @param closure The user data passed to `func`.
+ */
+PLUTOVG_API void plutovg_canvas_set_interrupt(plutovg_canvas_t* canvas, plutovg_interrupt_func_t func, void* closure);
+
 /**
  * @brief Sets the global opacity.
  *
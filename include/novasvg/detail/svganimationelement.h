@@ -0,0 +1,121 @@
+#ifndef NOVASVG_SVGANIMATIONELEMENT_H
+#define NOVASVG_SVGANIMATIONELEMENT_H
+
+#include "svgelement.h"
+
+#include <array>
+#include <vector>
+
+namespace novasvg {
+
+// An attribute value split into the numbers it contains and the text between them; two values
+// with the same text interpolate number by number, anything else only animates discretely.
+class SVGAnimationValue {
+public:
+    SVGAnimationValue() = default;
+    SVGAnimationValue(std::string_view input, bool isColor);
+
+    bool isNumeric() const { return m_numeric; }
+    bool isCompatible(const SVGAnimationValue& other) const;
+    const std::vector<float>& numbers() const { return m_numbers; }
+
+    float distance(const SVGAnimationValue& other) const;
+    SVGAnimationValue interpolated(const SVGAnimationValue& to, float t) const;
+    SVGAnimationValue added(const SVGAnimationValue& other, float times) const;
+
+    std::string toString() const;
+
+private:
+    bool m_numeric = false;
+    bool m_color = false;
+    std::string m_text;
+    std::vector<std::string> m_separators;
+    std::vector<float> m_numbers;
+};
+
+class SVGAnimationElement : public SVGElement, public SVGURIReference {
+public:
+    SVGAnimationElement(Document* document, ElementID id);
+
+    bool isAnimationElement() const final { return true; }
+
+    SVGElement* targetElement() const { return m_targetElement; }
+    PropertyID targetProperty() const { return m_targetProperty; }
+
+    float endTime() const;
+    bool apply(float time, std::string& value) const;
+
+    void build() override;
+
+protected:
+    virtual std::string valueString(std::string_view input) const { return std::string(input); }
+    virtual bool isTransformAnimation() const { return false; }
+
+private:
+    enum class Mode : uint8_t {
+        Values,
+        FromTo,
+        FromBy,
+        To,
+        By
+    };
+
+    bool resolveValues();
+    float keyTimeProgress(float progress, size_t count, bool isDiscrete, size_t& index) const;
+
+    SVGString m_attributeName;
+    SVGString m_begin;
+    SVGString m_end;
+    SVGString m_dur;
+    SVGString m_repeatCount;
+    SVGString m_repeatDur;
+    SVGString m_from;
+    SVGString m_to;
+    SVGString m_by;
+    SVGString m_values;
+    SVGString m_keyTimes;
+    SVGString m_keySplines;
+    SVGEnumeration<CalcMode> m_calcMode;
+    SVGEnumeration<AnimationAdditive> m_additive;
+    SVGEnumeration<AnimationAccumulate> m_accumulate;
+
+    SVGElement* m_targetElement = nullptr;
+    PropertyID m_targetProperty = PropertyID::Unknown;
+    Mode m_mode = Mode::Values;
+    bool m_freeze = false;
+    std::vector<float> m_beginTimes;
+    std::vector<float> m_endTimes;
+    float m_simpleDuration = 0.f;
+    float m_activeDuration = 0.f;
+    std::vector<SVGAnimationValue> m_animationValues;
+    std::vector<float> m_keyTimeValues;
+    std::vector<std::array<float, 4>> m_keySplineValues;
+};
+
+class SVGAnimateElement final : public SVGAnimationElement {
+public:
+    SVGAnimateElement(Document* document);
+};
+
+class SVGSetElement final : public SVGAnimationElement {
+public:
+    SVGSetElement(Document* document);
+};
+
+class SVGAnimateTransformElement final : public SVGAnimationElement {
+public:
+    SVGAnimateTransformElement(Document* document);
+
+    const SVGEnumeration<TransformType>& type() const { return m_type; }
+
+protected:
+    std::string valueString(std::string_view input) const final;
+    bool isTransformAnimation() const final { return true; }
+
+private:
+    SVGEnumeration<TransformType> m_type;
+};
+
+} // namespace novasvg
+
+#endif // NOVASVG_SVGANIMATIONELEMENT_H
@@ -0,0 +1,645 @@
+#include "svganimationelement.h"
+#include "svgparserutils.h"
+
+#include <cmath>
+#include <cstdio>
+
+namespace novasvg {
+
+static bool isColorProperty(PropertyID id)
+{
+    switch(id) {
+    case PropertyID::Color:
+    case PropertyID::Fill:
+    case PropertyID::Flood_Color:
+    case PropertyID::Stop_Color:
+    case PropertyID::Stroke:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static void appendAnimationNumber(std::string& output, float number)
+{
+    char buffer[32];
+    auto length = std::snprintf(buffer, sizeof(buffer), "%g", number);
+    output.append(buffer, length);
+}
+
+SVGAnimationValue::SVGAnimationValue(std::string_view input, bool isColor)
+{
+    stripLeadingAndTrailingSpaces(input);
+    m_text.assign(input);
+    if(isColor) {
+        plutovg_color_t color;
+        auto length = plutovg_color_parse(&color, input.data(), input.length());
+        if(length == 0 || length != static_cast<int>(input.length()))
+            return;
+        m_numbers = { color.r, color.g, color.b, color.a };
+        m_numeric = true;
+        m_color = true;
+        return;
+    }
+
+    if(input.find("url(") != std::string_view::npos)
+        return;
+    std::string separator;
+    while(!input.empty()) {
+        auto cc = input.front();
+        auto startsNumber = IS_NUM(cc);
+        if(!startsNumber && (cc == '-' || cc == '+' || cc == '.') && input.length() > 1) {
+            startsNumber = IS_NUM(input[1]) || (cc != '.' && input[1] == '.' && input.length() > 2 && IS_NUM(input[2]));
+        }
+
+        // Digits glued to a name (e.g. "h1" or "#f00") belong to the text, not to a number.
+        if(startsNumber && (separator.empty() || !(IS_ALPHA(separator.back()) || separator.back() == '#'))) {
+            float number;
+            if(parseNumber(input, number)) {
+                m_separators.push_back(std::move(separator));
+                m_numbers.push_back(number);
+                separator.clear();
+                continue;
+            }
+        }
+
+        if(IS_WS(cc) || cc == ',') {
+            if(separator.empty() || separator.back() != ' ')
+                separator += ' ';
+        } else {
+            separator += cc;
+        }
+
+        input.remove_prefix(1);
+    }
+
+    m_separators.push_back(std::move(separator));
+    m_numeric = !m_numbers.empty();
+}
+
+bool SVGAnimationValue::isCompatible(const SVGAnimationValue& other) const
+{
+    if(!m_numeric || !other.m_numeric || m_color != other.m_color)
+        return false;
+    return m_color || m_separators == other.m_separators;
+}
+
+float SVGAnimationValue::distance(const SVGAnimationValue& other) const
+{
+    float sum = 0.f;
+    for(size_t i = 0; i < m_numbers.size(); ++i) {
+        auto delta = other.m_numbers[i] - m_numbers[i];
+        sum += delta * delta;
+    }
+
+    return std::sqrt(sum);
+}
+
+SVGAnimationValue SVGAnimationValue::interpolated(const SVGAnimationValue& to, float t) const
+{
+    SVGAnimationValue value(*this);
+    for(size_t i = 0; i < m_numbers.size(); ++i)
+        value.m_numbers[i] = m_numbers[i] + (to.m_numbers[i] - m_numbers[i]) * t;
+    return value;
+}
+
+SVGAnimationValue SVGAnimationValue::added(const SVGAnimationValue& other, float times) const
+{
+    SVGAnimationValue value(*this);
+    for(size_t i = 0; i < m_numbers.size(); ++i)
+        value.m_numbers[i] = m_numbers[i] + other.m_numbers[i] * times;
+    return value;
+}
+
+std::string SVGAnimationValue::toString() const
+{
+    if(!m_numeric)
+        return m_text;
+    std::string output;
+    if(m_color) {
+        char buffer[16];
+        unsigned int channels[4];
+        for(int i = 0; i < 4; ++i)
+            channels[i] = static_cast<unsigned int>(std::lround(std::clamp(m_numbers[i], 0.f, 1.f) * 255.f));
+        std::snprintf(buffer, sizeof(buffer), "#%02x%02x%02x%02x", channels[0], channels[1], channels[2], channels[3]);
+        output.assign(buffer);
+        return output;
+    }
+
+    for(size_t i = 0; i < m_numbers.size(); ++i) {
+        output += m_separators[i];
+        appendAnimationNumber(output, m_numbers[i]);
+    }
+
+    output += m_separators.back();
+    return output;
+}
+
+static bool parseClockValue(std::string_view input, float& value)
+{
+    stripLeadingAndTrailingSpaces(input);
+    if(input.find(':') != std::string_view::npos) {
+        // Full ("02:30:03") and partial ("00:10.5") clock values.
+        float parts[3];
+        int count = 0;
+        while(true) {
+            if(count == 3 || !parseNumber(input, parts[count]) || parts[count] < 0.f)
+                return false;
+            ++count;
+            if(input.empty())
+                break;
+            if(!skipDelimiter(input, ':')) {
+                return false;
+            }
+        }
+
+        if(count == 2) {
+            value = parts[0] * 60.f + parts[1];
+        } else if(count == 3) {
+            value = parts[0] * 3600.f + parts[1] * 60.f + parts[2];
+        } else {
+            return false;
+        }
+
+        return true;
+    }
+
+    float number;
+    if(!parseNumber(input, number))
+        return false;
+    if(input.empty() || input == "s") {
+        value = number;
+    } else if(input == "ms") {
+        value = number / 1000.f;
+    } else if(input == "min") {
+        value = number * 60.f;
+    } else if(input == "h") {
+        value = number * 3600.f;
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+static float parseDurationValue(std::string_view input)
+{
+    float value;
+    if(!parseClockValue(input, value) || value <= 0.f)
+        return INFINITY;
+    return value;
+}
+
+template<typename T>
+static void splitAnimationList(std::string_view input, T callback)
+{
+    while(!input.empty()) {
+        auto end = input.find(';');
+        auto item = input.substr(0, end);
+        stripLeadingAndTrailingSpaces(item);
+        if(!item.empty())
+            callback(item);
+        if(end == std::string_view::npos)
+            break;
+        input.remove_prefix(end + 1);
+    }
+}
+
+static std::vector<float> parseTimeList(std::string_view input)
+{
+    // Only offset values resolve without a user agent clock; event, syncbase,
+    // repeat, accessKey and wallclock times never start an interval here.
+    std::vector<float> times;
+    splitAnimationList(input, [&times](std::string_view item) {
+        float value;
+        if(parseClockValue(item, value)) {
+            times.push_back(value);
+        }
+    });
+
+    return times;
+}
+
+static float solveKeySpline(const std::array<float, 4>& spline, float x)
+{
+    auto bezier = [](float p1, float p2, float t) {
+        auto u = 1.f - t;
+        return 3.f * u * u * t * p1 + 3.f * u * t * t * p2 + t * t * t;
+    };
+
+    float low = 0.f;
+    float high = 1.f;
+    for(int i = 0; i < 24; ++i) {
+        auto t = (low + high) * 0.5f;
+        if(bezier(spline[0], spline[2], t) < x) {
+            low = t;
+        } else {
+            high = t;
+        }
+    }
+
+    return bezier(spline[1], spline[3], (low + high) * 0.5f);
+}
+
+SVGAnimationElement::SVGAnimationElement(Document* document, ElementID id)
+    : SVGElement(document, id)
+    , SVGURIReference(this)
+    , m_attributeName(PropertyID::AttributeName)
+    , m_begin(PropertyID::Begin)
+    , m_end(PropertyID::End)
+    , m_dur(PropertyID::Dur)
+    , m_repeatCount(PropertyID::RepeatCount)
+    , m_repeatDur(PropertyID::RepeatDur)
+    , m_from(PropertyID::From)
+    , m_to(PropertyID::To)
+    , m_by(PropertyID::By)
+    , m_values(PropertyID::Values)
+    , m_keyTimes(PropertyID::KeyTimes)
+    , m_keySplines(PropertyID::KeySplines)
+    , m_calcMode(PropertyID::CalcMode, CalcMode::Linear)
+    , m_additive(PropertyID::Additive, AnimationAdditive::Replace)
+    , m_accumulate(PropertyID::Accumulate, AnimationAccumulate::None)
+{
+    addProperty(m_attributeName);
+    addProperty(m_begin);
+    addProperty(m_end);
+    addProperty(m_dur);
+    addProperty(m_repeatCount);
+    addProperty(m_repeatDur);
+    addProperty(m_from);
+    addProperty(m_to);
+    addProperty(m_by);
+    addProperty(m_values);
+    addProperty(m_keyTimes);
+    addProperty(m_keySplines);
+    addProperty(m_calcMode);
+    addProperty(m_additive);
+    addProperty(m_accumulate);
+}
+
+float SVGAnimationElement::endTime() const
+{
+    if(m_targetElement == nullptr || m_beginTimes.empty())
+        return 0.f;
+    auto begin = *std::max_element(m_beginTimes.begin(), m_beginTimes.end());
+    auto duration = m_activeDuration;
+    for(auto end : m_endTimes) {
+        if(end >= begin) {
+            duration = std::min(duration, end - begin);
+        }
+    }
+
+    // An animation that repeats forever contributes a single iteration.
+    if(!std::isfinite(duration))
+        duration = std::isfinite(m_simpleDuration) ? m_simpleDuration : 0.f;
+    return std::max(0.f, begin + duration);
+}
+
+bool SVGAnimationElement::apply(float time, std::string& value) const
+{
+    if(m_targetElement == nullptr)
+        return false;
+    bool hasBegin = false;
+    float begin = 0.f;
+    for(auto beginTime : m_beginTimes) {
+        if(beginTime <= time && (!hasBegin || beginTime > begin)) {
+            begin = beginTime;
+            hasBegin = true;
+        }
+    }
+
+    if(!hasBegin)
+        return false;
+    auto activeDuration = m_activeDuration;
+    for(auto end : m_endTimes) {
+        if(end >= begin) {
+            activeDuration = std::min(activeDuration, end - begin);
+        }
+    }
+
+    auto elapsed = time - begin;
+    bool ended = false;
+    if(elapsed >= activeDuration) {
+        if(!m_freeze)
+            return false;
+        elapsed = activeDuration;
+        ended = true;
+    }
+
+    float progress = 0.f;
+    float iteration = 0.f;
+    if(std::isfinite(m_simpleDuration)) {
+        iteration = std::floor(elapsed / m_simpleDuration);
+        progress = elapsed / m_simpleDuration - iteration;
+        if(ended && progress == 0.f && iteration > 0.f) {
+            iteration -= 1.f;
+            progress = 1.f;
+        }
+    }
+
+    const bool isColor = isColorProperty(m_targetProperty);
+    SVGAnimationValue underlyingValue(value, isColor);
+    SVGAnimationValue zeroValue;
+    const SVGAnimationValue* fromValue = nullptr;
+    if(m_mode == Mode::To) {
+        fromValue = &underlyingValue;
+    } else if(m_mode == Mode::By) {
+        zeroValue = m_animationValues.front().added(m_animationValues.front(), -1.f);
+        fromValue = &zeroValue;
+    }
+
+    auto valueAt = [&](size_t index) -> const SVGAnimationValue& {
+        if(fromValue == nullptr)
+            return m_animationValues[index];
+        return index == 0 ? *fromValue : m_animationValues.front();
+    };
+
+    const auto count = fromValue ? 2 : m_animationValues.size();
+
+    // Values that can't be interpolated fall back to discrete animation.
+    bool isDiscrete = m_calcMode.value() == CalcMode::Discrete;
+    for(size_t i = 1; !isDiscrete && i < count; ++i) {
+        isDiscrete = !valueAt(i - 1).isCompatible(valueAt(i));
+    }
+
+    size_t index = 0;
+    auto fraction = keyTimeProgress(progress, count, isDiscrete, index);
+    SVGAnimationValue result;
+    if(!isDiscrete && index + 1 < count) {
+        result = valueAt(index).interpolated(valueAt(index + 1), fraction);
+    } else {
+        result = valueAt(index);
+    }
+
+    const auto& lastValue = valueAt(count - 1);
+    if(m_accumulate.value() == AnimationAccumulate::Sum && iteration > 0.f
+        && m_mode != Mode::To && result.isCompatible(lastValue)) {
+        result = result.added(lastValue, iteration);
+    }
+
+    const auto isAdditive = m_mode == Mode::By || (m_mode != Mode::To && id() != ElementID::Set
+        && m_additive.value() == AnimationAdditive::Sum);
+    if(isAdditive && isTransformAnimation()) {
+        if(!value.empty())
+            value += ' ';
+        value += result.toString();
+    } else if(isAdditive && underlyingValue.isCompatible(result)) {
+        value = underlyingValue.added(result, 1.f).toString();
+    } else {
+        value = result.toString();
+    }
+
+    return true;
+}
+
+float SVGAnimationElement::keyTimeProgress(float progress, size_t count, bool isDiscrete, size_t& index) const
+{
+    index = 0;
+    if(count < 2)
+        return 0.f;
+    if(isDiscrete) {
+        if(m_keyTimeValues.size() == count) {
+            while(index + 1 < count && m_keyTimeValues[index + 1] <= progress) {
+                ++index;
+            }
+        } else {
+            index = std::min(count - 1, static_cast<size_t>(progress * count));
+        }
+
+        return 0.f;
+    }
+
+    if(m_keyTimeValues.size() != count) {
+        auto position = progress * (count - 1);
+        index = std::min(count - 2, static_cast<size_t>(position));
+        return std::min(1.f, position - index);
+    }
+
+    while(index + 2 < count && m_keyTimeValues[index + 1] <= progress)
+        ++index;
+    auto span = m_keyTimeValues[index + 1] - m_keyTimeValues[index];
+    auto fraction = span > 0.f ? (progress - m_keyTimeValues[index]) / span : 1.f;
+    fraction = std::clamp(fraction, 0.f, 1.f);
+    if(m_calcMode.value() == CalcMode::Spline && index < m_keySplineValues.size())
+        fraction = solveKeySpline(m_keySplineValues[index], fraction);
+    return fraction;
+}
+
+bool SVGAnimationElement::resolveValues()
+{
+    const bool isColor = isColorProperty(m_targetProperty);
+    auto addValue = [&](std::string_view input) {
+        m_animationValues.emplace_back(valueString(input), isColor);
+    };
+
+    m_animationValues.clear();
+    if(id() == ElementID::Set) {
+        if(m_to.value().empty())
+            return false;
+        addValue(m_to.value());
+        m_mode = Mode::Values;
+        return true;
+    }
+
+    if(!m_values.value().empty()) {
+        splitAnimationList(m_values.value(), addValue);
+        m_mode = Mode::Values;
+    } else if(!m_from.value().empty() && !m_to.value().empty()) {
+        addValue(m_from.value());
+        addValue(m_to.value());
+        m_mode = Mode::FromTo;
+    } else if(!m_from.value().empty() && !m_by.value().empty()) {
+        addValue(m_from.value());
+        addValue(m_by.value());
+        if(!m_animationValues[0].isCompatible(m_animationValues[1]))
+            return false;
+        m_animationValues[1] = m_animationValues[0].added(m_animationValues[1], 1.f);
+        m_mode = Mode::FromBy;
+    } else if(!m_to.value().empty()) {
+        addValue(m_to.value());
+        m_mode = Mode::To;
+    } else if(!m_by.value().empty()) {
+        addValue(m_by.value());
+        if(!m_animationValues[0].isNumeric())
+            return false;
+        m_mode = Mode::By;
+    }
+
+    return !m_animationValues.empty();
+}
+
+void SVGAnimationElement::build()
+{
+    SVGElement::build();
+    m_targetElement = nullptr;
+    if(!href().value().empty()) {
+        m_targetElement = getTargetElement();
+    } else {
+        m_targetElement = parentElement();
+    }
+
+    m_targetProperty = propertyid(m_attributeName.value());
+    if(m_attributeName.value().empty() && isTransformAnimation())
+        m_targetProperty = PropertyID::Transform;
+    if(m_targetElement == nullptr || m_targetProperty == PropertyID::Unknown
+        || (m_targetElement->getProperty(m_targetProperty) == nullptr && csspropertyid(m_attributeName.value()) == PropertyID::Unknown)
+        || !resolveValues()) {
+        m_targetElement = nullptr;
+        return;
+    }
+
+    m_beginTimes = hasAttribute(PropertyID::Begin) ? parseTimeList(m_begin.value()) : std::vector<float>{0.f};
+    m_endTimes = parseTimeList(m_end.value());
+    m_simpleDuration = parseDurationValue(m_dur.value());
+    m_freeze = getAttribute(PropertyID::Fill) == "freeze";
+
+    float repeatCount = INFINITY;
+    const auto& repeatCountValue = m_repeatCount.value();
+    const auto hasRepeatCount = !repeatCountValue.empty();
+    if(hasRepeatCount && repeatCountValue != "indefinite") {
+        std::string_view input(repeatCountValue);
+        if(!parseNumber(input, repeatCount) || !input.empty() || repeatCount <= 0.f) {
+            repeatCount = 1.f;
+        }
+    }
+
+    float repeatDuration = INFINITY;
+    const auto& repeatDurValue = m_repeatDur.value();
+    const auto hasRepeatDur = !repeatDurValue.empty();
+    if(hasRepeatDur && repeatDurValue != "indefinite")
+        repeatDuration = parseDurationValue(repeatDurValue);
+    if(!hasRepeatCount && !hasRepeatDur) {
+        m_activeDuration = m_simpleDuration;
+    } else {
+        m_activeDuration = INFINITY;
+        if(hasRepeatCount)
+            m_activeDuration = repeatCount * m_simpleDuration;
+        if(hasRepeatDur) {
+            m_activeDuration = std::min(m_activeDuration, repeatDuration);
+        }
+    }
+
+    const auto count = (m_mode == Mode::To || m_mode == Mode::By) ? 2 : m_animationValues.size();
+    m_keyTimeValues.clear();
+    m_keySplineValues.clear();
+    if(m_calcMode.value() == CalcMode::Paced && m_mode == Mode::Values && count > 2) {
+        float totalDistance = 0.f;
+        std::vector<float> distances(1, 0.f);
+        for(size_t i = 1; i < count; ++i) {
+            if(!m_animationValues[i - 1].isCompatible(m_animationValues[i])) {
+                distances.clear();
+                break;
+            }
+
+            totalDistance += m_animationValues[i - 1].distance(m_animationValues[i]);
+            distances.push_back(totalDistance);
+        }
+
+        if(!distances.empty() && totalDistance > 0.f) {
+            for(auto distance : distances) {
+                m_keyTimeValues.push_back(distance / totalDistance);
+            }
+        }
+    } else if(m_calcMode.value() != CalcMode::Paced && !m_keyTimes.value().empty()) {
+        splitAnimationList(m_keyTimes.value(), [this](std::string_view input) {
+            float value = NAN;
+            parseNumber(input, value);
+            m_keyTimeValues.push_back(value);
+        });
+
+        bool isValid = m_keyTimeValues.size() == count && m_keyTimeValues.front() == 0.f;
+        for(size_t i = 0; isValid && i < m_keyTimeValues.size(); ++i) {
+            auto value = m_keyTimeValues[i];
+            isValid = value >= 0.f && value <= 1.f && (i == 0 || value >= m_keyTimeValues[i - 1]);
+        }
+
+        if(isValid && m_calcMode.value() != CalcMode::Discrete)
+            isValid = m_keyTimeValues.back() == 1.f;
+        if(!isValid) {
+            m_keyTimeValues.clear();
+        }
+    }
+
+    if(m_calcMode.value() == CalcMode::Spline) {
+        splitAnimationList(m_keySplines.value(), [this](std::string_view input) {
+            std::array<float, 4> spline = {0.f, 0.f, 1.f, 1.f};
+            for(auto& value : spline) {
+                if(!parseNumber(input, value))
+                    break;
+                skipOptionalSpacesOrComma(input);
+            }
+
+            for(auto& value : spline)
+                value = std::clamp(value, 0.f, 1.f);
+            m_keySplineValues.push_back(spline);
+        });
+
+        if(m_keySplineValues.size() + 1 != count) {
+            m_keySplineValues.clear();
+        }
+    }
+}
+
+SVGAnimateElement::SVGAnimateElement(Document* document)
+    : SVGAnimationElement(document, ElementID::Animate)
+{
+}
+
+SVGSetElement::SVGSetElement(Document* document)
+    : SVGAnimationElement(document, ElementID::Set)
+{
+}
+
+SVGAnimateTransformElement::SVGAnimateTransformElement(Document* document)
+    : SVGAnimationElement(document, ElementID::AnimateTransform)
+    , m_type(PropertyID::Type, TransformType::Translate)
+{
+    addProperty(m_type);
+}
+
+std::string SVGAnimateTransformElement::valueString(std::string_view input) const
+{
+    float values[3] = {0.f, 0.f, 0.f};
+    int count = 0;
+    while(count < 3 && parseNumber(input, values[count])) {
+        skipOptionalSpacesOrComma(input);
+        ++count;
+    }
+
+    std::string output;
+    int arity = 1;
+    switch(m_type.value()) {
+    case TransformType::Translate:
+        output = "translate(";
+        arity = 2;
+        break;
+    case TransformType::Scale:
+        output = "scale(";
+        if(count == 1)
+            values[1] = values[0];
+        arity = 2;
+        break;
+    case TransformType::Rotate:
+        output = "rotate(";
+        arity = 3;
+        break;
+    case TransformType::SkewX:
+        output = "skewX(";
+        break;
+    case TransformType::SkewY:
+        output = "skewY(";
+        break;
+    }
+
+    // Every value is written with the full argument list so that values compare number by number.
+    for(int i = 0; i < arity; ++i) {
+        if(i > 0)
+            output += ' ';
+        appendAnimationNumber(output, values[i]);
+    }
+
+    output += ')';
+    return output;
+}
+
+} // namespace novasvg
@@ -0,0 +1,149 @@
+#ifndef NOVASVG_SVGBINARY_H
+#define NOVASVG_SVGBINARY_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace novasvg {
+
+// Appends native-endian values to a binary snapshot.
+class BinaryWriter {
+public:
+    explicit BinaryWriter(std::string& output)
+        : m_output(output)
+    {}
+
+    template<typename T>
+    void write(const T& value)
+    {
+        m_output.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void write(bool value)
+    {
+        write(static_cast<uint8_t>(value));
+    }
+
+    void write(std::string_view value)
+    {
+        write(static_cast<uint32_t>(value.size()));
+        m_output.append(value.data(), value.size());
+    }
+
+    void write(const void* data, size_t length)
+    {
+        m_output.append(static_cast<const char*>(data), length);
+    }
+
+    // Writes a uint32 count followed by the raw items; T must be trivially copyable.
+    template<typename T>
+    void writeList(const std::vector<T>& values)
+    {
+        write(static_cast<uint32_t>(values.size()));
+        write(values.data(), values.size() * sizeof(T));
+    }
+
+    void writePadding(size_t alignment)
+    {
+        while(m_output.size() % alignment) {
+            m_output += '\0';
+        }
+    }
+
+private:
+    std::string& m_output;
+};
+
+// Reads a binary snapshot in place; every read fails rather than run past the end.
+class BinaryReader {
+public:
+    BinaryReader(const char* data, size_t length)
+        : m_begin(data), m_data(data), m_end(data + length)
+    {}
+
+    bool atEnd() const { return m_data == m_end; }
+
+    template<typename T>
+    bool read(T& value)
+    {
+        if(static_cast<size_t>(m_end - m_data) < sizeof(T))
+            return false;
+        std::memcpy(&value, m_data, sizeof(T));
+        m_data += sizeof(T);
+        return true;
+    }
+
+    // Bools are stored as a byte; anything other than 0 or 1 is malformed.
+    bool read(bool& value)
+    {
+        uint8_t byte;
+        if(!read(byte) || byte > 1)
+            return false;
+        value = byte == 1;
+        return true;
+    }
+
+    bool read(std::string_view& value)
+    {
+        uint32_t length;
+        if(!read(length) || static_cast<size_t>(m_end - m_data) < length)
+            return false;
+        value = std::string_view(m_data, length);
+        m_data += length;
+        return true;
+    }
+
+    bool read(std::string& value)
+    {
+        std::string_view text;
+        if(!read(text))
+            return false;
+        value.assign(text);
+        return true;
+    }
+
+    // Reads a uint32 count of items of `size` bytes each, checking that they fit in the input.
+    bool readCount(uint32_t& count, size_t size)
+    {
+        return read(count) && count <= static_cast<size_t>(m_end - m_data) / size;
+    }
+
+    template<typename T>
+    bool readList(std::vector<T>& values)
+    {
+        uint32_t count;
+        if(!readCount(count, sizeof(T)))
+            return false;
+        values.resize(count);
+        if(count > 0)
+            std::memcpy(values.data(), skip(count * sizeof(T)), count * sizeof(T));
+        return true;
+    }
+
+    const char* skip(size_t length)
+    {
+        if(static_cast<size_t>(m_end - m_data) < length)
+            return nullptr;
+        auto data = m_data;
+        m_data += length;
+        return data;
+    }
+
+    bool skipPadding(size_t alignment)
+    {
+        auto offset = static_cast<size_t>(m_data - m_begin);
+        return skip((alignment - offset % alignment) % alignment) != nullptr;
+    }
+
+private:
+    const char* m_begin;
+    const char* m_data;
+    const char* m_end;
+};
+
+} // namespace novasvg
+
+#endif // NOVASVG_SVGBINARY_H
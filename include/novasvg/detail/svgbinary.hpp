@@ -0,0 +1,433 @@
+#include "svgbinary.h"
+#include "svgelement.h"
+#include "svggeometryelement.h"
+
+#include <climits>
+#include <cstring>
+#include <unordered_map>
+
+namespace novasvg {
+
+// Snapshot layout, in native byte order:
+//   header   "NSVB", format version, library version, byte order mark (all uint32 after the magic)
+//   nodes    pre-order; each node starts with a tag byte
+//     element  tag 1, uint8 ElementID, uint32 attribute count, attributes, child nodes, tag 0
+//     clone    tag 3, laid out like an element; the copy a <use> parent expanded into
+//     text     tag 2, string
+//   attribute uint8 PropertyID, int32 specificity, string, uint8 payload flags, payloads,
+//            int32 index of the element a url() reference resolves to, or -1
+//     presentation  the parsed SVGPresentationValue fields in declaration order; a length is a
+//                   float value and a uint8 LengthUnits, a length list a uint32 count and lengths,
+//                   and a baseline shift a uint8 type and a length
+//     property      the parsed property value as written by SVGProperty::write(); path
+//                   points are aligned so they are copied into the path in one pass
+//     image         int32 width, int32 height, then the decoded pixel rows
+//   string   uint32 length, bytes
+// Elements are indexed in node order, clones included. Element and property ids are stored by
+// value, so a snapshot only loads into the library version that wrote it.
+
+static constexpr char kBinaryMagic[4] = {'N', 'S', 'V', 'B'};
+static constexpr uint32_t kBinaryFormatVersion = 1;
+static constexpr uint32_t kBinaryByteOrderMark = 0x01020304;
+
+enum BinaryNodeTag : uint8_t {
+    BinaryNodeEnd = 0,
+    BinaryNodeElement = 1,
+    BinaryNodeText = 2,
+    BinaryNodeClone = 3
+};
+
+enum BinaryPayload : uint8_t {
+    BinaryPayloadPresentation = 1 << 0,
+    BinaryPayloadProperty = 1 << 1,
+    BinaryPayloadImage = 1 << 2
+};
+
+using BinaryBaseValues = std::unordered_multimap<const SVGElement*, const SVGAnimatedAttribute*>;
+using BinaryElementIndices = std::unordered_map<const SVGElement*, int32_t>;
+
+static void writeBinaryPresentationValue(BinaryWriter& writer, const SVGPresentationValue& value)
+{
+    writer.write(value.color.value());
+    writer.write(value.currentColor);
+    writer.write(value.number);
+    writer.write(value.enumeration);
+    value.length.write(writer);
+    writeLengthList(writer, value.lengths);
+    value.baselineShift.write(writer);
+    writer.write(std::string_view(value.string));
+}
+
+static uint8_t maxBinaryPresentationEnumeration(PropertyID id)
+{
+    switch(id) {
+    case PropertyID::Stroke_Linecap:
+        return static_cast<uint8_t>(LineCap::Square);
+    case PropertyID::Stroke_Linejoin:
+        return static_cast<uint8_t>(LineJoin::Bevel);
+    case PropertyID::Fill_Rule:
+    case PropertyID::Clip_Rule:
+        return static_cast<uint8_t>(FillRule::EvenOdd);
+    case PropertyID::Font_Weight:
+        return static_cast<uint8_t>(FontWeight::Bold);
+    case PropertyID::Font_Style:
+        return static_cast<uint8_t>(FontStyle::Italic);
+    case PropertyID::Alignment_Baseline:
+        return static_cast<uint8_t>(AlignmentBaseline::Mathematical);
+    case PropertyID::Dominant_Baseline:
+        return static_cast<uint8_t>(DominantBaseline::TextBeforeEdge);
+    case PropertyID::Direction:
+        return static_cast<uint8_t>(Direction::Rtl);
+    case PropertyID::Text_Anchor:
+        return static_cast<uint8_t>(TextAnchor::End);
+    case PropertyID::White_Space:
+        return static_cast<uint8_t>(WhiteSpace::Preserve);
+    case PropertyID::Writing_Mode:
+        return static_cast<uint8_t>(WritingMode::Vertical);
+    case PropertyID::Text_Orientation:
+        return static_cast<uint8_t>(TextOrientation::Upright);
+    case PropertyID::Visibility:
+        return static_cast<uint8_t>(Visibility::Collapse);
+    case PropertyID::Pointer_Events:
+        return static_cast<uint8_t>(PointerEvents::All);
+    case PropertyID::Display:
+        return static_cast<uint8_t>(Display::None);
+    case PropertyID::Overflow:
+        return static_cast<uint8_t>(Overflow::Hidden);
+    case PropertyID::Mask_Type:
+        return static_cast<uint8_t>(MaskType::Alpha);
+    default:
+        return 0;
+    }
+}
+
+// The lengths parsePresentationValue() rejects when negative.
+static LengthNegativeMode binaryPresentationLengthMode(PropertyID id)
+{
+    switch(id) {
+    case PropertyID::Font_Size:
+    case PropertyID::Stroke_Width:
+        return LengthNegativeMode::Forbid;
+    default:
+        return LengthNegativeMode::Allow;
+    }
+}
+
+static bool readBinaryPresentationValue(BinaryReader& reader, PropertyID id, SVGPresentationValue& value)
+{
+    uint32_t color;
+    if(!reader.read(color))
+        return false;
+    value.color = Color(color);
+    return reader.read(value.currentColor) && reader.read(value.number) && reader.read(value.enumeration)
+        && value.enumeration <= maxBinaryPresentationEnumeration(id)
+        && value.length.read(reader, binaryPresentationLengthMode(id))
+        && readLengthList(reader, value.lengths, LengthNegativeMode::Forbid)
+        && value.baselineShift.read(reader) && reader.read(value.string);
+}
+
+static void writeBinaryImage(BinaryWriter& writer, const Bitmap& image)
+{
+    int32_t width = image.isNull() ? 0 : image.width();
+    int32_t height = image.isNull() ? 0 : image.height();
+    writer.write(width);
+    writer.write(height);
+    for(int32_t y = 0; y < height; ++y) {
+        writer.write(image.data() + y * image.stride(), width * 4);
+    }
+}
+
+static bool readBinaryImage(BinaryReader& reader, Bitmap& image)
+{
+    int32_t width, height;
+    if(!reader.read(width) || !reader.read(height) || width < 0 || height < 0)
+        return false;
+    if(width == 0 || height == 0)
+        return true;
+    if(width > INT_MAX / 4 || static_cast<size_t>(height) > SIZE_MAX / (width * 4))
+        return false;
+    auto pixels = reader.skip(static_cast<size_t>(height) * width * 4);
+    if(pixels == nullptr)
+        return false;
+    image = Bitmap(width, height);
+    if(image.isNull())
+        return false;
+    for(int32_t y = 0; y < height; ++y) {
+        std::memcpy(image.data() + y * image.stride(), pixels + static_cast<size_t>(y) * width * 4, width * 4);
+    }
+
+    return true;
+}
+
+static void indexBinaryElements(const SVGElement* element, BinaryElementIndices& indices)
+{
+    indices.emplace(element, static_cast<int32_t>(indices.size()));
+    for(const auto& child : element->children()) {
+        if(auto childElement = toSVGElement(child)) {
+            indexBinaryElements(childElement, indices);
+        }
+    }
+}
+
+static void writeBinaryElement(BinaryWriter& writer, const SVGElement* element, bool isClone, const BinaryBaseValues& baseValues, const BinaryElementIndices& indices)
+{
+    // Animations overwrite attributes and properties in place; store the values they will be
+    // restored to, and leave those to be parsed again on load.
+    std::vector<std::pair<const Attribute*, bool>> attributes;
+    auto range = baseValues.equal_range(element);
+    for(const auto& attribute : element->attributes()) {
+        std::pair<const Attribute*, bool> value(&attribute, false);
+        for(auto it = range.first; it != range.second; ++it) {
+            if(it->second->id() == attribute.id()) {
+                value = std::make_pair(it->second->baseValue(), true);
+                break;
+            }
+        }
+
+        if(value.first) {
+            attributes.push_back(value);
+        }
+    }
+
+    writer.write(isClone ? BinaryNodeClone : BinaryNodeElement);
+    writer.write(element->id());
+    writer.write(static_cast<uint32_t>(attributes.size()));
+    for(auto it = attributes.rbegin(); it != attributes.rend(); ++it) {
+        const auto& attribute = *it->first;
+        auto presentationValue = attribute.presentationValue();
+        auto property = it->second ? nullptr : element->getProperty(attribute.id());
+        const Bitmap* image = nullptr;
+        if(!it->second && element->id() == ElementID::Image && attribute.id() == PropertyID::Href)
+            image = &static_cast<const SVGImageElement*>(element)->image();
+        uint8_t payload = 0;
+        if(presentationValue)
+            payload |= BinaryPayloadPresentation;
+        if(property)
+            payload |= BinaryPayloadProperty;
+        if(image) {
+            payload |= BinaryPayloadImage;
+        }
+
+        writer.write(attribute.id());
+        writer.write(static_cast<int32_t>(attribute.specificity()));
+        writer.write(std::string_view(attribute.value()));
+        writer.write(payload);
+        if(presentationValue)
+            writeBinaryPresentationValue(writer, *presentationValue);
+        if(property)
+            property->write(writer);
+        if(image)
+            writeBinaryImage(writer, *image);
+        auto target = indices.find(attribute.target());
+        writer.write(target == indices.end() ? int32_t(-1) : target->second);
+    }
+
+    const SVGElement* clonedElement = nullptr;
+    if(element->id() == ElementID::Use)
+        clonedElement = static_cast<const SVGUseElement*>(element)->clonedElement();
+    for(const auto& child : element->children()) {
+        if(child->isTextNode()) {
+            writer.write(BinaryNodeText);
+            writer.write(std::string_view(static_cast<const SVGTextNode*>(child.get())->data()));
+        } else {
+            auto childElement = static_cast<const SVGElement*>(child.get());
+            writeBinaryElement(writer, childElement, childElement == clonedElement, baseValues, indices);
+        }
+    }
+
+    writer.write(BinaryNodeEnd);
+}
+
+std::string Document::serialize() const
+{
+    NOVASVG_TRACE_SCOPE("serialize");
+    BinaryBaseValues baseValues;
+    for(const auto& attribute : m_rootElement->animatedAttributes()) {
+        if(attribute.isAnimated()) {
+            baseValues.emplace(attribute.element(), &attribute);
+        }
+    }
+
+    BinaryElementIndices indices;
+    indexBinaryElements(m_rootElement.get(), indices);
+
+    std::string output(kBinaryMagic, sizeof(kBinaryMagic));
+    BinaryWriter writer(output);
+    writer.write(kBinaryFormatVersion);
+    writer.write(static_cast<uint32_t>(NOVASVG_VERSION));
+    writer.write(kBinaryByteOrderMark);
+    writeBinaryElement(writer, m_rootElement.get(), false, baseValues, indices);
+    return output;
+}
+
+bool Document::parseBinary(const char* data, size_t length)
+{
+    NOVASVG_TRACE_SCOPE("parseBinary", std::string_view(), length);
+    BinaryReader reader(data, length);
+    char magic[sizeof(kBinaryMagic)];
+    uint32_t formatVersion, libraryVersion, byteOrderMark;
+    if(!reader.read(magic) || std::memcmp(magic, kBinaryMagic, sizeof(kBinaryMagic)) != 0
+        || !reader.read(formatVersion) || formatVersion != kBinaryFormatVersion
+        || !reader.read(libraryVersion) || libraryVersion != NOVASVG_VERSION
+        || !reader.read(byteOrderMark) || byteOrderMark != kBinaryByteOrderMark) {
+        return false;
+    }
+
+    std::vector<SVGElement*> elements;
+    std::vector<std::pair<Attribute*, int32_t>> targets;
+    std::string value;
+    SVGElement* currentElement = nullptr;
+    const SVGElement* cloneRoot = nullptr;
+    do {
+        uint8_t tag;
+        if(!reader.read(tag))
+            return false;
+        if(tag == BinaryNodeEnd) {
+            if(currentElement == nullptr)
+                return false;
+            if(currentElement == cloneRoot)
+                cloneRoot = nullptr;
+            currentElement = currentElement->parentElement();
+            continue;
+        }
+
+        if(tag == BinaryNodeText) {
+            std::string_view text;
+            if(currentElement == nullptr || !reader.read(text))
+                return false;
+            auto node = std::make_unique<SVGTextNode>(this);
+            node->setData(std::string(text));
+            currentElement->addChild(std::move(node));
+            continue;
+        }
+
+        ElementID id;
+        uint32_t attributeCount;
+        if((tag != BinaryNodeElement && tag != BinaryNodeClone) || !reader.read(id) || !reader.read(attributeCount))
+            return false;
+        if(id == ElementID::Unknown || id == ElementID::Star || id > ElementID::Use)
+            return false;
+        SVGElement* element = nullptr;
+        if(m_rootElement == nullptr) {
+            if(id != ElementID::Svg || tag != BinaryNodeElement)
+                return false;
+            m_rootElement = std::make_unique<SVGRootElement>(this);
+            element = m_rootElement.get();
+            m_memoryUsage += sizeof(SVGRootElement);
+        } else {
+            if(currentElement == nullptr)
+                return false;
+            SVGUseElement* useElement = nullptr;
+            if(tag == BinaryNodeClone) {
+                if(currentElement->id() != ElementID::Use)
+                    return false;
+                useElement = static_cast<SVGUseElement*>(currentElement);
+                if(useElement->clonedElement())
+                    return false;
+            }
+
+            auto child = SVGElement::create(this, id);
+            element = child.get();
+            currentElement->addChild(std::move(child));
+            if(useElement) {
+                useElement->setClonedElement(element);
+                if(cloneRoot == nullptr) {
+                    cloneRoot = element;
+                }
+            }
+        }
+
+        if(element->isOverMemoryBudget())
+            return false;
+        elements.push_back(element);
+        for(uint32_t index = 0; index < attributeCount; ++index) {
+            PropertyID propertyId;
+            int32_t specificity;
+            std::string_view text;
+            uint8_t payload;
+            if(!reader.read(propertyId) || !reader.read(specificity) || !reader.read(text) || !reader.read(payload))
+                return false;
+            if(propertyId == PropertyID::Unknown || propertyId > PropertyID::Y2)
+                return false;
+            value.assign(text);
+            m_memoryUsage += value.size();
+            // Clones are never registered, so ids keep resolving to the original elements.
+            if(propertyId == PropertyID::Id && cloneRoot == nullptr)
+                m_rootElement->addElementById(value, element);
+            std::shared_ptr<SVGPresentationValue> presentationValue;
+            if(payload & BinaryPayloadPresentation) {
+                presentationValue = std::make_shared<SVGPresentationValue>();
+                if(!readBinaryPresentationValue(reader, propertyId, *presentationValue)) {
+                    return false;
+                }
+            }
+
+            if(payload & BinaryPayloadProperty) {
+                auto property = element->getProperty(propertyId);
+                if(property == nullptr || !property->read(reader)) {
+                    return false;
+                }
+            }
+
+            if(payload & BinaryPayloadImage) {
+                if(id != ElementID::Image || propertyId != PropertyID::Href)
+                    return false;
+                Bitmap image;
+                if(!readBinaryImage(reader, image))
+                    return false;
+                static_cast<SVGImageElement*>(element)->setImage(std::move(image));
+            }
+
+            if(!(payload & (BinaryPayloadProperty | BinaryPayloadImage)))
+                element->parseAttribute(propertyId, value);
+            auto& attribute = element->addParsedAttribute(Attribute(specificity, propertyId, value, std::move(presentationValue)));
+            int32_t target;
+            if(!reader.read(target))
+                return false;
+            if(target >= 0) {
+                targets.emplace_back(&attribute, target);
+            }
+
+            // Register the reference so the target follows later id changes.
+            auto referenceId = attribute.referenceId();
+            if(!referenceId.empty()) {
+                m_rootElement->resolveReference(referenceId, element);
+            }
+        }
+
+        currentElement = element;
+    } while(currentElement);
+
+    if(!reader.atEnd())
+        return false;
+    for(const auto& [attribute, target] : targets) {
+        if(static_cast<size_t>(target) >= elements.size())
+            return false;
+        attribute->setTarget(elements[target]);
+    }
+
+    // Clones and references are already in place; only animations still resolve their targets.
+    m_rootElement->transverse([](SVGElement* element) {
+        if(element->isAnimationElement()) {
+            element->build();
+        }
+    });
+
+    m_rootElement->collectAnimatedAttributes();
+    return !m_rootElement->isOverMemoryBudget();
+}
+
+std::unique_ptr<Document> Document::loadFromBinary(const char* data, size_t length)
+{
+    std::unique_ptr<Document> document(new Document);
+    if(!document->parseBinary(data, length))
+        return nullptr;
+    return document;
+}
+
+std::unique_ptr<Document> Document::loadFromBinary(const std::string& data)
+{
+    return loadFromBinary(data.data(), data.size());
+}
+
+} // namespace novasvg
@@ -7,6 +7,11 @@
 #include <forward_list>
 #include <list>
 #include <map>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace novasvg {
 
@@ -26,7 +31,9 @@ public:
     virtual bool isPaintElement() const { return false; }
     virtual bool isGraphicsElement() const { return false; }
     virtual bool isGeometryElement() const { return false; }
+    virtual bool isFilterPrimitiveElement() const { return false; }
     virtual bool isTextPositioningElement() const { return false; }
+    virtual bool isAnimationElement() const { return false; }
 
     Document* document() const { return m_document; }
     SVGRootElement* rootElement() const { return m_document->rootElement(); }
@@ -38,6 +45,10 @@ public:
 
     virtual std::unique_ptr<SVGNode> clone(bool deep) const = 0;
 
+    void addMemoryUsage(size_t bytes) const { m_document->m_memoryUsage += bytes; }
+    void removeMemoryUsage(size_t bytes) const { m_document->m_memoryUsage -= bytes; }
+    bool isOverMemoryBudget() const { return m_document->m_memoryBudget > 0 && m_document->m_memoryUsage > m_document->m_memoryBudget; }
+
 private:
     SVGNode(const SVGNode&) = delete;
     SVGNode& operator=(const SVGNode&) = delete;
@@ -60,21 +71,55 @@ private:
     std::string m_data;
 };
 
+// A presentation attribute parsed into the typed value the layout cascade consumes. Only the
+// members that belong to the property are set; colors naming currentColor are resolved
+// against the element's color when the cascade runs.
+struct SVGPresentationValue {
+    Color color = Color::Transparent;
+    bool currentColor = false;
+    float number = 0.f;
+    uint8_t enumeration = 0;
+    Length length;
+    LengthList lengths;
+    BaselineShift baselineShift;
+    std::string string;
+};
+
+std::shared_ptr<const SVGPresentationValue> parsePresentationValue(PropertyID id, std::string_view input);
+
 class Attribute {
 public:
     Attribute() = default;
     Attribute(int specificity, PropertyID id, std::string value)
         : m_specificity(specificity), m_id(id), m_value(std::move(value))
+        , m_presentationValue(parsePresentationValue(id, m_value))
+    {}
+
+    Attribute(int specificity, PropertyID id, std::string value, std::shared_ptr<const SVGPresentationValue> presentationValue)
+        : m_specificity(specificity), m_id(id), m_value(std::move(value))
+        , m_presentationValue(std::move(presentationValue))
     {}
 
     int specificity() const { return m_specificity; }
     PropertyID id() const { return m_id; }
     const std::string& value() const { return m_value; }
 
+    // Null unless this is a presentation attribute with a specified (non-inherit) value.
+    const SVGPresentationValue* presentationValue() const { return m_presentationValue.get(); }
+
+    // The id a url() reference in this attribute names, or empty if it names none.
+    std::string_view referenceId() const;
+
+    // The element a url() reference in this attribute resolves to, kept up to date by the root element.
+    SVGElement* target() const { return m_target; }
+    void setTarget(SVGElement* target) { m_target = target; }
+
 private:
     int m_specificity;
     PropertyID m_id;
     std::string m_value;
+    std::shared_ptr<const SVGPresentationValue> m_presentationValue;
+    SVGElement* m_target = nullptr;
 };
 
 using AttributeList = std::forward_list<Attribute>;
@@ -82,10 +127,21 @@ using AttributeList = std::forward_list<Attribute>;
 enum class ElementID : uint8_t {
     Unknown = 0,
     Star,
+    Animate,
+    AnimateTransform,
     Circle,
     ClipPath,
     Defs,
     Ellipse,
+    FeBlend,
+    FeColorMatrix,
+    FeComposite,
+    FeFlood,
+    FeGaussianBlur,
+    FeMerge,
+    FeMergeNode,
+    FeOffset,
+    Filter,
     G,
     Image,
     Line,
@@ -98,6 +154,7 @@ enum class ElementID : uint8_t {
     Polyline,
     RadialGradient,
     Rect,
+    Set,
     Stop,
     Style,
     Svg,
@@ -115,7 +172,9 @@ using SVGPropertyList = std::forward_list<SVGProperty*>;
 class SVGMarkerElement;
 class SVGClipPathElement;
 class SVGMaskElement;
+class SVGFilterElement;
 class SVGPaintElement;
+class SVGAnimationElement;
 class SVGLayoutState;
 class SVGRenderState;
 
@@ -138,6 +197,11 @@ public:
     bool setAttribute(int specificity, PropertyID id, const std::string& value);
     void setAttributes(const AttributeList& attributes);
     bool setAttribute(const Attribute& attribute);
+    void setAttribute(const Attribute& attribute, const SVGProperty& value);
+    void removeAttribute(PropertyID id);
+
+    // Adds an attribute whose property value and reference target the caller sets itself.
+    Attribute& addParsedAttribute(Attribute attribute) { return m_attributes.emplace_front(std::move(attribute)); }
 
     virtual void parseAttribute(PropertyID id, const std::string& value);
 
@@ -157,11 +221,13 @@ public:
     virtual Rect fillBoundingBox() const;
     virtual Rect strokeBoundingBox() const;
     virtual Rect paintBoundingBox() const;
+    void invalidateBoundingBoxes() const;
 
-    SVGMarkerElement* getMarker(std::string_view id) const;
-    SVGClipPathElement* getClipper(std::string_view id) const;
-    SVGMaskElement* getMasker(std::string_view id) const;
-    SVGPaintElement* getPainter(std::string_view id) const;
+    SVGMarkerElement* getMarker(SVGElement* element) const;
+    SVGClipPathElement* getClipper(SVGElement* element) const;
+    SVGMaskElement* getMasker(SVGElement* element) const;
+    SVGFilterElement* getFilter(SVGElement* element) const;
+    SVGPaintElement* getPainter(SVGElement* element) const;
 
     SVGElement* elementFromPoint(float x, float y);
 
@@ -176,6 +242,7 @@ public:
     void cloneChildren(SVGElement* parentElement) const;
     std::unique_ptr<SVGNode> clone(bool deep) const final;
 
+    void resolveReferences();
     virtual void build();
 
     virtual void layoutElement(const SVGLayoutState& state);
@@ -194,14 +261,20 @@ public:
 
     const SVGClipPathElement* clipper() const { return m_clipper; }
     const SVGMaskElement* masker() const { return m_masker; }
+    const SVGFilterElement* filter() const { return m_filter; }
     float opacity() const { return m_opacity; }
 
     bool isElement() const final { return true; }
 
 private:
+    // Filled by SVGRootElement::updateBoundingBoxes() at the end of layout, so renders, which
+    // cull against the paint box and may run on several threads at once, only read them.
     mutable Rect m_paintBoundingBox = Rect::Invalid;
+    mutable Rect m_cachedFillBoundingBox = Rect::Invalid;
+    mutable Rect m_cachedStrokeBoundingBox = Rect::Invalid;
     const SVGClipPathElement* m_clipper = nullptr;
     const SVGMaskElement* m_masker = nullptr;
+    const SVGFilterElement* m_filter = nullptr;
     float m_opacity = 1.f;
 
     float m_font_size = 12.f;
@@ -271,9 +344,10 @@ public:
 
     const SVGString& href() const { return m_href; }
     const std::string& hrefString() const { return m_href.value(); }
-    SVGElement* getTargetElement(const Document* document) const;
+    SVGElement* getTargetElement() const;
 
 private:
+    const SVGElement* m_element;
     SVGString m_href;
 };
 
@@ -333,6 +407,31 @@ private:
     SVGLength m_height;
 };
 
+class SVGAnimatedAttribute {
+public:
+    SVGAnimatedAttribute(SVGElement* element, PropertyID id);
+
+    SVGElement* element() const { return m_element; }
+    PropertyID id() const { return m_id; }
+
+    // The attribute as written in the document while an animation overrides it.
+    bool isAnimated() const { return m_animated; }
+    const Attribute* baseValue() const { return m_hasBaseValue ? &m_baseValue : nullptr; }
+
+    const std::vector<const SVGAnimationElement*>& animations() const { return m_animations; }
+    void addAnimation(const SVGAnimationElement* animation) { m_animations.push_back(animation); }
+    bool update(float time);
+
+private:
+    SVGElement* m_element;
+    PropertyID m_id;
+    bool m_hasBaseValue = false;
+    bool m_animated = false;
+    Attribute m_baseValue;
+    std::string m_animatedValue;
+    std::vector<const SVGAnimationElement*> m_animations;
+};
+
 class SVGRootElement final : public SVGSVGElement {
 public:
     SVGRootElement(Document* document);
@@ -340,21 +439,62 @@ public:
     float intrinsicWidth() const { return m_intrinsicWidth; }
     float intrinsicHeight() const { return m_intrinsicHeight; }
 
-    void setNeedsLayout() { m_intrinsicWidth = -1.f; }
-    bool needsLayout() const { return m_intrinsicWidth == -1.f; }
+    void setNeedsLayout() { m_needsLayout = true; }
+    bool needsLayout() const { return m_needsLayout; }
 
     SVGRootElement* layoutIfNeeded();
 
     SVGElement* getElementById(std::string_view id) const;
     void addElementById(const std::string& id, SVGElement* element);
+    SVGElement* resolveReference(std::string_view id, SVGElement* referrer);
+    void updateElementId(SVGElement* element, const std::string& oldId);
+    const SVGElement* initialElement(ElementID id);
     void layout(SVGLayoutState& state) final;
+    void build() final;
+    void collectAnimatedAttributes();
 
     void forceLayout();
 
+    bool hasAnimations() const { return !m_animatedAttributes.empty(); }
+    const std::vector<SVGAnimatedAttribute>& animatedAttributes() const { return m_animatedAttributes; }
+    float animationDuration() const;
+    void setAnimationTime(float time);
+
+    void addDamage(const SVGElement* element);
+    void addFullDamage();
+    void clearDamage();
+
+    bool hasDamage() const { return m_fullDamage || !m_damagedElements.empty(); }
+    bool isFullyDamaged() const { return m_fullDamage; }
+    Rect damagedRect() const;
+
 private:
-    std::map<std::string, SVGElement*, std::less<>> m_idCache;
+    void layoutElements(const std::vector<SVGElement*>& elements);
+    void updateBoundingBoxes();
+
+    // Keyed by a view of the entry's own copy of the id, so lookups by string_view hash
+    // without building a std::string (heterogeneous unordered lookup needs C++20).
+    // The elements carrying the id, first in document order first, and the elements whose
+    // references name it, which are re-resolved when the first of those elements changes.
+    struct IdEntry {
+        explicit IdEntry(std::string_view id) : id(id) {}
+        std::string id;
+        std::vector<SVGElement*> elements;
+        std::unordered_set<SVGElement*> referrers;
+    };
+
+    IdEntry& idEntry(std::string_view id);
+
+    std::unordered_map<std::string_view, std::unique_ptr<IdEntry>> m_idCache;
+    std::map<ElementID, std::unique_ptr<SVGElement>> m_initialElements;
+    std::vector<SVGAnimatedAttribute> m_animatedAttributes;
+    std::vector<const SVGElement*> m_damagedElements;
+    Rect m_damagedRect{Rect::Invalid};
+    bool m_fullDamage{true};
     float m_intrinsicWidth{-1.f};
     float m_intrinsicHeight{-1.f};
+    bool m_intrinsicSizeFromContent{false};
+    bool m_needsLayout{true};
 };
 
 class SVGUseElement final : public SVGGraphicsElement, public SVGURIReference {
@@ -366,6 +506,10 @@ public:
     const SVGLength& width() const { return m_width; }
     const SVGLength& height() const { return m_height; }
 
+    // The copy of the referenced element added as the last child by build().
+    const SVGElement* clonedElement() const { return m_clonedElement; }
+    void setClonedElement(const SVGElement* element) { m_clonedElement = element; }
+
     Transform localTransform() const final;
     void render(SVGRenderState& state) const final;
     void build() final;
@@ -376,6 +520,7 @@ private:
     SVGLength m_y;
     SVGLength m_width;
     SVGLength m_height;
+    const SVGElement* m_clonedElement = nullptr;
 };
 
 class SVGImageElement final : public SVGGraphicsElement {
@@ -388,6 +533,7 @@ public:
     const SVGLength& height() const { return m_height; }
     const SVGPreserveAspectRatio& preserveAspectRatio() const { return m_preserveAspectRatio; }
     const Bitmap& image() const { return m_image; }
+    void setImage(Bitmap image) { m_image = std::move(image); }
 
     Rect fillBoundingBox() const final;
     Rect strokeBoundingBox() const final;
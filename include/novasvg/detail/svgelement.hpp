@@ -1,7 +1,9 @@
+#include "svgfilterelement.h"
 #include "svgpaintelement.h"
 #include "svggeometryelement.h"
 #include "svgtextelement.h"
 #include "svglayoutstate.h"
+#include "svganimationelement.h"
 
 #include <cassert>
 
@@ -14,10 +16,21 @@ ElementID elementid(std::string_view name)
         ElementID value;
     } table[] = {
         {"a", ElementID::G},
+        {"animate", ElementID::Animate},
+        {"animateTransform", ElementID::AnimateTransform},
         {"circle", ElementID::Circle},
         {"clipPath", ElementID::ClipPath},
         {"defs", ElementID::Defs},
         {"ellipse", ElementID::Ellipse},
+        {"feBlend", ElementID::FeBlend},
+        {"feColorMatrix", ElementID::FeColorMatrix},
+        {"feComposite", ElementID::FeComposite},
+        {"feFlood", ElementID::FeFlood},
+        {"feGaussianBlur", ElementID::FeGaussianBlur},
+        {"feMerge", ElementID::FeMerge},
+        {"feMergeNode", ElementID::FeMergeNode},
+        {"feOffset", ElementID::FeOffset},
+        {"filter", ElementID::Filter},
         {"g", ElementID::G},
         {"image", ElementID::Image},
         {"line", ElementID::Line},
@@ -30,6 +43,7 @@ ElementID elementid(std::string_view name)
         {"polyline", ElementID::Polyline},
         {"radialGradient", ElementID::RadialGradient},
         {"rect", ElementID::Rect},
+        {"set", ElementID::Set},
         {"stop", ElementID::Stop},
         {"style", ElementID::Style},
         {"svg", ElementID::Svg},
@@ -48,11 +62,16 @@ ElementID elementid(std::string_view name)
 SVGTextNode::SVGTextNode(Document* document)
     : SVGNode(document)
 {
+    addMemoryUsage(sizeof(SVGTextNode));
 }
 
 void SVGTextNode::setData(const std::string& data)
 {
+    if(auto parent = parentElement())
+        rootElement()->addDamage(parent);
     rootElement()->setNeedsLayout();
+    removeMemoryUsage(m_data.size());
+    addMemoryUsage(data.size());
     m_data.assign(data);
 }
 
@@ -65,54 +84,86 @@ std::unique_ptr<SVGNode> SVGTextNode::clone(bool deep) const
 
 const std::string emptyString;
 
+template<typename T, typename... Args>
+static std::unique_ptr<SVGElement> createElement(Document* document, Args&&... args)
+{
+    auto element = std::make_unique<T>(document, std::forward<Args>(args)...);
+    element->addMemoryUsage(sizeof(T));
+    return element;
+}
+
 std::unique_ptr<SVGElement> SVGElement::create(Document* document, ElementID id)
 {
     switch(id) {
     case ElementID::Svg:
-        return std::make_unique<SVGSVGElement>(document);
+        return createElement<SVGSVGElement>(document);
     case ElementID::Path:
-        return std::make_unique<SVGPathElement>(document);
+        return createElement<SVGPathElement>(document);
     case ElementID::G:
-        return std::make_unique<SVGGElement>(document);
+        return createElement<SVGGElement>(document);
     case ElementID::Rect:
-        return std::make_unique<SVGRectElement>(document);
+        return createElement<SVGRectElement>(document);
     case ElementID::Circle:
-        return std::make_unique<SVGCircleElement>(document);
+        return createElement<SVGCircleElement>(document);
     case ElementID::Ellipse:
-        return std::make_unique<SVGEllipseElement>(document);
+        return createElement<SVGEllipseElement>(document);
     case ElementID::Line:
-        return std::make_unique<SVGLineElement>(document);
+        return createElement<SVGLineElement>(document);
     case ElementID::Defs:
-        return std::make_unique<SVGDefsElement>(document);
+        return createElement<SVGDefsElement>(document);
     case ElementID::Polygon:
     case ElementID::Polyline:
-        return std::make_unique<SVGPolyElement>(document, id);
+        return createElement<SVGPolyElement>(document, id);
     case ElementID::Stop:
-        return std::make_unique<SVGStopElement>(document);
+        return createElement<SVGStopElement>(document);
     case ElementID::LinearGradient:
-        return std::make_unique<SVGLinearGradientElement>(document);
+        return createElement<SVGLinearGradientElement>(document);
     case ElementID::RadialGradient:
-        return std::make_unique<SVGRadialGradientElement>(document);
+        return createElement<SVGRadialGradientElement>(document);
     case ElementID::Symbol:
-        return std::make_unique<SVGSymbolElement>(document);
+        return createElement<SVGSymbolElement>(document);
     case ElementID::Use:
-        return std::make_unique<SVGUseElement>(document);
+        return createElement<SVGUseElement>(document);
     case ElementID::Pattern:
-        return std::make_unique<SVGPatternElement>(document);
+        return createElement<SVGPatternElement>(document);
     case ElementID::Mask:
-        return std::make_unique<SVGMaskElement>(document);
+        return createElement<SVGMaskElement>(document);
     case ElementID::ClipPath:
-        return std::make_unique<SVGClipPathElement>(document);
+        return createElement<SVGClipPathElement>(document);
     case ElementID::Marker:
-        return std::make_unique<SVGMarkerElement>(document);
+        return createElement<SVGMarkerElement>(document);
     case ElementID::Image:
-        return std::make_unique<SVGImageElement>(document);
+        return createElement<SVGImageElement>(document);
     case ElementID::Style:
-        return std::make_unique<SVGStyleElement>(document);
+        return createElement<SVGStyleElement>(document);
+    case ElementID::Filter:
+        return createElement<SVGFilterElement>(document);
+    case ElementID::FeBlend:
+        return createElement<SVGFeBlendElement>(document);
+    case ElementID::FeColorMatrix:
+        return createElement<SVGFeColorMatrixElement>(document);
+    case ElementID::FeComposite:
+        return createElement<SVGFeCompositeElement>(document);
+    case ElementID::FeFlood:
+        return createElement<SVGFeFloodElement>(document);
+    case ElementID::FeGaussianBlur:
+        return createElement<SVGFeGaussianBlurElement>(document);
+    case ElementID::FeMerge:
+        return createElement<SVGFeMergeElement>(document);
+    case ElementID::FeMergeNode:
+        return createElement<SVGFeMergeNodeElement>(document);
+    case ElementID::FeOffset:
+        return createElement<SVGFeOffsetElement>(document);
     case ElementID::Text:
-        return std::make_unique<SVGTextElement>(document);
+        return createElement<SVGTextElement>(document);
     case ElementID::Tspan:
-        return std::make_unique<SVGTSpanElement>(document);
+        return createElement<SVGTSpanElement>(document);
+    case ElementID::Animate:
+        return createElement<SVGAnimateElement>(document);
+    case ElementID::AnimateTransform:
+        return createElement<SVGAnimateTransformElement>(document);
+    case ElementID::Set:
+        return createElement<SVGSetElement>(document);
     default:
         assert(false);
     }
@@ -142,12 +193,60 @@ const std::string& SVGElement::getAttribute(std::string_view name) const
     return getAttribute(id);
 }
 
+static bool isReferenceProperty(PropertyID id)
+{
+    switch(id) {
+    case PropertyID::Fill:
+    case PropertyID::Stroke:
+    case PropertyID::Clip_Path:
+    case PropertyID::Mask:
+    case PropertyID::Filter:
+    case PropertyID::Marker_Start:
+    case PropertyID::Marker_Mid:
+    case PropertyID::Marker_End:
+        return true;
+    default:
+        return false;
+    }
+}
+
+std::string_view Attribute::referenceId() const
+{
+    if(m_id == PropertyID::Href) {
+        std::string_view value(m_value);
+        stripLeadingAndTrailingSpaces(value);
+        if(value.size() > 1 && value.front() == '#')
+            return value.substr(1);
+        return std::string_view();
+    }
+
+    if(m_presentationValue && isReferenceProperty(m_id))
+        return m_presentationValue->string;
+    return std::string_view();
+}
+
+static void resolveReference(SVGRootElement* rootElement, SVGElement* element, Attribute& attribute)
+{
+    auto id = attribute.referenceId();
+    if(!id.empty()) {
+        attribute.setTarget(rootElement->resolveReference(id, element));
+    } else {
+        attribute.setTarget(nullptr);
+    }
+}
+
 bool SVGElement::setAttribute(std::string_view name, const std::string& value)
 {
     auto id = propertyid(name);
     if(id == PropertyID::Unknown)
         return false;
-    return setAttribute(0x1000, id, value);
+    if(id != PropertyID::Id)
+        return setAttribute(0x1000, id, value);
+    auto oldId = getAttribute(PropertyID::Id);
+    if(!setAttribute(0x1000, id, value))
+        return false;
+    rootElement()->updateElementId(this, oldId);
+    return true;
 }
 
 const Attribute* SVGElement::findAttribute(PropertyID id) const
@@ -191,12 +290,13 @@ bool SVGElement::setAttribute(int specificity, PropertyID id, const std::string&
                 return false;
             parseAttribute(id, value);
             attribute = Attribute(specificity, id, value);
+            resolveReference(rootElement(), this, attribute);
             return true;
         }
     }
 
     parseAttribute(id, value);
-    m_attributes.emplace_front(specificity, id, value);
+    resolveReference(rootElement(), this, m_attributes.emplace_front(specificity, id, value));
     return true;
 }
 
@@ -209,11 +309,59 @@ void SVGElement::setAttributes(const AttributeList& attributes)
 
 bool SVGElement::setAttribute(const Attribute& attribute)
 {
-    return setAttribute(attribute.specificity(), attribute.id(), attribute.value());
+    for(auto& existing : m_attributes) {
+        if(attribute.id() == existing.id()) {
+            if(attribute.specificity() < existing.specificity())
+                return false;
+            parseAttribute(attribute.id(), attribute.value());
+            existing = attribute;
+            resolveReference(rootElement(), this, existing);
+            return true;
+        }
+    }
+
+    parseAttribute(attribute.id(), attribute.value());
+    resolveReference(rootElement(), this, m_attributes.emplace_front(attribute));
+    return true;
+}
+
+void SVGElement::setAttribute(const Attribute& attribute, const SVGProperty& value)
+{
+    rootElement()->addDamage(this);
+    rootElement()->setNeedsLayout();
+    if(auto property = getProperty(attribute.id()))
+        property->assign(value);
+    for(auto& existing : m_attributes) {
+        if(attribute.id() == existing.id()) {
+            existing = attribute;
+            resolveReference(rootElement(), this, existing);
+            return;
+        }
+    }
+
+    resolveReference(rootElement(), this, m_attributes.emplace_front(attribute));
+}
+
+void SVGElement::removeAttribute(PropertyID id)
+{
+    if(id == PropertyID::Id) {
+        auto oldId = getAttribute(PropertyID::Id);
+        m_attributes.remove_if([id](const auto& attribute) { return id == attribute.id(); });
+        rootElement()->updateElementId(this, oldId);
+    } else {
+        m_attributes.remove_if([id](const auto& attribute) { return id == attribute.id(); });
+    }
+
+    rootElement()->addDamage(this);
+    rootElement()->setNeedsLayout();
+    if(auto property = getProperty(id)) {
+        property->assign(*rootElement()->initialElement(m_id)->getProperty(id));
+    }
 }
 
 void SVGElement::parseAttribute(PropertyID id, const std::string& value)
 {
+    rootElement()->addDamage(this);
     rootElement()->setNeedsLayout();
     if(auto property = getProperty(id)) {
         property->parse(value);
@@ -285,6 +433,8 @@ SVGNode* SVGElement::lastChild() const
 
 Rect SVGElement::fillBoundingBox() const
 {
+    if(m_cachedFillBoundingBox.isValid())
+        return m_cachedFillBoundingBox;
     auto fillBoundingBox = Rect::Invalid;
     for(const auto& child : m_children) {
         if(auto element = toSVGElement(child); element && !element->isHiddenElement()) {
@@ -294,11 +444,14 @@ Rect SVGElement::fillBoundingBox() const
 
     if(!fillBoundingBox.isValid())
         fillBoundingBox = Rect::Empty;
+    m_cachedFillBoundingBox = fillBoundingBox;
     return fillBoundingBox;
 }
 
 Rect SVGElement::strokeBoundingBox() const
 {
+    if(m_cachedStrokeBoundingBox.isValid())
+        return m_cachedStrokeBoundingBox;
     auto strokeBoundingBox = Rect::Invalid;
     for(const auto& child : m_children) {
         if(auto element = toSVGElement(child); element && !element->isHiddenElement()) {
@@ -308,9 +461,17 @@ Rect SVGElement::strokeBoundingBox() const
 
     if(!strokeBoundingBox.isValid())
         strokeBoundingBox = Rect::Empty;
+    m_cachedStrokeBoundingBox = strokeBoundingBox;
     return strokeBoundingBox;
 }
 
+void SVGElement::invalidateBoundingBoxes() const
+{
+    m_paintBoundingBox = Rect::Invalid;
+    m_cachedFillBoundingBox = Rect::Invalid;
+    m_cachedStrokeBoundingBox = Rect::Invalid;
+}
+
 Rect SVGElement::paintBoundingBox() const
 {
     if(m_paintBoundingBox.isValid())
@@ -318,38 +479,42 @@ Rect SVGElement::paintBoundingBox() const
     m_paintBoundingBox = Rect::Empty;
     m_paintBoundingBox = strokeBoundingBox();
     assert(m_paintBoundingBox.isValid());
+    if(m_filter) m_paintBoundingBox = m_filter->filterRegion(this);
     if(m_clipper) m_paintBoundingBox.intersect(m_clipper->clipBoundingBox(this));
     if(m_masker) m_paintBoundingBox.intersect(m_masker->maskBoundingBox(this));
     return m_paintBoundingBox;
 }
 
-SVGMarkerElement* SVGElement::getMarker(std::string_view id) const
+SVGMarkerElement* SVGElement::getMarker(SVGElement* element) const
 {
-    auto element = rootElement()->getElementById(id);
     if(element && element->id() == ElementID::Marker)
         return static_cast<SVGMarkerElement*>(element);
     return nullptr;
 }
 
-SVGClipPathElement* SVGElement::getClipper(std::string_view id) const
+SVGClipPathElement* SVGElement::getClipper(SVGElement* element) const
 {
-    auto element = rootElement()->getElementById(id);
     if(element && element->id() == ElementID::ClipPath)
         return static_cast<SVGClipPathElement*>(element);
     return nullptr;
 }
 
-SVGMaskElement* SVGElement::getMasker(std::string_view id) const
+SVGMaskElement* SVGElement::getMasker(SVGElement* element) const
 {
-    auto element = rootElement()->getElementById(id);
     if(element && element->id() == ElementID::Mask)
         return static_cast<SVGMaskElement*>(element);
     return nullptr;
 }
 
-SVGPaintElement* SVGElement::getPainter(std::string_view id) const
+SVGFilterElement* SVGElement::getFilter(SVGElement* element) const
+{
+    if(element && element->id() == ElementID::Filter)
+        return static_cast<SVGFilterElement*>(element);
+    return nullptr;
+}
+
+SVGPaintElement* SVGElement::getPainter(SVGElement* element) const
 {
-    auto element = rootElement()->getElementById(id);
     if(element && element->isPaintElement())
         return static_cast<SVGPaintElement*>(element);
     return nullptr;
@@ -437,8 +602,17 @@ std::unique_ptr<SVGNode> SVGElement::clone(bool deep) const
     return element;
 }
 
+void SVGElement::resolveReferences()
+{
+    auto root = rootElement();
+    for(auto& attribute : m_attributes) {
+        resolveReference(root, this, attribute);
+    }
+}
+
 void SVGElement::build()
 {
+    resolveReferences();
     for(const auto& child : m_children) {
         if(auto element = toSVGElement(child)) {
             element->build();
@@ -448,9 +622,10 @@ void SVGElement::build()
 
 void SVGElement::layoutElement(const SVGLayoutState& state)
 {
-    m_paintBoundingBox = Rect::Invalid;
+    invalidateBoundingBoxes();
     m_clipper = getClipper(state.clip_path());
     m_masker = getMasker(state.mask());
+    m_filter = getFilter(state.filter());
     m_opacity = state.opacity();
 
     m_font_size = state.font_size();
@@ -479,6 +654,8 @@ void SVGElement::layout(SVGLayoutState& state)
 void SVGElement::renderChildren(SVGRenderState& state) const
 {
     for(const auto& child : m_children) {
+        if(state->interrupted())
+            return;
         if(auto element = toSVGElement(child)) {
             element->render(state);
         }
@@ -499,10 +676,14 @@ bool SVGElement::isHiddenElement() const
     case ElementID::Marker:
     case ElementID::ClipPath:
     case ElementID::Mask:
+    case ElementID::Filter:
     case ElementID::LinearGradient:
     case ElementID::RadialGradient:
     case ElementID::Pattern:
     case ElementID::Stop:
+    case ElementID::Animate:
+    case ElementID::AnimateTransform:
+    case ElementID::Set:
         return true;
     default:
         return false;
@@ -564,17 +745,16 @@ Rect SVGFitToViewBox::getClipRect(const Size& viewportSize) const
 }
 
 SVGURIReference::SVGURIReference(SVGElement* element)
-    : m_href(PropertyID::Href)
+    : m_element(element), m_href(PropertyID::Href)
 {
     element->addProperty(m_href);
 }
 
-SVGElement* SVGURIReference::getTargetElement(const Document* document) const
+SVGElement* SVGURIReference::getTargetElement() const
 {
-    std::string_view value(m_href.value());
-    if(value.empty() || value.front() != '#')
-        return nullptr;
-    return document->rootElement()->getElementById(value.substr(1));
+    if(auto attribute = m_element->findAttribute(PropertyID::Href))
+        return attribute->target();
+    return nullptr;
 }
 
 bool SVGPaintServer::applyPaint(SVGRenderState& state) const
@@ -597,7 +777,7 @@ SVGPaintServer SVGGraphicsElement::getPaintServer(const Paint& paint, float opac
 {
     if(paint.isNone())
         return SVGPaintServer();
-    if(auto element = getPainter(paint.id()))
+    if(auto element = getPainter(paint.target()))
         return SVGPaintServer(element, paint.color(), opacity);
     return SVGPaintServer(nullptr, paint.color(), opacity);
 }
@@ -649,8 +829,9 @@ Transform SVGSVGElement::localTransform() const
 
 void SVGSVGElement::render(SVGRenderState& state) const
 {
-    if(isDisplayNone())
+    if(state.cull(isDisplayNone()))
         return;
+    NOVASVG_TRACE_SCOPE("svg", getAttribute(PropertyID::Id));
     LengthContext lengthContext(this);
     const Size viewportSize = {
         lengthContext.valueForLength(m_width),
@@ -668,6 +849,43 @@ void SVGSVGElement::render(SVGRenderState& state) const
     newState.endGroup(blendInfo);
 }
 
+SVGAnimatedAttribute::SVGAnimatedAttribute(SVGElement* element, PropertyID id)
+    : m_element(element), m_id(id)
+{
+    if(auto attribute = element->findAttribute(id)) {
+        m_baseValue = *attribute;
+        m_hasBaseValue = true;
+    }
+}
+
+bool SVGAnimatedAttribute::update(float time)
+{
+    std::string value(m_hasBaseValue ? m_baseValue.value() : emptyString);
+    bool animated = false;
+    for(auto animation : m_animations) {
+        if(animation->apply(time, value)) {
+            animated = true;
+        }
+    }
+
+    if(!animated) {
+        if(!m_animated)
+            return false;
+        m_element->removeAttribute(m_id);
+        if(m_hasBaseValue)
+            m_element->setAttribute(m_baseValue);
+        m_animated = false;
+        return true;
+    }
+
+    if(m_animated && value == m_animatedValue)
+        return false;
+    m_element->setAttribute(0x10000, m_id, value);
+    m_animatedValue = std::move(value);
+    m_animated = true;
+    return true;
+}
+
 SVGRootElement::SVGRootElement(Document* document)
     : SVGSVGElement(document)
 {
@@ -682,20 +900,142 @@ SVGRootElement* SVGRootElement::layoutIfNeeded()
 
 SVGElement* SVGRootElement::getElementById(std::string_view id) const
 {
+    if(id.empty())
+        return nullptr;
     auto it = m_idCache.find(id);
-    if(it == m_idCache.end())
+    if(it == m_idCache.end() || it->second->elements.empty())
         return nullptr;
-    return it->second;
+    return it->second->elements.front();
+}
+
+SVGRootElement::IdEntry& SVGRootElement::idEntry(std::string_view id)
+{
+    auto it = m_idCache.find(id);
+    if(it == m_idCache.end()) {
+        auto entry = std::make_unique<IdEntry>(id);
+        std::string_view key(entry->id);
+        it = m_idCache.emplace(key, std::move(entry)).first;
+    }
+
+    return *it->second;
 }
 
 void SVGRootElement::addElementById(const std::string& id, SVGElement* element)
 {
-    m_idCache.emplace(id, element);
+    // Elements are registered while the document is read, so appending keeps document order.
+    idEntry(id).elements.push_back(element);
+}
+
+SVGElement* SVGRootElement::resolveReference(std::string_view id, SVGElement* referrer)
+{
+    auto& entry = idEntry(id);
+    entry.referrers.insert(referrer);
+    if(entry.elements.empty())
+        return nullptr;
+    return entry.elements.front();
+}
+
+static bool isInsideUseElement(const SVGElement* element)
+{
+    for(auto parent = element->parentElement(); parent; parent = parent->parentElement()) {
+        if(parent->id() == ElementID::Use) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool precedesInDocument(const SVGElement* a, const SVGElement* b)
+{
+    std::vector<const SVGElement*> pathA;
+    std::vector<const SVGElement*> pathB;
+    for(auto element = a; element; element = element->parentElement())
+        pathA.push_back(element);
+    for(auto element = b; element; element = element->parentElement())
+        pathB.push_back(element);
+    const SVGElement* parent = nullptr;
+    while(!pathA.empty() && !pathB.empty() && pathA.back() == pathB.back()) {
+        parent = pathA.back();
+        pathA.pop_back();
+        pathB.pop_back();
+    }
+
+    if(pathA.empty())
+        return true;
+    if(pathB.empty() || parent == nullptr)
+        return false;
+    for(const auto& child : parent->children()) {
+        if(child.get() == pathA.back())
+            return true;
+        if(child.get() == pathB.back()) {
+            return false;
+        }
+    }
+
+    return false;
+}
+
+void SVGRootElement::updateElementId(SVGElement* element, const std::string& oldId)
+{
+    // Clones under <use> elements are never registered, so ids keep resolving to the originals.
+    std::vector<SVGElement*> referrers;
+    if(!isInsideUseElement(element)) {
+        auto takeReferrers = [&referrers](IdEntry& entry) {
+            referrers.insert(referrers.end(), entry.referrers.begin(), entry.referrers.end());
+            entry.referrers.clear();
+        };
+
+        auto it = m_idCache.find(oldId);
+        if(it != m_idCache.end()) {
+            auto& elements = it->second->elements;
+            auto position = std::find(elements.begin(), elements.end(), element);
+            if(position != elements.end()) {
+                if(position == elements.begin())
+                    takeReferrers(*it->second);
+                elements.erase(position);
+            }
+        }
+
+        const auto& newId = element->getAttribute(PropertyID::Id);
+        if(!newId.empty()) {
+            auto& entry = idEntry(newId);
+            auto position = std::find_if(entry.elements.begin(), entry.elements.end(), [element](const SVGElement* holder) {
+                return precedesInDocument(element, holder);
+            });
+
+            if(position == entry.elements.begin())
+                takeReferrers(entry);
+            entry.elements.insert(position, element);
+        }
+    }
+
+    // Only the references naming an id whose first element changed need resolving again.
+    for(auto referrer : referrers) {
+        referrer->resolveReferences();
+    }
+
+    auto it = m_idCache.find(oldId);
+    if(it != m_idCache.end() && it->second->elements.empty() && it->second->referrers.empty())
+        m_idCache.erase(it);
+    addFullDamage();
+    setNeedsLayout();
+}
+
+const SVGElement* SVGRootElement::initialElement(ElementID id)
+{
+    // One attribute-free element per type supplies the initial value of every property it owns.
+    auto& element = m_initialElements[id];
+    if(element == nullptr)
+        element = SVGElement::create(document(), id);
+    return element.get();
 }
 
 void SVGRootElement::layout(SVGLayoutState& state)
 {
     SVGSVGElement::layout(state);
+    m_needsLayout = false;
+    m_intrinsicSizeFromContent = false;
 
     LengthContext lengthContext(this);
     if(!width().isPercent()) {
@@ -726,6 +1066,7 @@ void SVGRootElement::layout(SVGLayoutState& state)
     }
 
     if(!m_intrinsicWidth || !m_intrinsicHeight) {
+        m_intrinsicSizeFromContent = true;
         auto boundingBox = paintBoundingBox();
         if(!m_intrinsicWidth)
             m_intrinsicWidth = boundingBox.right();
@@ -735,10 +1076,243 @@ void SVGRootElement::layout(SVGLayoutState& state)
     }
 }
 
+void SVGRootElement::build()
+{
+    NOVASVG_TRACE_SCOPE("build");
+    SVGSVGElement::build();
+    collectAnimatedAttributes();
+}
+
+void SVGRootElement::collectAnimatedAttributes()
+{
+    m_animatedAttributes.clear();
+    transverse([this](SVGElement* element) {
+        if(!element->isAnimationElement())
+            return;
+        auto animation = static_cast<const SVGAnimationElement*>(element);
+        auto targetElement = animation->targetElement();
+        if(targetElement == nullptr)
+            return;
+        auto it = std::find_if(m_animatedAttributes.begin(), m_animatedAttributes.end(), [&](const auto& attribute) {
+            return targetElement == attribute.element() && animation->targetProperty() == attribute.id();
+        });
+
+        if(it == m_animatedAttributes.end())
+            it = m_animatedAttributes.emplace(it, targetElement, animation->targetProperty());
+        it->addAnimation(animation);
+    });
+}
+
 void SVGRootElement::forceLayout()
 {
-    SVGLayoutState state;
+    NOVASVG_TRACE_SCOPE("layout");
+    SVGStyleCache styleCache;
+    SVGLayoutState state(&styleCache);
     layout(state);
+    updateBoundingBoxes();
+}
+
+void SVGRootElement::updateBoundingBoxes()
+{
+    // The getters memoize bottom-up, following references to clips, masks and markers in
+    // whatever order they are needed.
+    transverse([](SVGElement* element) {
+        element->fillBoundingBox();
+        element->paintBoundingBox();
+    });
+}
+
+float SVGRootElement::animationDuration() const
+{
+    float duration = 0.f;
+    for(const auto& attribute : m_animatedAttributes) {
+        for(auto animation : attribute.animations()) {
+            duration = std::max(duration, animation->endTime());
+        }
+    }
+
+    return duration;
+}
+
+void SVGRootElement::setAnimationTime(float time)
+{
+    const auto needsLayout = m_needsLayout;
+    std::vector<SVGElement*> elements;
+    for(auto& attribute : m_animatedAttributes) {
+        if(attribute.update(time)) {
+            elements.push_back(attribute.element());
+        }
+    }
+
+    if(!needsLayout && !elements.empty()) {
+        layoutElements(elements);
+    }
+}
+
+static bool isResourceElement(const SVGElement* element)
+{
+    switch(element->id()) {
+    case ElementID::Defs:
+    case ElementID::Symbol:
+    case ElementID::Marker:
+    case ElementID::ClipPath:
+    case ElementID::Mask:
+    case ElementID::Filter:
+    case ElementID::LinearGradient:
+    case ElementID::RadialGradient:
+    case ElementID::Pattern:
+    case ElementID::Style:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static Rect userPaintBoundingBox(const SVGElement* element)
+{
+    auto transform = element->localTransform();
+    for(auto parent = element->parentElement(); parent; parent = parent->parentElement())
+        transform.postMultiply(parent->localTransform());
+    return transform.mapRect(element->paintBoundingBox());
+}
+
+static bool uniteFilterRegions(const SVGElement* element, Rect& damagedRect)
+{
+    if(isResourceElement(element))
+        return false;
+    bool changed = false;
+    if(element->filter()) {
+        // A filter reads pixels around its output, so a partly damaged filtered element is repainted whole.
+        auto boundingBox = userPaintBoundingBox(element);
+        auto intersection = boundingBox.intersected(damagedRect);
+        auto united = damagedRect.united(boundingBox);
+        if(!intersection.isEmpty() && (united.w > damagedRect.w || united.h > damagedRect.h)) {
+            damagedRect = united;
+            changed = true;
+        }
+    }
+
+    for(const auto& child : element->children()) {
+        if(auto childElement = toSVGElement(child); childElement && uniteFilterRegions(childElement, damagedRect)) {
+            changed = true;
+        }
+    }
+
+    return changed;
+}
+
+void SVGRootElement::addDamage(const SVGElement* element)
+{
+    if(m_fullDamage)
+        return;
+    for(auto parent = element; parent; parent = parent->parentElement()) {
+        if(element == this || isResourceElement(parent)) {
+            addFullDamage();
+            return;
+        }
+    }
+
+    // Text chunks are laid out together, so any change can move the whole text element.
+    while(element->id() == ElementID::Tspan && element->parentElement())
+        element = element->parentElement();
+    if(std::find(m_damagedElements.begin(), m_damagedElements.end(), element) != m_damagedElements.end())
+        return;
+    m_damagedElements.push_back(element);
+    m_damagedRect.unite(userPaintBoundingBox(element));
+}
+
+void SVGRootElement::addFullDamage()
+{
+    m_fullDamage = true;
+    m_damagedElements.clear();
+    m_damagedRect = Rect::Invalid;
+}
+
+void SVGRootElement::clearDamage()
+{
+    m_fullDamage = false;
+    m_damagedElements.clear();
+    m_damagedRect = Rect::Invalid;
+}
+
+Rect SVGRootElement::damagedRect() const
+{
+    auto damagedRect = m_damagedRect;
+    for(auto element : m_damagedElements)
+        damagedRect.unite(userPaintBoundingBox(element));
+    if(!damagedRect.isValid())
+        return Rect::Empty;
+    bool changed = true;
+    while(changed) {
+        changed = uniteFilterRegions(this, damagedRect);
+    }
+
+    return damagedRect;
+}
+
+void SVGRootElement::layoutElements(const std::vector<SVGElement*>& elements)
+{
+    NOVASVG_TRACE_SCOPE("layoutPartial", std::string_view(), elements.size());
+    if(m_intrinsicSizeFromContent) {
+        forceLayout();
+        return;
+    }
+
+    std::vector<SVGElement*> layoutRoots;
+    for(auto element : elements) {
+        // Text chunks are positioned as a whole, so a tspan is laid out from its text element.
+        while(element->id() == ElementID::Tspan && element->parentElement())
+            element = element->parentElement();
+        if(element == this) {
+            forceLayout();
+            return;
+        }
+
+        layoutRoots.push_back(element);
+    }
+
+    auto isLaidOutByAncestor = [&layoutRoots](const SVGElement* element) {
+        for(auto parent = element->parentElement(); parent; parent = parent->parentElement()) {
+            if(std::find(layoutRoots.begin(), layoutRoots.end(), parent) != layoutRoots.end()) {
+                return true;
+            }
+        }
+
+        return false;
+    };
+
+    std::sort(layoutRoots.begin(), layoutRoots.end());
+    layoutRoots.erase(std::unique(layoutRoots.begin(), layoutRoots.end()), layoutRoots.end());
+
+    bool invalidateAll = false;
+    SVGStyleCache styleCache;
+    for(auto element : layoutRoots) {
+        if(isLaidOutByAncestor(element))
+            continue;
+        std::vector<const SVGElement*> ancestors;
+        for(auto parent = element->parentElement(); parent; parent = parent->parentElement()) {
+            if(parent->isHiddenElement())
+                invalidateAll = true;
+            parent->invalidateBoundingBoxes();
+            ancestors.push_back(parent);
+        }
+
+        std::list<SVGLayoutState> states;
+        states.emplace_back(&styleCache);
+        for(auto it = ancestors.rbegin(); it != ancestors.rend(); ++it)
+            states.emplace_back(states.back(), *it);
+        if(element->isHiddenElement())
+            invalidateAll = true;
+        element->layout(states.back());
+    }
+
+    if(invalidateAll) {
+        // Resources are referenced from elsewhere in the tree; drop every cached bounding box.
+        transverse([](SVGElement* element) { element->invalidateBoundingBoxes(); });
+    }
+
+    updateBoundingBoxes();
+    m_needsLayout = false;
 }
 
 SVGUseElement::SVGUseElement(Document* document)
@@ -768,8 +1342,9 @@ Transform SVGUseElement::localTransform() const
 
 void SVGUseElement::render(SVGRenderState& state) const
 {
-    if(isDisplayNone())
+    if(state.cull(isDisplayNone()))
         return;
+    NOVASVG_TRACE_SCOPE("use", getAttribute(PropertyID::Id));
     SVGBlendInfo blendInfo(this);
     SVGRenderState newState(this, state, localTransform());
     newState.beginGroup(blendInfo);
@@ -779,8 +1354,16 @@ void SVGUseElement::render(SVGRenderState& state) const
 
 void SVGUseElement::build()
 {
-    if(auto targetElement = getTargetElement(document())) {
+    // Nested references can multiply the tree exponentially; stop expanding once over budget.
+    if(isOverMemoryBudget()) {
+        SVGGraphicsElement::build();
+        return;
+    }
+
+    resolveReferences();
+    if(auto targetElement = getTargetElement()) {
         if(auto newElement = cloneTargetElement(targetElement)) {
+            m_clonedElement = newElement.get();
             addChild(std::move(newElement));
         }
     }
@@ -879,8 +1462,9 @@ Rect SVGImageElement::strokeBoundingBox() const
 
 void SVGImageElement::render(SVGRenderState& state) const
 {
-    if(m_image.isNull() || isDisplayNone() || isVisibilityHidden())
+    if(state.cull(m_image.isNull() || isDisplayNone() || isVisibilityHidden() || state.isOutsideCanvas(paintBoundingBox(), localTransform())))
         return;
+    NOVASVG_TRACE_SCOPE("image", getAttribute(PropertyID::Id), int64_t(m_image.width()) * m_image.height());
     Rect dstRect(fillBoundingBox());
     Rect srcRect(0, 0, m_image.width(), m_image.height());
     if(dstRect.isEmpty() || srcRect.isEmpty())
@@ -930,8 +1514,9 @@ SVGGElement::SVGGElement(Document* document)
 
 void SVGGElement::render(SVGRenderState& state) const
 {
-    if(isDisplayNone())
+    if(state.cull(isDisplayNone()))
         return;
+    NOVASVG_TRACE_SCOPE("g", getAttribute(PropertyID::Id));
     SVGBlendInfo blendInfo(this);
     SVGRenderState newState(this, state, localTransform());
     newState.beginGroup(blendInfo);
@@ -1010,6 +1595,8 @@ void SVGMarkerElement::renderMarker(SVGRenderState& state, const Point& origin,
 {
     if(state.hasCycleReference(this))
         return;
+    if(auto stats = state.stats())
+        stats->markerRenders++;
     SVGBlendInfo blendInfo(this);
     SVGRenderState newState(this, state, markerTransform(origin, angle, strokeWidth));
     newState.beginGroup(blendInfo);
@@ -1049,7 +1636,19 @@ void SVGClipPathElement::applyClipMask(SVGRenderState& state) const
 {
     if(state.hasCycleReference(this))
         return;
-    auto maskImage = Canvas::create(state.currentTransform().mapRect(state.paintBoundingBox()));
+    NOVASVG_TRACE_SCOPE("clipMask", getAttribute(PropertyID::Id));
+    StatsTimer timer(state.stats(), &RenderStats::maskingTime);
+    auto maskExtents = state.currentTransform().mapRect(state.paintBoundingBox());
+    maskExtents.intersect(state->extents());
+    if(!state->canCreateLayer(maskExtents)) {
+        // Hide the whole group rather than paint it unclipped.
+        state->clear();
+        return;
+    }
+
+    if(auto stats = state.stats())
+        stats->clipMasks++;
+    auto maskImage = state->createLayer(maskExtents);
     auto currentTransform = state.currentTransform() * localTransform();
     if(m_clipPathUnits.value() == Units::ObjectBoundingBox) {
         auto bbox = state.fillBoundingBox();
@@ -1190,7 +1789,19 @@ void SVGMaskElement::applyMask(SVGRenderState& state) const
 {
     if(state.hasCycleReference(this))
         return;
-    auto maskImage = Canvas::create(state.currentTransform().mapRect(state.paintBoundingBox()));
+    NOVASVG_TRACE_SCOPE("mask", getAttribute(PropertyID::Id));
+    StatsTimer timer(state.stats(), &RenderStats::maskingTime);
+    auto maskExtents = state.currentTransform().mapRect(state.paintBoundingBox());
+    maskExtents.intersect(state->extents());
+    if(!state->canCreateLayer(maskExtents)) {
+        // Hide the whole group rather than paint it unmasked.
+        state->clear();
+        return;
+    }
+
+    if(auto stats = state.stats())
+        stats->masks++;
+    auto maskImage = state->createLayer(maskExtents);
     maskImage->clipRect(maskRect(state.element()), FillRule::NonZero, state.currentTransform());
 
     auto currentTransform = state.currentTransform();
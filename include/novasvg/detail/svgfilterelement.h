@@ -0,0 +1,218 @@
+#ifndef NOVASVG_SVGFILTERELEMENT_H
+#define NOVASVG_SVGFILTERELEMENT_H
+
+#include "svgelement.h"
+
+namespace novasvg {
+
+class SVGFilterContext;
+
+class SVGFilterElement final : public SVGElement {
+public:
+    SVGFilterElement(Document* document);
+
+    const SVGLength& x() const { return m_x; }
+    const SVGLength& y() const { return m_y; }
+    const SVGLength& width() const { return m_width; }
+    const SVGLength& height() const { return m_height; }
+    const SVGEnumeration<Units>& filterUnits() const { return m_filterUnits; }
+    const SVGEnumeration<Units>& primitiveUnits() const { return m_primitiveUnits; }
+
+    Rect filterRegion(const SVGElement* element) const;
+    std::shared_ptr<Canvas> applyFilter(const SVGRenderState& state) const;
+
+private:
+    SVGLength m_x;
+    SVGLength m_y;
+    SVGLength m_width;
+    SVGLength m_height;
+    SVGEnumeration<Units> m_filterUnits;
+    SVGEnumeration<Units> m_primitiveUnits;
+};
+
+class SVGFilterPrimitiveElement : public SVGElement {
+public:
+    SVGFilterPrimitiveElement(Document* document, ElementID id);
+
+    bool isFilterPrimitiveElement() const final { return true; }
+
+    const SVGLength& x() const { return m_x; }
+    const SVGLength& y() const { return m_y; }
+    const SVGLength& width() const { return m_width; }
+    const SVGLength& height() const { return m_height; }
+    const SVGString& result() const { return m_result; }
+
+    Rect primitiveSubregion(const SVGFilterContext& context) const;
+    virtual void collectInputs(std::vector<const std::string*>&) const {}
+    virtual std::shared_ptr<Canvas> apply(SVGFilterContext& context) const = 0;
+
+private:
+    SVGLength m_x;
+    SVGLength m_y;
+    SVGLength m_width;
+    SVGLength m_height;
+    SVGString m_result;
+};
+
+class SVGFeFloodElement final : public SVGFilterPrimitiveElement {
+public:
+    SVGFeFloodElement(Document* document);
+
+    void layoutElement(const SVGLayoutState& state) final;
+    std::shared_ptr<Canvas> apply(SVGFilterContext& context) const final;
+
+private:
+    Color m_flood_color = Color::Black;
+    float m_flood_opacity = 1.f;
+};
+
+class SVGFeOffsetElement final : public SVGFilterPrimitiveElement {
+public:
+    SVGFeOffsetElement(Document* document);
+
+    const SVGString& in() const { return m_in; }
+    const SVGNumber& dx() const { return m_dx; }
+    const SVGNumber& dy() const { return m_dy; }
+
+    void collectInputs(std::vector<const std::string*>& inputs) const final { inputs.push_back(&m_in.value()); }
+    std::shared_ptr<Canvas> apply(SVGFilterContext& context) const final;
+
+private:
+    SVGString m_in;
+    SVGNumber m_dx;
+    SVGNumber m_dy;
+};
+
+class SVGFeGaussianBlurElement final : public SVGFilterPrimitiveElement {
+public:
+    SVGFeGaussianBlurElement(Document* document);
+
+    const SVGString& in() const { return m_in; }
+    const SVGNumberList& stdDeviation() const { return m_stdDeviation; }
+
+    void collectInputs(std::vector<const std::string*>& inputs) const final { inputs.push_back(&m_in.value()); }
+    std::shared_ptr<Canvas> apply(SVGFilterContext& context) const final;
+
+private:
+    SVGString m_in;
+    SVGNumberList m_stdDeviation;
+};
+
+class SVGFeCompositeElement final : public SVGFilterPrimitiveElement {
+public:
+    SVGFeCompositeElement(Document* document);
+
+    const SVGString& in() const { return m_in; }
+    const SVGString& in2() const { return m_in2; }
+    const SVGEnumeration<CompositeOperator>& op() const { return m_operator; }
+    const SVGNumber& k1() const { return m_k1; }
+    const SVGNumber& k2() const { return m_k2; }
+    const SVGNumber& k3() const { return m_k3; }
+    const SVGNumber& k4() const { return m_k4; }
+
+    void collectInputs(std::vector<const std::string*>& inputs) const final { inputs.insert(inputs.end(), {&m_in.value(), &m_in2.value()}); }
+    std::shared_ptr<Canvas> apply(SVGFilterContext& context) const final;
+
+private:
+    SVGString m_in;
+    SVGString m_in2;
+    SVGEnumeration<CompositeOperator> m_operator;
+    SVGNumber m_k1;
+    SVGNumber m_k2;
+    SVGNumber m_k3;
+    SVGNumber m_k4;
+};
+
+class SVGFeMergeNodeElement final : public SVGElement {
+public:
+    SVGFeMergeNodeElement(Document* document);
+
+    const SVGString& in() const { return m_in; }
+
+private:
+    SVGString m_in;
+};
+
+class SVGFeMergeElement final : public SVGFilterPrimitiveElement {
+public:
+    SVGFeMergeElement(Document* document);
+
+    void collectInputs(std::vector<const std::string*>& inputs) const final;
+    std::shared_ptr<Canvas> apply(SVGFilterContext& context) const final;
+};
+
+class SVGFeColorMatrixElement final : public SVGFilterPrimitiveElement {
+public:
+    SVGFeColorMatrixElement(Document* document);
+
+    const SVGString& in() const { return m_in; }
+    const SVGEnumeration<ColorMatrixType>& type() const { return m_type; }
+    const SVGNumberList& values() const { return m_values; }
+
+    void collectInputs(std::vector<const std::string*>& inputs) const final { inputs.push_back(&m_in.value()); }
+    std::shared_ptr<Canvas> apply(SVGFilterContext& context) const final;
+
+private:
+    SVGString m_in;
+    SVGEnumeration<ColorMatrixType> m_type;
+    SVGNumberList m_values;
+};
+
+class SVGFeBlendElement final : public SVGFilterPrimitiveElement {
+public:
+    SVGFeBlendElement(Document* document);
+
+    const SVGString& in() const { return m_in; }
+    const SVGString& in2() const { return m_in2; }
+    const SVGEnumeration<FilterBlendMode>& mode() const { return m_mode; }
+
+    void collectInputs(std::vector<const std::string*>& inputs) const final { inputs.insert(inputs.end(), {&m_in.value(), &m_in2.value()}); }
+    std::shared_ptr<Canvas> apply(SVGFilterContext& context) const final;
+
+private:
+    SVGString m_in;
+    SVGString m_in2;
+    SVGEnumeration<FilterBlendMode> m_mode;
+};
+
+// Runs the primitives of a filter as a graph: every intermediate image is released once its last consumer has run.
+class SVGFilterContext {
+public:
+    SVGFilterContext(const SVGFilterElement* filter, const SVGRenderState& state);
+
+    const SVGElement* element() const { return m_element; }
+    const Transform& currentTransform() const { return m_currentTransform; }
+    const Rect& filterRegion() const { return m_filterRegion; }
+    Units primitiveUnits() const { return m_primitiveUnits; }
+    int threads() const { return m_threads; }
+
+    Size primitiveSize(float w, float h) const;
+    std::shared_ptr<Canvas> createImage() const;
+    std::shared_ptr<Canvas> getInput(const std::string& in);
+    std::shared_ptr<Canvas> run(const std::vector<const SVGFilterPrimitiveElement*>& primitives);
+
+    void forEachTile(int count, const std::function<void(int)>& task) const;
+    void forEachBand(int height, const std::function<void(int, int)>& task) const;
+
+private:
+    enum { SourceGraphicSlot = 0, SourceAlphaSlot = 1, FirstResultSlot = 2 };
+
+    int resolveInput(const std::string& in) const;
+    void addResult(int index, const std::string& name);
+
+    const SVGElement* m_element;
+    const Transform m_currentTransform;
+    const Rect m_filterRegion;
+    const Units m_primitiveUnits;
+    const int m_threads;
+    const Rect m_extents;
+    const std::shared_ptr<Canvas> m_canvas;
+    std::vector<std::shared_ptr<Canvas>> m_images;
+    std::vector<int> m_uses;
+    std::map<std::string, int, std::less<>> m_results;
+    int m_lastResult = -1;
+};
+
+} // namespace novasvg
+
+#endif // NOVASVG_SVGFILTERELEMENT_H
@@ -0,0 +1,897 @@
+#include <cmath>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace novasvg {
+
+SVGFilterElement::SVGFilterElement(Document* document)
+    : SVGElement(document, ElementID::Filter)
+    , m_x(PropertyID::X, LengthDirection::Horizontal, LengthNegativeMode::Allow, -10.f, LengthUnits::Percent)
+    , m_y(PropertyID::Y, LengthDirection::Vertical, LengthNegativeMode::Allow, -10.f, LengthUnits::Percent)
+    , m_width(PropertyID::Width, LengthDirection::Horizontal, LengthNegativeMode::Forbid, 120.f, LengthUnits::Percent)
+    , m_height(PropertyID::Height, LengthDirection::Vertical, LengthNegativeMode::Forbid, 120.f, LengthUnits::Percent)
+    , m_filterUnits(PropertyID::FilterUnits, Units::ObjectBoundingBox)
+    , m_primitiveUnits(PropertyID::PrimitiveUnits, Units::UserSpaceOnUse)
+{
+    addProperty(m_x);
+    addProperty(m_y);
+    addProperty(m_width);
+    addProperty(m_height);
+    addProperty(m_filterUnits);
+    addProperty(m_primitiveUnits);
+}
+
+Rect SVGFilterElement::filterRegion(const SVGElement* element) const
+{
+    LengthContext lengthContext(this, m_filterUnits.value());
+    Rect filterRegion = {
+        lengthContext.valueForLength(m_x),
+        lengthContext.valueForLength(m_y),
+        lengthContext.valueForLength(m_width),
+        lengthContext.valueForLength(m_height)
+    };
+
+    if(m_filterUnits.value() == Units::ObjectBoundingBox) {
+        auto bbox = element->fillBoundingBox();
+        filterRegion.x = filterRegion.x * bbox.w + bbox.x;
+        filterRegion.y = filterRegion.y * bbox.h + bbox.y;
+        filterRegion.w = filterRegion.w * bbox.w;
+        filterRegion.h = filterRegion.h * bbox.h;
+    }
+
+    return filterRegion;
+}
+
+inline const SVGFilterPrimitiveElement* toSVGFilterPrimitiveElement(const SVGNode* node)
+{
+    if(node && node->isFilterPrimitiveElement())
+        return static_cast<const SVGFilterPrimitiveElement*>(node);
+    return nullptr;
+}
+
+class FilterPixels {
+public:
+    explicit FilterPixels(const Canvas& image)
+        : m_data(plutovg_surface_get_data(image.surface()))
+        , m_width(image.width())
+        , m_height(image.height())
+        , m_stride(plutovg_surface_get_stride(image.surface()))
+    {}
+
+    uint32_t* row(int y) const { return reinterpret_cast<uint32_t*>(m_data + y * m_stride); }
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+
+private:
+    unsigned char* m_data;
+    const int m_width;
+    const int m_height;
+    const int m_stride;
+};
+
+static void clipToSubregion(const Canvas& image, const Rect& subregion)
+{
+    FilterPixels pixels(image);
+    auto l = std::clamp(static_cast<int>(std::floor(subregion.x)) - image.x(), 0, pixels.width());
+    auto t = std::clamp(static_cast<int>(std::floor(subregion.y)) - image.y(), 0, pixels.height());
+    auto r = std::clamp(static_cast<int>(std::ceil(subregion.right())) - image.x(), l, pixels.width());
+    auto b = std::clamp(static_cast<int>(std::ceil(subregion.bottom())) - image.y(), t, pixels.height());
+    for(int y = 0; y < pixels.height(); ++y) {
+        auto row = pixels.row(y);
+        if(y < t || y >= b) {
+            std::memset(row, 0, pixels.width() * 4);
+            continue;
+        }
+
+        std::memset(row, 0, l * 4);
+        std::memset(row + r, 0, (pixels.width() - r) * 4);
+    }
+}
+
+std::shared_ptr<Canvas> SVGFilterElement::applyFilter(const SVGRenderState& state) const
+{
+    NOVASVG_TRACE_SCOPE("filter", getAttribute(PropertyID::Id));
+    StatsTimer timer(state.stats(), &RenderStats::filterTime);
+    std::vector<const SVGFilterPrimitiveElement*> primitives;
+    for(const auto& child : children()) {
+        if(auto primitive = toSVGFilterPrimitiveElement(child.get())) {
+            primitives.push_back(primitive);
+        }
+    }
+
+    // Every result, SourceAlpha and a blur's scratch image may be alive at once; without room
+    // for them the source graphic is passed through unfiltered.
+    if(!state->canCreateLayer(state->extents(), primitives.size() + 2))
+        return state.canvas();
+    if(auto stats = state.stats())
+        stats->filterRenders++;
+
+    SVGFilterContext context(this, state);
+    return context.run(primitives);
+}
+
+SVGFilterPrimitiveElement::SVGFilterPrimitiveElement(Document* document, ElementID id)
+    : SVGElement(document, id)
+    , m_x(PropertyID::X, LengthDirection::Horizontal, LengthNegativeMode::Allow, 0.f, LengthUnits::Percent)
+    , m_y(PropertyID::Y, LengthDirection::Vertical, LengthNegativeMode::Allow, 0.f, LengthUnits::Percent)
+    , m_width(PropertyID::Width, LengthDirection::Horizontal, LengthNegativeMode::Forbid, 100.f, LengthUnits::Percent)
+    , m_height(PropertyID::Height, LengthDirection::Vertical, LengthNegativeMode::Forbid, 100.f, LengthUnits::Percent)
+    , m_result(PropertyID::Result)
+{
+    addProperty(m_x);
+    addProperty(m_y);
+    addProperty(m_width);
+    addProperty(m_height);
+    addProperty(m_result);
+}
+
+Rect SVGFilterPrimitiveElement::primitiveSubregion(const SVGFilterContext& context) const
+{
+    LengthContext lengthContext(this, context.primitiveUnits());
+    auto subregion = context.filterRegion();
+    auto bbox = Rect(0, 0, 1, 1);
+    if(context.primitiveUnits() == Units::ObjectBoundingBox)
+        bbox = context.element()->fillBoundingBox();
+    if(hasAttribute(PropertyID::X))
+        subregion.x = lengthContext.valueForLength(m_x) * bbox.w + bbox.x;
+    if(hasAttribute(PropertyID::Y))
+        subregion.y = lengthContext.valueForLength(m_y) * bbox.h + bbox.y;
+    if(hasAttribute(PropertyID::Width))
+        subregion.w = lengthContext.valueForLength(m_width) * bbox.w;
+    if(hasAttribute(PropertyID::Height))
+        subregion.h = lengthContext.valueForLength(m_height) * bbox.h;
+    return subregion.intersected(context.filterRegion());
+}
+
+SVGFeFloodElement::SVGFeFloodElement(Document* document)
+    : SVGFilterPrimitiveElement(document, ElementID::FeFlood)
+{
+}
+
+void SVGFeFloodElement::layoutElement(const SVGLayoutState& state)
+{
+    m_flood_color = state.flood_color();
+    m_flood_opacity = state.flood_opacity();
+    SVGFilterPrimitiveElement::layoutElement(state);
+}
+
+std::shared_ptr<Canvas> SVGFeFloodElement::apply(SVGFilterContext& context) const
+{
+    auto image = context.createImage();
+    auto color = plutovg_premultiply_argb(m_flood_color.colorWithAlpha(m_flood_opacity).value());
+    FilterPixels pixels(*image);
+    for(int y = 0; y < pixels.height(); ++y) {
+        plutovg_memfill32(pixels.row(y), pixels.width(), color);
+    }
+
+    return image;
+}
+
+SVGFeOffsetElement::SVGFeOffsetElement(Document* document)
+    : SVGFilterPrimitiveElement(document, ElementID::FeOffset)
+    , m_in(PropertyID::In)
+    , m_dx(PropertyID::Dx, 0.f)
+    , m_dy(PropertyID::Dy, 0.f)
+{
+    addProperty(m_in);
+    addProperty(m_dx);
+    addProperty(m_dy);
+}
+
+std::shared_ptr<Canvas> SVGFeOffsetElement::apply(SVGFilterContext& context) const
+{
+    auto input = context.getInput(m_in.value());
+    auto image = context.createImage();
+    const auto& matrix = context.currentTransform().matrix();
+    auto offset = context.primitiveSize(m_dx.value(), m_dy.value());
+    auto dx = static_cast<int>(std::lround(matrix.a * offset.w + matrix.c * offset.h));
+    auto dy = static_cast<int>(std::lround(matrix.b * offset.w + matrix.d * offset.h));
+
+    FilterPixels src(*input);
+    FilterPixels dst(*image);
+    auto l = std::clamp(dx, 0, dst.width());
+    auto r = std::clamp(dst.width() + dx, l, dst.width());
+    for(int y = std::max(0, dy); y < std::min(dst.height(), dst.height() + dy); ++y) {
+        std::memcpy(dst.row(y) + l, src.row(y - dy) + l - dx, (r - l) * 4);
+    }
+
+    return image;
+}
+
+// A box filter covering [x - left, x + right]; three of them approximate a Gaussian.
+struct BoxBlurPass {
+    int left;
+    int right;
+};
+
+static int computeBoxBlurPasses(float deviation, BoxBlurPass passes[3])
+{
+    auto size = static_cast<int>(std::floor(deviation * 3.f * std::sqrt(2.f * PLUTOVG_PI) / 4.f + 0.5f));
+    if(size <= 1)
+        return 0;
+    auto half = size / 2;
+    if(size % 2 == 1) {
+        passes[0] = passes[1] = passes[2] = {half, half};
+    } else {
+        passes[0] = {half, half - 1};
+        passes[1] = {half - 1, half};
+        passes[2] = {half, half};
+    }
+
+    return 3;
+}
+
+#ifdef __SSE2__
+
+static inline __m128i unpackPixel(uint32_t pixel)
+{
+    auto zero = _mm_setzero_si128();
+    auto value = _mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(pixel)), zero);
+    return _mm_unpacklo_epi16(value, zero);
+}
+
+static inline uint32_t packPixel(__m128i sum, __m128 scale)
+{
+    auto value = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(sum), scale), _mm_set1_ps(0.5f)));
+    value = _mm_packs_epi32(value, value);
+    value = _mm_packus_epi16(value, value);
+    return static_cast<uint32_t>(_mm_cvtsi128_si32(value));
+}
+
+#endif
+
+// Running sums make each pass O(1) per pixel whatever the radius; pixels outside the image are transparent.
+static void boxBlurRow(const uint32_t* src, uint32_t* dst, int width, const BoxBlurPass& pass)
+{
+    const auto scale = 1.f / (pass.left + pass.right + 1);
+#ifdef __SSE2__
+    const auto vscale = _mm_set1_ps(scale);
+    auto sum = _mm_setzero_si128();
+    for(int x = 0; x < width && x <= pass.right; ++x)
+        sum = _mm_add_epi32(sum, unpackPixel(src[x]));
+    for(int x = 0; x < width; ++x) {
+        dst[x] = packPixel(sum, vscale);
+        if(x + pass.right + 1 < width)
+            sum = _mm_add_epi32(sum, unpackPixel(src[x + pass.right + 1]));
+        if(x - pass.left >= 0) {
+            sum = _mm_sub_epi32(sum, unpackPixel(src[x - pass.left]));
+        }
+    }
+#else
+    int sum[4] = {0, 0, 0, 0};
+    auto add = [&sum](uint32_t pixel, int sign) {
+        for(int i = 0; i < 4; ++i) {
+            sum[i] += sign * static_cast<int>((pixel >> (i * 8)) & 0xFF);
+        }
+    };
+
+    for(int x = 0; x < width && x <= pass.right; ++x)
+        add(src[x], 1);
+    for(int x = 0; x < width; ++x) {
+        uint32_t pixel = 0;
+        for(int i = 0; i < 4; ++i)
+            pixel |= static_cast<uint32_t>(sum[i] * scale + 0.5f) << (i * 8);
+        dst[x] = pixel;
+        if(x + pass.right + 1 < width)
+            add(src[x + pass.right + 1], 1);
+        if(x - pass.left >= 0) {
+            add(src[x - pass.left], -1);
+        }
+    }
+#endif
+}
+
+// The vertical pass keeps one running sum per column of the tile [x0, x1) and walks its rows [y0, y1), so memory is
+// read sequentially; the sums start from the halo rows above the tile, which makes every tile independent.
+static void boxBlurColumns(const FilterPixels& src, const FilterPixels& dst, const BoxBlurPass& pass, int x0, int x1, int y0, int y1)
+{
+    const auto width = x1 - x0;
+    const auto height = src.height();
+    const auto scale = 1.f / (pass.left + pass.right + 1);
+    const auto haloTop = std::max(0, y0 - pass.left);
+    const auto haloBottom = std::min(height, y0 + pass.right + 1);
+#ifdef __SSE2__
+    const auto vscale = _mm_set1_ps(scale);
+    const auto half = _mm_set1_ps(0.5f);
+    const auto zero = _mm_setzero_si128();
+    std::vector<int32_t> sums(width * 4, 0);
+    auto data = reinterpret_cast<__m128i*>(sums.data());
+    for(int y = haloTop; y < haloBottom; ++y) {
+        auto row = src.row(y) + x0;
+        for(int x = 0; x < width; ++x) {
+            _mm_storeu_si128(data + x, _mm_add_epi32(_mm_loadu_si128(data + x), unpackPixel(row[x])));
+        }
+    }
+
+    for(int y = y0; y < y1; ++y) {
+        auto row = dst.row(y) + x0;
+        auto addRow = y + pass.right + 1 < height ? src.row(y + pass.right + 1) + x0 : nullptr;
+        auto subRow = y - pass.left >= 0 ? src.row(y - pass.left) + x0 : nullptr;
+        int x = 0;
+        for(; x + 4 <= width; x += 4) {
+            __m128i sum[4];
+            __m128i value[4];
+            for(int i = 0; i < 4; ++i) {
+                sum[i] = _mm_loadu_si128(data + x + i);
+                value[i] = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(sum[i]), vscale), half));
+            }
+
+            auto lo = _mm_packs_epi32(value[0], value[1]);
+            auto hi = _mm_packs_epi32(value[2], value[3]);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(row + x), _mm_packus_epi16(lo, hi));
+
+            // The per-row change fits in 16 bits; sign-extend it to 32 before accumulating.
+            auto added = addRow ? _mm_loadu_si128(reinterpret_cast<const __m128i*>(addRow + x)) : zero;
+            auto subtracted = subRow ? _mm_loadu_si128(reinterpret_cast<const __m128i*>(subRow + x)) : zero;
+            auto deltaLo = _mm_sub_epi16(_mm_unpacklo_epi8(added, zero), _mm_unpacklo_epi8(subtracted, zero));
+            auto deltaHi = _mm_sub_epi16(_mm_unpackhi_epi8(added, zero), _mm_unpackhi_epi8(subtracted, zero));
+            __m128i delta[4] = {
+                _mm_srai_epi32(_mm_unpacklo_epi16(deltaLo, deltaLo), 16),
+                _mm_srai_epi32(_mm_unpackhi_epi16(deltaLo, deltaLo), 16),
+                _mm_srai_epi32(_mm_unpacklo_epi16(deltaHi, deltaHi), 16),
+                _mm_srai_epi32(_mm_unpackhi_epi16(deltaHi, deltaHi), 16)
+            };
+
+            for(int i = 0; i < 4; ++i) {
+                _mm_storeu_si128(data + x + i, _mm_add_epi32(sum[i], delta[i]));
+            }
+        }
+
+        for(; x < width; ++x) {
+            auto sum = _mm_loadu_si128(data + x);
+            row[x] = packPixel(sum, vscale);
+            if(addRow)
+                sum = _mm_add_epi32(sum, unpackPixel(addRow[x]));
+            if(subRow)
+                sum = _mm_sub_epi32(sum, unpackPixel(subRow[x]));
+            _mm_storeu_si128(data + x, sum);
+        }
+    }
+#else
+    std::vector<int> sums(width * 4, 0);
+    auto add = [&sums, width](const uint32_t* row, int sign) {
+        for(int x = 0; x < width; ++x) {
+            for(int i = 0; i < 4; ++i) {
+                sums[x * 4 + i] += sign * static_cast<int>((row[x] >> (i * 8)) & 0xFF);
+            }
+        }
+    };
+
+    for(int y = haloTop; y < haloBottom; ++y)
+        add(src.row(y) + x0, 1);
+    for(int y = y0; y < y1; ++y) {
+        auto row = dst.row(y) + x0;
+        for(int x = 0; x < width; ++x) {
+            uint32_t pixel = 0;
+            for(int i = 0; i < 4; ++i)
+                pixel |= static_cast<uint32_t>(sums[x * 4 + i] * scale + 0.5f) << (i * 8);
+            row[x] = pixel;
+        }
+
+        if(y + pass.right + 1 < height)
+            add(src.row(y + pass.right + 1) + x0, 1);
+        if(y - pass.left >= 0) {
+            add(src.row(y - pass.left) + x0, -1);
+        }
+    }
+#endif
+}
+
+// Column strips keep the running sums of a vertical pass in L1; with several threads the strips are also cut into
+// row bands tall enough that re-reading each band's halo stays cheap.
+static void boxBlurColumns(const SVGFilterContext& context, const FilterPixels& src, const FilterPixels& dst, const BoxBlurPass& pass)
+{
+    constexpr int kStripWidth = 256;
+    const auto strips = (src.width() + kStripWidth - 1) / kStripWidth;
+    auto bandHeight = src.height();
+    if(context.threads() > 1) {
+        auto minBandHeight = std::max(64, 4 * (pass.left + pass.right + 1));
+        auto bands = std::clamp(src.height() / minBandHeight, 1, (4 * context.threads() + strips - 1) / strips);
+        bandHeight = (src.height() + bands - 1) / bands;
+    }
+
+    const auto bands = (src.height() + bandHeight - 1) / bandHeight;
+    context.forEachTile(strips * bands, [&](int index) {
+        auto x0 = (index % strips) * kStripWidth;
+        auto y0 = (index / strips) * bandHeight;
+        boxBlurColumns(src, dst, pass, x0, std::min(x0 + kStripWidth, src.width()), y0, std::min(y0 + bandHeight, src.height()));
+    });
+}
+
+// All three horizontal passes of a row run back to back through two row-sized temporaries.
+static void boxBlurRows(const SVGFilterContext& context, const FilterPixels& src, const FilterPixels& dst, const BoxBlurPass passes[3])
+{
+    context.forEachBand(src.height(), [&](int y0, int y1) {
+        std::vector<uint32_t> rowA(src.width());
+        std::vector<uint32_t> rowB(src.width());
+        for(int y = y0; y < y1; ++y) {
+            boxBlurRow(src.row(y), rowA.data(), src.width(), passes[0]);
+            boxBlurRow(rowA.data(), rowB.data(), src.width(), passes[1]);
+            boxBlurRow(rowB.data(), dst.row(y), src.width(), passes[2]);
+        }
+    });
+}
+
+SVGFeGaussianBlurElement::SVGFeGaussianBlurElement(Document* document)
+    : SVGFilterPrimitiveElement(document, ElementID::FeGaussianBlur)
+    , m_in(PropertyID::In)
+    , m_stdDeviation(PropertyID::StdDeviation)
+{
+    addProperty(m_in);
+    addProperty(m_stdDeviation);
+}
+
+std::shared_ptr<Canvas> SVGFeGaussianBlurElement::apply(SVGFilterContext& context) const
+{
+    auto input = context.getInput(m_in.value());
+    auto image = context.createImage();
+    const auto& values = m_stdDeviation.values();
+    auto deviationX = values.empty() ? 0.f : values[0];
+    auto deviationY = values.size() > 1 ? values[1] : deviationX;
+    auto deviation = context.primitiveSize(deviationX, deviationY);
+
+    BoxBlurPass passesX[3];
+    BoxBlurPass passesY[3];
+    auto numPassesX = computeBoxBlurPasses(deviation.w * context.currentTransform().xScale(), passesX);
+    auto numPassesY = computeBoxBlurPasses(deviation.h * context.currentTransform().yScale(), passesY);
+
+    FilterPixels src(*input);
+    FilterPixels dst(*image);
+    if(numPassesY > 0) {
+        auto scratch = context.createImage();
+        FilterPixels tmp(*scratch);
+        const auto& target = numPassesX > 0 ? tmp : dst;
+        const auto& other = numPassesX > 0 ? dst : tmp;
+        boxBlurColumns(context, src, target, passesY[0]);
+        boxBlurColumns(context, target, other, passesY[1]);
+        boxBlurColumns(context, other, target, passesY[2]);
+        if(numPassesX > 0)
+            boxBlurRows(context, tmp, dst, passesX);
+        return image;
+    }
+
+    if(numPassesX > 0) {
+        boxBlurRows(context, src, dst, passesX);
+        return image;
+    }
+
+    image->blendCanvas(*input, BlendMode::Src, 1.f);
+    return image;
+}
+
+SVGFeCompositeElement::SVGFeCompositeElement(Document* document)
+    : SVGFilterPrimitiveElement(document, ElementID::FeComposite)
+    , m_in(PropertyID::In)
+    , m_in2(PropertyID::In2)
+    , m_operator(PropertyID::Operator, CompositeOperator::Over)
+    , m_k1(PropertyID::K1, 0.f)
+    , m_k2(PropertyID::K2, 0.f)
+    , m_k3(PropertyID::K3, 0.f)
+    , m_k4(PropertyID::K4, 0.f)
+{
+    addProperty(m_in);
+    addProperty(m_in2);
+    addProperty(m_operator);
+    addProperty(m_k1);
+    addProperty(m_k2);
+    addProperty(m_k3);
+    addProperty(m_k4);
+}
+
+static BlendMode compositeBlendMode(CompositeOperator op)
+{
+    switch(op) {
+    case CompositeOperator::In:
+        return BlendMode::Src_In;
+    case CompositeOperator::Out:
+        return BlendMode::Src_Out;
+    case CompositeOperator::Atop:
+        return BlendMode::Src_Atop;
+    case CompositeOperator::Xor:
+        return BlendMode::Xor;
+    default:
+        return BlendMode::Src_Over;
+    }
+}
+
+std::shared_ptr<Canvas> SVGFeCompositeElement::apply(SVGFilterContext& context) const
+{
+    auto input = context.getInput(m_in.value());
+    auto input2 = context.getInput(m_in2.value());
+    auto image = context.createImage();
+    if(m_operator.value() != CompositeOperator::Arithmetic) {
+        image->blendCanvas(*input2, BlendMode::Src, 1.f);
+        image->blendCanvas(*input, compositeBlendMode(m_operator.value()), 1.f);
+        return image;
+    }
+
+    const auto k1 = m_k1.value() / 255.f;
+    const auto k2 = m_k2.value();
+    const auto k3 = m_k3.value();
+    const auto k4 = m_k4.value() * 255.f;
+
+    FilterPixels src(*input);
+    FilterPixels src2(*input2);
+    FilterPixels dst(*image);
+    context.forEachBand(dst.height(), [&](int y0, int y1) {
+        for(int y = y0; y < y1; ++y) {
+            auto row = src.row(y);
+            auto row2 = src2.row(y);
+            auto out = dst.row(y);
+            for(int x = 0; x < dst.width(); ++x) {
+                int channels[4];
+                for(int i = 0; i < 4; ++i) {
+                    float i1 = (row[x] >> (i * 8)) & 0xFF;
+                    float i2 = (row2[x] >> (i * 8)) & 0xFF;
+                    channels[i] = std::clamp(static_cast<int>(k1 * i1 * i2 + k2 * i1 + k3 * i2 + k4 + 0.5f), 0, 255);
+                }
+
+                auto a = channels[3];
+                out[x] = static_cast<uint32_t>(a) << 24 | std::min(channels[2], a) << 16 | std::min(channels[1], a) << 8 | std::min(channels[0], a);
+            }
+        }
+    });
+
+    return image;
+}
+
+SVGFeMergeNodeElement::SVGFeMergeNodeElement(Document* document)
+    : SVGElement(document, ElementID::FeMergeNode)
+    , m_in(PropertyID::In)
+{
+    addProperty(m_in);
+}
+
+SVGFeMergeElement::SVGFeMergeElement(Document* document)
+    : SVGFilterPrimitiveElement(document, ElementID::FeMerge)
+{
+}
+
+void SVGFeMergeElement::collectInputs(std::vector<const std::string*>& inputs) const
+{
+    for(const auto& child : children()) {
+        auto element = toSVGElement(child);
+        if(element && element->id() == ElementID::FeMergeNode) {
+            inputs.push_back(&static_cast<const SVGFeMergeNodeElement*>(element)->in().value());
+        }
+    }
+}
+
+std::shared_ptr<Canvas> SVGFeMergeElement::apply(SVGFilterContext& context) const
+{
+    auto image = context.createImage();
+    for(const auto& child : children()) {
+        auto element = toSVGElement(child);
+        if(element && element->id() == ElementID::FeMergeNode) {
+            auto node = static_cast<const SVGFeMergeNodeElement*>(element);
+            image->blendCanvas(*context.getInput(node->in().value()), BlendMode::Src_Over, 1.f);
+        }
+    }
+
+    return image;
+}
+
+SVGFeColorMatrixElement::SVGFeColorMatrixElement(Document* document)
+    : SVGFilterPrimitiveElement(document, ElementID::FeColorMatrix)
+    , m_in(PropertyID::In)
+    , m_type(PropertyID::Type, ColorMatrixType::Matrix)
+    , m_values(PropertyID::Values)
+{
+    addProperty(m_in);
+    addProperty(m_type);
+    addProperty(m_values);
+}
+
+std::shared_ptr<Canvas> SVGFeColorMatrixElement::apply(SVGFilterContext& context) const
+{
+    float matrix[20] = {
+        1, 0, 0, 0, 0,
+        0, 1, 0, 0, 0,
+        0, 0, 1, 0, 0,
+        0, 0, 0, 1, 0
+    };
+
+    const auto& values = m_values.values();
+    switch(m_type.value()) {
+    case ColorMatrixType::Matrix:
+        if(values.size() == 20)
+            std::copy(values.begin(), values.end(), matrix);
+        break;
+    case ColorMatrixType::Saturate: {
+        auto s = values.empty() ? 1.f : values[0];
+        const float saturate[20] = {
+            0.213f + 0.787f * s, 0.715f - 0.715f * s, 0.072f - 0.072f * s, 0, 0,
+            0.213f - 0.213f * s, 0.715f + 0.285f * s, 0.072f - 0.072f * s, 0, 0,
+            0.213f - 0.213f * s, 0.715f - 0.715f * s, 0.072f + 0.928f * s, 0, 0,
+            0, 0, 0, 1, 0
+        };
+
+        std::copy(saturate, saturate + 20, matrix);
+        break;
+    }
+
+    case ColorMatrixType::HueRotate: {
+        auto angle = (values.empty() ? 0.f : values[0]) * PLUTOVG_PI / 180.f;
+        auto c = std::cos(angle);
+        auto s = std::sin(angle);
+        const float hueRotate[20] = {
+            0.213f + c * 0.787f - s * 0.213f, 0.715f - c * 0.715f - s * 0.715f, 0.072f - c * 0.072f + s * 0.928f, 0, 0,
+            0.213f - c * 0.213f + s * 0.143f, 0.715f + c * 0.285f + s * 0.140f, 0.072f - c * 0.072f - s * 0.283f, 0, 0,
+            0.213f - c * 0.213f - s * 0.787f, 0.715f - c * 0.715f + s * 0.715f, 0.072f + c * 0.928f + s * 0.072f, 0, 0,
+            0, 0, 0, 1, 0
+        };
+
+        std::copy(hueRotate, hueRotate + 20, matrix);
+        break;
+    }
+
+    case ColorMatrixType::LuminanceToAlpha: {
+        const float luminanceToAlpha[20] = {
+            0, 0, 0, 0, 0,
+            0, 0, 0, 0, 0,
+            0, 0, 0, 0, 0,
+            0.2125f, 0.7154f, 0.0721f, 0, 0
+        };
+
+        std::copy(luminanceToAlpha, luminanceToAlpha + 20, matrix);
+        break;
+    }
+    }
+
+    auto input = context.getInput(m_in.value());
+    auto image = context.createImage();
+    FilterPixels src(*input);
+    FilterPixels dst(*image);
+    context.forEachBand(dst.height(), [&](int y0, int y1) {
+        for(int y = y0; y < y1; ++y) {
+            auto row = src.row(y);
+            auto out = dst.row(y);
+            for(int x = 0; x < dst.width(); ++x) {
+                auto pixel = row[x];
+                float a = (pixel >> 24) & 0xFF;
+                float r = (pixel >> 16) & 0xFF;
+                float g = (pixel >> 8) & 0xFF;
+                float b = (pixel >> 0) & 0xFF;
+                if(a > 0.f && a < 255.f) {
+                    r = r * 255.f / a;
+                    g = g * 255.f / a;
+                    b = b * 255.f / a;
+                }
+
+                auto transform = [&](const float* m) {
+                    return std::clamp(m[0] * r + m[1] * g + m[2] * b + m[3] * a + m[4] * 255.f, 0.f, 255.f);
+                };
+
+                auto na = transform(matrix + 15);
+                auto scale = na / 255.f;
+                auto nr = static_cast<uint32_t>(transform(matrix + 0) * scale + 0.5f);
+                auto ng = static_cast<uint32_t>(transform(matrix + 5) * scale + 0.5f);
+                auto nb = static_cast<uint32_t>(transform(matrix + 10) * scale + 0.5f);
+                out[x] = static_cast<uint32_t>(na + 0.5f) << 24 | nr << 16 | ng << 8 | nb;
+            }
+        }
+    });
+
+    return image;
+}
+
+SVGFeBlendElement::SVGFeBlendElement(Document* document)
+    : SVGFilterPrimitiveElement(document, ElementID::FeBlend)
+    , m_in(PropertyID::In)
+    , m_in2(PropertyID::In2)
+    , m_mode(PropertyID::Mode, FilterBlendMode::Normal)
+{
+    addProperty(m_in);
+    addProperty(m_in2);
+    addProperty(m_mode);
+}
+
+std::shared_ptr<Canvas> SVGFeBlendElement::apply(SVGFilterContext& context) const
+{
+    auto input = context.getInput(m_in.value());
+    auto input2 = context.getInput(m_in2.value());
+    auto image = context.createImage();
+    image->blendCanvas(*input2, BlendMode::Src, 1.f);
+    if(m_mode.value() == FilterBlendMode::Normal) {
+        image->blendCanvas(*input, BlendMode::Src_Over, 1.f);
+        return image;
+    }
+
+    // Premultiplied W3C compositing formulas with `in` as the source and `in2` as the backdrop.
+    const auto mode = m_mode.value();
+    FilterPixels src(*input);
+    FilterPixels dst(*image);
+    context.forEachBand(dst.height(), [&](int y0, int y1) {
+        for(int y = y0; y < y1; ++y) {
+            auto row = src.row(y);
+            auto out = dst.row(y);
+            for(int x = 0; x < dst.width(); ++x) {
+                auto sa = (row[x] >> 24) & 0xFF;
+                auto ba = (out[x] >> 24) & 0xFF;
+                auto ra = sa + ba - (sa * ba + 127) / 255;
+                uint32_t pixel = ra << 24;
+                for(int i = 0; i < 3; ++i) {
+                    auto sc = (row[x] >> (i * 8)) & 0xFF;
+                    auto bc = (out[x] >> (i * 8)) & 0xFF;
+                    uint32_t value = 0;
+                    switch(mode) {
+                    case FilterBlendMode::Multiply:
+                        value = ((255 - sa) * bc + (255 - ba) * sc + sc * bc + 127) / 255;
+                        break;
+                    case FilterBlendMode::Screen:
+                        value = sc + bc - (sc * bc + 127) / 255;
+                        break;
+                    case FilterBlendMode::Darken:
+                        value = (std::min((255 - sa) * bc + 255 * sc, (255 - ba) * sc + 255 * bc) + 127) / 255;
+                        break;
+                    case FilterBlendMode::Lighten:
+                        value = (std::max((255 - sa) * bc + 255 * sc, (255 - ba) * sc + 255 * bc) + 127) / 255;
+                        break;
+                    default:
+                        break;
+                    }
+
+                    pixel |= std::min(value, ra) << (i * 8);
+                }
+
+                out[x] = pixel;
+            }
+        }
+    });
+
+    return image;
+}
+
+SVGFilterContext::SVGFilterContext(const SVGFilterElement* filter, const SVGRenderState& state)
+    : m_element(state.element())
+    , m_currentTransform(state.currentTransform())
+    , m_filterRegion(filter->filterRegion(state.element()))
+    , m_primitiveUnits(filter->primitiveUnits().value())
+    , m_threads(state->renderOptions().threads > 0 ? state->renderOptions().threads : workerPool()->concurrency())
+    , m_extents(state.canvas()->extents())
+    , m_canvas(state.canvas())
+    , m_images({state.canvas(), nullptr})
+{
+}
+
+Size SVGFilterContext::primitiveSize(float w, float h) const
+{
+    if(m_primitiveUnits == Units::ObjectBoundingBox) {
+        auto bbox = m_element->fillBoundingBox();
+        return Size(w * bbox.w, h * bbox.h);
+    }
+
+    return Size(w, h);
+}
+
+std::shared_ptr<Canvas> SVGFilterContext::createImage() const
+{
+    return m_canvas->createLayer(m_extents);
+}
+
+std::shared_ptr<Canvas> SVGFilterContext::getInput(const std::string& in)
+{
+    auto slot = resolveInput(in);
+    if(slot == SourceAlphaSlot && m_images[slot] == nullptr) {
+        auto image = createImage();
+        FilterPixels src(*m_images[SourceGraphicSlot]);
+        FilterPixels dst(*image);
+        forEachBand(dst.height(), [&](int y0, int y1) {
+            for(int y = y0; y < y1; ++y) {
+                auto row = src.row(y);
+                auto out = dst.row(y);
+                for(int x = 0; x < dst.width(); ++x) {
+                    out[x] = row[x] & 0xFF000000;
+                }
+            }
+        });
+
+        m_images[slot] = std::move(image);
+    }
+
+    return m_images[slot];
+}
+
+std::shared_ptr<Canvas> SVGFilterContext::run(const std::vector<const SVGFilterPrimitiveElement*>& primitives)
+{
+    // Resolve every reference up front to count how many primitives read each image; the last result is read once
+    // more as the output. Results nobody reads are never computed.
+    std::vector<std::vector<int>> inputs(primitives.size());
+    m_images.resize(FirstResultSlot + primitives.size());
+    m_uses.assign(m_images.size(), 0);
+    std::vector<const std::string*> names;
+    for(size_t index = 0; index < primitives.size(); ++index) {
+        names.clear();
+        primitives[index]->collectInputs(names);
+        for(auto name : names) {
+            auto slot = resolveInput(*name);
+            inputs[index].push_back(slot);
+            if(slot == SourceAlphaSlot) {
+                // SourceAlpha is built lazily from SourceGraphic, which must outlive it.
+                inputs[index].push_back(SourceGraphicSlot);
+            }
+        }
+
+        for(auto slot : inputs[index]) {
+            m_uses[slot] += 1;
+        }
+
+        addResult(index, primitives[index]->result().value());
+    }
+
+    if(m_lastResult == -1)
+        return createImage();
+    auto output = m_lastResult;
+    m_uses[output] += 1;
+
+    m_results.clear();
+    m_lastResult = -1;
+    for(size_t index = 0; index < primitives.size(); ++index) {
+        if(m_canvas->interrupted())
+            return createImage();
+        auto slot = FirstResultSlot + index;
+        if(m_uses[slot] > 0) {
+            NOVASVG_TRACE_SCOPE("filterPrimitive", primitives[index]->result().value());
+            auto image = primitives[index]->apply(*this);
+            clipToSubregion(*image, m_currentTransform.mapRect(primitives[index]->primitiveSubregion(*this)));
+            m_images[slot] = std::move(image);
+        }
+
+        for(auto input : inputs[index]) {
+            if(--m_uses[input] == 0) {
+                m_images[input].reset();
+            }
+        }
+
+        addResult(index, primitives[index]->result().value());
+    }
+
+    return std::move(m_images[output]);
+}
+
+void SVGFilterContext::forEachTile(int count, const std::function<void(int)>& task) const
+{
+    workerPool()->parallelFor(count, m_threads, task);
+}
+
+void SVGFilterContext::forEachBand(int height, const std::function<void(int, int)>& task) const
+{
+    // Small images are not worth waking the workers for.
+    constexpr int kMinBandPixels = 1 << 15;
+    auto bands = std::min(4 * m_threads, static_cast<int>(static_cast<int64_t>(m_extents.w * height) / kMinBandPixels));
+    if(m_threads <= 1 || bands <= 1) {
+        task(0, height);
+        return;
+    }
+
+    auto bandHeight = (height + bands - 1) / bands;
+    forEachTile((height + bandHeight - 1) / bandHeight, [&](int index) {
+        task(index * bandHeight, std::min(height, (index + 1) * bandHeight));
+    });
+}
+
+int SVGFilterContext::resolveInput(const std::string& in) const
+{
+    if(in == "SourceGraphic")
+        return SourceGraphicSlot;
+    if(in == "SourceAlpha")
+        return SourceAlphaSlot;
+    if(auto it = m_results.find(in); it != m_results.end())
+        return it->second;
+    if(m_lastResult != -1)
+        return m_lastResult;
+    return SourceGraphicSlot;
+}
+
+void SVGFilterContext::addResult(int index, const std::string& name)
+{
+    m_lastResult = FirstResultSlot + index;
+    if(!name.empty()) {
+        m_results[name] = m_lastResult;
+    }
+}
+
+} // namespace novasvg
@@ -128,6 +128,7 @@ class SVGPathElement final : public SVGGeometryElement {
 public:
     SVGPathElement(Document* document);
 
+    const SVGPath& d() const { return m_d; }
     Rect updateShape(Path& path) final;
 
 private:
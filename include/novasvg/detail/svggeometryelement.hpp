@@ -136,8 +136,9 @@ void SVGGeometryElement::updateMarkerPositions(SVGMarkerPositionList& positions,
 
 void SVGGeometryElement::render(SVGRenderState& state) const
 {
-    if(!isRenderable())
+    if(state.cull(!isRenderable() || state.isOutsideCanvas(paintBoundingBox(), localTransform())))
         return;
+    NOVASVG_TRACE_SCOPE("shape", getAttribute(PropertyID::Id));
     SVGBlendInfo blendInfo(this);
     SVGRenderState newState(this, state, localTransform());
     newState.beginGroup(blendInfo);
@@ -1,125 +1,170 @@
 #ifndef NOVASVG_SVGLAYOUTSTATE_H
 #define NOVASVG_SVGLAYOUTSTATE_H
 
+#include <memory>
+#include <unordered_map>
+
 namespace novasvg {
 
+// The inherited computed style of an element. Blocks are immutable once built and shared by
+// every layout state that inherits them unchanged, so descending the tree copies a pointer
+// instead of the paints, strings and dash lists inside.
+struct SVGInheritedStyle {
+    Paint fill{Color::Black};
+    Paint stroke{Color::Transparent};
+
+    Color color = Color::Black;
+
+    float fill_opacity = 1.f;
+    float stroke_opacity = 1.f;
+    float stroke_miterlimit = 4.f;
+    float font_size = 12.f;
+
+    Length letter_spacing{0.f, LengthUnits::None};
+    Length word_spacing{0.f, LengthUnits::None};
+
+    Length stroke_width{1.f, LengthUnits::None};
+    Length stroke_dashoffset{0.f, LengthUnits::None};
+    LengthList stroke_dasharray;
+
+    LineCap stroke_linecap = LineCap::Butt;
+    LineJoin stroke_linejoin = LineJoin::Miter;
+
+    FillRule fill_rule = FillRule::NonZero;
+    FillRule clip_rule = FillRule::NonZero;
+
+    FontWeight font_weight = FontWeight::Normal;
+    FontStyle font_style = FontStyle::Normal;
+
+    DominantBaseline dominant_baseline = DominantBaseline::Auto;
+
+    TextAnchor text_anchor = TextAnchor::Start;
+    WhiteSpace white_space = WhiteSpace::Default;
+    WritingMode writing_mode = WritingMode::Horizontal;
+    TextOrientation text_orientation = TextOrientation::Mixed;
+    Direction direction = Direction::Ltr;
+
+    Visibility visibility = Visibility::Visible;
+    PointerEvents pointer_events = PointerEvents::Auto;
+
+    SVGElement* marker_start = nullptr;
+    SVGElement* marker_mid = nullptr;
+    SVGElement* marker_end = nullptr;
+    std::string font_family;
+};
+
+// Interns the inherited styles built during one layout pass. Elements that set the same
+// inherited attributes under the same parent style share a single block, which is parsed once.
+class SVGStyleCache {
+public:
+    SVGStyleCache() = default;
+
+    std::shared_ptr<const SVGInheritedStyle> get(const std::shared_ptr<const SVGInheritedStyle>& parent, const SVGElement* element);
+
+    size_t size() const { return m_entries.size(); }
+
+private:
+    SVGStyleCache(const SVGStyleCache&) = delete;
+    SVGStyleCache& operator=(const SVGStyleCache&) = delete;
+
+    struct Entry {
+        const SVGInheritedStyle* parent;
+        std::vector<std::pair<PropertyID, std::string>> attributes;
+        std::shared_ptr<const SVGInheritedStyle> style;
+    };
+
+    std::unordered_multimap<size_t, Entry> m_entries;
+};
+
 class SVGLayoutState {
 public:
-    SVGLayoutState() = default;
+    explicit SVGLayoutState(SVGStyleCache* styleCache = nullptr);
     SVGLayoutState(const SVGLayoutState& parent, const SVGElement* element);
 
     const SVGLayoutState* parent() const { return m_parent; }
     const SVGElement* element() const { return m_element; }
+    const std::shared_ptr<const SVGInheritedStyle>& inheritedStyle() const { return m_inherited; }
 
-    const Paint& fill() const { return m_fill; }
-    const Paint& stroke() const { return m_stroke; }
+    const Paint& fill() const { return m_inherited->fill; }
+    const Paint& stroke() const { return m_inherited->stroke; }
 
-    const Color& color() const { return m_color; }
+    const Color& color() const { return m_inherited->color; }
     const Color& stop_color() const { return m_stop_color; }
+    const Color& flood_color() const { return m_flood_color; }
 
     float opacity() const { return m_opacity; }
     float stop_opacity() const { return m_stop_opacity; }
-    float fill_opacity() const { return m_fill_opacity; }
-    float stroke_opacity() const { return m_stroke_opacity; }
-    float stroke_miterlimit() const { return m_stroke_miterlimit; }
-    float font_size() const { return m_font_size; }
+    float flood_opacity() const { return m_flood_opacity; }
+    float fill_opacity() const { return m_inherited->fill_opacity; }
+    float stroke_opacity() const { return m_inherited->stroke_opacity; }
+    float stroke_miterlimit() const { return m_inherited->stroke_miterlimit; }
+    float font_size() const { return m_inherited->font_size; }
 
-    const Length& letter_spacing() const { return m_letter_spacing; }
-    const Length& word_spacing() const { return m_word_spacing; }
+    const Length& letter_spacing() const { return m_inherited->letter_spacing; }
+    const Length& word_spacing() const { return m_inherited->word_spacing; }
 
     const BaselineShift& baseline_shift() const { return m_baseline_shift; }
-    const Length& stroke_width() const { return m_stroke_width; }
-    const Length& stroke_dashoffset() const { return m_stroke_dashoffset; }
-    const LengthList& stroke_dasharray() const { return m_stroke_dasharray; }
+    const Length& stroke_width() const { return m_inherited->stroke_width; }
+    const Length& stroke_dashoffset() const { return m_inherited->stroke_dashoffset; }
+    const LengthList& stroke_dasharray() const { return m_inherited->stroke_dasharray; }
 
-    LineCap stroke_linecap() const { return m_stroke_linecap; }
-    LineJoin stroke_linejoin() const { return m_stroke_linejoin; }
+    LineCap stroke_linecap() const { return m_inherited->stroke_linecap; }
+    LineJoin stroke_linejoin() const { return m_inherited->stroke_linejoin; }
 
-    FillRule fill_rule() const { return m_fill_rule; }
-    FillRule clip_rule() const { return m_clip_rule; }
+    FillRule fill_rule() const { return m_inherited->fill_rule; }
+    FillRule clip_rule() const { return m_inherited->clip_rule; }
 
-    FontWeight font_weight() const { return m_font_weight; }
-    FontStyle font_style() const { return m_font_style; }
+    FontWeight font_weight() const { return m_inherited->font_weight; }
+    FontStyle font_style() const { return m_inherited->font_style; }
 
     AlignmentBaseline alignment_baseline() const { return m_alignment_baseline; }
-    DominantBaseline dominant_baseline() const { return m_dominant_baseline; }
+    DominantBaseline dominant_baseline() const { return m_inherited->dominant_baseline; }
 
-    TextAnchor text_anchor() const { return m_text_anchor; }
-    WhiteSpace white_space() const { return m_white_space; }
-    WritingMode writing_mode() const { return m_writing_mode; }
-    TextOrientation text_orientation() const { return m_text_orientation; }
-    Direction direction() const { return m_direction; }
+    TextAnchor text_anchor() const { return m_inherited->text_anchor; }
+    WhiteSpace white_space() const { return m_inherited->white_space; }
+    WritingMode writing_mode() const { return m_inherited->writing_mode; }
+    TextOrientation text_orientation() const { return m_inherited->text_orientation; }
+    Direction direction() const { return m_inherited->direction; }
 
     Display display() const { return m_display; }
-    Visibility visibility() const { return m_visibility; }
+    Visibility visibility() const { return m_inherited->visibility; }
     Overflow overflow() const { return m_overflow; }
-    PointerEvents pointer_events() const { return m_pointer_events; }
+    PointerEvents pointer_events() const { return m_inherited->pointer_events; }
     MaskType mask_type() const { return m_mask_type; }
 
-    const std::string& mask() const { return m_mask; }
-    const std::string& clip_path() const { return m_clip_path; }
-    const std::string& marker_start() const { return m_marker_start; }
-    const std::string& marker_mid() const { return m_marker_mid; }
-    const std::string& marker_end() const { return m_marker_end; }
-    const std::string& font_family() const { return m_font_family; }
+    SVGElement* mask() const { return m_mask; }
+    SVGElement* clip_path() const { return m_clip_path; }
+    SVGElement* filter() const { return m_filter; }
+    SVGElement* marker_start() const { return m_inherited->marker_start; }
+    SVGElement* marker_mid() const { return m_inherited->marker_mid; }
+    SVGElement* marker_end() const { return m_inherited->marker_end; }
+    const std::string& font_family() const { return m_inherited->font_family; }
 
     Font font() const;
 
 private:
     const SVGLayoutState* m_parent = nullptr;
     const SVGElement* m_element = nullptr;
+    SVGStyleCache* m_styleCache = nullptr;
+    std::shared_ptr<const SVGInheritedStyle> m_inherited;
 
-    Paint m_fill{Color::Black};
-    Paint m_stroke{Color::Transparent};
-
-    Color m_color = Color::Black;
     Color m_stop_color = Color::Black;
+    Color m_flood_color = Color::Black;
 
     float m_opacity = 1.f;
-    float m_fill_opacity = 1.f;
-    float m_stroke_opacity = 1.f;
     float m_stop_opacity = 1.f;
-    float m_stroke_miterlimit = 4.f;
-    float m_font_size = 12.f;
-
-    Length m_letter_spacing{0.f, LengthUnits::None};
-    Length m_word_spacing{0.f, LengthUnits::None};
+    float m_flood_opacity = 1.f;
 
     BaselineShift m_baseline_shift;
-    Length m_stroke_width{1.f, LengthUnits::None};
-    Length m_stroke_dashoffset{0.f, LengthUnits::None};
-    LengthList m_stroke_dasharray;
-
-    LineCap m_stroke_linecap = LineCap::Butt;
-    LineJoin m_stroke_linejoin = LineJoin::Miter;
-
-    FillRule m_fill_rule = FillRule::NonZero;
-    FillRule m_clip_rule = FillRule::NonZero;
-
-    FontWeight m_font_weight = FontWeight::Normal;
-    FontStyle m_font_style = FontStyle::Normal;
-
     AlignmentBaseline m_alignment_baseline = AlignmentBaseline::Auto;
-    DominantBaseline m_dominant_baseline = DominantBaseline::Auto;
-
-    TextAnchor m_text_anchor = TextAnchor::Start;
-    WhiteSpace m_white_space = WhiteSpace::Default;
-    WritingMode m_writing_mode = WritingMode::Horizontal;
-    TextOrientation m_text_orientation = TextOrientation::Mixed;
-    Direction m_direction = Direction::Ltr;
 
     Display m_display = Display::Inline;
-    Visibility m_visibility = Visibility::Visible;
     Overflow m_overflow = Overflow::Visible;
-    PointerEvents m_pointer_events = PointerEvents::Auto;
     MaskType m_mask_type = MaskType::Luminance;
 
-    std::string m_mask;
-    std::string m_clip_path;
-    std::string m_marker_start;
-    std::string m_marker_mid;
-    std::string m_marker_end;
-    std::string m_font_family;
+    SVGElement* m_mask = nullptr;
+    SVGElement* m_clip_path = nullptr;
+    SVGElement* m_filter = nullptr;
 };
 
 } // namespace novasvg
@@ -1,36 +1,44 @@
 #include "svgparserutils.h"
 
-#include <optional>
-
 namespace novasvg {
 
-static std::optional<Color> parseColorValue(std::string_view& input, const SVGLayoutState* state)
+static bool parseColorValue(std::string_view& input, SVGPresentationValue& value)
 {
     if(skipString(input, "currentColor")) {
-        return state->color();
+        value.currentColor = true;
+        return true;
     }
 
     plutovg_color_t color;
     int length = plutovg_color_parse(&color, input.data(), input.length());
     if(length == 0)
-        return std::nullopt;
+        return false;
     input.remove_prefix(length);
-    return Color(plutovg_color_to_argb32(&color));
+    value.color = Color(plutovg_color_to_argb32(&color));
+    return true;
 }
 
-static Color parseColor(std::string_view input, const SVGLayoutState* state, const Color& defaultValue)
+static void parseColor(std::string_view input, const Color& defaultValue, SVGPresentationValue& value)
 {
-    auto color = parseColorValue(input, state);
-    if(!color || !input.empty())
-        color = defaultValue;
-    return color.value();
+    if(!parseColorValue(input, value) || !input.empty()) {
+        value.color = defaultValue;
+        value.currentColor = false;
+    }
 }
 
-static Color parseColorOrNone(std::string_view input, const SVGLayoutState* state, const Color& defaultValue)
+static void parseColorOrNone(std::string_view input, const Color& defaultValue, SVGPresentationValue& value)
 {
-    if(input.compare("none") == 0)
-        return Color::Transparent;
-    return parseColor(input, state, defaultValue);
+    if(input.compare("none") == 0) {
+        value.color = Color::Transparent;
+        return;
+    }
+
+    parseColor(input, defaultValue, value);
+}
+
+static Color resolveColor(const SVGPresentationValue& value, const Color& currentColor)
+{
+    return value.currentColor ? currentColor : value.color;
 }
 
 static bool parseUrlValue(std::string_view& input, std::string& value)
@@ -82,14 +90,21 @@ static std::string parseUrl(std::string_view input)
     return value;
 }
 
-static Paint parsePaint(std::string_view input, const SVGLayoutState* state, const Color& defaultValue)
+static void parsePaint(std::string_view input, const Color& defaultValue, SVGPresentationValue& value)
 {
     std::string id;
-    if(!parseUrlValue(input, id))
-        return Paint(parseColorOrNone(input, state, defaultValue));
-    if(skipOptionalSpaces(input))
-        return Paint(id, parseColorOrNone(input, state, defaultValue));
-    return Paint(id, Color::Transparent);
+    if(!parseUrlValue(input, id)) {
+        parseColorOrNone(input, defaultValue, value);
+        return;
+    }
+
+    value.string = std::move(id);
+    if(skipOptionalSpaces(input)) {
+        parseColorOrNone(input, defaultValue, value);
+        return;
+    }
+
+    value.color = Color::Transparent;
 }
 
 static float parseNumberOrPercentage(std::string_view input, bool allowPercentage, float defaultValue)
@@ -152,15 +167,14 @@ static Length parseLengthOrNormal(std::string_view input)
     return parseLength(input, LengthNegativeMode::Allow, Length(0, LengthUnits::None));
 }
 
-static float parseFontSize(std::string_view input, const SVGLayoutState* state)
+static float resolveFontSize(const Length& length, float parentFontSize)
 {
-    auto length = parseLength(input, LengthNegativeMode::Forbid, Length(12, LengthUnits::None));
     if(length.units() == LengthUnits::Percent)
-        return length.value() * state->font_size() / 100.f;
+        return length.value() * parentFontSize / 100.f;
     if(length.units() == LengthUnits::Ex)
-        return length.value() * state->font_size() / 2.f;
+        return length.value() * parentFontSize / 2.f;
     if(length.units() == LengthUnits::Em)
-        return length.value() * state->font_size();
+        return length.value() * parentFontSize;
     return length.value();
 }
 
@@ -403,166 +417,402 @@ static LineJoin parseLineJoin(std::string_view input)
     return parseEnumValue(input, entries, LineJoin::Miter);
 }
 
+static bool isInheritedProperty(PropertyID id)
+{
+    switch(id) {
+    case PropertyID::Fill:
+    case PropertyID::Stroke:
+    case PropertyID::Color:
+    case PropertyID::Fill_Opacity:
+    case PropertyID::Stroke_Opacity:
+    case PropertyID::Stroke_Miterlimit:
+    case PropertyID::Font_Size:
+    case PropertyID::Letter_Spacing:
+    case PropertyID::Word_Spacing:
+    case PropertyID::Stroke_Width:
+    case PropertyID::Stroke_Dashoffset:
+    case PropertyID::Stroke_Dasharray:
+    case PropertyID::Stroke_Linecap:
+    case PropertyID::Stroke_Linejoin:
+    case PropertyID::Fill_Rule:
+    case PropertyID::Clip_Rule:
+    case PropertyID::Font_Weight:
+    case PropertyID::Font_Style:
+    case PropertyID::Dominant_Baseline:
+    case PropertyID::Text_Anchor:
+    case PropertyID::White_Space:
+    case PropertyID::Writing_Mode:
+    case PropertyID::Text_Orientation:
+    case PropertyID::Direction:
+    case PropertyID::Visibility:
+    case PropertyID::Pointer_Events:
+    case PropertyID::Marker_Start:
+    case PropertyID::Marker_Mid:
+    case PropertyID::Marker_End:
+    case PropertyID::Font_Family:
+        return true;
+    default:
+        return false;
+    }
+}
+
+std::shared_ptr<const SVGPresentationValue> parsePresentationValue(PropertyID id, std::string_view input)
+{
+    stripLeadingAndTrailingSpaces(input);
+    if(input.empty() || input.compare("inherit") == 0)
+        return nullptr;
+    SVGPresentationValue value;
+    switch(id) {
+    case PropertyID::Fill:
+        parsePaint(input, Color::Black, value);
+        break;
+    case PropertyID::Stroke:
+        parsePaint(input, Color::Transparent, value);
+        break;
+    case PropertyID::Color:
+    case PropertyID::Stop_Color:
+    case PropertyID::Flood_Color:
+        parseColor(input, Color::Black, value);
+        break;
+    case PropertyID::Opacity:
+    case PropertyID::Fill_Opacity:
+    case PropertyID::Stroke_Opacity:
+    case PropertyID::Stop_Opacity:
+    case PropertyID::Flood_Opacity:
+        value.number = parseNumberOrPercentage(input, true, 1.f);
+        break;
+    case PropertyID::Stroke_Miterlimit:
+        value.number = parseNumberOrPercentage(input, false, 4.f);
+        break;
+    case PropertyID::Font_Size:
+        value.length = parseLength(input, LengthNegativeMode::Forbid, Length(12.f, LengthUnits::None));
+        break;
+    case PropertyID::Letter_Spacing:
+    case PropertyID::Word_Spacing:
+        value.length = parseLengthOrNormal(input);
+        break;
+    case PropertyID::Stroke_Width:
+        value.length = parseLength(input, LengthNegativeMode::Forbid, Length(1.f, LengthUnits::None));
+        break;
+    case PropertyID::Stroke_Dashoffset:
+        value.length = parseLength(input, LengthNegativeMode::Allow, Length(0.f, LengthUnits::None));
+        break;
+    case PropertyID::Stroke_Dasharray:
+        value.lengths = parseDashArray(input);
+        break;
+    case PropertyID::Baseline_Shift:
+        value.baselineShift = parseBaselineShift(input);
+        break;
+    case PropertyID::Stroke_Linecap:
+        value.enumeration = static_cast<uint8_t>(parseLineCap(input));
+        break;
+    case PropertyID::Stroke_Linejoin:
+        value.enumeration = static_cast<uint8_t>(parseLineJoin(input));
+        break;
+    case PropertyID::Fill_Rule:
+    case PropertyID::Clip_Rule:
+        value.enumeration = static_cast<uint8_t>(parseFillRule(input));
+        break;
+    case PropertyID::Font_Weight:
+        value.enumeration = static_cast<uint8_t>(parseFontWeight(input));
+        break;
+    case PropertyID::Font_Style:
+        value.enumeration = static_cast<uint8_t>(parseFontStyle(input));
+        break;
+    case PropertyID::Alignment_Baseline:
+        value.enumeration = static_cast<uint8_t>(parseAlignmentBaseline(input));
+        break;
+    case PropertyID::Dominant_Baseline:
+        value.enumeration = static_cast<uint8_t>(parseDominantBaseline(input));
+        break;
+    case PropertyID::Direction:
+        value.enumeration = static_cast<uint8_t>(parseDirection(input));
+        break;
+    case PropertyID::Text_Anchor:
+        value.enumeration = static_cast<uint8_t>(parseTextAnchor(input));
+        break;
+    case PropertyID::White_Space:
+        value.enumeration = static_cast<uint8_t>(parseWhiteSpace(input));
+        break;
+    case PropertyID::Writing_Mode:
+        value.enumeration = static_cast<uint8_t>(parseWritingMode(input));
+        break;
+    case PropertyID::Text_Orientation:
+        value.enumeration = static_cast<uint8_t>(parseTextOrientation(input));
+        break;
+    case PropertyID::Visibility:
+        value.enumeration = static_cast<uint8_t>(parseVisibility(input));
+        break;
+    case PropertyID::Pointer_Events:
+        value.enumeration = static_cast<uint8_t>(parsePointerEvents(input));
+        break;
+    case PropertyID::Display:
+        value.enumeration = static_cast<uint8_t>(parseDisplay(input));
+        break;
+    case PropertyID::Overflow:
+        value.enumeration = static_cast<uint8_t>(parseOverflow(input));
+        break;
+    case PropertyID::Mask_Type:
+        value.enumeration = static_cast<uint8_t>(parseMaskType(input));
+        break;
+    case PropertyID::Marker_Start:
+    case PropertyID::Marker_Mid:
+    case PropertyID::Marker_End:
+    case PropertyID::Mask:
+    case PropertyID::Clip_Path:
+    case PropertyID::Filter:
+        value.string = parseUrl(input);
+        break;
+    case PropertyID::Font_Family:
+        value.string.assign(input);
+        break;
+    default:
+        return nullptr;
+    }
+
+    return std::make_shared<const SVGPresentationValue>(std::move(value));
+}
+
+static void applyInheritedProperty(SVGInheritedStyle& style, const Attribute& attribute)
+{
+    const auto& value = *attribute.presentationValue();
+    auto target = attribute.target();
+    switch(attribute.id()) {
+    case PropertyID::Fill:
+        style.fill = Paint(value.string, target, resolveColor(value, style.color));
+        break;
+    case PropertyID::Stroke:
+        style.stroke = Paint(value.string, target, resolveColor(value, style.color));
+        break;
+    case PropertyID::Color:
+        style.color = resolveColor(value, style.color);
+        break;
+    case PropertyID::Fill_Opacity:
+        style.fill_opacity = value.number;
+        break;
+    case PropertyID::Stroke_Opacity:
+        style.stroke_opacity = value.number;
+        break;
+    case PropertyID::Stroke_Miterlimit:
+        style.stroke_miterlimit = value.number;
+        break;
+    case PropertyID::Font_Size:
+        style.font_size = resolveFontSize(value.length, style.font_size);
+        break;
+    case PropertyID::Letter_Spacing:
+        style.letter_spacing = value.length;
+        break;
+    case PropertyID::Word_Spacing:
+        style.word_spacing = value.length;
+        break;
+    case PropertyID::Stroke_Width:
+        style.stroke_width = value.length;
+        break;
+    case PropertyID::Stroke_Dashoffset:
+        style.stroke_dashoffset = value.length;
+        break;
+    case PropertyID::Stroke_Dasharray:
+        style.stroke_dasharray = value.lengths;
+        break;
+    case PropertyID::Stroke_Linecap:
+        style.stroke_linecap = static_cast<LineCap>(value.enumeration);
+        break;
+    case PropertyID::Stroke_Linejoin:
+        style.stroke_linejoin = static_cast<LineJoin>(value.enumeration);
+        break;
+    case PropertyID::Fill_Rule:
+        style.fill_rule = static_cast<FillRule>(value.enumeration);
+        break;
+    case PropertyID::Clip_Rule:
+        style.clip_rule = static_cast<FillRule>(value.enumeration);
+        break;
+    case PropertyID::Font_Weight:
+        style.font_weight = static_cast<FontWeight>(value.enumeration);
+        break;
+    case PropertyID::Font_Style:
+        style.font_style = static_cast<FontStyle>(value.enumeration);
+        break;
+    case PropertyID::Dominant_Baseline:
+        style.dominant_baseline = static_cast<DominantBaseline>(value.enumeration);
+        break;
+    case PropertyID::Direction:
+        style.direction = static_cast<Direction>(value.enumeration);
+        break;
+    case PropertyID::Text_Anchor:
+        style.text_anchor = static_cast<TextAnchor>(value.enumeration);
+        break;
+    case PropertyID::White_Space:
+        style.white_space = static_cast<WhiteSpace>(value.enumeration);
+        break;
+    case PropertyID::Writing_Mode:
+        style.writing_mode = static_cast<WritingMode>(value.enumeration);
+        break;
+    case PropertyID::Text_Orientation:
+        style.text_orientation = static_cast<TextOrientation>(value.enumeration);
+        break;
+    case PropertyID::Visibility:
+        style.visibility = static_cast<Visibility>(value.enumeration);
+        break;
+    case PropertyID::Pointer_Events:
+        style.pointer_events = static_cast<PointerEvents>(value.enumeration);
+        break;
+    case PropertyID::Marker_Start:
+        style.marker_start = target;
+        break;
+    case PropertyID::Marker_Mid:
+        style.marker_mid = target;
+        break;
+    case PropertyID::Marker_End:
+        style.marker_end = target;
+        break;
+    case PropertyID::Font_Family:
+        style.font_family = value.string;
+        break;
+    default:
+        assert(false);
+    }
+}
+
+static bool isSpecifiedInheritedProperty(const Attribute& attribute)
+{
+    return attribute.presentationValue() && isInheritedProperty(attribute.id());
+}
+
+static std::shared_ptr<const SVGInheritedStyle> buildInheritedStyle(const std::shared_ptr<const SVGInheritedStyle>& parent, const SVGElement* element)
+{
+    // The color goes first so that currentColor in the other properties sees the element's own color.
+    std::shared_ptr<SVGInheritedStyle> style;
+    for(const auto& attribute : element->attributes()) {
+        if(isSpecifiedInheritedProperty(attribute)) {
+            if(style == nullptr)
+                style = std::make_shared<SVGInheritedStyle>(*parent);
+            if(attribute.id() == PropertyID::Color) {
+                applyInheritedProperty(*style, attribute);
+            }
+        }
+    }
+
+    if(style == nullptr)
+        return parent;
+    for(const auto& attribute : element->attributes()) {
+        if(isSpecifiedInheritedProperty(attribute) && attribute.id() != PropertyID::Color) {
+            applyInheritedProperty(*style, attribute);
+        }
+    }
+
+    return style;
+}
+
+std::shared_ptr<const SVGInheritedStyle> SVGStyleCache::get(const std::shared_ptr<const SVGInheritedStyle>& parent, const SVGElement* element)
+{
+    size_t hash = std::hash<const void*>()(parent.get());
+    size_t count = 0;
+    for(const auto& attribute : element->attributes()) {
+        if(isSpecifiedInheritedProperty(attribute)) {
+            hash = hash * 31 + static_cast<size_t>(attribute.id());
+            hash = hash * 31 + std::hash<std::string_view>()(attribute.value());
+            ++count;
+        }
+    }
+
+    if(count == 0)
+        return parent;
+    auto matches = [&](const Entry& entry) {
+        if(entry.parent != parent.get() || entry.attributes.size() != count)
+            return false;
+        auto it = entry.attributes.begin();
+        for(const auto& attribute : element->attributes()) {
+            if(isSpecifiedInheritedProperty(attribute)) {
+                if(it->first != attribute.id() || it->second != attribute.value())
+                    return false;
+                ++it;
+            }
+        }
+
+        return true;
+    };
+
+    auto range = m_entries.equal_range(hash);
+    for(auto it = range.first; it != range.second; ++it) {
+        if(matches(it->second)) {
+            return it->second.style;
+        }
+    }
+
+    Entry entry;
+    entry.parent = parent.get();
+    for(const auto& attribute : element->attributes()) {
+        if(isSpecifiedInheritedProperty(attribute)) {
+            entry.attributes.emplace_back(attribute.id(), attribute.value());
+        }
+    }
+
+    entry.style = buildInheritedStyle(parent, element);
+    return m_entries.emplace(hash, std::move(entry))->second.style;
+}
+
+SVGLayoutState::SVGLayoutState(SVGStyleCache* styleCache)
+    : m_styleCache(styleCache)
+{
+    static const auto initialStyle = std::make_shared<const SVGInheritedStyle>();
+    m_inherited = initialStyle;
+}
+
 SVGLayoutState::SVGLayoutState(const SVGLayoutState& parent, const SVGElement* element)
     : m_parent(&parent)
     , m_element(element)
-    , m_fill(parent.fill())
-    , m_stroke(parent.stroke())
-    , m_color(parent.color())
-    , m_fill_opacity(parent.fill_opacity())
-    , m_stroke_opacity(parent.stroke_opacity())
-    , m_stroke_miterlimit(parent.stroke_miterlimit())
-    , m_font_size(parent.font_size())
-    , m_letter_spacing(parent.letter_spacing())
-    , m_word_spacing(parent.word_spacing())
-    , m_stroke_width(parent.stroke_width())
-    , m_stroke_dashoffset(parent.stroke_dashoffset())
-    , m_stroke_dasharray(parent.stroke_dasharray())
-    , m_stroke_linecap(parent.stroke_linecap())
-    , m_stroke_linejoin(parent.stroke_linejoin())
-    , m_fill_rule(parent.fill_rule())
-    , m_clip_rule(parent.clip_rule())
-    , m_font_weight(parent.font_weight())
-    , m_font_style(parent.font_style())
-    , m_dominant_baseline(parent.dominant_baseline())
-    , m_text_anchor(parent.text_anchor())
-    , m_white_space(parent.white_space())
-    , m_writing_mode(parent.writing_mode())
-    , m_text_orientation(parent.text_orientation())
-    , m_direction(parent.direction())
-    , m_visibility(parent.visibility())
+    , m_styleCache(parent.m_styleCache)
     , m_overflow(element->isRootElement() ? Overflow::Visible : Overflow::Hidden)
-    , m_pointer_events(parent.pointer_events())
-    , m_marker_start(parent.marker_start())
-    , m_marker_mid(parent.marker_mid())
-    , m_marker_end(parent.marker_end())
-    , m_font_family(parent.font_family())
 {
+    if(m_styleCache) {
+        m_inherited = m_styleCache->get(parent.m_inherited, element);
+    } else {
+        m_inherited = buildInheritedStyle(parent.m_inherited, element);
+    }
+
     for(const auto& attribute : element->attributes()) {
-        std::string_view input(attribute.value());
-        stripLeadingAndTrailingSpaces(input);
-        if(input.empty() || input.compare("inherit") == 0)
+        auto value = attribute.presentationValue();
+        if(value == nullptr)
             continue;
         switch(attribute.id()) {
-        case PropertyID::Fill:
-            m_fill = parsePaint(input, this, Color::Black);
-            break;
-        case PropertyID::Stroke:
-            m_stroke = parsePaint(input, this, Color::Transparent);
-            break;
-        case PropertyID::Color:
-            m_color = parseColor(input, this, Color::Black);
-            break;
         case PropertyID::Stop_Color:
-            m_stop_color = parseColor(input, this, Color::Black);
+            m_stop_color = resolveColor(*value, color());
             break;
-        case PropertyID::Opacity:
-            m_opacity = parseNumberOrPercentage(input, true, 1.f);
+        case PropertyID::Flood_Color:
+            m_flood_color = resolveColor(*value, color());
             break;
-        case PropertyID::Fill_Opacity:
-            m_fill_opacity = parseNumberOrPercentage(input, true, 1.f);
-            break;
-        case PropertyID::Stroke_Opacity:
-            m_stroke_opacity = parseNumberOrPercentage(input, true, 1.f);
+        case PropertyID::Opacity:
+            m_opacity = value->number;
             break;
         case PropertyID::Stop_Opacity:
-            m_stop_opacity = parseNumberOrPercentage(input, true, 1.f);
+            m_stop_opacity = value->number;
             break;
-        case PropertyID::Stroke_Miterlimit:
-            m_stroke_miterlimit = parseNumberOrPercentage(input, false, 4.f);
-            break;
-        case PropertyID::Font_Size:
-            m_font_size = parseFontSize(input, this);
-            break;
-        case PropertyID::Letter_Spacing:
-            m_letter_spacing = parseLengthOrNormal(input);
-            break;
-        case PropertyID::Word_Spacing:
-            m_word_spacing = parseLengthOrNormal(input);
+        case PropertyID::Flood_Opacity:
+            m_flood_opacity = value->number;
             break;
         case PropertyID::Baseline_Shift:
-            m_baseline_shift = parseBaselineShift(input);
-            break;
-        case PropertyID::Stroke_Width:
-            m_stroke_width = parseLength(input, LengthNegativeMode::Forbid, Length(1.f, LengthUnits::None));
-            break;
-        case PropertyID::Stroke_Dashoffset:
-            m_stroke_dashoffset = parseLength(input, LengthNegativeMode::Allow, Length(0.f, LengthUnits::None));
-            break;
-        case PropertyID::Stroke_Dasharray:
-            m_stroke_dasharray = parseDashArray(input);
-            break;
-        case PropertyID::Stroke_Linecap:
-            m_stroke_linecap = parseLineCap(input);
-            break;
-        case PropertyID::Stroke_Linejoin:
-            m_stroke_linejoin = parseLineJoin(input);
-            break;
-        case PropertyID::Fill_Rule:
-            m_fill_rule = parseFillRule(input);
-            break;
-        case PropertyID::Clip_Rule:
-            m_clip_rule = parseFillRule(input);
-            break;
-        case PropertyID::Font_Weight:
-            m_font_weight = parseFontWeight(input);
-            break;
-        case PropertyID::Font_Style:
-            m_font_style = parseFontStyle(input);
+            m_baseline_shift = value->baselineShift;
             break;
         case PropertyID::Alignment_Baseline:
-            m_alignment_baseline = parseAlignmentBaseline(input);
-            break;
-        case PropertyID::Dominant_Baseline:
-            m_dominant_baseline = parseDominantBaseline(input);
-            break;
-        case PropertyID::Direction:
-            m_direction = parseDirection(input);
-            break;
-        case PropertyID::Text_Anchor:
-            m_text_anchor = parseTextAnchor(input);
-            break;
-        case PropertyID::White_Space:
-            m_white_space = parseWhiteSpace(input);
-            break;
-        case PropertyID::Writing_Mode:
-            m_writing_mode = parseWritingMode(input);
-            break;
-        case PropertyID::Text_Orientation:
-            m_text_orientation = parseTextOrientation(input);
+            m_alignment_baseline = static_cast<AlignmentBaseline>(value->enumeration);
             break;
         case PropertyID::Display:
-            m_display = parseDisplay(input);
-            break;
-        case PropertyID::Visibility:
-            m_visibility = parseVisibility(input);
+            m_display = static_cast<Display>(value->enumeration);
             break;
         case PropertyID::Overflow:
-            m_overflow = parseOverflow(input);
-            break;
-        case PropertyID::Pointer_Events:
-            m_pointer_events = parsePointerEvents(input);
+            m_overflow = static_cast<Overflow>(value->enumeration);
             break;
         case PropertyID::Mask_Type:
-            m_mask_type = parseMaskType(input);
+            m_mask_type = static_cast<MaskType>(value->enumeration);
             break;
         case PropertyID::Mask:
-            m_mask = parseUrl(input);
+            m_mask = attribute.target();
             break;
         case PropertyID::Clip_Path:
-            m_clip_path = parseUrl(input);
-            break;
-        case PropertyID::Marker_Start:
-            m_marker_start = parseUrl(input);
-            break;
-        case PropertyID::Marker_Mid:
-            m_marker_mid = parseUrl(input);
-            break;
-        case PropertyID::Marker_End:
-            m_marker_end = parseUrl(input);
+            m_clip_path = attribute.target();
             break;
-        case PropertyID::Font_Family:
-            m_font_family.assign(input);
+        case PropertyID::Filter:
+            m_filter = attribute.target();
             break;
         default:
             break;
@@ -572,11 +822,11 @@ SVGLayoutState::SVGLayoutState(const SVGLayoutState& parent, const SVGElement* e
 
 Font SVGLayoutState::font() const
 {
-    auto bold = m_font_weight == FontWeight::Bold;
-    auto italic = m_font_style == FontStyle::Italic;
+    auto bold = font_weight() == FontWeight::Bold;
+    auto italic = font_style() == FontStyle::Italic;
 
     FontFace face;
-    std::string_view input(m_font_family);
+    std::string_view input(font_family());
     while(!input.empty() && face.isNull()) {
         auto family = input.substr(0, input.find(','));
         input.remove_prefix(family.length());
@@ -599,7 +849,7 @@ Font SVGLayoutState::font() const
 
     if(face.isNull())
         face = fontFaceCache()->getFontFace(emptyString, bold, italic);
-    return Font(face, m_font_size);
+    return Font(face, font_size());
 }
 
 } // namespace novasvg
@@ -95,7 +95,7 @@ SVGLinearGradientAttributes SVGLinearGradientElement::collectGradientAttributes(
             }
         }
 
-        auto targetElement = current->getTargetElement(document());
+        auto targetElement = current->getTargetElement();
         if(!targetElement || !(targetElement->id() == ElementID::LinearGradient || targetElement->id() == ElementID::RadialGradient))
             break;
         processedGradients.insert(current);
@@ -225,7 +225,7 @@ SVGRadialGradientAttributes SVGRadialGradientElement::collectGradientAttributes(
             }
         }
 
-        auto targetElement = current->getTargetElement(document());
+        auto targetElement = current->getTargetElement();
         if(!targetElement || !(targetElement->id() == ElementID::LinearGradient || targetElement->id() == ElementID::RadialGradient))
             break;
         processedGradients.insert(current);
@@ -264,6 +264,7 @@ bool SVGPatternElement::applyPaint(SVGRenderState& state, float opacity) const
 {
     if(state.hasCycleReference(this))
         return false;
+    NOVASVG_TRACE_SCOPE("pattern", getAttribute(PropertyID::Id));
     auto attributes = collectPatternAttributes();
     auto patternContentElement = attributes.patternContentElement();
     if(patternContentElement == nullptr)
@@ -288,7 +289,12 @@ bool SVGPatternElement::applyPaint(SVGRenderState& state, float opacity) const
     auto xScale = currentTransform.xScale();
     auto yScale = currentTransform.yScale();
 
-    auto patternImage = Canvas::create(0, 0, patternRect.w * xScale, patternRect.h * yScale);
+    Rect patternExtents(0, 0, patternRect.w * xScale, patternRect.h * yScale);
+    if(!state->canCreateLayer(patternExtents))
+        return false;
+    if(auto stats = state.stats())
+        stats->patternRenders++;
+    auto patternImage = state->createLayer(patternExtents);
     auto patternImageTransform = Transform::scaled(xScale, yScale);
 
     const auto& viewBoxRect = attributes.viewBox();
@@ -343,7 +349,7 @@ SVGPatternAttributes SVGPatternElement::collectPatternAttributes() const
             }
         }
 
-        auto targetElement = current->getTargetElement(document());
+        auto targetElement = current->getTargetElement();
         if(!targetElement || targetElement->id() != ElementID::Pattern)
             break;
         processedPatterns.insert(current);
@@ -709,6 +709,7 @@ inline bool readIdentifier(std::string_view& input, std::string& output)
 
 bool Document::parse(const char* data, size_t length)
 {
+    NOVASVG_TRACE_SCOPE("parse", std::string_view(), length);
     std::string buffer;
     std::string styleSheet;
     SVGElement* currentElement = nullptr;
@@ -850,11 +851,16 @@ bool Document::parse(const char* data, size_t length)
                         return false;
                     m_rootElement = std::make_unique<SVGRootElement>(this);
                     element = m_rootElement.get();
+                    m_memoryUsage += sizeof(SVGRootElement);
                 } else {
                     auto child = SVGElement::create(this, id);
                     element = child.get();
                     currentElement->addChild(std::move(child));
                 }
+
+                if(element->isOverMemoryBudget()) {
+                    return false;
+                }
             }
         }
 
@@ -876,6 +882,7 @@ bool Document::parse(const char* data, size_t length)
                 id = propertyid(buffer);
             if(id != PropertyID::Unknown) {
                 decodeText(input.substr(0, n), buffer);
+                m_memoryUsage += buffer.size();
                 if(id == PropertyID::Style) {
                     removeStyleComments(buffer);
                     parseInlineStyle(buffer, element);
@@ -911,11 +918,12 @@ bool Document::parse(const char* data, size_t length)
         return false;
     applyStyleSheet(styleSheet);
     m_rootElement->build();
-    return true;
+    return !m_rootElement->isOverMemoryBudget();
 }
 
 void Document::applyStyleSheet(const std::string& content)
 {
+    NOVASVG_TRACE_SCOPE("applyStyleSheet", std::string_view(), content.size());
     auto rules = parseStyleSheet(content);
     if(!rules.empty()) {
         std::sort(rules.begin(), rules.end());
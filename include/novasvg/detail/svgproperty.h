@@ -6,10 +6,20 @@
 
 namespace novasvg {
 
+class SVGElement;
+class BinaryReader;
+class BinaryWriter;
+
 enum class PropertyID : uint8_t {
     Unknown = 0,
+    Accumulate,
+    Additive,
     Alignment_Baseline,
+    AttributeName,
     Baseline_Shift,
+    Begin,
+    By,
+    CalcMode,
     Class,
     Clip_Path,
     Clip_Rule,
@@ -21,15 +31,22 @@ enum class PropertyID : uint8_t {
     Direction,
     Display,
     Dominant_Baseline,
+    Dur,
     Dx,
     Dy,
+    End,
     Fill,
     Fill_Opacity,
     Fill_Rule,
+    Filter,
+    FilterUnits,
+    Flood_Color,
+    Flood_Opacity,
     Font_Family,
     Font_Size,
     Font_Style,
     Font_Weight,
+    From,
     Fx,
     Fy,
     GradientTransform,
@@ -37,6 +54,14 @@ enum class PropertyID : uint8_t {
     Height,
     Href,
     Id,
+    In,
+    In2,
+    K1,
+    K2,
+    K3,
+    K4,
+    KeySplines,
+    KeyTimes,
     LengthAdjust,
     Letter_Spacing,
     Marker_End,
@@ -49,8 +74,10 @@ enum class PropertyID : uint8_t {
     Mask_Type,
     MaskContentUnits,
     MaskUnits,
+    Mode,
     Offset,
     Opacity,
+    Operator,
     Orient,
     Overflow,
     PatternContentUnits,
@@ -59,13 +86,18 @@ enum class PropertyID : uint8_t {
     Pointer_Events,
     Points,
     PreserveAspectRatio,
+    PrimitiveUnits,
     R,
     RefX,
     RefY,
+    RepeatCount,
+    RepeatDur,
+    Result,
     Rotate,
     Rx,
     Ry,
     SpreadMethod,
+    StdDeviation,
     Stop_Color,
     Stop_Opacity,
     Stroke,
@@ -80,7 +112,10 @@ enum class PropertyID : uint8_t {
     Text_Anchor,
     Text_Orientation,
     TextLength,
+    To,
     Transform,
+    Type,
+    Values,
     ViewBox,
     Visibility,
     White_Space,
@@ -107,6 +142,11 @@ public:
     PropertyID id() const { return m_id; }
 
     virtual bool parse(std::string_view input) = 0;
+    virtual void assign(const SVGProperty& other) = 0;
+
+    // Binary snapshots store the parsed value, so loading one skips parse().
+    virtual void write(BinaryWriter& writer) const = 0;
+    virtual bool read(BinaryReader& reader) = 0;
 
 private:
     SVGProperty(const SVGProperty&) = delete;
@@ -122,6 +162,9 @@ public:
 
     const std::string& value() const { return m_value; }
     bool parse(std::string_view input) final;
+    void assign(const SVGProperty& other) final;
+    void write(BinaryWriter& writer) const final;
+    bool read(BinaryReader& reader) final;
 
 private:
     std::string m_value;
@@ -131,16 +174,18 @@ class Paint {
 public:
     Paint() = default;
     explicit Paint(const Color& color) : m_color(color) {}
-    Paint(const std::string& id, const Color& color)
-        : m_id(id), m_color(color)
+    Paint(const std::string& id, SVGElement* target, const Color& color)
+        : m_id(id), m_target(target), m_color(color)
     {}
 
     const Color& color() const { return m_color; }
     const std::string& id() const { return m_id; }
+    SVGElement* target() const { return m_target; }
     bool isNone() const { return m_id.empty() && !m_color.isVisible(); }
 
 private:
     std::string m_id;
+    SVGElement* m_target = nullptr;
     Color m_color = Color::Transparent;
 };
 
@@ -260,9 +305,75 @@ enum class LengthAdjust : uint8_t {
     SpacingAndGlyphs
 };
 
+enum class FilterBlendMode : uint8_t {
+    Normal,
+    Multiply,
+    Screen,
+    Darken,
+    Lighten
+};
+
+enum class CompositeOperator : uint8_t {
+    Over,
+    In,
+    Out,
+    Atop,
+    Xor,
+    Arithmetic
+};
+
+enum class ColorMatrixType : uint8_t {
+    Matrix,
+    Saturate,
+    HueRotate,
+    LuminanceToAlpha
+};
+
+enum class CalcMode : uint8_t {
+    Discrete,
+    Linear,
+    Paced,
+    Spline
+};
+
+enum class AnimationAdditive : uint8_t {
+    Replace,
+    Sum
+};
+
+enum class AnimationAccumulate : uint8_t {
+    None,
+    Sum
+};
+
+enum class TransformType : uint8_t {
+    Translate,
+    Scale,
+    Rotate,
+    SkewX,
+    SkewY
+};
+
 template<typename Enum>
 using SVGEnumerationEntry = std::pair<Enum, std::string_view>;
 
+// The entry table of an enumeration, iterable with a range-based for.
+template<typename Enum>
+class SVGEnumerationEntries {
+public:
+    template<size_t N>
+    SVGEnumerationEntries(const SVGEnumerationEntry<Enum>(&entries)[N])
+        : m_begin(entries), m_end(entries + N)
+    {}
+
+    const SVGEnumerationEntry<Enum>* begin() const { return m_begin; }
+    const SVGEnumerationEntry<Enum>* end() const { return m_end; }
+
+private:
+    const SVGEnumerationEntry<Enum>* m_begin;
+    const SVGEnumerationEntry<Enum>* m_end;
+};
+
 template<typename Enum>
 class SVGEnumeration final : public SVGProperty {
 public:
@@ -273,10 +384,12 @@ public:
 
     Enum value() const { return m_value; }
     bool parse(std::string_view input) final;
+    void assign(const SVGProperty& other) final;
+    void write(BinaryWriter& writer) const final;
+    bool read(BinaryReader& reader) final;
 
 private:
-    template<unsigned int N>
-    bool parseEnum(std::string_view input, const SVGEnumerationEntry<Enum>(&entries)[N]);
+    static SVGEnumerationEntries<Enum> entries();
     Enum m_value;
 };
 
@@ -295,6 +408,9 @@ public:
     float value() const { return m_value; }
     OrientType orientType() const { return m_orientType; }
     bool parse(std::string_view input) final;
+    void assign(const SVGProperty& other) final;
+    void write(BinaryWriter& writer) const final;
+    bool read(BinaryReader& reader) final;
 
 private:
     float m_value = 0;
@@ -331,6 +447,8 @@ public:
     LengthUnits units() const { return m_units; }
 
     bool parse(std::string_view input, LengthNegativeMode mode);
+    void write(BinaryWriter& writer) const;
+    bool read(BinaryReader& reader, LengthNegativeMode mode);
 
 private:
     float m_value = 0.f;
@@ -352,6 +470,9 @@ public:
     LengthNegativeMode negativeMode() const { return m_negativeMode; }
     const Length& value() const { return m_value; }
     bool parse(std::string_view input) final;
+    void assign(const SVGProperty& other) final;
+    void write(BinaryWriter& writer) const final;
+    bool read(BinaryReader& reader) final;
 
 private:
     const LengthDirection m_direction;
@@ -376,6 +497,9 @@ private:
 
 using LengthList = std::vector<Length>;
 
+void writeLengthList(BinaryWriter& writer, const LengthList& values);
+bool readLengthList(BinaryReader& reader, LengthList& values, LengthNegativeMode mode);
+
 class SVGLengthList final : public SVGProperty {
 public:
     SVGLengthList(PropertyID id, LengthDirection direction, LengthNegativeMode negativeMode)
@@ -388,6 +512,9 @@ public:
     LengthNegativeMode negativeMode() const { return m_negativeMode; }
     const LengthList& values() const { return m_values; }
     bool parse(std::string_view input) final;
+    void assign(const SVGProperty& other) final;
+    void write(BinaryWriter& writer) const final;
+    bool read(BinaryReader& reader) final;
 
 private:
     const LengthDirection m_direction;
@@ -411,6 +538,9 @@ public:
     Type type() const { return m_type; }
     const Length& length() const { return m_length; }
 
+    void write(BinaryWriter& writer) const;
+    bool read(BinaryReader& reader);
+
 private:
     Type m_type{Type::Baseline};
     Length m_length;
@@ -425,6 +555,9 @@ public:
 
     float value() const { return m_value; }
     bool parse(std::string_view input) override;
+    void assign(const SVGProperty& other) override;
+    void write(BinaryWriter& writer) const override;
+    bool read(BinaryReader& reader) override;
 
 private:
     float m_value;
@@ -439,6 +572,9 @@ public:
 
     float value() const { return m_value; }
     bool parse(std::string_view input) final;
+    void assign(const SVGProperty& other) final;
+    void write(BinaryWriter& writer) const final;
+    bool read(BinaryReader& reader) final;
 
 private:
     float m_value;
@@ -454,6 +590,9 @@ public:
 
     const NumberList& values() const { return m_values; }
     bool parse(std::string_view input) final;
+    void assign(const SVGProperty& other) final;
+    void write(BinaryWriter& writer) const final;
+    bool read(BinaryReader& reader) final;
 
 private:
     NumberList m_values;
@@ -465,8 +604,15 @@ public:
         : SVGProperty(id)
     {}
 
+    SVGPath(PropertyID id, Path value)
+        : SVGProperty(id), m_value(std::move(value))
+    {}
+
     const Path& value() const { return m_value; }
     bool parse(std::string_view input) final;
+    void assign(const SVGProperty& other) final;
+    void write(BinaryWriter& writer) const final;
+    bool read(BinaryReader& reader) final;
 
 private:
     Path m_value;
@@ -480,6 +626,9 @@ public:
 
     const Point& value() const { return m_value; }
     bool parse(std::string_view input) final;
+    void assign(const SVGProperty& other) final;
+    void write(BinaryWriter& writer) const final;
+    bool read(BinaryReader& reader) final;
 
 private:
     Point m_value;
@@ -495,6 +644,9 @@ public:
 
     const PointList& values() const { return m_values; }
     bool parse(std::string_view input) final;
+    void assign(const SVGProperty& other) final;
+    void write(BinaryWriter& writer) const final;
+    bool read(BinaryReader& reader) final;
 
 private:
     PointList m_values;
@@ -509,6 +661,9 @@ public:
 
     const Rect& value() const { return m_value; }
     bool parse(std::string_view input) final;
+    void assign(const SVGProperty& other) final;
+    void write(BinaryWriter& writer) const final;
+    bool read(BinaryReader& reader) final;
 
 private:
     Rect m_value;
@@ -522,6 +677,9 @@ public:
 
     const Transform& value() const { return m_value; }
     bool parse(std::string_view input) final;
+    void assign(const SVGProperty& other) final;
+    void write(BinaryWriter& writer) const final;
+    bool read(BinaryReader& reader) final;
 
 private:
     Transform m_value;
@@ -554,6 +712,9 @@ public:
     AlignType alignType() const { return m_alignType; }
     MeetOrSlice meetOrSlice() const { return m_meetOrSlice; }
     bool parse(std::string_view input) final;
+    void assign(const SVGProperty& other) final;
+    void write(BinaryWriter& writer) const final;
+    bool read(BinaryReader& reader) final;
 
     Rect getClipRect(const Rect& viewBoxRect, const Size& viewportSize) const;
     Transform getTransform(const Rect& viewBoxRect, const Size& viewportSize) const;
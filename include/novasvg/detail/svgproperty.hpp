@@ -1,4 +1,8 @@
+#include "svgbinary.h"
+
 #include <cassert>
+#include <climits>
+#include <type_traits>
 
 namespace novasvg {
 
@@ -8,13 +12,23 @@ PropertyID propertyid(std::string_view name)
         std::string_view name;
         PropertyID value;
     } table[] = {
+        {"accumulate", PropertyID::Accumulate},
+        {"additive", PropertyID::Additive},
+        {"attributeName", PropertyID::AttributeName},
+        {"begin", PropertyID::Begin},
+        {"by", PropertyID::By},
+        {"calcMode", PropertyID::CalcMode},
         {"class", PropertyID::Class},
         {"clipPathUnits", PropertyID::ClipPathUnits},
         {"cx", PropertyID::Cx},
         {"cy", PropertyID::Cy},
         {"d", PropertyID::D},
+        {"dur", PropertyID::Dur},
         {"dx", PropertyID::Dx},
         {"dy", PropertyID::Dy},
+        {"end", PropertyID::End},
+        {"filterUnits", PropertyID::FilterUnits},
+        {"from", PropertyID::From},
         {"fx", PropertyID::Fx},
         {"fy", PropertyID::Fy},
         {"gradientTransform", PropertyID::GradientTransform},
@@ -22,29 +36,47 @@ PropertyID propertyid(std::string_view name)
         {"height", PropertyID::Height},
         {"href", PropertyID::Href},
         {"id", PropertyID::Id},
+        {"in", PropertyID::In},
+        {"in2", PropertyID::In2},
+        {"k1", PropertyID::K1},
+        {"k2", PropertyID::K2},
+        {"k3", PropertyID::K3},
+        {"k4", PropertyID::K4},
+        {"keySplines", PropertyID::KeySplines},
+        {"keyTimes", PropertyID::KeyTimes},
         {"lengthAdjust", PropertyID::LengthAdjust},
         {"markerHeight", PropertyID::MarkerHeight},
         {"markerUnits", PropertyID::MarkerUnits},
         {"markerWidth", PropertyID::MarkerWidth},
         {"maskContentUnits", PropertyID::MaskContentUnits},
         {"maskUnits", PropertyID::MaskUnits},
+        {"mode", PropertyID::Mode},
         {"offset", PropertyID::Offset},
+        {"operator", PropertyID::Operator},
         {"orient", PropertyID::Orient},
         {"patternContentUnits", PropertyID::PatternContentUnits},
         {"patternTransform", PropertyID::PatternTransform},
         {"patternUnits", PropertyID::PatternUnits},
         {"points", PropertyID::Points},
         {"preserveAspectRatio", PropertyID::PreserveAspectRatio},
+        {"primitiveUnits", PropertyID::PrimitiveUnits},
         {"r", PropertyID::R},
         {"refX", PropertyID::RefX},
         {"refY", PropertyID::RefY},
+        {"repeatCount", PropertyID::RepeatCount},
+        {"repeatDur", PropertyID::RepeatDur},
+        {"result", PropertyID::Result},
         {"rotate", PropertyID::Rotate},
         {"rx", PropertyID::Rx},
         {"ry", PropertyID::Ry},
         {"spreadMethod", PropertyID::SpreadMethod},
+        {"stdDeviation", PropertyID::StdDeviation},
         {"style", PropertyID::Style},
         {"textLength", PropertyID::TextLength},
+        {"to", PropertyID::To},
         {"transform", PropertyID::Transform},
+        {"type", PropertyID::Type},
+        {"values", PropertyID::Values},
         {"viewBox", PropertyID::ViewBox},
         {"width", PropertyID::Width},
         {"x", PropertyID::X},
@@ -80,6 +112,9 @@ PropertyID csspropertyid(std::string_view name)
         {"fill", PropertyID::Fill},
         {"fill-opacity", PropertyID::Fill_Opacity},
         {"fill-rule", PropertyID::Fill_Rule},
+        {"filter", PropertyID::Filter},
+        {"flood-color", PropertyID::Flood_Color},
+        {"flood-opacity", PropertyID::Flood_Opacity},
         {"font-family", PropertyID::Font_Family},
         {"font-size", PropertyID::Font_Size},
         {"font-style", PropertyID::Font_Style},
@@ -129,8 +164,24 @@ bool SVGString::parse(std::string_view input)
     return true;
 }
 
+void SVGString::assign(const SVGProperty& other)
+{
+    const auto& property = static_cast<const SVGString&>(other);
+    m_value = property.m_value;
+}
+
+void SVGString::write(BinaryWriter& writer) const
+{
+    writer.write(std::string_view(m_value));
+}
+
+bool SVGString::read(BinaryReader& reader)
+{
+    return reader.read(m_value);
+}
+
 template<>
-bool SVGEnumeration<SpreadMethod>::parse(std::string_view input)
+SVGEnumerationEntries<SpreadMethod> SVGEnumeration<SpreadMethod>::entries()
 {
     static const SVGEnumerationEntry<SpreadMethod> entries[] = {
         {SpreadMethod::Pad, "pad"},
@@ -138,48 +189,138 @@ bool SVGEnumeration<SpreadMethod>::parse(std::string_view input)
         {SpreadMethod::Repeat, "repeat"}
     };
 
-    return parseEnum(input, entries);
+    return SVGEnumerationEntries<SpreadMethod>(entries);
 }
 
 template<>
-bool SVGEnumeration<Units>::parse(std::string_view input)
+SVGEnumerationEntries<Units> SVGEnumeration<Units>::entries()
 {
     static const SVGEnumerationEntry<Units> entries[] = {
         {Units::UserSpaceOnUse, "userSpaceOnUse"},
         {Units::ObjectBoundingBox, "objectBoundingBox"}
     };
 
-    return parseEnum(input, entries);
+    return SVGEnumerationEntries<Units>(entries);
 }
 
 template<>
-bool SVGEnumeration<MarkerUnits>::parse(std::string_view input)
+SVGEnumerationEntries<MarkerUnits> SVGEnumeration<MarkerUnits>::entries()
 {
     static const SVGEnumerationEntry<MarkerUnits> entries[] = {
         {MarkerUnits::StrokeWidth, "strokeWidth"},
         {MarkerUnits::UserSpaceOnUse, "userSpaceOnUse"}
     };
 
-    return parseEnum(input, entries);
+    return SVGEnumerationEntries<MarkerUnits>(entries);
 }
 
 template<>
-bool SVGEnumeration<LengthAdjust>::parse(std::string_view input)
+SVGEnumerationEntries<LengthAdjust> SVGEnumeration<LengthAdjust>::entries()
 {
     static const SVGEnumerationEntry<LengthAdjust> entries[] = {
         {LengthAdjust::Spacing, "spacing"},
         {LengthAdjust::SpacingAndGlyphs, "spacingAndGlyphs"}
     };
 
-    return parseEnum(input, entries);
+    return SVGEnumerationEntries<LengthAdjust>(entries);
+}
+
+template<>
+SVGEnumerationEntries<FilterBlendMode> SVGEnumeration<FilterBlendMode>::entries()
+{
+    static const SVGEnumerationEntry<FilterBlendMode> entries[] = {
+        {FilterBlendMode::Normal, "normal"},
+        {FilterBlendMode::Multiply, "multiply"},
+        {FilterBlendMode::Screen, "screen"},
+        {FilterBlendMode::Darken, "darken"},
+        {FilterBlendMode::Lighten, "lighten"}
+    };
+
+    return SVGEnumerationEntries<FilterBlendMode>(entries);
+}
+
+template<>
+SVGEnumerationEntries<CompositeOperator> SVGEnumeration<CompositeOperator>::entries()
+{
+    static const SVGEnumerationEntry<CompositeOperator> entries[] = {
+        {CompositeOperator::Over, "over"},
+        {CompositeOperator::In, "in"},
+        {CompositeOperator::Out, "out"},
+        {CompositeOperator::Atop, "atop"},
+        {CompositeOperator::Xor, "xor"},
+        {CompositeOperator::Arithmetic, "arithmetic"}
+    };
+
+    return SVGEnumerationEntries<CompositeOperator>(entries);
+}
+
+template<>
+SVGEnumerationEntries<ColorMatrixType> SVGEnumeration<ColorMatrixType>::entries()
+{
+    static const SVGEnumerationEntry<ColorMatrixType> entries[] = {
+        {ColorMatrixType::Matrix, "matrix"},
+        {ColorMatrixType::Saturate, "saturate"},
+        {ColorMatrixType::HueRotate, "hueRotate"},
+        {ColorMatrixType::LuminanceToAlpha, "luminanceToAlpha"}
+    };
+
+    return SVGEnumerationEntries<ColorMatrixType>(entries);
+}
+
+template<>
+SVGEnumerationEntries<CalcMode> SVGEnumeration<CalcMode>::entries()
+{
+    static const SVGEnumerationEntry<CalcMode> entries[] = {
+        {CalcMode::Discrete, "discrete"},
+        {CalcMode::Linear, "linear"},
+        {CalcMode::Paced, "paced"},
+        {CalcMode::Spline, "spline"}
+    };
+
+    return SVGEnumerationEntries<CalcMode>(entries);
+}
+
+template<>
+SVGEnumerationEntries<AnimationAdditive> SVGEnumeration<AnimationAdditive>::entries()
+{
+    static const SVGEnumerationEntry<AnimationAdditive> entries[] = {
+        {AnimationAdditive::Replace, "replace"},
+        {AnimationAdditive::Sum, "sum"}
+    };
+
+    return SVGEnumerationEntries<AnimationAdditive>(entries);
+}
+
+template<>
+SVGEnumerationEntries<AnimationAccumulate> SVGEnumeration<AnimationAccumulate>::entries()
+{
+    static const SVGEnumerationEntry<AnimationAccumulate> entries[] = {
+        {AnimationAccumulate::None, "none"},
+        {AnimationAccumulate::Sum, "sum"}
+    };
+
+    return SVGEnumerationEntries<AnimationAccumulate>(entries);
+}
+
+template<>
+SVGEnumerationEntries<TransformType> SVGEnumeration<TransformType>::entries()
+{
+    static const SVGEnumerationEntry<TransformType> entries[] = {
+        {TransformType::Translate, "translate"},
+        {TransformType::Scale, "scale"},
+        {TransformType::Rotate, "rotate"},
+        {TransformType::SkewX, "skewX"},
+        {TransformType::SkewY, "skewY"}
+    };
+
+    return SVGEnumerationEntries<TransformType>(entries);
 }
 
 template<typename Enum>
-template<unsigned int N>
-bool SVGEnumeration<Enum>::parseEnum(std::string_view input, const SVGEnumerationEntry<Enum>(&entries)[N])
+bool SVGEnumeration<Enum>::parse(std::string_view input)
 {
     stripLeadingAndTrailingSpaces(input);
-    for(const auto& entry : entries) {
+    for(const auto& entry : entries()) {
         if(input == entry.second) {
             m_value = entry.first;
             return true;
@@ -189,6 +330,34 @@ bool SVGEnumeration<Enum>::parseEnum(std::string_view input, const SVGEnumeratio
     return false;
 }
 
+template<typename Enum>
+void SVGEnumeration<Enum>::assign(const SVGProperty& other)
+{
+    m_value = static_cast<const SVGEnumeration<Enum>&>(other).m_value;
+}
+
+template<typename Enum>
+void SVGEnumeration<Enum>::write(BinaryWriter& writer) const
+{
+    writer.write(m_value);
+}
+
+template<typename Enum>
+bool SVGEnumeration<Enum>::read(BinaryReader& reader)
+{
+    std::underlying_type_t<Enum> value;
+    if(!reader.read(value))
+        return false;
+    for(const auto& entry : entries()) {
+        if(value == static_cast<std::underlying_type_t<Enum>>(entry.first)) {
+            m_value = entry.first;
+            return true;
+        }
+    }
+
+    return false;
+}
+
 bool SVGAngle::parse(std::string_view input)
 {
     stripLeadingAndTrailingSpaces(input);
@@ -224,6 +393,30 @@ bool SVGAngle::parse(std::string_view input)
     return true;
 }
 
+void SVGAngle::assign(const SVGProperty& other)
+{
+    const auto& property = static_cast<const SVGAngle&>(other);
+    m_value = property.m_value;
+    m_orientType = property.m_orientType;
+}
+
+void SVGAngle::write(BinaryWriter& writer) const
+{
+    writer.write(m_value);
+    writer.write(m_orientType);
+}
+
+bool SVGAngle::read(BinaryReader& reader)
+{
+    std::underlying_type_t<OrientType> orientType;
+    if(!reader.read(m_value) || !reader.read(orientType))
+        return false;
+    if(orientType < 0 || orientType > static_cast<int>(OrientType::Angle))
+        return false;
+    m_orientType = static_cast<OrientType>(orientType);
+    return true;
+}
+
 bool Length::parse(std::string_view input, LengthNegativeMode mode)
 {
     float value = 0.f;
@@ -313,6 +506,64 @@ bool Length::parse(std::string_view input, LengthNegativeMode mode)
     return input.empty();
 }
 
+// Lengths are stored as a float value and a units byte rather than as the struct, which has padding.
+void Length::write(BinaryWriter& writer) const
+{
+    writer.write(m_value);
+    writer.write(m_units);
+}
+
+bool Length::read(BinaryReader& reader, LengthNegativeMode mode)
+{
+    std::underlying_type_t<LengthUnits> units;
+    if(!reader.read(m_value) || !reader.read(units))
+        return false;
+    if(units > static_cast<uint8_t>(LengthUnits::Ex))
+        return false;
+    if(m_value < 0.f && mode == LengthNegativeMode::Forbid)
+        return false;
+    m_units = static_cast<LengthUnits>(units);
+    return true;
+}
+
+void writeLengthList(BinaryWriter& writer, const LengthList& values)
+{
+    writer.write(static_cast<uint32_t>(values.size()));
+    for(const auto& value : values) {
+        value.write(writer);
+    }
+}
+
+bool readLengthList(BinaryReader& reader, LengthList& values, LengthNegativeMode mode)
+{
+    uint32_t count;
+    if(!reader.readCount(count, sizeof(float) + sizeof(LengthUnits)))
+        return false;
+    values.resize(count);
+    for(auto& value : values) {
+        if(!value.read(reader, mode)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void BaselineShift::write(BinaryWriter& writer) const
+{
+    writer.write(static_cast<uint8_t>(m_type));
+    m_length.write(writer);
+}
+
+bool BaselineShift::read(BinaryReader& reader)
+{
+    uint8_t type;
+    if(!reader.read(type) || type > static_cast<uint8_t>(Type::Length))
+        return false;
+    m_type = static_cast<Type>(type);
+    return m_length.read(reader, LengthNegativeMode::Allow);
+}
+
 float LengthContext::valueForLength(const Length& length, LengthDirection direction) const
 {
     if(length.units() == LengthUnits::Percent) {
@@ -346,6 +597,22 @@ bool SVGLength::parse(std::string_view input)
     return m_value.parse(input, m_negativeMode);
 }
 
+void SVGLength::assign(const SVGProperty& other)
+{
+    const auto& property = static_cast<const SVGLength&>(other);
+    m_value = property.m_value;
+}
+
+void SVGLength::write(BinaryWriter& writer) const
+{
+    m_value.write(writer);
+}
+
+bool SVGLength::read(BinaryReader& reader)
+{
+    return m_value.read(reader, m_negativeMode);
+}
+
 bool SVGLengthList::parse(std::string_view input)
 {
     m_values.clear();
@@ -366,6 +633,22 @@ bool SVGLengthList::parse(std::string_view input)
     return true;
 }
 
+void SVGLengthList::assign(const SVGProperty& other)
+{
+    const auto& property = static_cast<const SVGLengthList&>(other);
+    m_values = property.m_values;
+}
+
+void SVGLengthList::write(BinaryWriter& writer) const
+{
+    writeLengthList(writer, m_values);
+}
+
+bool SVGLengthList::read(BinaryReader& reader)
+{
+    return readLengthList(reader, m_values, m_negativeMode);
+}
+
 bool SVGNumber::parse(std::string_view input)
 {
     float value = 0.f;
@@ -378,6 +661,22 @@ bool SVGNumber::parse(std::string_view input)
     return true;
 }
 
+void SVGNumber::assign(const SVGProperty& other)
+{
+    const auto& property = static_cast<const SVGNumber&>(other);
+    m_value = property.m_value;
+}
+
+void SVGNumber::write(BinaryWriter& writer) const
+{
+    writer.write(m_value);
+}
+
+bool SVGNumber::read(BinaryReader& reader)
+{
+    return reader.read(m_value);
+}
+
 bool SVGNumberPercentage::parse(std::string_view input)
 {
     float value = 0.f;
@@ -395,6 +694,22 @@ bool SVGNumberPercentage::parse(std::string_view input)
     return true;
 }
 
+void SVGNumberPercentage::assign(const SVGProperty& other)
+{
+    const auto& property = static_cast<const SVGNumberPercentage&>(other);
+    m_value = property.m_value;
+}
+
+void SVGNumberPercentage::write(BinaryWriter& writer) const
+{
+    writer.write(m_value);
+}
+
+bool SVGNumberPercentage::read(BinaryReader& reader)
+{
+    return reader.read(m_value);
+}
+
 bool SVGNumberList::parse(std::string_view input)
 {
     m_values.clear();
@@ -410,11 +725,63 @@ bool SVGNumberList::parse(std::string_view input)
     return true;
 }
 
+void SVGNumberList::assign(const SVGProperty& other)
+{
+    const auto& property = static_cast<const SVGNumberList&>(other);
+    m_values = property.m_values;
+}
+
+void SVGNumberList::write(BinaryWriter& writer) const
+{
+    writer.writeList(m_values);
+}
+
+bool SVGNumberList::read(BinaryReader& reader)
+{
+    return reader.readList(m_values);
+}
+
 bool SVGPath::parse(std::string_view input)
 {
     return m_value.parse(input.data(), input.length());
 }
 
+void SVGPath::assign(const SVGProperty& other)
+{
+    const auto& property = static_cast<const SVGPath&>(other);
+    m_value = property.m_value;
+}
+
+void SVGPath::write(BinaryWriter& writer) const
+{
+    const uint8_t* commands = nullptr;
+    const plutovg_point_t* points = nullptr;
+    int commandCount = m_value.isNull() ? 0 : plutovg_path_get_commands(m_value.data(), &commands);
+    int pointCount = m_value.isNull() ? 0 : plutovg_path_get_points(m_value.data(), &points);
+    writer.write(static_cast<uint32_t>(commandCount));
+    writer.write(commands, commandCount);
+    writer.writePadding(alignof(plutovg_point_t));
+    writer.write(static_cast<uint32_t>(pointCount));
+    writer.write(points, pointCount * sizeof(plutovg_point_t));
+}
+
+bool SVGPath::read(BinaryReader& reader)
+{
+    uint32_t commandCount, pointCount;
+    if(!reader.readCount(commandCount, 1) || commandCount > INT_MAX)
+        return false;
+    auto commands = reader.skip(commandCount);
+    if(!reader.skipPadding(alignof(plutovg_point_t)) || !reader.readCount(pointCount, sizeof(plutovg_point_t)) || pointCount > INT_MAX)
+        return false;
+    auto points = reader.skip(pointCount * sizeof(plutovg_point_t));
+    if(reinterpret_cast<uintptr_t>(points) % alignof(plutovg_point_t) == 0)
+        return m_value.setData(reinterpret_cast<const uint8_t*>(commands), commandCount, reinterpret_cast<const plutovg_point_t*>(points), pointCount);
+    // The padding only aligns the points when the snapshot itself is suitably aligned in memory.
+    std::vector<plutovg_point_t> alignedPoints(pointCount);
+    std::memcpy(alignedPoints.data(), points, pointCount * sizeof(plutovg_point_t));
+    return m_value.setData(reinterpret_cast<const uint8_t*>(commands), commandCount, alignedPoints.data(), pointCount);
+}
+
 bool SVGPoint::parse(std::string_view input)
 {
     Point value;
@@ -430,6 +797,22 @@ bool SVGPoint::parse(std::string_view input)
     return true;
 }
 
+void SVGPoint::assign(const SVGProperty& other)
+{
+    const auto& property = static_cast<const SVGPoint&>(other);
+    m_value = property.m_value;
+}
+
+void SVGPoint::write(BinaryWriter& writer) const
+{
+    writer.write(m_value);
+}
+
+bool SVGPoint::read(BinaryReader& reader)
+{
+    return reader.read(m_value);
+}
+
 bool SVGPointList::parse(std::string_view input)
 {
     m_values.clear();
@@ -449,6 +832,22 @@ bool SVGPointList::parse(std::string_view input)
     return true;
 }
 
+void SVGPointList::assign(const SVGProperty& other)
+{
+    const auto& property = static_cast<const SVGPointList&>(other);
+    m_values = property.m_values;
+}
+
+void SVGPointList::write(BinaryWriter& writer) const
+{
+    writer.writeList(m_values);
+}
+
+bool SVGPointList::read(BinaryReader& reader)
+{
+    return reader.readList(m_values);
+}
+
 bool SVGRect::parse(std::string_view input)
 {
     Rect value;
@@ -470,11 +869,51 @@ bool SVGRect::parse(std::string_view input)
     return true;
 }
 
+void SVGRect::assign(const SVGProperty& other)
+{
+    const auto& property = static_cast<const SVGRect&>(other);
+    m_value = property.m_value;
+}
+
+void SVGRect::write(BinaryWriter& writer) const
+{
+    writer.write(m_value);
+}
+
+bool SVGRect::read(BinaryReader& reader)
+{
+    Rect value;
+    if(!reader.read(value) || value.w < 0.f || value.h < 0.f)
+        return false;
+    m_value = value;
+    return true;
+}
+
 bool SVGTransform::parse(std::string_view input)
 {
     return m_value.parse(input.data(), input.length());
 }
 
+void SVGTransform::assign(const SVGProperty& other)
+{
+    const auto& property = static_cast<const SVGTransform&>(other);
+    m_value = property.m_value;
+}
+
+void SVGTransform::write(BinaryWriter& writer) const
+{
+    writer.write(m_value.matrix());
+}
+
+bool SVGTransform::read(BinaryReader& reader)
+{
+    plutovg_matrix_t matrix;
+    if(!reader.read(matrix))
+        return false;
+    m_value = Transform(matrix);
+    return true;
+}
+
 bool SVGPreserveAspectRatio::parse(std::string_view input)
 {
     auto alignType = AlignType::xMidYMid;
@@ -521,6 +960,35 @@ bool SVGPreserveAspectRatio::parse(std::string_view input)
     return true;
 }
 
+void SVGPreserveAspectRatio::assign(const SVGProperty& other)
+{
+    const auto& property = static_cast<const SVGPreserveAspectRatio&>(other);
+    m_alignType = property.m_alignType;
+    m_meetOrSlice = property.m_meetOrSlice;
+}
+
+void SVGPreserveAspectRatio::write(BinaryWriter& writer) const
+{
+    writer.write(m_alignType);
+    writer.write(m_meetOrSlice);
+}
+
+bool SVGPreserveAspectRatio::read(BinaryReader& reader)
+{
+    std::underlying_type_t<AlignType> alignType;
+    std::underlying_type_t<MeetOrSlice> meetOrSlice;
+    if(!reader.read(alignType) || !reader.read(meetOrSlice))
+        return false;
+    if(alignType < 0 || alignType > static_cast<int>(AlignType::xMaxYMax)
+        || meetOrSlice < 0 || meetOrSlice > static_cast<int>(MeetOrSlice::Slice)) {
+        return false;
+    }
+
+    m_alignType = static_cast<AlignType>(alignType);
+    m_meetOrSlice = static_cast<MeetOrSlice>(meetOrSlice);
+    return true;
+}
+
 Rect SVGPreserveAspectRatio::getClipRect(const Rect& viewBoxRect, const Size& viewportSize) const
 {
     assert(!viewBoxRect.isEmpty() && !viewportSize.isEmpty());
@@ -13,18 +13,20 @@ enum class SVGRenderMode {
 class SVGBlendInfo {
 public:
     explicit SVGBlendInfo(const SVGElement* element);
-    SVGBlendInfo(const SVGClipPathElement* clipper, const SVGMaskElement* masker, float opacity)
-        : m_clipper(clipper), m_masker(masker), m_opacity(opacity)
+    SVGBlendInfo(const SVGClipPathElement* clipper, const SVGMaskElement* masker, const SVGFilterElement* filter, float opacity)
+        : m_clipper(clipper), m_masker(masker), m_filter(filter), m_opacity(opacity)
     {}
 
     bool requiresCompositing(SVGRenderMode mode) const;
     const SVGClipPathElement* clipper() const { return m_clipper; }
     const SVGMaskElement* masker() const { return m_masker; }
+    const SVGFilterElement* filter() const { return m_filter; }
     float opacity() const { return m_opacity; }
 
 private:
     const SVGClipPathElement* m_clipper;
     const SVGMaskElement* m_masker;
+    const SVGFilterElement* m_filter;
     const float m_opacity;
 };
 
@@ -53,6 +55,10 @@ public:
 
     bool hasCycleReference(const SVGElement* element) const;
 
+    RenderStats* stats() const { return m_canvas->renderOptions().stats; }
+    bool cull(bool drawsNothing) const;
+    bool isOutsideCanvas(const Rect& paintBoundingBox, const Transform& localTransform) const;
+
     void beginGroup(const SVGBlendInfo& blendInfo);
     void endGroup(const SVGBlendInfo& blendInfo);
 
@@ -3,13 +3,14 @@ namespace novasvg {
 SVGBlendInfo::SVGBlendInfo(const SVGElement* element)
     : m_clipper(element->clipper())
     , m_masker(element->masker())
+    , m_filter(element->filter())
     , m_opacity(element->opacity())
 {
 }
 
 bool SVGBlendInfo::requiresCompositing(SVGRenderMode mode) const
 {
-    return (m_clipper && m_clipper->requiresMasking()) || (mode == SVGRenderMode::Painting && (m_masker || m_opacity < 1.f));
+    return (m_clipper && m_clipper->requiresMasking()) || (mode == SVGRenderMode::Painting && (m_masker || m_filter || m_opacity < 1.f));
 }
 
 bool SVGRenderState::hasCycleReference(const SVGElement* element) const
@@ -23,18 +24,51 @@ bool SVGRenderState::hasCycleReference(const SVGElement* element) const
     return false;
 }
 
+bool SVGRenderState::cull(bool drawsNothing) const
+{
+    if(auto stats = this->stats()) {
+        stats->elementsVisited++;
+        if(drawsNothing) {
+            stats->elementsCulled++;
+        }
+    }
+
+    return drawsNothing;
+}
+
+bool SVGRenderState::isOutsideCanvas(const Rect& paintBoundingBox, const Transform& localTransform) const
+{
+    // Anti-aliasing can touch the pixel next to the exact bounds.
+    auto boundingBox = (m_currentTransform * localTransform).mapRect(paintBoundingBox);
+    boundingBox.inflate(1.f);
+    return boundingBox.intersected(m_canvas->extents()).isEmpty();
+}
+
 void SVGRenderState::beginGroup(const SVGBlendInfo& blendInfo)
 {
     auto requiresCompositing = blendInfo.requiresCompositing(m_mode);
+    auto requiresMaskLayer = (blendInfo.clipper() && blendInfo.clipper()->requiresMasking())
+        || (m_mode == SVGRenderMode::Painting && blendInfo.masker());
     if(requiresCompositing) {
         auto boundingBox = m_currentTransform.mapRect(m_element->paintBoundingBox());
         boundingBox.intersect(m_canvas->extents());
-        m_canvas = Canvas::create(boundingBox);
-    } else {
+        // A clip mask or mask is built in a second layer of the same size, so both must fit.
+        // Without room the group is drawn in place, dropping its opacity and filter.
+        requiresCompositing = m_canvas->canCreateLayer(boundingBox, requiresMaskLayer ? 2 : 1);
+        if(requiresCompositing) {
+            m_canvas = m_canvas->createLayer(boundingBox);
+        }
+    }
+
+    if(!requiresCompositing) {
         m_canvas->save();
     }
 
-    if(!requiresCompositing && blendInfo.clipper()) {
+    if(!requiresCompositing && requiresMaskLayer) {
+        // Neither a mask nor a clip that needs one can be approximated, so the content is
+        // hidden rather than shown unmasked or partly clipped.
+        m_canvas->clipRect(Rect::Empty, FillRule::NonZero, Transform::Identity);
+    } else if(!requiresCompositing && blendInfo.clipper()) {
         blendInfo.clipper()->applyClipPath(*this);
     }
 }
@@ -47,6 +81,8 @@ void SVGRenderState::endGroup(const SVGBlendInfo& blendInfo)
     }
 
     auto opacity = m_mode == SVGRenderMode::Clipping ? 1.f : blendInfo.opacity();
+    if(m_mode == SVGRenderMode::Painting && blendInfo.filter())
+        m_canvas = blendInfo.filter()->applyFilter(*this);
     if(blendInfo.clipper())
         blendInfo.clipper()->applyClipMask(*this);
     if(m_mode == SVGRenderMode::Painting && blendInfo.masker()) {
@@ -519,8 +519,9 @@ void SVGTextElement::layout(SVGLayoutState& state)
 
 void SVGTextElement::render(SVGRenderState& state) const
 {
-    if(m_fragments.empty() || isVisibilityHidden() || isDisplayNone())
+    if(state.cull(m_fragments.empty() || isVisibilityHidden() || isDisplayNone()))
         return;
+    NOVASVG_TRACE_SCOPE("text", getAttribute(PropertyID::Id));
     SVGBlendInfo blendInfo(this);
     SVGRenderState newState(this, state, localTransform());
     newState.beginGroup(blendInfo);
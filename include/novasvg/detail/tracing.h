@@ -0,0 +1,58 @@
+#ifndef NOVASVG_TRACING_H
+#define NOVASVG_TRACING_H
+
+#include <atomic>
+#include <cstdint>
+#include <string_view>
+
+namespace novasvg {
+
+#ifdef NOVASVG_ENABLE_TRACING
+
+extern std::atomic<bool> tracingActive;
+
+// Records one complete event covering the rest of the enclosing scope. The scope is armed
+// only while tracing is active, so its arguments are not evaluated otherwise.
+class TraceScope {
+public:
+    TraceScope() = default;
+    ~TraceScope()
+    {
+        if(m_name) {
+            end();
+        }
+    }
+
+    void begin(const char* name, std::string_view detail = std::string_view(), int64_t size = -1);
+
+    static constexpr size_t kMaxDetailLength = 47;
+
+private:
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+    void end();
+    const char* m_name = nullptr;
+    int64_t m_start;
+    int64_t m_size;
+    uint8_t m_detailLength;
+    char m_detail[kMaxDetailLength];
+};
+
+#define NOVASVG_TRACE_CONCAT_(a, b) a##b
+#define NOVASVG_TRACE_CONCAT(a, b) NOVASVG_TRACE_CONCAT_(a, b)
+// The scope object must outlive the macro, so it cannot sit in a do/while; the inverted
+// if/else leaves no dangling if for an else written after the macro to bind to.
+#define NOVASVG_TRACE_SCOPE(...) \
+    novasvg::TraceScope NOVASVG_TRACE_CONCAT(traceScope, __LINE__); \
+    if(!novasvg::tracingActive.load(std::memory_order_relaxed)) {} \
+    else NOVASVG_TRACE_CONCAT(traceScope, __LINE__).begin(__VA_ARGS__)
+
+#else
+
+#define NOVASVG_TRACE_SCOPE(...) ((void)0)
+
+#endif // NOVASVG_ENABLE_TRACING
+
+} // namespace novasvg
+
+#endif // NOVASVG_TRACING_H
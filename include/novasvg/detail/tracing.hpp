@@ -0,0 +1,258 @@
+#include "tracing.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace novasvg {
+
+#ifdef NOVASVG_ENABLE_TRACING
+
+std::atomic<bool> tracingActive{false};
+
+struct TraceEvent {
+    const char* name;
+    int64_t start;
+    int64_t duration;
+    int64_t size;
+    uint8_t detailLength;
+    char detail[TraceScope::kMaxDetailLength];
+};
+
+// Events are only ever appended by the thread that owns the buffer; readers see the
+// prefix published through `count`, so recording only locks to allocate a new chunk.
+struct TraceBuffer {
+    static constexpr size_t kChunkSize = 4096;
+    using Chunk = std::array<TraceEvent, kChunkSize>;
+
+    int threadId = 0;
+    std::atomic<uint64_t> session{0};
+    std::atomic<size_t> count{0};
+    std::vector<std::unique_ptr<Chunk>> chunks;
+};
+
+struct TraceRegistry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<TraceBuffer>> buffers;
+    std::vector<TraceBuffer*> freeBuffers;
+    std::atomic<uint64_t> session{0};
+    std::atomic<int64_t> origin{0};
+    int nextThreadId = 1;
+};
+
+static TraceRegistry& traceRegistry()
+{
+    static TraceRegistry registry;
+    return registry;
+}
+
+static int64_t traceClock()
+{
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+}
+
+// Hands the thread's buffer back to the registry when the thread exits. A later thread
+// takes it over, events and thread id included, so the number of buffers is bounded by
+// the number of threads tracing at once rather than by every thread ever started.
+struct TraceBufferLease {
+    TraceBuffer* buffer = nullptr;
+
+    ~TraceBufferLease()
+    {
+        if(buffer == nullptr)
+            return;
+        auto& registry = traceRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.freeBuffers.push_back(buffer);
+    }
+};
+
+static TraceBuffer* traceBuffer()
+{
+    thread_local TraceBufferLease lease;
+    auto& registry = traceRegistry();
+    if(lease.buffer == nullptr) {
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        if(registry.freeBuffers.empty()) {
+            registry.buffers.push_back(std::make_unique<TraceBuffer>());
+            registry.buffers.back()->threadId = registry.nextThreadId++;
+            lease.buffer = registry.buffers.back().get();
+        } else {
+            lease.buffer = registry.freeBuffers.back();
+            registry.freeBuffers.pop_back();
+        }
+    }
+
+    auto buffer = lease.buffer;
+    auto session = registry.session.load(std::memory_order_acquire);
+    if(buffer->session.load(std::memory_order_relaxed) != session) {
+        buffer->count.store(0, std::memory_order_relaxed);
+        buffer->session.store(session, std::memory_order_release);
+    }
+
+    return buffer;
+}
+
+void TraceScope::begin(const char* name, std::string_view detail, int64_t size)
+{
+    m_name = name;
+    m_size = size;
+    auto length = std::min(detail.length(), kMaxDetailLength);
+    // Cut before a UTF-8 lead byte so the trace JSON never holds half a character.
+    if(length < detail.length()) {
+        while(length > 0 && (static_cast<unsigned char>(detail[length]) & 0xC0) == 0x80) {
+            --length;
+        }
+    }
+
+    m_detailLength = static_cast<uint8_t>(length);
+    if(length > 0)
+        std::memcpy(m_detail, detail.data(), m_detailLength);
+    m_start = traceClock();
+}
+
+void TraceScope::end()
+{
+    auto finish = traceClock();
+    auto buffer = traceBuffer();
+    auto index = buffer->count.load(std::memory_order_relaxed);
+    if(index / TraceBuffer::kChunkSize == buffer->chunks.size()) {
+        // Growing the chunk list is the only step a concurrent traceToJson() can observe.
+        std::lock_guard<std::mutex> lock(traceRegistry().mutex);
+        buffer->chunks.push_back(std::make_unique<TraceBuffer::Chunk>());
+    }
+
+    auto& event = (*buffer->chunks[index / TraceBuffer::kChunkSize])[index % TraceBuffer::kChunkSize];
+    event.name = m_name;
+    event.start = m_start;
+    event.duration = finish - m_start;
+    event.size = m_size;
+    event.detailLength = m_detailLength;
+    std::copy_n(m_detail, m_detailLength, event.detail);
+    buffer->count.store(index + 1, std::memory_order_release);
+}
+
+static void appendTraceString(std::string& output, std::string_view value)
+{
+    output += '"';
+    for(auto cc : value) {
+        if(cc == '"' || cc == '\\') {
+            output += '\\';
+            output += cc;
+        } else if(static_cast<unsigned char>(cc) < 0x20) {
+            char buffer[8];
+            std::snprintf(buffer, sizeof(buffer), "\\u%04x", cc);
+            output += buffer;
+        } else {
+            output += cc;
+        }
+    }
+
+    output += '"';
+}
+
+bool startTracing()
+{
+    auto& registry = traceRegistry();
+    registry.origin.store(traceClock(), std::memory_order_relaxed);
+    registry.session.fetch_add(1, std::memory_order_release);
+    tracingActive.store(true, std::memory_order_release);
+    return true;
+}
+
+void stopTracing()
+{
+    tracingActive.store(false, std::memory_order_release);
+}
+
+bool isTracing()
+{
+    return tracingActive.load(std::memory_order_relaxed);
+}
+
+std::string traceToJson()
+{
+    auto& registry = traceRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    auto session = registry.session.load(std::memory_order_acquire);
+    auto origin = registry.origin.load(std::memory_order_relaxed);
+
+    std::string output("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    bool first = true;
+    char buffer[128];
+    for(const auto& traceBuffer : registry.buffers) {
+        if(traceBuffer->session.load(std::memory_order_acquire) != session)
+            continue;
+        auto count = traceBuffer->count.load(std::memory_order_acquire);
+        for(size_t index = 0; index < count; ++index) {
+            const auto& event = (*traceBuffer->chunks[index / TraceBuffer::kChunkSize])[index % TraceBuffer::kChunkSize];
+            output += first ? "\n" : ",\n";
+            first = false;
+            output += "{\"name\":";
+            appendTraceString(output, event.name);
+            std::snprintf(buffer, sizeof(buffer), ",\"cat\":\"novasvg\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f",
+                traceBuffer->threadId, (event.start - origin) / 1000.0, event.duration / 1000.0);
+            output += buffer;
+            if(event.detailLength > 0 || event.size >= 0) {
+                output += ",\"args\":{";
+                if(event.detailLength > 0) {
+                    output += "\"id\":";
+                    appendTraceString(output, std::string_view(event.detail, event.detailLength));
+                }
+
+                if(event.size >= 0) {
+                    std::snprintf(buffer, sizeof(buffer), "%s\"size\":%lld", event.detailLength > 0 ? "," : "", static_cast<long long>(event.size));
+                    output += buffer;
+                }
+
+                output += '}';
+            }
+
+            output += '}';
+        }
+    }
+
+    output += "\n]}\n";
+    return output;
+}
+
+#else
+
+bool startTracing()
+{
+    return false;
+}
+
+void stopTracing()
+{
+}
+
+bool isTracing()
+{
+    return false;
+}
+
+std::string traceToJson()
+{
+    return "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[]}\n";
+}
+
+#endif // NOVASVG_ENABLE_TRACING
+
+bool writeTraceToFile(const std::string& filename)
+{
+    std::ofstream output(filename, std::ios::binary);
+    if(!output.is_open())
+        return false;
+    output << traceToJson();
+    return output.good();
+}
+
+} // namespace novasvg
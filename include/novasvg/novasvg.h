@@ -27,6 +27,8 @@
 #define NOVASVG_H
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -131,6 +133,44 @@ bool addFontFaceFromFile(const char* family, bool bold, bool italic, const char*
 */
 bool addFontFaceFromData(const char* family, bool bold, bool italic, const void* data, size_t length, novasvg_destroy_func_t destroy_func, void* closure);
 
+/**
+* @brief Starts recording trace events, discarding any previously recorded ones.
+*
+* Parsing, style application, build, layout, element rendering, filters and canvas
+* fill/stroke/blend calls are recorded as scoped events on every thread. Tracing is compiled
+* in only when `NOVASVG_ENABLE_TRACING` is defined; otherwise it costs nothing and this
+* function does nothing.
+* @return `true` if tracing is available in this build, `false` otherwise.
+*/
+bool startTracing();
+
+/**
+* @brief Stops recording trace events. Recorded events are kept until the next `startTracing`.
+*/
+void stopTracing();
+
+/**
+* @brief Checks whether trace events are currently being recorded.
+* @return `true` between `startTracing` and `stopTracing`, `false` otherwise.
+*/
+bool isTracing();
+
+/**
+* @brief Returns the recorded events in Chrome Trace Event JSON format.
+*
+* The output loads in `chrome://tracing` and Perfetto. Call it while no document is being
+* parsed or rendered, typically after `stopTracing`.
+* @return The JSON document as a string.
+*/
+std::string traceToJson();
+
+/**
+* @brief Writes the recorded events to a file in Chrome Trace Event JSON format.
+* @param filename The path of the JSON file to write.
+* @return `true` if the file was written successfully, `false` otherwise.
+*/
+bool writeTraceToFile(const std::string& filename);
+
 /**
 * @note Bitmap pixel format is ARGB32_Premultiplied.
 */
@@ -466,6 +506,122 @@ public:
     float f{0}; ///< The vertical translation offset.
 };
 
+/**
+ * @brief Scan converters used to turn shapes into pixel coverage.
+ */
+enum class Rasterizer {
+    Gray, ///< Cell-based rasterizer; well suited to text and many small shapes.
+    Sparse ///< Sparse-scanline rasterizer; well suited to large shapes.
+};
+
+/**
+ * @brief Presets trading rendering accuracy for speed.
+ */
+enum class RenderQuality {
+    Draft, ///< Aliased edges, nearest image sampling, coarse curves, small gradient tables and the sparse rasterizer; for live previews and thumbnails.
+    Normal, ///< The default balance of quality and speed.
+    High ///< Finer curve flattening for large or close-up output.
+};
+
+/**
+ * @brief Compositing operators, in the order `RenderStats::pixelsBlended` is indexed.
+ */
+enum class BlendOperator {
+    Clear, ///< Clears the destination.
+    Src, ///< Source replaces destination; opaque solid fills are upgraded to this from `SrcOver`.
+    Dst, ///< Destination is kept.
+    SrcOver, ///< Source is composited over destination.
+    DstOver, ///< Destination is composited over source.
+    SrcIn, ///< Source within destination.
+    DstIn, ///< Destination within source; used to apply clip masks and masks.
+    SrcOut, ///< Source outside destination.
+    DstOut, ///< Destination outside source.
+    SrcAtop, ///< Source atop destination.
+    DstAtop, ///< Destination atop source.
+    Xor ///< Source and destination where they do not overlap.
+};
+
+/**
+ * @brief Counters describing the work done by one or more renders.
+ *
+ * Pass a pointer through `RenderOptions::stats` to collect them. Renders add to the
+ * counters, so call `reset()` between renders to measure each one separately.
+ */
+class NOVASVG_API RenderStats {
+public:
+    /**
+     * @brief Sets every counter back to zero.
+     */
+    void reset() { *this = RenderStats(); }
+
+    /**
+     * @brief Returns the number of pixels blended with any operator.
+     * @return The sum of `pixelsBlended`.
+     */
+    uint64_t totalPixelsBlended() const;
+
+    uint64_t elementsVisited{0}; ///< Elements whose rendering was started.
+    uint64_t elementsCulled{0}; ///< Visited elements skipped without drawing: not displayed, hidden, or painted entirely outside their target surface.
+    uint64_t fills{0}; ///< Path fills, including clip shapes.
+    uint64_t strokes{0}; ///< Path strokes.
+    uint64_t glyphs{0}; ///< Glyphs filled or stroked.
+    uint64_t images{0}; ///< Raster images drawn.
+    uint64_t spans{0}; ///< Coverage spans handed to the compositor.
+    uint64_t pixelsBlended[12]{}; ///< Pixels composited, indexed by `BlendOperator`.
+    uint64_t offscreenCanvases{0}; ///< Offscreen surfaces allocated for groups, clip masks, masks, patterns and filter results.
+    uint64_t offscreenBytes{0}; ///< Total size of those surfaces in bytes.
+    uint64_t peakOffscreenBytes{0}; ///< The most bytes of offscreen surfaces alive at once during any single render.
+    uint64_t effectsSkipped{0}; ///< Layers, masks, patterns and filters dropped to stay within `RenderOptions::memoryBudget`.
+    uint64_t clipMasks{0}; ///< Clip paths rendered to a mask because a plain clip could not express them.
+    uint64_t masks{0}; ///< `<mask>` renders.
+    uint64_t patternRenders{0}; ///< `<pattern>` tiles rendered.
+    uint64_t markerRenders{0}; ///< Markers placed on shapes.
+    uint64_t filterRenders{0}; ///< Filter graphs run.
+    double layoutTime{0}; ///< Seconds spent on the layout a render triggered.
+    double renderTime{0}; ///< Seconds spent painting, including the filter and masking time below.
+    double filterTime{0}; ///< Seconds spent running filter graphs.
+    double maskingTime{0}; ///< Seconds spent rendering clip masks and masks.
+};
+
+/**
+ * @brief How a render ended.
+ */
+enum class RenderStatus {
+    Complete, ///< Everything was drawn.
+    Cancelled, ///< `RenderOptions::cancel` was raised; the bitmap holds a partial result.
+    DeadlineExceeded ///< `RenderOptions::deadline` passed; the bitmap holds a partial result.
+};
+
+/**
+ * @brief Controls the speed/quality trade-offs applied while rendering.
+ *
+ * A default-constructed object matches `RenderQuality::Normal`.
+ */
+class NOVASVG_API RenderOptions {
+public:
+    /**
+     * @brief Constructs options with the normal quality preset.
+     */
+    RenderOptions() = default;
+
+    /**
+     * @brief Constructs options from a quality preset.
+     * @param quality The preset to apply.
+     */
+    explicit RenderOptions(RenderQuality quality);
+
+    bool antialias{true}; ///< Whether fill, stroke and clip edges are anti-aliased.
+    bool smoothImages{true}; ///< Whether transformed images and patterns are sampled bilinearly rather than from the nearest pixel.
+    float curveTolerance{0.1f}; ///< The maximum distance, in device pixels, between a curve and its flattened approximation.
+    int gradientTableSize{1024}; ///< The number of entries in each gradient's color lookup table, clamped to [2, 1024].
+    Rasterizer rasterizer{Rasterizer::Gray}; ///< The scan converter used for fills, strokes and clips.
+    int threads{0}; ///< The maximum number of threads filter effects may run on; 0 uses every available core and 1 keeps rendering on the calling thread.
+    size_t memoryBudget{0}; ///< The most bytes the offscreen surfaces of one render may hold at once; 0 means no limit. Groups that do not fit are drawn without their opacity or filter, and hidden when they carry a mask or a clip path that needs one; patterns and filters that do not fit are skipped.
+    RenderStats* stats{nullptr}; ///< Where to accumulate render counters, or null to skip collecting them; concurrent renders need separate objects.
+    const std::atomic<bool>* cancel{nullptr}; ///< A flag another thread may raise to stop the render early, or null. It is polled between elements, between bands of scanlines and between batches of spans.
+    std::chrono::steady_clock::time_point deadline{std::chrono::steady_clock::time_point::max()}; ///< The time at which the render stops early, polled like `cancel`; the default never passes.
+};
+
 class SVGNode;
 class SVGTextNode;
 class SVGElement;
@@ -602,17 +758,20 @@ public:
      * @brief Renders the element onto a bitmap using a transformation matrix.
      * @param bitmap The bitmap to render onto.
      * @param The root transformation matrix.
+     * @param options The speed/quality trade-offs to apply.
+     * @return Whether the render completed or was stopped early by `options`.
      */
-    void render(Bitmap& bitmap, const Matrix& matrix = Matrix()) const;
+    RenderStatus render(Bitmap& bitmap, const Matrix& matrix = Matrix(), const RenderOptions& options = RenderOptions()) const;
 
     /**
      * @brief Renders the element to a bitmap with specified dimensions.
      * @param width The desired width in pixels, or -1 to auto-scale based on the intrinsic size.
      * @param height The desired height in pixels, or -1 to auto-scale based on the intrinsic size.
      * @param backgroundColor The background color in 0xRRGGBBAA format.
+     * @param options The speed/quality trade-offs to apply.
      * @return A Bitmap containing the raster representation of the element.
      */
-    Bitmap renderToBitmap(int width = -1, int height = -1, uint32_t backgroundColor = 0x00000000) const;
+    Bitmap renderToBitmap(int width = -1, int height = -1, uint32_t backgroundColor = 0x00000000, const RenderOptions& options = RenderOptions()) const;
 
     /**
      * @brief Retrieves the local transformation matrix of the element.
@@ -692,6 +851,54 @@ public:
      */
     static std::unique_ptr<Document> loadFromData(const char* data, size_t length);
 
+    /**
+     * @brief Load an SVG document, failing if its element tree outgrows a memory budget.
+     *
+     * The budget covers the elements and text parsed from the data and the copies made to
+     * expand `<use>` references, which can grow exponentially with the size of the input.
+     * @param data The string containing the SVG data.
+     * @param length The length of the string in bytes.
+     * @param memoryBudget The most bytes the element tree may use, as estimated by `memoryUsage()`; 0 means no limit.
+     * @return A pointer to the loaded `Document`, or `nullptr` on failure or if the budget is exceeded.
+     */
+    static std::unique_ptr<Document> loadFromData(const char* data, size_t length, size_t memoryBudget);
+
+    /**
+     * @brief Load a document from a snapshot written by `serialize()`.
+     *
+     * The bytes are decoded in place and not retained, so they may come straight from a
+     * memory-mapped file. Snapshots skip XML, CSS and attribute parsing, `<use>` expansion,
+     * reference resolution and image decoding; only animation targets are resolved on load.
+     * @param data The snapshot bytes.
+     * @param length The length of the snapshot in bytes.
+     * @return A pointer to the loaded `Document`, or `nullptr` if the snapshot is malformed or was written by another library version.
+     */
+    static std::unique_ptr<Document> loadFromBinary(const char* data, size_t length);
+
+    /**
+     * @brief Load a document from a snapshot written by `serialize()`.
+     * @param data The snapshot bytes.
+     * @return A pointer to the loaded `Document`, or `nullptr` on failure.
+     */
+    static std::unique_ptr<Document> loadFromBinary(const std::string& data);
+
+    /**
+     * @brief Writes a compact binary snapshot of the document for `loadFromBinary()`.
+     *
+     * The snapshot holds the element tree with stylesheet rules already applied, `<use>`
+     * clones expanded, attribute values and references in parsed form and images decoded.
+     * Animated attributes are written with their base values. The format
+     * is versioned and native-endian; it only loads into the library version that wrote it.
+     * @return The snapshot bytes.
+     */
+    std::string serialize() const;
+
+    /**
+     * @brief Estimates the memory held by the element tree.
+     * @return The approximate number of bytes used by elements, `<use>` expansions and text.
+     */
+    size_t memoryUsage() const { return m_memoryUsage; }
+
     /**
      * @brief Applies a CSS stylesheet to the document.
      * @param content A string containing the CSS rules to apply, with comments removed.
@@ -737,17 +944,70 @@ public:
      * @brief Renders the document onto a bitmap using a transformation matrix.
      * @param bitmap The bitmap to render onto.
      * @param The root transformation matrix.
+     * @param options The speed/quality trade-offs to apply.
+     * @return Whether the render completed or was stopped early by `options`.
+     */
+    RenderStatus render(Bitmap& bitmap, const Matrix& matrix = Matrix(), const RenderOptions& options = RenderOptions()) const;
+
+    /**
+     * @brief Repaints only the parts of a bitmap affected by changes since the last call.
+     *
+     * Every attribute or text change records the old and new paint bounds of the changed
+     * element. This call clears the union of those regions to `backgroundColor` and renders
+     * the whole document clipped to it, so content underneath and around the changes composites
+     * as in a full render. The first call, and any change to the root element or to a resource
+     * such as a gradient or filter, repaints the entire bitmap, as does the call after a repaint
+     * that `options` stopped early.
+     * @param bitmap A bitmap holding the previous rendering with the same matrix.
+     * @param matrix The root transformation matrix.
+     * @param backgroundColor The background color in 0xRRGGBBAA format.
+     * @param options The speed/quality trade-offs to apply.
+     * @return The repainted region in bitmap pixels, empty if nothing changed.
+     */
+    Box renderDamaged(Bitmap& bitmap, const Matrix& matrix = Matrix(), uint32_t backgroundColor = 0x00000000, const RenderOptions& options = RenderOptions());
+
+    /**
+     * @brief Checks whether the document contains resolvable SMIL animations.
+     * @return True if `<animate>`, `<animateTransform>` or `<set>` elements target an attribute.
+     */
+    bool hasAnimations() const;
+
+    /**
+     * @brief Returns the time at which the last animation finishes its active duration.
+     *
+     * Animations that repeat indefinitely contribute a single iteration.
+     * @return The duration of the animation timeline in seconds.
+     */
+    float animationDuration() const;
+
+    /**
+     * @brief Seeks the animation timeline to the given time.
+     *
+     * Only attributes whose animated value changes are updated, and only the subtrees
+     * rooted at their elements are laid out again.
+     * @param time The document time in seconds.
+     */
+    void setAnimationTime(float time);
+
+    /**
+     * @brief Renders the document as it appears at the given animation time.
+     * @param time The document time in seconds.
+     * @param bitmap The bitmap to render onto.
+     * @param matrix The root transformation matrix.
+     * @param options The speed/quality trade-offs to apply.
+     * @return Whether the render completed or was stopped early by `options`.
      */
-    void render(Bitmap& bitmap, const Matrix& matrix = Matrix()) const;
+    RenderStatus renderFrame(float time, Bitmap& bitmap, const Matrix& matrix = Matrix(), const RenderOptions& options = RenderOptions());
 
     /**
      * @brief Renders the document to a bitmap with specified dimensions.
      * @param width The desired width in pixels, or -1 to auto-scale based on the intrinsic size.
      * @param height The desired height in pixels, or -1 to auto-scale based on the intrinsic size.
      * @param backgroundColor The background color in 0xRRGGBBAA format.
+     * @param options The speed/quality trade-offs to apply.
      * @return A Bitmap containing the raster representation of the document.
      */
-    Bitmap renderToBitmap(int width = -1, int height = -1, uint32_t backgroundColor = 0x00000000) const;
+    Bitmap renderToBitmap(int width = -1, int height = -1, uint32_t backgroundColor = 0x00000000, const RenderOptions& options = RenderOptions()) const;
 
     /**
      * @brief Returns the topmost element under the specified point.
@@ -779,7 +1039,11 @@ private:
     Document(const Document&) = delete;
     Document& operator=(const Document&) = delete;
     SVGRootElement* rootElement(bool layoutIfNeeded = false) const;
+    SVGRootElement* layoutRootElement(RenderStats* stats) const;
     bool parse(const char* data, size_t length);
+    bool parseBinary(const char* data, size_t length);
+    size_t m_memoryBudget = 0;
+    size_t m_memoryUsage = 0;
     std::unique_ptr<SVGRootElement> m_rootElement;
     friend class SVGURIReference;
     friend class SVGNode;
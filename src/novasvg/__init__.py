@@ -10,8 +10,18 @@ from ._novasvg import (
     # Font functions
     add_font_face_from_file,
     add_font_face_from_data,
+
+    # Batch rendering
+    render_batch,
     
     # Classes
+    Rasterizer,
+    RenderQuality,
+    RenderStatus,
+    BlendOperator,
+    RenderStats,
+    CancelToken,
+    RenderOptions,
     Bitmap,
     Box,
     Matrix,
@@ -31,6 +41,14 @@ __all__ = [
     "version_string",
     "add_font_face_from_file",
     "add_font_face_from_data",
+    "render_batch",
+    "Rasterizer",
+    "RenderQuality",
+    "RenderStatus",
+    "BlendOperator",
+    "RenderStats",
+    "CancelToken",
+    "RenderOptions",
     "Bitmap",
     "Box",
     "Matrix",
@@ -62,42 +80,64 @@ def load(filename: str) -> Document:
     return Document.load_from_file(filename)
 
 
+def _load_document(svg_source: Union[str, bytes, Document]) -> Document:
+    if isinstance(svg_source, Document):
+        return svg_source
+    if isinstance(svg_source, bytes) or svg_source.strip().startswith("<"):
+        doc = Document.load_from_data(svg_source)
+    else:
+        doc = Document.load_from_file(svg_source)
+    if doc is None:
+        raise ValueError("failed to load SVG document")
+    return doc
+
+
 def render_svg(
-    svg_source: Union[str, Document],
+    svg_source: Union[str, bytes, Document],
     width: int = -1,
     height: int = -1,
     background_color: int = 0x00000000,
+    out: Optional[np.ndarray] = None,
+    channel_order: str = "rgba",
+    options: Optional[RenderOptions] = None,
 ) -> np.ndarray:
     """
     Render SVG to a numpy array.
     
+    The document is rendered directly into the returned array; no intermediate
+    bitmap is allocated or copied.
+    
     Parameters
     ----------
-    svg_source : str or Document
-        SVG string or loaded Document
+    svg_source : str, bytes or Document
+        SVG string, file name or loaded Document
     width : int, optional
-        Output width in pixels (-1 for auto)
+        Output width in pixels (-1 for auto); ignored when `out` is given
     height : int, optional
-        Output height in pixels (-1 for auto)
+        Output height in pixels (-1 for auto); ignored when `out` is given
     background_color : int, optional
         Background color in 0xRRGGBBAA format
+    out : np.ndarray, optional
+        Writable uint8 array of shape (height, width, 4) to render into; the
+        document is scaled to fill it
+    channel_order : str, optional
+        "rgba" or "bgra" for straight alpha, or "bgra_premultiplied" for the
+        renderer's native layout, which skips the final conversion pass
+    options : RenderOptions, optional
+        Speed/quality trade-offs applied while rendering
         
     Returns
     -------
     np.ndarray
-        RGBA image array with shape (height, width, 4)
+        Image array with shape (height, width, 4); `out` when it was given
     """
-    if isinstance(svg_source, str):
-        # Check if it's a filename or SVG string
-        if svg_source.strip().startswith("<"):
-            doc = Document.load_from_data(svg_source)
-        else:
-            doc = Document.load_from_file(svg_source)
-    else:
-        doc = svg_source
-    
-    bitmap = doc.render_to_bitmap(width, height, background_color)
-    return bitmap.to_numpy()
+    doc = _load_document(svg_source)
+    if options is None:
+        options = RenderOptions()
+    if out is not None:
+        doc.render_into(out, background_color, channel_order, options)
+        return out
+    return doc.render_to_array(width, height, background_color, channel_order, options)
 
 
 def svg_to_array(
@@ -187,21 +227,29 @@ def _element_render_to_array(
     return bitmap.to_numpy()
 
 
-def _document_render_to_array(
-    self,
-    width: int = -1,
-    height: int = -1,
-    background_color: int = 0x00000000,
-) -> np.ndarray:
-    """Render document to numpy array."""
-    bitmap = self.render_to_bitmap(width, height, background_color)
-    return bitmap.to_numpy()
+def _bitmap_array(self, dtype=None, copy=None) -> np.ndarray:
+    """Expose the premultiplied BGRA pixels to ``np.asarray`` without copying."""
+    array = self.view()
+    if dtype is not None or copy:
+        return np.array(array, dtype=dtype, copy=True)
+    return array
+
+
+def _bitmap_dlpack(self, **kwargs):
+    """Export the premultiplied BGRA pixels through DLPack without copying."""
+    return self.view().__dlpack__(**kwargs)
+
+
+def _bitmap_dlpack_device(self):
+    return self.view().__dlpack_device__()
 
 
 # Monkey patch the classes with numpy methods
 Bitmap.to_array = _bitmap_to_array
+Bitmap.__array__ = _bitmap_array
+Bitmap.__dlpack__ = _bitmap_dlpack
+Bitmap.__dlpack_device__ = _bitmap_dlpack_device
 Element.render_to_array = _element_render_to_array
-Document.render_to_array = _document_render_to_array
 
 # Add __version__ to module
 __version__ = __version__
\ No newline at end of file
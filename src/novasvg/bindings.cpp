@@ -0,0 +1,737 @@
+/**
+ * NovaSVG Python bindings
+ *
+ * Exposes the C++ API to Python through nanobind as the `_novasvg` extension
+ * module. Pixel data crosses the boundary without copies wherever possible:
+ * - `Bitmap.view()` returns a (height, width, 4) array that aliases the bitmap
+ * - `Document.render_into()` renders straight into a caller-provided array
+ * - `Document.render_to_array()` allocates the array once and renders into it
+ * - `render_batch()` parses and renders many documents on native threads into
+ *   one preallocated (N, H, W, C) array, with the GIL released
+ *
+ * `Document.render()`, `Element.render()` and `Document.render_frame()` release the GIL
+ * while they paint, so another Python thread can raise a `CancelToken` meanwhile. Layout
+ * and animation seeks mutate the document and run with the GIL held; mutating a Document
+ * from another thread during a render is still not supported.
+ */
+
+#define NOVASVG_IMPLEMENTATION
+#include <novasvg/novasvg.h>
+
+#include <nanobind/nanobind.h>
+#include <nanobind/ndarray.h>
+#include <nanobind/stl/optional.h>
+#include <nanobind/stl/pair.h>
+#include <nanobind/stl/string.h>
+#include <nanobind/stl/string_view.h>
+#include <nanobind/stl/unique_ptr.h>
+#include <nanobind/stl/vector.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace nb = nanobind;
+using namespace nb::literals;
+
+// A writable (height, width, 4) byte array from any framework, rows may be padded.
+using PixelArray = nb::ndarray<uint8_t, nb::shape<-1, -1, 4>, nb::device::cpu>;
+// A read-only, C-contiguous (height, width, 4) byte array.
+using ConstPixelArray = nb::ndarray<const uint8_t, nb::shape<-1, -1, 4>, nb::c_contig, nb::device::cpu>;
+// A (height, width, 4) byte array handed back to Python as a NumPy array.
+using NumpyPixelArray = nb::ndarray<uint8_t, nb::numpy, nb::shape<-1, -1, 4>, nb::device::cpu>;
+// A C-contiguous array of any dtype; render_batch checks the shape and dtype itself.
+using BatchArray = nb::ndarray<nb::c_contig, nb::device::cpu>;
+// The same, handed back to Python as a NumPy array.
+using NumpyBatchArray = nb::ndarray<nb::numpy, nb::c_contig, nb::device::cpu>;
+
+// Layout of the pixels written to Python arrays.
+enum class PixelFormat {
+    RGBA, // Straight alpha, R G B A in memory.
+    BGRA, // Straight alpha, B G R A in memory.
+    PremultipliedBGRA, // The renderer's own premultiplied ARGB32 layout on little-endian hosts; needs no conversion.
+    Gray, // One channel, BT.601 luma of the rendered pixels over black.
+    Alpha // One channel, coverage only (A8).
+};
+
+PixelFormat parse_pixel_format(const std::string& name, bool allowSingleChannel = false) {
+    if (name == "rgba")
+        return PixelFormat::RGBA;
+    if (name == "bgra")
+        return PixelFormat::BGRA;
+    if (name == "bgra_premultiplied")
+        return PixelFormat::PremultipliedBGRA;
+    if (allowSingleChannel && name == "gray")
+        return PixelFormat::Gray;
+    if (allowSingleChannel && name == "a8")
+        return PixelFormat::Alpha;
+    if (allowSingleChannel)
+        throw nb::value_error("channel_order must be 'rgba', 'bgra', 'bgra_premultiplied', 'gray' or 'a8'");
+    throw nb::value_error("channel_order must be 'rgba', 'bgra' or 'bgra_premultiplied'");
+}
+
+int pixel_format_channels(PixelFormat format) {
+    return format == PixelFormat::Gray || format == PixelFormat::Alpha ? 1 : 4;
+}
+
+// Rewrites rendered premultiplied ARGB32 pixels in place into a four-channel format.
+void convert_pixels(uint8_t* data, int width, int height, int stride, PixelFormat format) {
+    switch (format) {
+    case PixelFormat::RGBA:
+        plutovg_convert_argb_to_rgba(data, data, width, height, stride);
+        break;
+    case PixelFormat::BGRA:
+        for (int y = 0; y < height; ++y) {
+            auto row = reinterpret_cast<uint32_t*>(data + y * stride);
+            for (int x = 0; x < width; ++x) {
+                uint32_t pixel = row[x];
+                uint32_t a = pixel >> 24;
+                if (a == 0 || a == 255)
+                    continue;
+                uint32_t r = (((pixel >> 16) & 0xff) * 255) / a;
+                uint32_t g = (((pixel >> 8) & 0xff) * 255) / a;
+                uint32_t b = ((pixel & 0xff) * 255) / a;
+                row[x] = (a << 24) | (r << 16) | (g << 8) | b;
+            }
+        }
+
+        break;
+    default:
+        break;
+    }
+}
+
+inline uint8_t unpremultiply(uint32_t value, uint32_t alpha) {
+    return alpha == 0 || alpha == 255 ? value : static_cast<uint8_t>((value * 255) / alpha);
+}
+
+inline void store_channel(uint8_t* dst, uint32_t value) { *dst = static_cast<uint8_t>(value); }
+inline void store_channel(float* dst, uint32_t value) { *dst = value * (1.f / 255.f); }
+
+// Copies rendered premultiplied ARGB32 pixels into a packed output slot of any format.
+template<typename T>
+void store_pixels(const uint8_t* data, int width, int height, int stride, PixelFormat format, T* dst) {
+    const int channels = pixel_format_channels(format);
+    for (int y = 0; y < height; ++y) {
+        auto row = reinterpret_cast<const uint32_t*>(data + y * stride);
+        for (int x = 0; x < width; ++x, dst += channels) {
+            uint32_t pixel = row[x];
+            uint32_t a = pixel >> 24;
+            uint32_t r = (pixel >> 16) & 0xff;
+            uint32_t g = (pixel >> 8) & 0xff;
+            uint32_t b = pixel & 0xff;
+            switch (format) {
+            case PixelFormat::RGBA:
+                store_channel(dst + 0, unpremultiply(r, a));
+                store_channel(dst + 1, unpremultiply(g, a));
+                store_channel(dst + 2, unpremultiply(b, a));
+                store_channel(dst + 3, a);
+                break;
+            case PixelFormat::BGRA:
+                store_channel(dst + 0, unpremultiply(b, a));
+                store_channel(dst + 1, unpremultiply(g, a));
+                store_channel(dst + 2, unpremultiply(r, a));
+                store_channel(dst + 3, a);
+                break;
+            case PixelFormat::PremultipliedBGRA:
+                store_channel(dst + 0, b);
+                store_channel(dst + 1, g);
+                store_channel(dst + 2, r);
+                store_channel(dst + 3, a);
+                break;
+            case PixelFormat::Gray:
+                store_channel(dst, (r * 77 + g * 150 + b * 29 + 128) >> 8);
+                break;
+            case PixelFormat::Alpha:
+                store_channel(dst, a);
+                break;
+            }
+        }
+    }
+}
+
+// Resolves -1 dimensions the same way Document::renderToBitmap does.
+bool resolve_render_size(const novasvg::Document& document, int& width, int& height) {
+    float intrinsicWidth = document.width();
+    float intrinsicHeight = document.height();
+    if (intrinsicWidth == 0.f || intrinsicHeight == 0.f)
+        return false;
+    if (width <= 0 && height <= 0) {
+        width = static_cast<int>(std::ceil(intrinsicWidth));
+        height = static_cast<int>(std::ceil(intrinsicHeight));
+    } else if (width > 0 && height <= 0) {
+        height = static_cast<int>(std::ceil(width * intrinsicHeight / intrinsicWidth));
+    } else if (height > 0 && width <= 0) {
+        width = static_cast<int>(std::ceil(height * intrinsicWidth / intrinsicHeight));
+    }
+
+    return width > 0 && height > 0;
+}
+
+// Renders the document into a caller-owned pixel buffer, either stretched to fill it or
+// scaled uniformly and centered.
+void render_document(const novasvg::Document& document, uint8_t* data, int width, int height, int stride,
+                     uint32_t background_color, PixelFormat format, const novasvg::RenderOptions& options,
+                     bool keep_aspect = false) {
+    novasvg::Bitmap bitmap(data, width, height, stride);
+    bitmap.clear(background_color);
+    float intrinsicWidth = document.width();
+    float intrinsicHeight = document.height();
+    if (intrinsicWidth > 0.f && intrinsicHeight > 0.f) {
+        float xScale = width / intrinsicWidth;
+        float yScale = height / intrinsicHeight;
+        float xOffset = 0.f;
+        float yOffset = 0.f;
+        if (keep_aspect) {
+            xScale = yScale = std::min(xScale, yScale);
+            xOffset = (width - intrinsicWidth * xScale) / 2.f;
+            yOffset = (height - intrinsicHeight * yScale) / 2.f;
+        }
+
+        novasvg::Matrix matrix(xScale, 0, 0, yScale, xOffset, yOffset);
+        document.render(bitmap, matrix, options);
+    }
+
+    convert_pixels(data, width, height, stride, format);
+}
+
+NumpyPixelArray allocate_pixels(int width, int height) {
+    auto data = new uint8_t[static_cast<size_t>(width) * height * 4];
+    nb::capsule owner(data, [](void* p) noexcept { delete[] static_cast<uint8_t*>(p); });
+    return NumpyPixelArray(data, {static_cast<size_t>(height), static_cast<size_t>(width), 4}, owner);
+}
+
+NumpyPixelArray bitmap_view(nb::handle_t<novasvg::Bitmap> self) {
+    auto& bitmap = nb::cast<novasvg::Bitmap&>(self);
+    if (bitmap.isNull())
+        throw nb::value_error("cannot view a null bitmap");
+    return NumpyPixelArray(bitmap.data(), {static_cast<size_t>(bitmap.height()), static_cast<size_t>(bitmap.width()), 4},
+                           self, {bitmap.stride(), 4, 1});
+}
+
+NumpyPixelArray bitmap_to_numpy(const novasvg::Bitmap& bitmap) {
+    if (bitmap.isNull())
+        throw nb::value_error("cannot convert a null bitmap");
+    auto array = allocate_pixels(bitmap.width(), bitmap.height());
+    auto src = bitmap.data();
+    auto dst = array.data();
+    const int rowSize = bitmap.width() * 4;
+    for (int y = 0; y < bitmap.height(); ++y)
+        std::memcpy(dst + y * rowSize, src + y * bitmap.stride(), rowSize);
+    plutovg_convert_argb_to_rgba(dst, dst, bitmap.width(), bitmap.height(), rowSize);
+    return array;
+}
+
+novasvg::Bitmap bitmap_from_numpy(ConstPixelArray array) {
+    const int width = static_cast<int>(array.shape(1));
+    const int height = static_cast<int>(array.shape(0));
+    novasvg::Bitmap bitmap(width, height);
+    plutovg_convert_rgba_to_argb(bitmap.data(), array.data(), width, height, bitmap.stride());
+    return bitmap;
+}
+
+void document_render_into(const novasvg::Document& document, PixelArray out, uint32_t background_color,
+                          const std::string& channel_order, const novasvg::RenderOptions& options) {
+    auto format = parse_pixel_format(channel_order);
+    const int height = static_cast<int>(out.shape(0));
+    const int width = static_cast<int>(out.shape(1));
+    const int64_t stride = out.stride(0);
+    if (out.stride(2) != 1 || out.stride(1) != 4 || stride < 4 * width || stride % 4 != 0)
+        throw nb::value_error("out must hold 4-byte pixels contiguously within each row");
+    if (width == 0 || height == 0)
+        return;
+    render_document(document, out.data(), width, height, static_cast<int>(stride), background_color, format, options);
+}
+
+nb::object document_render_to_array(const novasvg::Document& document, int width, int height, uint32_t background_color,
+                                    const std::string& channel_order, const novasvg::RenderOptions& options) {
+    auto format = parse_pixel_format(channel_order);
+    if (!resolve_render_size(document, width, height))
+        return nb::none();
+    auto array = allocate_pixels(width, height);
+    render_document(document, array.data(), width, height, width * 4, background_color, format, options);
+    return nb::cast(array);
+}
+
+bool add_font_face_from_data(const std::string& family, bool bold, bool italic, nb::bytes data) {
+    auto copy = std::malloc(data.size());
+    if (copy == nullptr)
+        throw std::bad_alloc();
+    std::memcpy(copy, data.c_str(), data.size());
+    return novasvg::addFontFaceFromData(family.c_str(), bold, italic, copy, data.size(), std::free, copy);
+}
+
+// A flag that stops renders given it through `RenderOptions.cancel`; any thread may raise it.
+struct CancelToken {
+    std::atomic<bool> flag{false};
+};
+
+static_assert(std::is_standard_layout_v<CancelToken>, "the flag must be pointer-interconvertible with its token");
+
+CancelToken* options_get_cancel(const novasvg::RenderOptions& options) {
+    // Python only ever stores the flag of a CancelToken here.
+    return reinterpret_cast<CancelToken*>(const_cast<std::atomic<bool>*>(options.cancel));
+}
+
+void options_set_cancel(novasvg::RenderOptions& options, nb::handle token) {
+    options.cancel = token.is_none() ? nullptr : &nb::cast<CancelToken&>(token).flag;
+}
+
+novasvg::RenderStats* options_get_stats(const novasvg::RenderOptions& options) {
+    return options.stats;
+}
+
+void options_set_stats(novasvg::RenderOptions& options, nb::handle stats) {
+    options.stats = stats.is_none() ? nullptr : &nb::cast<novasvg::RenderStats&>(stats);
+}
+
+// Python cannot read the steady clock the deadline is measured on, so it is exposed in
+// seconds from now; None means the render never runs out of time.
+std::optional<double> options_get_deadline(const novasvg::RenderOptions& options) {
+    if (options.deadline == std::chrono::steady_clock::time_point::max())
+        return std::nullopt;
+    return std::chrono::duration<double>(options.deadline - std::chrono::steady_clock::now()).count();
+}
+
+void options_set_deadline(novasvg::RenderOptions& options, std::optional<double> seconds) {
+    // Anything past a few decades, and NaN, is treated as no deadline rather than overflowing the clock.
+    if (!seconds || !(*seconds < 1e9)) {
+        options.deadline = std::chrono::steady_clock::time_point::max();
+        return;
+    }
+
+    auto timeout = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(*seconds));
+    options.deadline = std::chrono::steady_clock::now() + timeout;
+}
+
+// Layout and animation seeks rewrite the element tree, so they run with the GIL held; only the
+// paint, which just reads the tree, releases it. `lay_out` is timed into `stats` the way the
+// layout inside Document::render would have been.
+template<typename LayOut>
+void lay_out_with_gil(const novasvg::RenderOptions& options, LayOut lay_out) {
+    auto start = std::chrono::steady_clock::now();
+    lay_out();
+    if (options.stats)
+        options.stats->layoutTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+novasvg::RenderStatus document_render(novasvg::Document& document, novasvg::Bitmap& bitmap, const novasvg::Matrix& matrix,
+                                      const novasvg::RenderOptions& options) {
+    lay_out_with_gil(options, [&] { document.updateLayout(); });
+    nb::gil_scoped_release release;
+    return document.render(bitmap, matrix, options);
+}
+
+novasvg::RenderStatus document_render_frame(novasvg::Document& document, float time, novasvg::Bitmap& bitmap,
+                                            const novasvg::Matrix& matrix, const novasvg::RenderOptions& options) {
+    document.setAnimationTime(time);
+    return document_render(document, bitmap, matrix, options);
+}
+
+novasvg::RenderStatus element_render(const novasvg::Element& element, novasvg::Bitmap& bitmap, const novasvg::Matrix& matrix,
+                                     const novasvg::RenderOptions& options) {
+    // Reading the local matrix lays out the document that owns the element.
+    lay_out_with_gil(options, [&] { element.getLocalMatrix(); });
+    nb::gil_scoped_release release;
+    return element.render(bitmap, matrix, options);
+}
+
+struct BatchSource {
+    std::string content;
+    bool isFile;
+};
+
+template<typename T>
+void render_batch_slots(const std::vector<BatchSource>& sources, int width, int height, PixelFormat format,
+                        uint32_t background_color, const novasvg::RenderOptions& options, bool keep_aspect,
+                        int threads, T* out, std::vector<char>& failed) {
+    const size_t slotSize = static_cast<size_t>(width) * height * pixel_format_channels(format);
+    // Four-channel byte output is rendered in place; everything else goes through a per-thread scratch bitmap.
+    const bool inPlace = std::is_same_v<T, uint8_t> && pixel_format_channels(format) == 4;
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        std::vector<uint8_t> scratch(inPlace ? 0 : static_cast<size_t>(width) * height * 4);
+        for (size_t index = next++; index < sources.size(); index = next++) {
+            T* slot = out + index * slotSize;
+            try {
+                const auto& source = sources[index];
+                auto document = source.isFile ? novasvg::Document::loadFromFile(source.content)
+                                              : novasvg::Document::loadFromData(source.content);
+                if (document == nullptr) {
+                    failed[index] = 1;
+                    std::fill(slot, slot + slotSize, T(0));
+                    continue;
+                }
+
+                if constexpr (std::is_same_v<T, uint8_t>) {
+                    if (inPlace) {
+                        render_document(*document, slot, width, height, width * 4, background_color, format, options, keep_aspect);
+                        continue;
+                    }
+                }
+
+                render_document(*document, scratch.data(), width, height, width * 4, background_color,
+                                PixelFormat::PremultipliedBGRA, options, keep_aspect);
+                store_pixels(scratch.data(), width, height, width * 4, format, slot);
+            } catch (...) {
+                failed[index] = 1;
+                std::fill(slot, slot + slotSize, T(0));
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int i = 1; i < threads; ++i)
+        pool.emplace_back(worker);
+    worker();
+    for (auto& thread : pool) {
+        thread.join();
+    }
+}
+
+nb::object render_batch(nb::sequence sources, nb::object size, int threads, nb::object out, uint32_t background_color,
+                        const std::string& channel_order, const std::string& dtype, const novasvg::RenderOptions& options,
+                        bool keep_aspect, bool skip_invalid) {
+    const auto format = parse_pixel_format(channel_order, true);
+    const int channels = pixel_format_channels(format);
+    if (dtype != "uint8" && dtype != "float32")
+        throw nb::value_error("dtype must be 'uint8' or 'float32'");
+    const bool normalize = dtype == "float32";
+
+    int width, height;
+    if (nb::isinstance<int>(size)) {
+        width = height = nb::cast<int>(size);
+    } else {
+        auto pair = nb::cast<std::pair<int, int>>(size);
+        width = pair.first;
+        height = pair.second;
+    }
+
+    if (width <= 0 || height <= 0)
+        throw nb::value_error("size must be positive");
+
+    // Sources are copied out of Python objects up front so the workers never touch the interpreter.
+    std::vector<BatchSource> batch;
+    batch.reserve(nb::len(sources));
+    for (nb::handle source : sources) {
+        if (nb::isinstance<nb::bytes>(source)) {
+            auto bytes = nb::borrow<nb::bytes>(source);
+            batch.push_back({std::string(bytes.c_str(), bytes.size()), false});
+        } else {
+            auto text = nb::cast<std::string>(source);
+            auto start = text.find_first_not_of(" \t\r\n");
+            bool isMarkup = start != std::string::npos && text[start] == '<';
+            batch.push_back({std::move(text), !isMarkup});
+        }
+    }
+
+    const size_t shape[4] = {batch.size(), static_cast<size_t>(height), static_cast<size_t>(width), static_cast<size_t>(channels)};
+    const auto expectedType = normalize ? nb::dtype<float>() : nb::dtype<uint8_t>();
+    void* data = nullptr;
+    nb::object result;
+    if (out.is_none()) {
+        const size_t count = shape[0] * shape[1] * shape[2] * shape[3];
+        nb::capsule owner;
+        if (normalize) {
+            auto buffer = new float[count];
+            owner = nb::capsule(buffer, [](void* p) noexcept { delete[] static_cast<float*>(p); });
+            data = buffer;
+        } else {
+            auto buffer = new uint8_t[count];
+            owner = nb::capsule(buffer, [](void* p) noexcept { delete[] static_cast<uint8_t*>(p); });
+            data = buffer;
+        }
+
+        result = nb::cast(NumpyBatchArray(data, 4, shape, owner, nullptr, expectedType));
+    } else {
+        auto array = nb::cast<BatchArray>(out);
+        bool matches = array.ndim() == 4 && array.dtype() == expectedType;
+        for (size_t i = 0; matches && i < 4; ++i)
+            matches = array.shape(i) == shape[i];
+        if (!matches)
+            throw nb::value_error("out must be a C-contiguous (N, H, W, C) array matching sources, size, channel_order and dtype");
+        data = array.data();
+        result = out;
+    }
+
+    if (threads <= 0)
+        threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    threads = static_cast<int>(std::min<size_t>(threads, std::max<size_t>(batch.size(), 1)));
+    if (options.stats != nullptr && threads > 1)
+        throw nb::value_error("options.stats cannot be shared between threads; pass threads=1 to collect stats");
+
+    // The batch already keeps every thread busy; filters running their own workers on top would only oversubscribe.
+    novasvg::RenderOptions batchOptions(options);
+    if (threads > 1)
+        batchOptions.threads = 1;
+
+    std::vector<char> failed(batch.size(), 0);
+    {
+        nb::gil_scoped_release release;
+        if (normalize) {
+            render_batch_slots(batch, width, height, format, background_color, batchOptions, keep_aspect, threads, static_cast<float*>(data), failed);
+        } else {
+            render_batch_slots(batch, width, height, format, background_color, batchOptions, keep_aspect, threads, static_cast<uint8_t*>(data), failed);
+        }
+    }
+
+    if (!skip_invalid) {
+        std::string indices;
+        for (size_t i = 0; i < failed.size(); ++i) {
+            if (failed[i])
+                indices += (indices.empty() ? "" : ", ") + std::to_string(i);
+        }
+
+        if (!indices.empty()) {
+            throw nb::value_error(("failed to render sources at indices: " + indices).c_str());
+        }
+    }
+
+    return result;
+}
+
+NB_MODULE(_novasvg, m) {
+    m.doc() = "NovaSVG native extension";
+
+    m.def("version", &novasvg::version);
+    m.def("version_string", &novasvg::versionString);
+    m.def("add_font_face_from_file", [](const std::string& family, bool bold, bool italic, const std::string& filename) {
+        return novasvg::addFontFaceFromFile(family.c_str(), bold, italic, filename.c_str());
+    }, "family"_a, "bold"_a, "italic"_a, "filename"_a);
+    m.def("add_font_face_from_data", &add_font_face_from_data, "family"_a, "bold"_a, "italic"_a, "data"_a);
+
+    nb::enum_<novasvg::Rasterizer>(m, "Rasterizer")
+        .value("Gray", novasvg::Rasterizer::Gray)
+        .value("Sparse", novasvg::Rasterizer::Sparse);
+
+    nb::enum_<novasvg::RenderQuality>(m, "RenderQuality")
+        .value("Draft", novasvg::RenderQuality::Draft)
+        .value("Normal", novasvg::RenderQuality::Normal)
+        .value("High", novasvg::RenderQuality::High);
+
+    nb::enum_<novasvg::RenderStatus>(m, "RenderStatus")
+        .value("Complete", novasvg::RenderStatus::Complete)
+        .value("Cancelled", novasvg::RenderStatus::Cancelled)
+        .value("DeadlineExceeded", novasvg::RenderStatus::DeadlineExceeded);
+
+    nb::enum_<novasvg::BlendOperator>(m, "BlendOperator")
+        .value("Clear", novasvg::BlendOperator::Clear)
+        .value("Src", novasvg::BlendOperator::Src)
+        .value("Dst", novasvg::BlendOperator::Dst)
+        .value("SrcOver", novasvg::BlendOperator::SrcOver)
+        .value("DstOver", novasvg::BlendOperator::DstOver)
+        .value("SrcIn", novasvg::BlendOperator::SrcIn)
+        .value("DstIn", novasvg::BlendOperator::DstIn)
+        .value("SrcOut", novasvg::BlendOperator::SrcOut)
+        .value("DstOut", novasvg::BlendOperator::DstOut)
+        .value("SrcAtop", novasvg::BlendOperator::SrcAtop)
+        .value("DstAtop", novasvg::BlendOperator::DstAtop)
+        .value("Xor", novasvg::BlendOperator::Xor);
+
+    nb::class_<novasvg::RenderStats>(m, "RenderStats")
+        .def(nb::init<>())
+        .def("reset", &novasvg::RenderStats::reset)
+        .def("total_pixels_blended", &novasvg::RenderStats::totalPixelsBlended)
+        .def_rw("elements_visited", &novasvg::RenderStats::elementsVisited)
+        .def_rw("elements_culled", &novasvg::RenderStats::elementsCulled)
+        .def_rw("fills", &novasvg::RenderStats::fills)
+        .def_rw("strokes", &novasvg::RenderStats::strokes)
+        .def_rw("glyphs", &novasvg::RenderStats::glyphs)
+        .def_rw("images", &novasvg::RenderStats::images)
+        .def_rw("spans", &novasvg::RenderStats::spans)
+        .def_prop_ro("pixels_blended", [](const novasvg::RenderStats& stats) {
+            return std::vector<uint64_t>(std::begin(stats.pixelsBlended), std::end(stats.pixelsBlended));
+        }, "Pixels composited, indexed by BlendOperator.")
+        .def_rw("offscreen_canvases", &novasvg::RenderStats::offscreenCanvases)
+        .def_rw("offscreen_bytes", &novasvg::RenderStats::offscreenBytes)
+        .def_rw("peak_offscreen_bytes", &novasvg::RenderStats::peakOffscreenBytes)
+        .def_rw("effects_skipped", &novasvg::RenderStats::effectsSkipped)
+        .def_rw("clip_masks", &novasvg::RenderStats::clipMasks)
+        .def_rw("masks", &novasvg::RenderStats::masks)
+        .def_rw("pattern_renders", &novasvg::RenderStats::patternRenders)
+        .def_rw("marker_renders", &novasvg::RenderStats::markerRenders)
+        .def_rw("filter_renders", &novasvg::RenderStats::filterRenders)
+        .def_rw("layout_time", &novasvg::RenderStats::layoutTime)
+        .def_rw("render_time", &novasvg::RenderStats::renderTime)
+        .def_rw("filter_time", &novasvg::RenderStats::filterTime)
+        .def_rw("masking_time", &novasvg::RenderStats::maskingTime);
+
+    nb::class_<CancelToken>(m, "CancelToken")
+        .def(nb::init<>())
+        .def("cancel", [](CancelToken& token) { token.flag.store(true); },
+             "Stops every render given this token; safe to call from any thread.")
+        .def("reset", [](CancelToken& token) { token.flag.store(false); })
+        .def_prop_ro("cancelled", [](const CancelToken& token) { return token.flag.load(); });
+
+    // The options hold raw pointers to the token and stats, so each keeps the object it was given alive.
+    nb::class_<novasvg::RenderOptions>(m, "RenderOptions")
+        .def(nb::init<>())
+        .def(nb::init<novasvg::RenderQuality>(), "quality"_a)
+        .def_rw("antialias", &novasvg::RenderOptions::antialias)
+        .def_rw("smooth_images", &novasvg::RenderOptions::smoothImages)
+        .def_rw("curve_tolerance", &novasvg::RenderOptions::curveTolerance)
+        .def_rw("gradient_table_size", &novasvg::RenderOptions::gradientTableSize)
+        .def_rw("rasterizer", &novasvg::RenderOptions::rasterizer)
+        .def_rw("threads", &novasvg::RenderOptions::threads)
+        .def_rw("memory_budget", &novasvg::RenderOptions::memoryBudget)
+        .def_prop_rw("stats", &options_get_stats, &options_set_stats, nb::for_setter(nb::keep_alive<1, 2>()),
+                     "A RenderStats that renders add their counters to, or None.")
+        .def_prop_rw("cancel", &options_get_cancel, &options_set_cancel, nb::for_setter(nb::keep_alive<1, 2>()),
+                     "A CancelToken that stops the render early once raised, or None.")
+        .def_prop_rw("deadline", &options_get_deadline, &options_set_deadline,
+                     "Seconds from now after which the render stops early, or None for no deadline.");
+
+    nb::implicitly_convertible<novasvg::RenderQuality, novasvg::RenderOptions>();
+
+    nb::class_<novasvg::Bitmap>(m, "Bitmap")
+        .def(nb::init<>())
+        .def(nb::init<int, int>(), "width"_a, "height"_a)
+        .def("width", &novasvg::Bitmap::width)
+        .def("height", &novasvg::Bitmap::height)
+        .def("stride", &novasvg::Bitmap::stride)
+        .def("data", [](const novasvg::Bitmap& bitmap) { return reinterpret_cast<uintptr_t>(bitmap.data()); })
+        .def("clear", &novasvg::Bitmap::clear, "value"_a)
+        .def("convert_to_rgba", &novasvg::Bitmap::convertToRGBA)
+        .def("is_null", &novasvg::Bitmap::isNull)
+        .def("valid", &novasvg::Bitmap::valid)
+        .def("__bool__", &novasvg::Bitmap::valid)
+        .def("write_to_png", [](const novasvg::Bitmap& bitmap, const std::string& filename) {
+            return bitmap.writeToPng(filename);
+        }, "filename"_a)
+        .def("view", &bitmap_view,
+             "Returns a (height, width, 4) array aliasing the premultiplied BGRA pixels; the bitmap stays alive while the view does.")
+        .def("to_numpy", &bitmap_to_numpy, "Returns a straight-alpha RGBA copy of the pixels.")
+        .def_static("from_numpy", &bitmap_from_numpy, "array"_a);
+
+    nb::class_<novasvg::Box>(m, "Box")
+        .def(nb::init<>())
+        .def(nb::init<float, float, float, float>(), "x"_a, "y"_a, "w"_a, "h"_a)
+        .def_rw("x", &novasvg::Box::x)
+        .def_rw("y", &novasvg::Box::y)
+        .def_rw("w", &novasvg::Box::w)
+        .def_rw("h", &novasvg::Box::h)
+        .def("transform", &novasvg::Box::transform, "matrix"_a, nb::rv_policy::reference_internal)
+        .def("transformed", &novasvg::Box::transformed, "matrix"_a)
+        .def("__repr__", [](const novasvg::Box& box) {
+            return "Box(" + std::to_string(box.x) + ", " + std::to_string(box.y) + ", "
+                + std::to_string(box.w) + ", " + std::to_string(box.h) + ")";
+        });
+
+    nb::class_<novasvg::Matrix>(m, "Matrix")
+        .def(nb::init<>())
+        .def(nb::init<float, float, float, float, float, float>(), "a"_a, "b"_a, "c"_a, "d"_a, "e"_a, "f"_a)
+        .def_rw("a", &novasvg::Matrix::a)
+        .def_rw("b", &novasvg::Matrix::b)
+        .def_rw("c", &novasvg::Matrix::c)
+        .def_rw("d", &novasvg::Matrix::d)
+        .def_rw("e", &novasvg::Matrix::e)
+        .def_rw("f", &novasvg::Matrix::f)
+        .def("__mul__", &novasvg::Matrix::operator*, "matrix"_a)
+        .def("__imul__", &novasvg::Matrix::operator*=, "matrix"_a, nb::rv_policy::reference_internal)
+        .def("multiply", &novasvg::Matrix::multiply, "matrix"_a, nb::rv_policy::reference_internal)
+        .def("translate", &novasvg::Matrix::translate, "tx"_a, "ty"_a, nb::rv_policy::reference_internal)
+        .def("scale", &novasvg::Matrix::scale, "sx"_a, "sy"_a, nb::rv_policy::reference_internal)
+        .def("rotate", &novasvg::Matrix::rotate, "angle"_a, "cx"_a = 0.f, "cy"_a = 0.f, nb::rv_policy::reference_internal)
+        .def("shear", &novasvg::Matrix::shear, "shx"_a, "shy"_a, nb::rv_policy::reference_internal)
+        .def("invert", &novasvg::Matrix::invert, nb::rv_policy::reference_internal)
+        .def("inverse", &novasvg::Matrix::inverse)
+        .def("reset", &novasvg::Matrix::reset)
+        .def_static("translated", &novasvg::Matrix::translated, "tx"_a, "ty"_a)
+        .def_static("scaled", &novasvg::Matrix::scaled, "sx"_a, "sy"_a)
+        .def_static("rotated", &novasvg::Matrix::rotated, "angle"_a, "cx"_a = 0.f, "cy"_a = 0.f)
+        .def_static("sheared", &novasvg::Matrix::sheared, "shx"_a, "shy"_a);
+
+    nb::class_<novasvg::Node>(m, "Node")
+        .def(nb::init<>())
+        .def("is_text_node", &novasvg::Node::isTextNode)
+        .def("is_element", &novasvg::Node::isElement)
+        .def("to_text_node", &novasvg::Node::toTextNode)
+        .def("to_element", &novasvg::Node::toElement)
+        .def("parent_element", &novasvg::Node::parentElement)
+        .def("is_null", &novasvg::Node::isNull)
+        .def("__bool__", [](const novasvg::Node& node) { return !node.isNull(); })
+        .def("__eq__", [](const novasvg::Node& a, const novasvg::Node& b) { return a == b; })
+        .def("__ne__", [](const novasvg::Node& a, const novasvg::Node& b) { return a != b; });
+
+    nb::class_<novasvg::TextNode, novasvg::Node>(m, "TextNode")
+        .def(nb::init<>())
+        .def("data", &novasvg::TextNode::data)
+        .def("set_data", &novasvg::TextNode::setData, "data"_a);
+
+    nb::class_<novasvg::Element, novasvg::Node>(m, "Element")
+        .def(nb::init<>())
+        .def("has_attribute", &novasvg::Element::hasAttribute, "name"_a)
+        .def("get_attribute", &novasvg::Element::getAttribute, "name"_a)
+        .def("set_attribute", &novasvg::Element::setAttribute, "name"_a, "value"_a)
+        .def("render", &element_render, "bitmap"_a, "matrix"_a = novasvg::Matrix(),
+             "options"_a = novasvg::RenderOptions(),
+             "Renders the element into `bitmap`, releasing the GIL while it paints. Concurrent mutation of the "
+             "owning Document isn't supported: don't modify it from another thread while this runs.")
+        .def("render_to_bitmap", &novasvg::Element::renderToBitmap, "width"_a = -1, "height"_a = -1,
+             "background_color"_a = 0x00000000, "options"_a = novasvg::RenderOptions())
+        .def("get_local_matrix", &novasvg::Element::getLocalMatrix)
+        .def("get_global_matrix", &novasvg::Element::getGlobalMatrix)
+        .def("get_local_bounding_box", &novasvg::Element::getLocalBoundingBox)
+        .def("get_global_bounding_box", &novasvg::Element::getGlobalBoundingBox)
+        .def("get_bounding_box", &novasvg::Element::getBoundingBox)
+        .def("children", &novasvg::Element::children);
+
+    nb::class_<novasvg::Document>(m, "Document")
+        .def_static("load_from_file", &novasvg::Document::loadFromFile, "filename"_a)
+        .def_static("load_from_data", [](const std::string& data) {
+            return novasvg::Document::loadFromData(data);
+        }, "data"_a)
+        .def_static("load_from_data", [](nb::bytes data) {
+            return novasvg::Document::loadFromData(data.c_str(), data.size());
+        }, "data"_a)
+        .def("apply_style_sheet", &novasvg::Document::applyStyleSheet, "content"_a)
+        .def("query_selector_all", &novasvg::Document::querySelectorAll, "selector"_a)
+        .def("width", &novasvg::Document::width)
+        .def("height", &novasvg::Document::height)
+        .def("bounding_box", &novasvg::Document::boundingBox)
+        .def("update_layout", &novasvg::Document::updateLayout)
+        .def("force_layout", &novasvg::Document::forceLayout)
+        .def("render", &document_render, "bitmap"_a, "matrix"_a = novasvg::Matrix(),
+             "options"_a = novasvg::RenderOptions(),
+             "Renders the document into `bitmap`, releasing the GIL while it paints. Concurrent mutation of the "
+             "Document isn't supported: don't modify it from another thread while this runs.")
+        .def("render_damaged", &novasvg::Document::renderDamaged, "bitmap"_a, "matrix"_a = novasvg::Matrix(),
+             "background_color"_a = 0x00000000, "options"_a = novasvg::RenderOptions(),
+             "Repaints only the regions changed since the last call into `bitmap` and returns the repainted Box.")
+        .def("has_animations", &novasvg::Document::hasAnimations)
+        .def("animation_duration", &novasvg::Document::animationDuration)
+        .def("set_animation_time", &novasvg::Document::setAnimationTime, "time"_a,
+             "Seeks the SMIL animation timeline; later renders show the document at `time` seconds.")
+        .def("render_frame", &document_render_frame, "time"_a, "bitmap"_a, "matrix"_a = novasvg::Matrix(),
+             "options"_a = novasvg::RenderOptions(),
+             "Seeks to `time` and renders that frame into `bitmap`, releasing the GIL only while it paints. "
+             "Concurrent mutation of the Document isn't supported: don't modify it from another thread while this runs.")
+        .def("render_to_bitmap", &novasvg::Document::renderToBitmap, "width"_a = -1, "height"_a = -1,
+             "background_color"_a = 0x00000000, "options"_a = novasvg::RenderOptions())
+        .def("render_into", &document_render_into, "out"_a, "background_color"_a = 0x00000000,
+             "channel_order"_a = "rgba", "options"_a = novasvg::RenderOptions(),
+             "Renders the document scaled to fill `out`, a writable (height, width, 4) uint8 array.")
+        .def("render_to_array", &document_render_to_array, "width"_a = -1, "height"_a = -1,
+             "background_color"_a = 0x00000000, "channel_order"_a = "rgba", "options"_a = novasvg::RenderOptions(),
+             "Renders the document into a newly allocated (height, width, 4) uint8 array.")
+        .def("element_from_point", &novasvg::Document::elementFromPoint, "x"_a, "y"_a)
+        .def("get_element_by_id", &novasvg::Document::getElementById, "id"_a)
+        .def("document_element", &novasvg::Document::documentElement);
+
+    m.def("render_batch", &render_batch, "sources"_a, "size"_a, "threads"_a = 0, "out"_a = nb::none(),
+          "background_color"_a = 0x00000000, "channel_order"_a = "rgba", "dtype"_a = "uint8",
+          "options"_a = novasvg::RenderOptions(), "keep_aspect"_a = false, "skip_invalid"_a = false,
+          "Parses and renders SVG sources (markup strings, bytes or file names) on `threads` native threads "
+          "with the GIL released, into one (N, H, W, C) array. `size` is an int or a (width, height) pair. "
+          "`channel_order` is 'rgba', 'bgra', 'bgra_premultiplied', 'gray' or 'a8'; `dtype` 'float32' "
+          "normalizes to [0, 1]. Failed sources are left zeroed and raise ValueError unless `skip_invalid`.");
+}
@@ -10,6 +10,7 @@
  * - Apply CSS stylesheets
  * - Manage fonts
  * - Batch processing
+ * - Export animation frames
  */
 
 #define NOVASVG_IMPLEMENTATION
@@ -24,6 +25,10 @@
 #include <cstring>
 #include <iomanip>
 #include <sstream>
+#include <map>
+#include <cmath>
+#include <atomic>
+#include <thread>
 
 namespace fs = std::filesystem;
 
@@ -45,7 +50,7 @@ std::string human_readable_size(std::uintmax_t bytes) {
 
 // Command implementations
 int cmd_convert(const std::string& input, const std::string& output, 
-                int width, int height, uint32_t bg_color, float scale) {
+                int width, int height, uint32_t bg_color, float scale, novasvg::RenderQuality quality) {
     std::unique_ptr<novasvg::Document> doc = novasvg::Document::loadFromFile(input);
     if (!doc) {
         std::cerr << "Error: Failed to load SVG file: " << input << "\n";
@@ -66,7 +71,7 @@ int cmd_convert(const std::string& input, const std::string& output,
         if (height > 0) std::cout << height << "px\n";
     }
 
-    auto bitmap = doc->renderToBitmap(width, height, bg_color);
+    auto bitmap = doc->renderToBitmap(width, height, bg_color, novasvg::RenderOptions(quality));
     if (bitmap.isNull()) {
         std::cerr << "Error: Failed to render SVG\n";
         return 1;
@@ -95,7 +100,66 @@ size_t count_all_elements(const novasvg::Element& element) {
     return count;
 }
 
-int cmd_info(const std::string& input, bool json_output = false) {
+// Render a document once at its intrinsic size and return the counters it produced
+novasvg::RenderStats collect_render_stats(const novasvg::Document& doc) {
+    novasvg::RenderStats stats;
+    novasvg::RenderOptions options;
+    options.stats = &stats;
+    doc.renderToBitmap(-1, -1, 0x00000000, options);
+    return stats;
+}
+
+const char* const blend_operator_names[] = {
+    "clear", "src", "dst", "src_over", "dst_over", "src_in",
+    "dst_in", "src_out", "dst_out", "src_atop", "dst_atop", "xor"
+};
+
+void print_render_stats(const novasvg::RenderStats& stats) {
+    std::cout << "Render Statistics:\n";
+    std::cout << "  Elements visited: " << stats.elementsVisited << " (" << stats.elementsCulled << " culled)\n";
+    std::cout << "  Fills: " << stats.fills << ", strokes: " << stats.strokes
+              << ", glyphs: " << stats.glyphs << ", images: " << stats.images << "\n";
+    std::cout << "  Spans: " << stats.spans << "\n";
+    std::cout << "  Pixels blended: " << stats.totalPixelsBlended() << "\n";
+    for (size_t i = 0; i < std::size(stats.pixelsBlended); ++i) {
+        if (stats.pixelsBlended[i] > 0) {
+            std::cout << "    " << blend_operator_names[i] << ": " << stats.pixelsBlended[i] << "\n";
+        }
+    }
+
+    std::cout << "  Offscreen canvases: " << stats.offscreenCanvases
+              << " (" << human_readable_size(stats.offscreenBytes) << ", peak "
+              << human_readable_size(stats.peakOffscreenBytes) << ")\n";
+    std::cout << "  Clip masks: " << stats.clipMasks << ", masks: " << stats.masks
+              << ", patterns: " << stats.patternRenders << ", markers: " << stats.markerRenders
+              << ", filters: " << stats.filterRenders << "\n";
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "  Layout: " << stats.layoutTime * 1000 << " ms\n";
+    std::cout << "  Render: " << stats.renderTime * 1000 << " ms (filters "
+              << stats.filterTime * 1000 << " ms, masking " << stats.maskingTime * 1000 << " ms)\n";
+    std::cout.unsetf(std::ios::floatfield);
+}
+
+std::string render_stats_json(const novasvg::RenderStats& stats) {
+    std::ostringstream out;
+    out << "{\"elements_visited\":" << stats.elementsVisited << ",\"elements_culled\":" << stats.elementsCulled
+        << ",\"fills\":" << stats.fills << ",\"strokes\":" << stats.strokes << ",\"glyphs\":" << stats.glyphs
+        << ",\"images\":" << stats.images << ",\"spans\":" << stats.spans << ",\"pixels_blended\":{";
+    for (size_t i = 0; i < std::size(stats.pixelsBlended); ++i) {
+        out << (i ? "," : "") << "\"" << blend_operator_names[i] << "\":" << stats.pixelsBlended[i];
+    }
+
+    out << "},\"offscreen_canvases\":" << stats.offscreenCanvases << ",\"offscreen_bytes\":" << stats.offscreenBytes
+        << ",\"peak_offscreen_bytes\":" << stats.peakOffscreenBytes << ",\"effects_skipped\":" << stats.effectsSkipped
+        << ",\"clip_masks\":" << stats.clipMasks << ",\"masks\":" << stats.masks
+        << ",\"pattern_renders\":" << stats.patternRenders << ",\"marker_renders\":" << stats.markerRenders
+        << ",\"filter_renders\":" << stats.filterRenders << ",\"layout_ms\":" << stats.layoutTime * 1000
+        << ",\"render_ms\":" << stats.renderTime * 1000 << ",\"filter_ms\":" << stats.filterTime * 1000
+        << ",\"masking_ms\":" << stats.maskingTime * 1000 << "}";
+    return out.str();
+}
+
+int cmd_info(const std::string& input, bool json_output = false, bool show_stats = false) {
     std::unique_ptr<novasvg::Document> doc = novasvg::Document::loadFromFile(input);
     if (!doc) {
         std::cerr << "Error: Failed to load SVG file: " << input << "\n";
@@ -131,7 +195,12 @@ int cmd_info(const std::string& input, bool json_output = false) {
                   << bbox.x << ",\"y\":" << bbox.y << ",\"width\":" << bbox.w 
                   << ",\"height\":" << bbox.h << "},\"total_elements\":" << total_elements 
                   << ",\"file_size\":" << file_size << ",\"readable_size\":\"" 
-                  << readable_size << "\"}\n";
+                  << readable_size << "\"";
+        if (show_stats) {
+            std::cout << ",\"render_stats\":" << render_stats_json(collect_render_stats(*doc));
+        }
+
+        std::cout << "}\n";
         return 0;
     }
     
@@ -162,6 +231,10 @@ int cmd_info(const std::string& input, bool json_output = false) {
         std::cout << "  File size: N/A\n";
     }
 
+    if (show_stats) {
+        print_render_stats(collect_render_stats(*doc));
+    }
+
     return 0;
 }
 
@@ -367,6 +440,118 @@ int cmd_batch(const std::string& input_dir, const std::string& output_dir) {
     return failed > 0 ? 1 : 0;
 }
 
+int cmd_frames(const std::string& input, const std::string& output_dir, float fps, float duration,
+               int width, int height, uint32_t bg_color, unsigned int threads) {
+    std::unique_ptr<novasvg::Document> doc = novasvg::Document::loadFromFile(input);
+    if (!doc) {
+        std::cerr << "Error: Failed to load SVG file: " << input << "\n";
+        return 1;
+    }
+
+    if (fps <= 0.0f) {
+        std::cerr << "Error: Frame rate must be positive\n";
+        return 1;
+    }
+
+    if (duration < 0.0f) {
+        duration = doc->animationDuration();
+    }
+
+    const float intrinsic_width = doc->width();
+    const float intrinsic_height = doc->height();
+    if (intrinsic_width <= 0.0f || intrinsic_height <= 0.0f) {
+        std::cerr << "Error: Document has no intrinsic size\n";
+        return 1;
+    }
+
+    if (width <= 0 && height <= 0) {
+        width = static_cast<int>(std::ceil(intrinsic_width));
+        height = static_cast<int>(std::ceil(intrinsic_height));
+    } else if (height <= 0) {
+        height = static_cast<int>(std::ceil(width * intrinsic_height / intrinsic_width));
+    } else if (width <= 0) {
+        width = static_cast<int>(std::ceil(height * intrinsic_width / intrinsic_height));
+    }
+
+    // The frame at t = duration is included so a frozen end state is exported too.
+    const int frame_count = std::max(1, static_cast<int>(std::floor(duration * fps + 1e-3f)) + 1);
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    threads = std::min<unsigned int>(threads, frame_count);
+    fs::create_directories(output_dir);
+
+    std::cout << "Exporting " << frame_count << " frames (" << width << "x" << height
+              << " at " << fps << " fps) to " << output_dir << "\n";
+
+    const novasvg::Matrix matrix(width / intrinsic_width, 0, 0, height / intrinsic_height, 0, 0);
+    std::atomic<int> next_frame{0};
+    std::atomic<int> failed{0};
+    auto worker = [&](std::unique_ptr<novasvg::Document> document) {
+        // Seeking mutates the document, so every worker animates its own copy; the font and glyph
+        // caches they share are locked.
+        if (!document) {
+            document = novasvg::Document::loadFromFile(input);
+        }
+
+        if (!document) {
+            failed++;
+            return;
+        }
+
+        novasvg::Bitmap bitmap(width, height);
+        for (int frame = next_frame++; frame < frame_count; frame = next_frame++) {
+            bitmap.clear(bg_color);
+            document->renderFrame(frame / fps, bitmap, matrix);
+
+            char filename[32];
+            std::snprintf(filename, sizeof(filename), "frame_%05d.png", frame);
+            if (!bitmap.writeToPng((fs::path(output_dir) / filename).string())) {
+                std::cerr << "  Failed to save " << filename << "\n";
+                failed++;
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned int i = 1; i < threads; ++i) {
+        workers.emplace_back(worker, nullptr);
+    }
+
+    worker(std::move(doc));
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    if (failed > 0) {
+        std::cerr << "Error: " << failed << " frames failed\n";
+        return 1;
+    }
+
+    std::cout << "Successfully exported " << frame_count << " frames\n";
+    return 0;
+}
+
+// Run a command, recording a Chrome trace of it when a trace file is given
+template <typename Command>
+int run_traced(const std::string& trace_file, Command command) {
+    if (trace_file.empty()) {
+        return command();
+    }
+
+    novasvg::startTracing();
+    int result = command();
+    novasvg::stopTracing();
+    if (!novasvg::writeTraceToFile(trace_file)) {
+        std::cerr << "Error: Failed to write trace to " << trace_file << "\n";
+        return 1;
+    }
+
+    std::cout << "Trace written to " << trace_file << "\n";
+    return result;
+}
+
 int main(int argc, char** argv) {
     CLI::App app{"NovaSVG CLI - SVG processing tool"};
     
@@ -381,7 +566,9 @@ int main(int argc, char** argv) {
                "  novasvg info input.svg\n"
                "  novasvg query \"circle\" input.svg\n"
                "  novasvg query \"rect[fill='red']\" input.svg\n"
-               "  novasvg batch input_dir/ output_dir/\n");
+               "  novasvg batch input_dir/ output_dir/\n"
+               "  novasvg convert --trace trace.json input.svg output.png\n"
+               "  novasvg frames --fps 30 animated.svg frames/\n");
     
     // Convert command
     auto convert_cmd = app.add_subcommand("convert", "Convert SVG to PNG");
@@ -389,6 +576,13 @@ int main(int argc, char** argv) {
     int convert_width = -1, convert_height = -1;
     std::string convert_bg_color;
     float convert_scale = 0.0f;
+    novasvg::RenderQuality convert_quality = novasvg::RenderQuality::Normal;
+    std::string convert_trace;
+    const std::map<std::string, novasvg::RenderQuality> quality_names = {
+        {"draft", novasvg::RenderQuality::Draft},
+        {"normal", novasvg::RenderQuality::Normal},
+        {"high", novasvg::RenderQuality::High}
+    };
     
     convert_cmd->add_option("input", convert_input, "Input SVG file")->required()->check(CLI::ExistingFile);
     convert_cmd->add_option("output", convert_output, "Output PNG file")->required();
@@ -396,25 +590,32 @@ int main(int argc, char** argv) {
     convert_cmd->add_option("-H,--height", convert_height, "Output height in pixels");
     convert_cmd->add_option("-b,--bg", convert_bg_color, "Background color (hex: RRGGBBAA, default: transparent)");
     convert_cmd->add_option("-s,--scale", convert_scale, "Scale factor");
+    convert_cmd->add_option("-q,--quality", convert_quality, "Render quality: draft, normal or high (default: normal)")
+        ->transform(CLI::CheckedTransformer(quality_names, CLI::ignore_case));
+    convert_cmd->add_option("--trace", convert_trace, "Write a Chrome trace (JSON) of parsing, layout and rendering");
     
     convert_cmd->callback([&]() {
         uint32_t bg_color = 0x00000000; // Transparent
         if (!convert_bg_color.empty()) {
             bg_color = std::stoul(convert_bg_color, nullptr, 16);
         }
-        return cmd_convert(convert_input, convert_output, convert_width, convert_height, bg_color, convert_scale);
+        return run_traced(convert_trace, [&]() {
+            return cmd_convert(convert_input, convert_output, convert_width, convert_height, bg_color, convert_scale, convert_quality);
+        });
     });
     
     // Info command
     auto info_cmd = app.add_subcommand("info", "Display SVG information");
     std::string info_input;
     bool info_json = false;
+    bool info_stats = false;
     
     info_cmd->add_option("input", info_input, "Input SVG file")->required()->check(CLI::ExistingFile);
     info_cmd->add_flag("--json", info_json, "Output in JSON format");
+    info_cmd->add_flag("--stats", info_stats, "Render once and report render statistics");
     
     info_cmd->callback([&]() {
-        return cmd_info(info_input, info_json);
+        return cmd_info(info_input, info_json, info_stats);
     });
     
     // Query command
@@ -445,14 +646,45 @@ int main(int argc, char** argv) {
     // Batch command
     auto batch_cmd = app.add_subcommand("batch", "Batch process multiple files");
     std::string batch_input, batch_output = "output";
+    std::string batch_trace;
     
     batch_cmd->add_option("input", batch_input, "Input directory")->required()->check(CLI::ExistingDirectory);
     batch_cmd->add_option("output", batch_output, "Output directory");
+    batch_cmd->add_option("--trace", batch_trace, "Write a Chrome trace (JSON) of parsing, layout and rendering");
     
     batch_cmd->callback([&]() {
-        return cmd_batch(batch_input, batch_output);
+        return run_traced(batch_trace, [&]() {
+            return cmd_batch(batch_input, batch_output);
+        });
     });
     
+    // Frames command
+    auto frames_cmd = app.add_subcommand("frames", "Export the frames of an animated SVG as PNG files");
+    std::string frames_input, frames_output = "frames";
+    std::string frames_bg_color;
+    float frames_fps = 30.0f;
+    float frames_duration = -1.0f;
+    int frames_width = -1, frames_height = -1;
+    unsigned int frames_threads = 0;
+
+    frames_cmd->add_option("input", frames_input, "Input SVG file")->required()->check(CLI::ExistingFile);
+    frames_cmd->add_option("output", frames_output, "Output directory (default: frames)");
+    frames_cmd->add_option("-r,--fps", frames_fps, "Frames per second (default: 30)");
+    frames_cmd->add_option("-d,--duration", frames_duration, "Seconds to export (default: the animation duration)");
+    frames_cmd->add_option("-w,--width", frames_width, "Output width in pixels");
+    frames_cmd->add_option("-H,--height", frames_height, "Output height in pixels");
+    frames_cmd->add_option("-b,--bg", frames_bg_color, "Background color (hex: RRGGBBAA, default: transparent)");
+    frames_cmd->add_option("-j,--threads", frames_threads, "Worker threads (default: all cores)");
+
+    frames_cmd->callback([&]() {
+        uint32_t bg_color = 0x00000000;
+        if (!frames_bg_color.empty()) {
+            bg_color = std::stoul(frames_bg_color, nullptr, 16);
+        }
+        return cmd_frames(frames_input, frames_output, frames_fps, frames_duration,
+                          frames_width, frames_height, bg_color, frames_threads);
+    });
+
     // Parse and run
     try {
         app.parse(argc, argv);
@@ -0,0 +1,244 @@
+#include "doctest.h"
+
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <novasvg/novasvg.h>
+
+namespace {
+std::unique_ptr<novasvg::Document> load_animated(const std::string& body)
+{
+    return novasvg::Document::loadFromData("<svg xmlns='http://www.w3.org/2000/svg' width='100' height='100'>" + body + "</svg>");
+}
+
+bool same_pixels(const novasvg::Bitmap& a, const novasvg::Bitmap& b)
+{
+    return a.width() == b.width() && a.height() == b.height()
+        && std::memcmp(a.data(), b.data(), a.height() * a.stride()) == 0;
+}
+} // namespace
+
+TEST_CASE("Animations interpolate attributes linearly over their duration") {
+    auto document = load_animated(
+        "<circle id='c' cx='10' cy='50' r='5' fill='red'>"
+        "<animate attributeName='cx' from='10' to='90' dur='2s'/>"
+        "<animate attributeName='fill' from='#ff0000' to='#0000ff' dur='2s'/>"
+        "</circle>");
+    REQUIRE(document != nullptr);
+    CHECK(document->hasAnimations());
+    CHECK(document->animationDuration() == doctest::Approx(2.f));
+
+    auto circle = document->getElementById("c");
+    document->setAnimationTime(0.5f);
+    CHECK(circle.getAttribute("cx") == "30");
+    CHECK(circle.getAttribute("fill") == "#bf0040ff");
+    CHECK(circle.getBoundingBox().x == doctest::Approx(25.f));
+
+    document->setAnimationTime(1.5f);
+    CHECK(circle.getAttribute("cx") == "70");
+    CHECK(circle.getBoundingBox().x == doctest::Approx(65.f));
+
+    // Without fill="freeze" the base value comes back once the animation ends.
+    document->setAnimationTime(2.f);
+    CHECK(circle.getAttribute("cx") == "10");
+    CHECK(circle.getAttribute("fill") == "red");
+    CHECK(circle.getBoundingBox().x == doctest::Approx(5.f));
+}
+
+TEST_CASE("Attributes without a base value return to their initial value") {
+    auto document = load_animated(
+        "<rect id='r' width='10' height='10'>"
+        "<animate attributeName='x' from='20' to='40' dur='1s'/>"
+        "</rect>");
+    REQUIRE(document != nullptr);
+
+    auto rect = document->getElementById("r");
+    document->setAnimationTime(0.5f);
+    CHECK(rect.getBoundingBox().x == doctest::Approx(30.f));
+    document->setAnimationTime(2.f);
+    CHECK_FALSE(rect.hasAttribute("x"));
+    CHECK(rect.getBoundingBox().x == doctest::Approx(0.f));
+
+    // Restoring the initial value does not grow the document.
+    auto memoryUsage = document->memoryUsage();
+    for(int frame = 0; frame < 10; ++frame) {
+        document->setAnimationTime(0.5f);
+        document->setAnimationTime(2.f);
+    }
+
+    CHECK(document->memoryUsage() == memoryUsage);
+}
+
+TEST_CASE("Animation timing honours begin, repeatCount and freeze") {
+    auto document = load_animated(
+        "<rect id='r' x='0' width='10' height='10'>"
+        "<animate attributeName='x' from='0' to='10' begin='1s' dur='500ms' repeatCount='2' accumulate='sum' fill='freeze'/>"
+        "</rect>");
+    REQUIRE(document != nullptr);
+    CHECK(document->animationDuration() == doctest::Approx(2.f));
+
+    auto rect = document->getElementById("r");
+    document->setAnimationTime(0.5f);
+    CHECK(rect.getAttribute("x") == "0");
+    document->setAnimationTime(1.25f);
+    CHECK(rect.getAttribute("x") == "5");
+    document->setAnimationTime(1.75f);
+    CHECK(rect.getAttribute("x") == "15");
+    document->setAnimationTime(5.f);
+    CHECK(rect.getAttribute("x") == "20");
+}
+
+TEST_CASE("Values, keyTimes and calcMode select animation values") {
+    auto document = load_animated(
+        "<rect id='a' width='10' height='10'>"
+        "<animate attributeName='x' values='0;10;40' keyTimes='0;0.5;1' dur='2s'/></rect>"
+        "<rect id='b' width='10' height='10'>"
+        "<animate attributeName='y' values='0;10;20' calcMode='discrete' dur='3s'/></rect>"
+        "<rect id='c' width='10' height='10'>"
+        "<set attributeName='visibility' to='hidden' begin='1s'/></rect>");
+    REQUIRE(document != nullptr);
+
+    auto a = document->getElementById("a");
+    auto b = document->getElementById("b");
+    auto c = document->getElementById("c");
+    document->setAnimationTime(1.5f);
+    CHECK(a.getAttribute("x") == "25");
+    CHECK(b.getAttribute("y") == "10");
+    CHECK(c.getAttribute("visibility") == "hidden");
+
+    document->setAnimationTime(0.5f);
+    CHECK(a.getAttribute("x") == "5");
+    CHECK(b.getAttribute("y") == "0");
+    CHECK(c.getAttribute("visibility").empty());
+}
+
+TEST_CASE("Values that can't be interpolated animate discretely") {
+    auto document = load_animated(
+        "<rect id='a' width='10' height='10' visibility='visible'>"
+        "<animate attributeName='visibility' values='visible;hidden' dur='1s' fill='freeze'/></rect>"
+        "<rect id='b' width='10' height='10' stroke='black'>"
+        "<animate attributeName='stroke-linecap' values='butt;round;square' dur='3s' fill='freeze'/></rect>"
+        "<rect id='c' width='10' height='10' visibility='visible'>"
+        "<animate attributeName='visibility' to='hidden' dur='1s' fill='freeze'/></rect>");
+    REQUIRE(document != nullptr);
+
+    auto a = document->getElementById("a");
+    auto b = document->getElementById("b");
+    auto c = document->getElementById("c");
+    document->setAnimationTime(0.4f);
+    CHECK(a.getAttribute("visibility") == "visible");
+    CHECK(b.getAttribute("stroke-linecap") == "butt");
+    CHECK(c.getAttribute("visibility") == "visible");
+
+    document->setAnimationTime(0.6f);
+    CHECK(a.getAttribute("visibility") == "hidden");
+    CHECK(c.getAttribute("visibility") == "hidden");
+
+    document->setAnimationTime(2.5f);
+    CHECK(a.getAttribute("visibility") == "hidden");
+    CHECK(b.getAttribute("stroke-linecap") == "square");
+    CHECK(c.getAttribute("visibility") == "hidden");
+
+    document->setAnimationTime(5.f);
+    CHECK(a.getAttribute("visibility") == "hidden");
+    CHECK(b.getAttribute("stroke-linecap") == "square");
+    CHECK(c.getAttribute("visibility") == "hidden");
+}
+
+TEST_CASE("animateTransform builds full transform functions") {
+    auto document = load_animated(
+        "<rect id='r' width='10' height='10' transform='translate(5 5)'>"
+        "<animateTransform attributeName='transform' type='rotate' from='0 5 5' to='360 5 5' dur='4s' repeatCount='indefinite' additive='sum'/>"
+        "</rect>"
+        "<rect id='s' width='10' height='10'>"
+        "<animateTransform attributeName='transform' type='scale' from='1' to='3' dur='2s'/>"
+        "</rect>");
+    REQUIRE(document != nullptr);
+    CHECK(document->animationDuration() == doctest::Approx(4.f));
+
+    document->setAnimationTime(5.f);
+    CHECK(document->getElementById("r").getAttribute("transform") == "translate(5 5) rotate(90 5 5)");
+    document->setAnimationTime(1.f);
+    CHECK(document->getElementById("s").getAttribute("transform") == "scale(2 2)");
+    CHECK(document->getElementById("s").getGlobalBoundingBox().w == doctest::Approx(20.f));
+}
+
+TEST_CASE("Rendered frames match a document holding the animated values") {
+    const std::string shapes =
+        "<linearGradient id='g'><stop offset='0' stop-color='yellow'>%STOP%</stop><stop offset='1' stop-color='blue'/></linearGradient>"
+        "<g transform='translate(10 10)'>"
+        "<rect id='r' x='0' y='0' width='30' height='20' fill='url(#g)'>%RECT%</rect>"
+        "<text x='10' y='60' font-size='12'>A<tspan dx='0' fill='green'>B%TSPAN%</tspan></text>"
+        "</g>";
+    auto expand = [&shapes](const std::string& stop, const std::string& rect, const std::string& tspan) {
+        std::string result(shapes);
+        result.replace(result.find("%STOP%"), 6, stop);
+        result.replace(result.find("%RECT%"), 6, rect);
+        result.replace(result.find("%TSPAN%"), 7, tspan);
+        return result;
+    };
+
+    auto animated = load_animated(expand(
+        "<animate attributeName='stop-color' from='yellow' to='red' dur='2s' fill='freeze'/>",
+        "<animate attributeName='width' from='30' to='60' dur='2s' fill='freeze'/>",
+        "<animate attributeName='dx' from='0' to='20' dur='2s' fill='freeze'/>"));
+    REQUIRE(animated != nullptr);
+
+    novasvg::Bitmap first(100, 100);
+    animated->renderFrame(0.f, first);
+    for(float time : {1.f, 2.f}) {
+        auto width = std::to_string(static_cast<int>(30 + 15 * time));
+        auto dx = std::to_string(static_cast<int>(10 * time));
+        auto expected = load_animated(expand("", "", ""));
+        REQUIRE(expected != nullptr);
+        auto stop = expected->querySelectorAll("stop").front();
+        stop.setAttribute("stop-color", time == 1.f ? "#ff8000ff" : "#ff0000ff");
+        expected->querySelectorAll("rect").front().setAttribute("width", width);
+        expected->querySelectorAll("tspan").front().setAttribute("dx", dx);
+
+        novasvg::Bitmap frame(100, 100);
+        animated->renderFrame(time, frame);
+        auto reference = expected->renderToBitmap();
+        CHECK(same_pixels(frame, reference));
+        CHECK(!same_pixels(frame, first));
+    }
+}
+
+TEST_CASE("Frames of animated text render on several threads at once") {
+    const std::string body =
+        "<text x='10' y='50' font-size='20'>Frame"
+        "<animate attributeName='x' from='10' to='40' dur='1s' fill='freeze'/></text>";
+    auto document = load_animated(body);
+    REQUIRE(document != nullptr);
+
+    std::vector<novasvg::Bitmap> expected;
+    for(int frame = 0; frame < 8; ++frame) {
+        expected.emplace_back(100, 100);
+        expected.back().clear(0);
+        document->renderFrame(frame / 7.f, expected.back());
+    }
+
+    // Like `novasvg frames`, every worker seeks its own copy of the document.
+    std::atomic<int> mismatches(0);
+    std::vector<std::thread> workers;
+    for(int i = 0; i < 4; ++i) {
+        workers.emplace_back([&] {
+            auto copy = load_animated(body);
+            for(int frame = 0; frame < 8; ++frame) {
+                novasvg::Bitmap bitmap(100, 100);
+                bitmap.clear(0);
+                copy->renderFrame(frame / 7.f, bitmap);
+                if(!same_pixels(bitmap, expected[frame])) {
+                    mismatches++;
+                }
+            }
+        });
+    }
+
+    for(auto& worker : workers)
+        worker.join();
+    CHECK(mismatches == 0);
+}
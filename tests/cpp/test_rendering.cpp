@@ -0,0 +1,1098 @@
+#include "doctest.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <novasvg/novasvg.h>
+#include <novasvg/detail/plutovg/plutovg.h>
+#include <novasvg/detail/graphics.h>
+
+extern "C" {
+#include <novasvg/detail/plutovg/plutovg-private.h>
+}
+
+namespace {
+uint32_t pixel_at(const novasvg::Bitmap& bitmap, int x, int y)
+{
+    auto row = reinterpret_cast<const uint32_t*>(bitmap.data() + y * bitmap.stride());
+    return row[x];
+}
+
+int max_alpha_difference(void (*draw)(plutovg_canvas_t*))
+{
+    plutovg_surface_t* surfaces[2];
+    const plutovg_rasterizer_t rasterizers[2] = {PLUTOVG_RASTERIZER_GRAY, PLUTOVG_RASTERIZER_SPARSE};
+    for(int i = 0; i < 2; ++i) {
+        surfaces[i] = plutovg_surface_create(128, 128);
+        auto canvas = plutovg_canvas_create(surfaces[i]);
+        plutovg_canvas_set_rasterizer(canvas, rasterizers[i]);
+        draw(canvas);
+        plutovg_canvas_destroy(canvas);
+    }
+
+    int difference = 0;
+    const unsigned char* a = plutovg_surface_get_data(surfaces[0]);
+    const unsigned char* b = plutovg_surface_get_data(surfaces[1]);
+    for(int i = 3; i < 128 * 128 * 4; i += 4)
+        difference = std::max(difference, std::abs(a[i] - b[i]));
+    plutovg_surface_destroy(surfaces[0]);
+    plutovg_surface_destroy(surfaces[1]);
+    return difference;
+}
+} // namespace
+
+TEST_CASE("Nested clip paths are restored after each group") {
+    const std::string svg = R"svg(
+        <svg xmlns="http://www.w3.org/2000/svg" width="100" height="100">
+          <clipPath id="left"><rect width="50" height="100"/></clipPath>
+          <clipPath id="top"><rect width="100" height="50"/></clipPath>
+          <g clip-path="url(#left)">
+            <rect width="100" height="100" fill="#ff0000" clip-path="url(#top)"/>
+            <rect y="50" width="100" height="50" fill="#0000ff"/>
+          </g>
+          <rect x="60" y="60" width="40" height="40" fill="#00ff00"/>
+        </svg>
+    )svg";
+
+    auto document = novasvg::Document::loadFromData(svg);
+    REQUIRE(document != nullptr);
+
+    auto bitmap = document->renderToBitmap(100, 100);
+    REQUIRE_FALSE(bitmap.isNull());
+    CHECK(pixel_at(bitmap, 25, 25) == 0xFFFF0000);
+    CHECK(pixel_at(bitmap, 75, 25) == 0x00000000);
+    CHECK(pixel_at(bitmap, 25, 75) == 0xFF0000FF);
+    CHECK(pixel_at(bitmap, 75, 75) == 0xFF00FF00);
+}
+
+TEST_CASE("Sparse rasterizer matches the gray rasterizer") {
+    // Polygons partially outside the surface, in both fill rules.
+    CHECK(max_alpha_difference([](plutovg_canvas_t* canvas) {
+        plutovg_canvas_move_to(canvas, -40.f, 10.3f);
+        plutovg_canvas_line_to(canvas, 150.f, 40.7f);
+        plutovg_canvas_line_to(canvas, 20.5f, 160.f);
+        plutovg_canvas_close_path(canvas);
+        plutovg_canvas_fill(canvas);
+    }) <= 2);
+
+    CHECK(max_alpha_difference([](plutovg_canvas_t* canvas) {
+        plutovg_canvas_set_fill_rule(canvas, PLUTOVG_FILL_RULE_EVEN_ODD);
+        plutovg_canvas_rect(canvas, 10.25f, 10.5f, 100.f, 100.f);
+        plutovg_canvas_rect(canvas, 30.75f, 30.f, 40.f, 40.f);
+        plutovg_canvas_fill(canvas);
+    }) <= 2);
+
+    // Curves are flattened differently by each backend, so they are compared as the same
+    // pre-flattened polygons.
+    CHECK(max_alpha_difference([](plutovg_canvas_t* canvas) {
+        auto path = plutovg_path_create();
+        plutovg_path_add_ellipse(path, 64.3f, 60.7f, 50.2f, 40.1f);
+        auto flattened = plutovg_path_clone_flatten(path);
+        plutovg_canvas_fill_path(canvas, flattened);
+        plutovg_path_destroy(flattened);
+        plutovg_path_destroy(path);
+    }) <= 2);
+
+    CHECK(max_alpha_difference([](plutovg_canvas_t* canvas) {
+        auto path = plutovg_path_create();
+        plutovg_path_add_circle(path, 64.f, 64.f, 40.f);
+        auto flattened = plutovg_path_clone_flatten(path);
+        plutovg_canvas_set_line_width(canvas, 6.f);
+        plutovg_canvas_set_line_join(canvas, PLUTOVG_LINE_JOIN_ROUND);
+        plutovg_canvas_stroke_path(canvas, flattened);
+        plutovg_path_destroy(flattened);
+        plutovg_path_destroy(path);
+    }) <= 2);
+}
+
+TEST_CASE("Streamed and clipped fills blend identically") {
+    plutovg_surface_t* surfaces[2];
+    for(int i = 0; i < 2; ++i) {
+        surfaces[i] = plutovg_surface_create(64, 64);
+        auto canvas = plutovg_canvas_create(surfaces[i]);
+        if(i == 1) {
+            plutovg_canvas_rect(canvas, 0.f, 0.f, 64.f, 64.f);
+            plutovg_canvas_clip(canvas);
+        }
+
+        const plutovg_gradient_stop_t stops[2] = {{0.f, {1.f, 0.f, 0.f, 1.f}}, {1.f, {0.f, 0.f, 1.f, 0.5f}}};
+        plutovg_canvas_set_linear_gradient(canvas, 0.f, 0.f, 64.f, 64.f, PLUTOVG_SPREAD_METHOD_PAD, stops, 2, nullptr);
+        plutovg_canvas_circle(canvas, 32.f, 32.f, 28.f);
+        plutovg_canvas_fill(canvas);
+        plutovg_canvas_destroy(canvas);
+    }
+
+    const unsigned char* a = plutovg_surface_get_data(surfaces[0]);
+    const unsigned char* b = plutovg_surface_get_data(surfaces[1]);
+    CHECK(std::equal(a, a + 64 * 64 * 4, b));
+    plutovg_surface_destroy(surfaces[0]);
+    plutovg_surface_destroy(surfaces[1]);
+}
+
+TEST_CASE("Opaque solid spans blend like one span at a time") {
+    // Abutting full spans on a row are merged into one fill; edge spans interrupt the merge.
+    std::vector<plutovg_span_t> spans = {
+        {2, 5, 1, 255}, {7, 3, 1, 255}, {10, 4, 1, 255}, {14, 1, 1, 128}, {15, 6, 1, 255},
+        {20, 8, 2, 255}, {0, 20, 3, 255}, {0, 1, 4, 0}, {1, 30, 4, 1}, {31, 1, 4, 254},
+        {0, 32, 5, 255}
+    };
+
+    auto blend_spans = [](plutovg_surface_t* surface, plutovg_span_t* data, int count) {
+        auto canvas = plutovg_canvas_create(surface);
+        plutovg_canvas_set_rgb(canvas, 0.2f, 0.6f, 1.f);
+        plutovg_span_buffer_t buffer;
+        buffer.spans.data = data;
+        buffer.spans.size = count;
+        buffer.spans.capacity = count;
+        buffer.x = buffer.y = 0;
+        buffer.w = buffer.h = -1;
+        plutovg_blend(canvas, &buffer);
+        plutovg_canvas_destroy(canvas);
+    };
+
+    plutovg_surface_t* surfaces[2];
+    for(int i = 0; i < 2; ++i) {
+        surfaces[i] = plutovg_surface_create(32, 8);
+        auto pixels = reinterpret_cast<uint32_t*>(plutovg_surface_get_data(surfaces[i]));
+        for(int j = 0; j < 32 * 8; ++j)
+            pixels[j] = 0x80402010;
+    }
+
+    blend_spans(surfaces[0], spans.data(), static_cast<int>(spans.size()));
+    for(auto& span : spans)
+        blend_spans(surfaces[1], &span, 1);
+
+    const unsigned char* merged = plutovg_surface_get_data(surfaces[0]);
+    const unsigned char* single = plutovg_surface_get_data(surfaces[1]);
+    CHECK(std::equal(merged, merged + 32 * 8 * 4, single));
+
+    // Edge spans interpolate between the fill and what was underneath by their coverage.
+    const uint32_t solid = 0xff3399ff;
+    auto rows = reinterpret_cast<const uint32_t*>(merged);
+    for(const auto& span : spans) {
+        for(int x = span.x; x < span.x + span.len; ++x) {
+            uint32_t pixel = rows[span.y * 32 + x];
+            for(int shift = 0; shift < 32; shift += 8) {
+                float expected = (((solid >> shift) & 0xff) * span.coverage + ((0x80402010u >> shift) & 0xff) * (255 - span.coverage)) / 255.f;
+                CHECK(std::abs(int((pixel >> shift) & 0xff) - expected) <= 1.f);
+            }
+        }
+    }
+
+    plutovg_surface_destroy(surfaces[0]);
+    plutovg_surface_destroy(surfaces[1]);
+}
+
+TEST_CASE("Dashed curves are flattened to the device tolerance") {
+    plutovg_surface_t* surfaces[2];
+    for(int i = 0; i < 2; ++i) {
+        surfaces[i] = plutovg_surface_create(128, 128);
+        auto canvas = plutovg_canvas_create(surfaces[i]);
+        CHECK(plutovg_canvas_get_curve_tolerance(canvas) == PLUTOVG_DEFAULT_CURVE_TOLERANCE);
+        if(i == 1) {
+            // A single gap-free dash routes the stroke through the user-space dasher.
+            const float dashes[2] = {100.f, 0.f};
+            plutovg_canvas_set_dash_array(canvas, dashes, 2);
+        }
+
+        plutovg_canvas_scale(canvas, 100.f, 100.f);
+        plutovg_canvas_set_line_width(canvas, 0.04f);
+        plutovg_canvas_circle(canvas, 0.64f, 0.64f, 0.5f);
+        plutovg_canvas_stroke(canvas);
+        plutovg_canvas_destroy(canvas);
+    }
+
+    int difference = 0;
+    const unsigned char* a = plutovg_surface_get_data(surfaces[0]);
+    const unsigned char* b = plutovg_surface_get_data(surfaces[1]);
+    for(int i = 3; i < 128 * 128 * 4; i += 4)
+        difference = std::max(difference, std::abs(a[i] - b[i]));
+    CHECK(difference <= 40);
+    plutovg_surface_destroy(surfaces[0]);
+    plutovg_surface_destroy(surfaces[1]);
+}
+
+TEST_CASE("Dashed element strokes are flattened for each render") {
+    const std::string svg = R"svg(
+        <svg xmlns="http://www.w3.org/2000/svg" width="100" height="100">
+          <path d="M10 10 C 90 10, 10 90, 90 90" fill="none" stroke="black" stroke-width="4" stroke-dasharray="8 4" stroke-dashoffset="3"/>
+        </svg>
+    )svg";
+
+    auto document = novasvg::Document::loadFromData(svg);
+    REQUIRE(document != nullptr);
+
+    auto render_on_canvas = [](int size) {
+        auto surface = plutovg_surface_create(size, size);
+        auto canvas = plutovg_canvas_create(surface);
+        const float dashes[2] = {8.f, 4.f};
+        plutovg_canvas_scale(canvas, size / 100.f, size / 100.f);
+        plutovg_canvas_set_dash_array(canvas, dashes, 2);
+        plutovg_canvas_set_dash_offset(canvas, 3.f);
+        plutovg_canvas_set_line_width(canvas, 4.f);
+        plutovg_canvas_move_to(canvas, 10.f, 10.f);
+        plutovg_canvas_cubic_to(canvas, 90.f, 10.f, 10.f, 90.f, 90.f, 90.f);
+        plutovg_canvas_stroke(canvas);
+        plutovg_canvas_destroy(canvas);
+        return surface;
+    };
+
+    auto max_difference = [](const novasvg::Bitmap& bitmap, plutovg_surface_t* surface) {
+        int difference = 0;
+        const unsigned char* data = plutovg_surface_get_data(surface);
+        for(int y = 0; y < bitmap.height(); ++y) {
+            for(int x = 0; x < bitmap.width(); ++x) {
+                int expected = data[(y * bitmap.width() + x) * 4 + 3];
+                difference = std::max(difference, std::abs(int(pixel_at(bitmap, x, y) >> 24) - expected));
+            }
+        }
+
+        return difference;
+    };
+
+    // Each render dashes at its own scale, also when renders at different scales overlap.
+    auto small = render_on_canvas(100);
+    auto large = render_on_canvas(400);
+    document->updateLayout();
+    for(int i = 0; i < 2; ++i) {
+        novasvg::Bitmap bitmaps[2];
+        std::thread thread([&] { bitmaps[1] = document->renderToBitmap(400, 400); });
+        bitmaps[0] = document->renderToBitmap(100, 100);
+        thread.join();
+        REQUIRE_FALSE(bitmaps[0].isNull());
+        REQUIRE_FALSE(bitmaps[1].isNull());
+        CHECK(max_difference(bitmaps[0], small) == 0);
+        CHECK(max_difference(bitmaps[1], large) == 0);
+    }
+
+    // Container bounding boxes are filled during layout, so concurrent renders only read them.
+    auto clipped = novasvg::Document::loadFromData(R"svg(
+        <svg xmlns="http://www.w3.org/2000/svg" width="100" height="100">
+          <clipPath id="clip" clipPathUnits="objectBoundingBox"><rect width="0.5" height="0.5"/></clipPath>
+          <g clip-path="url(#clip)">
+            <rect x="20" y="20" width="60" height="60" fill="#0000ff"/>
+          </g>
+        </svg>
+    )svg");
+    REQUIRE(clipped != nullptr);
+    clipped->updateLayout();
+    novasvg::Bitmap bitmaps[2];
+    std::thread thread([&] { bitmaps[1] = clipped->renderToBitmap(100, 100); });
+    bitmaps[0] = clipped->renderToBitmap(100, 100);
+    thread.join();
+    for(const auto& bitmap : bitmaps) {
+        REQUIRE_FALSE(bitmap.isNull());
+        CHECK(pixel_at(bitmap, 30, 30) == 0xff0000ff);
+        CHECK(pixel_at(bitmap, 70, 70) == 0x00000000);
+    }
+
+    plutovg_surface_destroy(small);
+    plutovg_surface_destroy(large);
+}
+
+TEST_CASE("Thin strokes cover their exact outline") {
+    // A one pixel wide mitered rectangle on pixel centers covers a ring of whole pixels.
+    plutovg_surface_t* surfaces[2];
+    for(int i = 0; i < 2; ++i) {
+        surfaces[i] = plutovg_surface_create(64, 64);
+        auto canvas = plutovg_canvas_create(surfaces[i]);
+        if(i == 0) {
+            plutovg_canvas_set_line_width(canvas, 1.f);
+            plutovg_canvas_rect(canvas, 10.5f, 10.5f, 40.f, 30.f);
+            plutovg_canvas_stroke(canvas);
+        } else {
+            plutovg_canvas_set_fill_rule(canvas, PLUTOVG_FILL_RULE_EVEN_ODD);
+            plutovg_canvas_rect(canvas, 10.f, 10.f, 41.f, 31.f);
+            plutovg_canvas_rect(canvas, 11.f, 11.f, 39.f, 29.f);
+            plutovg_canvas_fill(canvas);
+        }
+
+        plutovg_canvas_destroy(canvas);
+    }
+
+    const unsigned char* a = plutovg_surface_get_data(surfaces[0]);
+    const unsigned char* b = plutovg_surface_get_data(surfaces[1]);
+    CHECK(std::equal(a, a + 64 * 64 * 4, b));
+    plutovg_surface_destroy(surfaces[0]);
+    plutovg_surface_destroy(surfaces[1]);
+
+    // A diagonal hairline with butt caps covers its length times its width.
+    auto surface = plutovg_surface_create(128, 128);
+    auto canvas = plutovg_canvas_create(surface);
+    plutovg_canvas_set_line_width(canvas, 0.75f);
+    plutovg_canvas_move_to(canvas, 10.3f, 10.7f);
+    plutovg_canvas_line_to(canvas, 110.9f, 90.2f);
+    plutovg_canvas_stroke(canvas);
+    plutovg_canvas_destroy(canvas);
+
+    double coverage = 0.0;
+    const unsigned char* data = plutovg_surface_get_data(surface);
+    for(int i = 3; i < 128 * 128 * 4; i += 4)
+        coverage += data[i] / 255.0;
+    CHECK(coverage == doctest::Approx(std::hypot(100.6, 79.5) * 0.75).epsilon(0.01));
+    plutovg_surface_destroy(surface);
+
+    // Only the join whose miter is over the limit is beveled; the right angle keeps its miter.
+    auto stroke_corners = [](plutovg_line_join_t join, float miter_limit) {
+        auto surface = plutovg_surface_create(64, 80);
+        auto canvas = plutovg_canvas_create(surface);
+        plutovg_canvas_set_line_width(canvas, 2.f);
+        plutovg_canvas_set_line_join(canvas, join);
+        plutovg_canvas_set_miter_limit(canvas, miter_limit);
+        plutovg_canvas_move_to(canvas, 10.f, 10.f);
+        plutovg_canvas_line_to(canvas, 50.f, 10.f);
+        plutovg_canvas_line_to(canvas, 50.f, 50.f);
+        plutovg_canvas_line_to(canvas, 46.f, 10.f);
+        plutovg_canvas_stroke(canvas);
+        plutovg_canvas_destroy(canvas);
+        return surface;
+    };
+
+    auto alpha_at = [](plutovg_surface_t* surface, int x, int y) {
+        return plutovg_surface_get_data(surface)[y * plutovg_surface_get_stride(surface) + x * 4 + 3];
+    };
+
+    auto limited = stroke_corners(PLUTOVG_LINE_JOIN_MITER, 4.f);
+    auto unlimited = stroke_corners(PLUTOVG_LINE_JOIN_MITER, 100.f);
+    auto beveled = stroke_corners(PLUTOVG_LINE_JOIN_BEVEL, 4.f);
+    CHECK(alpha_at(limited, 50, 9) == 255);
+    CHECK(alpha_at(beveled, 50, 9) < 255);
+    CHECK(alpha_at(unlimited, 50, 56) > 0);
+    CHECK(alpha_at(limited, 50, 56) == 0);
+    int difference = 0;
+    for(int y = 20; y < 80; ++y) {
+        for(int x = 0; x < 64; ++x) {
+            difference = std::max(difference, std::abs(alpha_at(limited, x, y) - alpha_at(beveled, x, y)));
+        }
+    }
+
+    CHECK(difference == 0);
+
+    plutovg_surface_destroy(limited);
+    plutovg_surface_destroy(unlimited);
+    plutovg_surface_destroy(beveled);
+}
+
+TEST_CASE("Render quality presets") {
+    const novasvg::RenderOptions normal;
+    static_assert(!std::is_convertible_v<novasvg::RenderQuality, novasvg::RenderOptions>);
+    const novasvg::RenderOptions draft(novasvg::RenderQuality::Draft);
+    const novasvg::RenderOptions high(novasvg::RenderQuality::High);
+    CHECK(normal.antialias);
+    CHECK_FALSE(draft.antialias);
+    CHECK_FALSE(draft.smoothImages);
+    CHECK(draft.curveTolerance > normal.curveTolerance);
+    CHECK(draft.gradientTableSize < normal.gradientTableSize);
+    CHECK(draft.rasterizer == novasvg::Rasterizer::Sparse);
+    CHECK(high.curveTolerance < normal.curveTolerance);
+
+    const std::string svg = R"svg(
+        <svg xmlns="http://www.w3.org/2000/svg" width="64" height="64">
+          <defs>
+            <linearGradient id="fade"><stop offset="0" stop-color="red"/><stop offset="1" stop-color="blue"/></linearGradient>
+          </defs>
+          <circle cx="32" cy="32" r="27.3" fill="url(#fade)"/>
+          <g opacity="0.5"><path d="M4 60 C 20 20, 44 20, 60 60" stroke="black" stroke-width="3" fill="none"/></g>
+        </svg>
+    )svg";
+
+    auto document = novasvg::Document::loadFromData(svg);
+    REQUIRE(document != nullptr);
+
+    // Aliased edges leave only fully covered or untouched pixels, including inside groups.
+    auto aliased = document->renderToBitmap(-1, -1, 0x00000000, draft);
+    REQUIRE_FALSE(aliased.isNull());
+    int partial = 0;
+    for(int y = 0; y < aliased.height(); ++y) {
+        for(int x = 0; x < aliased.width(); ++x) {
+            auto alpha = pixel_at(aliased, x, y) >> 24;
+            if(alpha != 0x00 && alpha != 0x7F && alpha != 0xFF) {
+                ++partial;
+            }
+        }
+    }
+
+    CHECK(partial == 0);
+
+    auto smooth = document->renderToBitmap(-1, -1, 0x00000000, high);
+    auto edge = pixel_at(smooth, 32, 59) >> 24;
+    CHECK(edge > 0);
+    CHECK(edge < 0xFF);
+}
+
+TEST_CASE("Path commands and points are stored separately") {
+    auto path = plutovg_path_create();
+    plutovg_path_move_to(path, 1.f, 2.f);
+    plutovg_path_line_to(path, 5.f, 2.f);
+    plutovg_path_cubic_to(path, 6.f, 3.f, 6.f, 5.f, 5.f, 6.f);
+    plutovg_path_close(path);
+
+    const uint8_t* commands;
+    const plutovg_point_t* points;
+    REQUIRE(plutovg_path_get_commands(path, &commands) == 4);
+    REQUIRE(plutovg_path_get_points(path, &points) == 6);
+    CHECK(commands[2] == PLUTOVG_PATH_COMMAND_CUBIC_TO);
+    CHECK(points[4].x == 5.f);
+    CHECK(points[5].y == 2.f);
+
+    plutovg_matrix_t matrix;
+    plutovg_matrix_init_translate(&matrix, 10.f, 20.f);
+    auto copy = plutovg_path_create();
+    plutovg_path_add_path(copy, path, &matrix);
+    plutovg_path_add_path(copy, path, nullptr);
+    plutovg_path_transform(path, &matrix);
+
+    plutovg_path_iterator_t it;
+    plutovg_path_iterator_init(&it, copy);
+    plutovg_point_t segment[3];
+    std::string commandNames;
+    while(plutovg_path_iterator_has_next(&it)) {
+        auto command = plutovg_path_iterator_next(&it, segment);
+        commandNames += "MLCZ"[command];
+        if(commandNames.size() == 3) {
+            CHECK(segment[2].x == 15.f);
+            CHECK(segment[2].y == 26.f);
+        }
+    }
+
+    CHECK(commandNames == "MLCZMLCZ");
+
+    plutovg_rect_t extents;
+    plutovg_path_extents(path, &extents, false);
+    CHECK(extents.x == 11.f);
+    CHECK(extents.y == 22.f);
+    CHECK(extents.w == 5.f);
+    CHECK(extents.h == 4.f);
+
+    plutovg_path_destroy(copy);
+    plutovg_path_destroy(path);
+}
+
+TEST_CASE("Documents with text load and render on several threads at once") {
+    const std::string svg =
+        "<svg xmlns='http://www.w3.org/2000/svg' width='120' height='40'>"
+        "<text x='4' y='28' font-size='24'>Hello<tspan font-weight='bold'>Wörld</tspan></text>"
+        "</svg>";
+    auto reference = novasvg::Document::loadFromData(svg)->renderToBitmap();
+    REQUIRE_FALSE(reference.isNull());
+
+    // Every thread looks faces up in the shared font cache and fills glyphs from the shared glyph caches.
+    std::atomic<int> mismatches(0);
+    std::vector<std::thread> threads;
+    for(int i = 0; i < 4; ++i) {
+        threads.emplace_back([&] {
+            for(int j = 0; j < 16; ++j) {
+                auto bitmap = novasvg::Document::loadFromData(svg)->renderToBitmap();
+                if(bitmap.isNull() || std::memcmp(bitmap.data(), reference.data(), reference.height() * reference.stride()) != 0) {
+                    mismatches++;
+                }
+            }
+        });
+    }
+
+    for(auto& thread : threads)
+        thread.join();
+    CHECK(mismatches == 0);
+}
+
+TEST_CASE("Filter effects render drop shadows") {
+    const std::string svg = R"SVG(<svg xmlns="http://www.w3.org/2000/svg" width="100" height="100">
+        <filter id="shadow" x="-50%" y="-50%" width="200%" height="200%">
+            <feGaussianBlur in="SourceAlpha" stdDeviation="3"/>
+            <feOffset dx="10" dy="10" result="blur"/>
+            <feFlood flood-color="#ff0000"/>
+            <feComposite in2="blur" operator="in"/>
+            <feMerge><feMergeNode/><feMergeNode in="SourceGraphic"/></feMerge>
+        </filter>
+        <rect x="20" y="20" width="40" height="40" fill="#0000ff" filter="url(#shadow)"/>
+    </svg>)SVG";
+
+    auto document = novasvg::Document::loadFromData(svg);
+    REQUIRE(document != nullptr);
+    auto bitmap = document->renderToBitmap();
+    REQUIRE(!bitmap.isNull());
+
+    CHECK(pixel_at(bitmap, 40, 40) == 0xFF0000FF);
+    for(auto shadow : {pixel_at(bitmap, 62, 45), pixel_at(bitmap, 45, 62)}) {
+        CHECK((shadow >> 24) >= 250);
+        CHECK(((shadow >> 16) & 0xFF) == (shadow >> 24));
+        CHECK((shadow & 0xFFFF) == 0);
+    }
+    CHECK(pixel_at(bitmap, 10, 10) == 0);
+
+    // The blurred edge falls off symmetrically around the offset outline at x = 70.
+    auto inside = pixel_at(bitmap, 66, 45) >> 24;
+    auto edge = pixel_at(bitmap, 70, 45) >> 24;
+    auto outside = pixel_at(bitmap, 73, 45) >> 24;
+    CHECK(inside > edge);
+    CHECK(edge > outside);
+    CHECK(outside > 0);
+    CHECK(std::abs(static_cast<int>(inside + outside) - 255) <= 4);
+}
+
+TEST_CASE("Filter primitives honour subregions and color operations") {
+    const std::string svg = R"SVG(<svg xmlns="http://www.w3.org/2000/svg" width="40" height="20">
+        <filter id="gray" x="0" y="0" width="1" height="1">
+            <feColorMatrix type="saturate" values="0"/>
+        </filter>
+        <filter id="half" filterUnits="userSpaceOnUse" x="20" y="0" width="20" height="20">
+            <feFlood flood-color="#00ff00" x="20" width="10"/>
+            <feBlend in2="SourceGraphic" mode="multiply"/>
+        </filter>
+        <rect width="20" height="20" fill="#ff0000" filter="url(#gray)"/>
+        <rect x="20" width="20" height="20" fill="#ffff00" filter="url(#half)"/>
+    </svg>)SVG";
+
+    auto document = novasvg::Document::loadFromData(svg);
+    REQUIRE(document != nullptr);
+    auto bitmap = document->renderToBitmap();
+    REQUIRE(!bitmap.isNull());
+
+    auto gray = pixel_at(bitmap, 10, 10);
+    CHECK((gray >> 24) == 255);
+    CHECK(((gray >> 16) & 0xFF) == (gray & 0xFF));
+    CHECK(((gray >> 16) & 0xFF) == 54);
+
+    // The flood is clipped to its subregion, so the multiply only tints the left half.
+    CHECK(pixel_at(bitmap, 25, 10) == 0xFF00FF00);
+    CHECK(pixel_at(bitmap, 35, 10) == 0xFFFFFF00);
+}
+
+TEST_CASE("Filter primitives scale their values by the bounding box") {
+    auto render = [](const char* units, const char* offset, const char* deviation) {
+        auto svg = std::string(R"SVG(<svg xmlns="http://www.w3.org/2000/svg" width="100" height="100">
+            <filter id="f" x="-1" y="-1" width="3" height="3" primitiveUnits=")SVG") + units + R"SVG(">
+                <feOffset )SVG" + offset + R"SVG(/>
+                <feGaussianBlur stdDeviation=")SVG" + deviation + R"SVG("/>
+            </filter>
+            <rect x="20" y="30" width="40" height="20" fill="#0000ff" filter="url(#f)"/>
+        </svg>)SVG";
+        auto document = novasvg::Document::loadFromData(svg);
+        REQUIRE(document != nullptr);
+        return document->renderToBitmap();
+    };
+
+    auto expected = render("userSpaceOnUse", R"(dx="10" dy="10")", "2 4");
+    auto bitmap = render("objectBoundingBox", R"(dx="0.25" dy="0.5")", "0.05 0.2");
+    REQUIRE(!expected.isNull());
+    REQUIRE(!bitmap.isNull());
+    CHECK((pixel_at(expected, 50, 50) >> 24) > 250);
+    CHECK(pixel_at(expected, 25, 35) == 0);
+    CHECK(std::memcmp(bitmap.data(), expected.data(), expected.height() * expected.stride()) == 0);
+}
+
+TEST_CASE("Filter graphs render identically on any number of threads") {
+    const std::string svg = R"SVG(<svg xmlns="http://www.w3.org/2000/svg" width="600" height="400" viewBox="0 0 150 100">
+        <filter id="f" x="-30%" y="-30%" width="160%" height="160%">
+            <feGaussianBlur in="SourceGraphic" stdDeviation="3.3 1.7" result="blur"/>
+            <feFlood flood-color="#0000ff" result="unused"/>
+            <feColorMatrix in="blur" type="hueRotate" values="40" result="hue"/>
+            <feBlend in="hue" in2="SourceAlpha" mode="screen" result="blend"/>
+            <feComposite in="blend" in2="blur" operator="arithmetic" k1="0.5" k2="0.5" k3="0.3" k4="0.1"/>
+        </filter>
+        <g filter="url(#f)">
+            <circle cx="50" cy="50" r="30" fill="orange" opacity="0.7"/>
+            <rect x="60" y="30" width="70" height="40" fill="teal"/>
+        </g>
+    </svg>)SVG";
+
+    auto document = novasvg::Document::loadFromData(svg);
+    REQUIRE(document != nullptr);
+
+    novasvg::RenderOptions options;
+    options.threads = 1;
+    auto expected = document->renderToBitmap(-1, -1, 0, options);
+    REQUIRE(!expected.isNull());
+    CHECK(pixel_at(expected, 300, 200) != 0);
+
+    // Tiling follows the requested thread count even where fewer cores exist, so this exercises the halo bands.
+    for(int threads : {2, 3, 8}) {
+        options.threads = threads;
+        auto bitmap = document->renderToBitmap(-1, -1, 0, options);
+        REQUIRE(!bitmap.isNull());
+        CHECK(std::memcmp(bitmap.data(), expected.data(), expected.height() * expected.stride()) == 0);
+    }
+}
+
+TEST_CASE("Worker pool tasks that throw are rethrown on the caller") {
+    auto pool = novasvg::workerPool();
+    std::atomic<int> finished(0);
+    CHECK_THROWS_AS(pool->parallelFor(64, 4, [&](int index) {
+        if(index % 16 == 3)
+            throw std::runtime_error("task failed");
+        finished++;
+    }), std::runtime_error);
+    CHECK(finished <= 60);
+
+    // The pool stays usable after a failed job.
+    finished = 0;
+    pool->parallelFor(64, 4, [&](int) { finished++; });
+    CHECK(finished == 64);
+}
+
+TEST_CASE("Damaged regions repaint to the same pixels as a full render") {
+    const std::string svg = R"SVG(<svg xmlns="http://www.w3.org/2000/svg" width="200" height="120" viewBox="0 0 100 60">
+        <filter id="blur"><feGaussianBlur stdDeviation="2"/></filter>
+        <rect width="100" height="60" fill="#eeeeee"/>
+        <g opacity="0.6">
+            <rect id="bar" x="10" y="10" width="20" height="30" fill="steelblue"/>
+            <circle cx="30" cy="30" r="12" fill="orange"/>
+        </g>
+        <circle id="glow" cx="48" cy="30" r="6" fill="crimson" filter="url(#blur)"/>
+        <text id="label" x="70" y="50" font-size="8">0</text>
+        <rect id="far" x="85" y="5" width="10" height="10" fill="green"/>
+    </svg>)SVG";
+
+    auto document = novasvg::Document::loadFromData(svg);
+    REQUIRE(document != nullptr);
+    const novasvg::Matrix matrix;
+    novasvg::Bitmap bitmap(200, 120);
+    auto box = document->renderDamaged(bitmap, matrix, 0xffffffff);
+    CHECK(box.w == 200.f);
+    CHECK(box.h == 120.f);
+    CHECK(document->renderDamaged(bitmap, matrix, 0xffffffff).w == 0.f);
+
+    auto check_matches_full_render = [&]() {
+        auto expected = document->renderToBitmap(200, 120, 0xffffffff);
+        REQUIRE(!expected.isNull());
+        CHECK(std::memcmp(bitmap.data(), expected.data(), expected.height() * expected.stride()) == 0);
+    };
+
+    // The bar shrinks under the translucent group and next to the blurred circle.
+    document->getElementById("bar").setAttribute("height", "5");
+    box = document->renderDamaged(bitmap, matrix, 0xffffffff);
+    CHECK(box.w > 0.f);
+    CHECK(box.w < 200.f);
+    check_matches_full_render();
+
+    document->getElementById("far").setAttribute("x", "80");
+    document->getElementById("label").children().front().toTextNode().setData("42");
+    box = document->renderDamaged(bitmap, matrix, 0xffffffff);
+    CHECK(box.x >= 100.f);
+    check_matches_full_render();
+
+    document->getElementById("glow").setAttribute("fill", "navy");
+    document->renderDamaged(bitmap, matrix, 0xffffffff);
+    check_matches_full_render();
+}
+
+TEST_CASE("Render statistics count the work of a render") {
+    const std::string svg = R"SVG(<svg xmlns="http://www.w3.org/2000/svg" width="100" height="100">
+        <defs>
+            <clipPath id="clip"><circle cx="30" cy="30" r="20"/><rect width="10" height="10"/></clipPath>
+            <pattern id="dots" width="10" height="10" patternUnits="userSpaceOnUse"><circle cx="5" cy="5" r="3"/></pattern>
+        </defs>
+        <rect width="100" height="100" fill="white"/>
+        <g opacity="0.5"><rect x="10" y="10" width="30" height="30" fill="red" stroke="blue"/></g>
+        <rect x="50" y="50" width="40" height="40" fill="url(#dots)" clip-path="url(#clip)"/>
+        <rect x="500" y="500" width="10" height="10" fill="green"/>
+        <rect width="10" height="10" display="none"/>
+        <text x="10" y="90" font-size="10">abc</text>
+    </svg>)SVG";
+
+    auto document = novasvg::Document::loadFromData(svg);
+    REQUIRE(document != nullptr);
+    auto plain = document->renderToBitmap();
+
+    novasvg::RenderStats stats;
+    novasvg::RenderOptions options;
+    options.stats = &stats;
+    auto counted = document->renderToBitmap(-1, -1, 0, options);
+    CHECK(std::memcmp(plain.data(), counted.data(), plain.height() * plain.stride()) == 0);
+
+    CHECK(stats.elementsVisited >= 7);
+    // The offscreen rect, the undisplayed one, and the clip circle that misses the clipped rect.
+    CHECK(stats.elementsCulled == 3);
+    CHECK(stats.fills >= 4);
+    CHECK(stats.strokes == 1);
+    CHECK(stats.glyphs == 3);
+    CHECK(stats.spans > 0);
+    CHECK(stats.pixelsBlended[static_cast<int>(novasvg::BlendOperator::Src)] >= 100 * 100);
+    CHECK(stats.pixelsBlended[static_cast<int>(novasvg::BlendOperator::DstIn)] > 0);
+    CHECK(stats.totalPixelsBlended() > stats.pixelsBlended[static_cast<int>(novasvg::BlendOperator::Src)]);
+    CHECK(stats.offscreenCanvases >= 3);
+    CHECK(stats.offscreenBytes > 0);
+    CHECK(stats.clipMasks == 1);
+    CHECK(stats.patternRenders == 1);
+    CHECK(stats.renderTime > 0.0);
+    CHECK(stats.renderTime >= stats.maskingTime);
+
+    auto first = stats;
+    document->renderToBitmap(-1, -1, 0, options);
+    CHECK(stats.fills == 2 * first.fills);
+    stats.reset();
+    CHECK(stats.totalPixelsBlended() == 0);
+}
+
+TEST_CASE("Memory budgets bound offscreen surfaces and use expansion") {
+    const std::string svg = R"SVG(<svg xmlns="http://www.w3.org/2000/svg" width="100" height="100">
+        <mask id="m"><rect width="50" height="100" fill="white"/></mask>
+        <pattern id="p" width="50" height="50" patternUnits="userSpaceOnUse"><rect width="25" height="25" fill="blue"/></pattern>
+        <g opacity="0.5"><rect width="100" height="100" fill="red"/></g>
+        <rect width="100" height="100" fill="url(#p)" mask="url(#m)"/>
+    </svg>)SVG";
+
+    auto document = novasvg::Document::loadFromData(svg);
+    REQUIRE(document != nullptr);
+
+    novasvg::RenderStats stats;
+    novasvg::RenderOptions options;
+    options.stats = &stats;
+    auto full = document->renderToBitmap(-1, -1, 0, options);
+    CHECK(stats.effectsSkipped == 0);
+    CHECK(stats.peakOffscreenBytes == 100 * 100 * 4);
+    CHECK(stats.peakOffscreenBytes < stats.offscreenBytes);
+
+    // Neither the group's layer nor the masked rect's layer and mask fit; the group is drawn
+    // opaque and the masked rect is hidden rather than painted unmasked.
+    stats.reset();
+    options.memoryBudget = 50 * 100 * 4 + 50 * 50 * 4;
+    auto limited = document->renderToBitmap(-1, -1, 0, options);
+    CHECK(stats.effectsSkipped == 2);
+    CHECK(stats.masks == 0);
+    CHECK(stats.peakOffscreenBytes <= options.memoryBudget);
+    CHECK(pixel_at(limited, 10, 10) == 0xffff0000);
+    CHECK(pixel_at(limited, 90, 90) == 0xffff0000);
+
+    // Nothing fits: the group is drawn opaque and the pattern fill is dropped.
+    stats.reset();
+    options.memoryBudget = 16;
+    auto minimal = document->renderToBitmap(-1, -1, 0, options);
+    CHECK(stats.offscreenCanvases == 0);
+    CHECK(stats.fills == 1);
+    CHECK(pixel_at(minimal, 90, 90) == 0xffff0000);
+
+    // A group layer alone fits, but not its clip mask; the clipped group is hidden, like a masked one.
+    auto clipped = novasvg::Document::loadFromData(R"SVG(<svg xmlns="http://www.w3.org/2000/svg" width="100" height="100">
+        <clipPath id="c"><rect width="20" height="100"/><rect x="80" width="20" height="100"/></clipPath>
+        <rect width="100" height="100" fill="red" clip-path="url(#c)"/>
+    </svg>)SVG");
+    REQUIRE(clipped != nullptr);
+    stats.reset();
+    options.memoryBudget = 100 * 100 * 4;
+    auto partial = clipped->renderToBitmap(-1, -1, 0, options);
+    CHECK(stats.clipMasks == 0);
+    CHECK(stats.effectsSkipped == 1);
+    CHECK(pixel_at(partial, 10, 50) == 0);
+    CHECK(pixel_at(partial, 50, 50) == 0);
+    CHECK(pixel_at(partial, 90, 50) == 0);
+
+    std::string laughs = "<svg xmlns='http://www.w3.org/2000/svg' xmlns:xlink='http://www.w3.org/1999/xlink'><rect id='l0' width='1' height='1'/>";
+    for(int i = 1; i <= 20; ++i) {
+        auto prev = "#l" + std::to_string(i - 1);
+        laughs += "<g id='l" + std::to_string(i) + "'><use xlink:href='" + prev + "'/><use xlink:href='" + prev + "'/></g>";
+    }
+
+    laughs += "</svg>";
+    CHECK(novasvg::Document::loadFromData(laughs.data(), laughs.size(), 1 << 20) == nullptr);
+    auto small = novasvg::Document::loadFromData(svg.data(), svg.size(), 1 << 20);
+    REQUIRE(small != nullptr);
+    CHECK(small->memoryUsage() > 0);
+    CHECK(small->memoryUsage() < (1 << 20));
+
+    // Replacing text frees what the old text was counted for.
+    auto text = novasvg::Document::loadFromData("<svg xmlns='http://www.w3.org/2000/svg'><text id='t'>abc</text></svg>");
+    REQUIRE(text != nullptr);
+    auto node = text->getElementById("t").children().front().toTextNode();
+    auto memoryUsage = text->memoryUsage();
+    for(int i = 0; i < 10; ++i) {
+        node.setData("abcdef");
+        node.setData("abc");
+    }
+
+    CHECK(text->memoryUsage() == memoryUsage);
+    node.setData("abcdef");
+    CHECK(text->memoryUsage() == memoryUsage + 3);
+}
+
+TEST_CASE("Cancelled and overdue renders stop early with a partial result") {
+    const std::string svg =
+        "<svg xmlns='http://www.w3.org/2000/svg' width='100' height='100'>"
+        "<rect width='100' height='100' fill='blue'/>"
+        "<line x1='0' y1='50' x2='1e7' y2='50' stroke='red' stroke-width='4' stroke-dasharray='0.01'/>"
+        "</svg>";
+    auto document = novasvg::Document::loadFromData(svg);
+    REQUIRE(document != nullptr);
+
+    novasvg::Bitmap bitmap(100, 100);
+    novasvg::RenderOptions options;
+    std::atomic<bool> cancel{true};
+    options.cancel = &cancel;
+    CHECK(document->render(bitmap, novasvg::Matrix(), options) == novasvg::RenderStatus::Cancelled);
+    CHECK(pixel_at(bitmap, 10, 10) == 0);
+
+    // A billion dashes would take minutes; the dasher gives up once the deadline passes.
+    options.cancel = nullptr;
+    options.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(50);
+    auto start = std::chrono::steady_clock::now();
+    CHECK(document->render(bitmap, novasvg::Matrix(), options) == novasvg::RenderStatus::DeadlineExceeded);
+    CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(5));
+    CHECK(pixel_at(bitmap, 10, 10) == 0xff0000ff);
+
+    // A repaint that is stopped early leaves the whole document to repaint next time.
+    options.deadline = std::chrono::steady_clock::now();
+    CHECK(document->renderDamaged(bitmap, novasvg::Matrix(), 0, options).w == 100);
+    CHECK(document->renderDamaged(bitmap, novasvg::Matrix(), 0, options).w == 100);
+
+    auto simple = novasvg::Document::loadFromData("<svg xmlns='http://www.w3.org/2000/svg' width='10' height='10'><rect width='10' height='10'/></svg>");
+    REQUIRE(simple != nullptr);
+    cancel = false;
+    options.cancel = &cancel;
+    options.deadline = std::chrono::steady_clock::now() + std::chrono::hours(1);
+    novasvg::Bitmap small(10, 10);
+    CHECK(simple->render(small, novasvg::Matrix(), options) == novasvg::RenderStatus::Complete);
+    CHECK(pixel_at(small, 5, 5) == 0xff000000);
+}
+
+TEST_CASE("Shared inherited styles resolve against each parent") {
+    // Both rects carry identical inherited attributes, but their stroke widths and
+    // currentColor fills must follow their own parents.
+    auto document = novasvg::Document::loadFromData(
+        "<svg xmlns='http://www.w3.org/2000/svg' width='100' height='50'>"
+        "<g stroke-width='4' color='red'><rect x='10' y='15' width='20' height='20' stroke='black' fill='currentColor'/></g>"
+        "<g stroke-width='12' color='blue'><rect x='60' y='15' width='20' height='20' stroke='black' fill='currentColor'/></g>"
+        "</svg>");
+    REQUIRE(document != nullptr);
+    auto bitmap = document->renderToBitmap();
+    CHECK(pixel_at(bitmap, 20, 25) == 0xffff0000);
+    CHECK(pixel_at(bitmap, 70, 25) == 0xff0000ff);
+    CHECK(pixel_at(bitmap, 20, 11) == 0);
+    CHECK(pixel_at(bitmap, 70, 11) == 0xff000000);
+
+    auto rect = document->querySelectorAll("rect").back();
+    rect.setAttribute("fill", "green");
+    bitmap = document->renderToBitmap();
+    CHECK(pixel_at(bitmap, 20, 25) == 0xffff0000);
+    CHECK(pixel_at(bitmap, 70, 25) == 0xff008000);
+}
+
+TEST_CASE("Presentation attributes are parsed when set") {
+    auto document = novasvg::Document::loadFromData(
+        "<svg xmlns='http://www.w3.org/2000/svg' width='40' height='20'>"
+        "<rect width='20' height='20' fill='currentColor' color='red'/>"
+        "<rect x='20' width='20' height='20' color='blue' fill=' inherit ' opacity='50%'/>"
+        "</svg>");
+    REQUIRE(document != nullptr);
+    auto bitmap = document->renderToBitmap();
+    CHECK(pixel_at(bitmap, 10, 10) == 0xffff0000);
+    CHECK(pixel_at(bitmap, 30, 10) == 0x7f000000);
+
+    auto rect = document->querySelectorAll("rect").back();
+    rect.setAttribute("fill", "currentColor");
+    rect.setAttribute("opacity", "1");
+    bitmap = document->renderToBitmap();
+    CHECK(pixel_at(bitmap, 30, 10) == 0xff0000ff);
+    CHECK(rect.getAttribute("fill") == "currentColor");
+}
+
+TEST_CASE("References follow id changes after the document is built") {
+    auto document = novasvg::Document::loadFromData(
+        "<svg xmlns='http://www.w3.org/2000/svg' width='40' height='20'>"
+        "<linearGradient id='paint'><stop stop-color='blue'/></linearGradient>"
+        "<clipPath id='left'><rect width='20' height='20'/></clipPath>"
+        "<g fill='url(#paint) red'><rect width='40' height='20' clip-path='url(#clip)'/></g>"
+        "</svg>");
+    REQUIRE(document != nullptr);
+    auto bitmap = document->renderToBitmap();
+    CHECK(pixel_at(bitmap, 10, 10) == 0xff0000ff);
+    CHECK(pixel_at(bitmap, 30, 10) == 0xff0000ff);
+
+    auto clip = document->getElementById("left");
+    clip.setAttribute("id", "clip");
+    CHECK(document->getElementById("left").isNull());
+    CHECK(document->getElementById("clip") == clip);
+    bitmap = document->renderToBitmap();
+    CHECK(pixel_at(bitmap, 10, 10) == 0xff0000ff);
+    CHECK(pixel_at(bitmap, 30, 10) == 0);
+
+    // A paint server that goes away falls back to the paint's color.
+    document->getElementById("paint").setAttribute("id", "gone");
+    bitmap = document->renderToBitmap();
+    CHECK(pixel_at(bitmap, 10, 10) == 0xffff0000);
+
+    // The next element in document order with a lost id takes it over; <use> clones never do.
+    document = novasvg::Document::loadFromData(
+        "<svg xmlns='http://www.w3.org/2000/svg' xmlns:xlink='http://www.w3.org/1999/xlink' width='40' height='20'>"
+        "<rect id='dup' width='10' height='10'/><use xlink:href='#dup' y='10'/>"
+        "<rect id='dup' x='20' width='10' height='10'/>"
+        "</svg>");
+    REQUIRE(document != nullptr);
+    auto first = document->getElementById("dup");
+    first.setAttribute("id", "first");
+    auto second = document->getElementById("dup");
+    REQUIRE_FALSE(second.isNull());
+    CHECK(second != first);
+    CHECK(second.getAttribute("x") == "20");
+    second.setAttribute("id", "other");
+    CHECK(document->getElementById("dup").isNull());
+
+    // An element that gains an id held by a later element takes it over.
+    first.setAttribute("id", "other");
+    CHECK(document->getElementById("other") == first);
+    CHECK(document->getElementById("other") != second);
+}
+
+TEST_CASE("Paint server href chains follow id changes after the document is built") {
+    auto document = novasvg::Document::loadFromData(
+        "<svg xmlns='http://www.w3.org/2000/svg' xmlns:xlink='http://www.w3.org/1999/xlink' width='20' height='20'>"
+        "<linearGradient id='base'><stop stop-color='blue'/></linearGradient>"
+        "<linearGradient id='alt'><stop stop-color='lime'/></linearGradient>"
+        "<linearGradient id='paint' xlink:href='#base'/>"
+        "<rect width='20' height='20' fill='url(#paint)'/>"
+        "</svg>");
+    REQUIRE(document != nullptr);
+    auto bitmap = document->renderToBitmap();
+    CHECK(pixel_at(bitmap, 10, 10) == 0xff0000ff);
+
+    document->getElementById("base").setAttribute("id", "old");
+    document->getElementById("alt").setAttribute("id", "base");
+    bitmap = document->renderToBitmap();
+    CHECK(pixel_at(bitmap, 10, 10) == 0xff00ff00);
+
+    // Without stops of its own or inherited ones the gradient paints nothing.
+    document->getElementById("base").setAttribute("id", "gone");
+    bitmap = document->renderToBitmap();
+    CHECK(pixel_at(bitmap, 10, 10) == 0);
+}
+
+TEST_CASE("Cached group bounding boxes follow incremental layout") {
+    auto document = novasvg::Document::loadFromData(
+        "<svg xmlns='http://www.w3.org/2000/svg' width='100' height='100'>"
+        "<g id='outer'><g id='inner' transform='translate(10 0)'><rect id='r' width='10' height='10'/></g></g>"
+        "</svg>");
+    REQUIRE(document != nullptr);
+    auto outer = document->getElementById("outer");
+    CHECK(outer.getBoundingBox().x == doctest::Approx(10.f));
+    CHECK(outer.getBoundingBox().w == doctest::Approx(10.f));
+
+    document->getElementById("r").setAttribute("width", "30");
+    CHECK(outer.getBoundingBox().w == doctest::Approx(30.f));
+    document->getElementById("inner").setAttribute("transform", "translate(20 0)");
+    CHECK(outer.getBoundingBox().x == doctest::Approx(20.f));
+    CHECK(document->getElementById("inner").getBoundingBox().w == doctest::Approx(30.f));
+}
+
+TEST_CASE("Binary snapshots render like the source document") {
+    auto source = novasvg::Document::loadFromData(
+        "<svg xmlns='http://www.w3.org/2000/svg' xmlns:xlink='http://www.w3.org/1999/xlink' width='100' height='100'>"
+        "<style>.blue { fill: blue }</style>"
+        "<defs><linearGradient id='grad'><stop offset='0' stop-color='lime'/><stop offset='1' stop-color='red'/></linearGradient>"
+        "<path id='tri' d='M0 0L40 0L0 40Z'/></defs>"
+        "<rect id='box' class='blue' x='50' width='10' height='50'>"
+        "<animate attributeName='width' from='10' to='50' dur='1s' fill='freeze'/></rect>"
+        "<use xlink:href='#tri' x='0' y='50' fill='url(#grad)'/>"
+        "<path d='M0 0h40v40h-40z' fill='#800000'/>"
+        "<image x='80' y='80' width='20' height='20' xlink:href='data:image/png;base64,"
+        "iVBORw0KGgoAAAANSUhEUgAAAAIAAAACCAIAAAD91JpzAAAAD0lEQVR4nGNg+M8AQhAKABvyA/1tVLjHAAAAAElFTkSuQmCC'/>"
+        "</svg>");
+    REQUIRE(source != nullptr);
+    source->setAnimationTime(1.f);
+    CHECK(source->getElementById("box").getAttribute("width") == "50");
+
+    auto snapshot = source->serialize();
+    auto document = novasvg::Document::loadFromBinary(snapshot);
+    REQUIRE(document != nullptr);
+
+    // Animated attributes are stored with their base values.
+    CHECK(document->getElementById("box").getAttribute("width") == "10");
+    CHECK(document->getElementById("tri").getAttribute("d") == "M0 0L40 0L0 40Z");
+    CHECK(document->hasAnimations());
+    document->setAnimationTime(1.f);
+    CHECK(document->getElementById("box").getAttribute("width") == "50");
+    document->setAnimationTime(0.f);
+
+    // Use clones, references and decoded images are stored, so a loaded snapshot writes back unchanged.
+    CHECK(document->serialize() == snapshot);
+
+    source->setAnimationTime(0.f);
+    auto expected = source->renderToBitmap();
+    auto bitmap = document->renderToBitmap();
+    REQUIRE(bitmap.width() == expected.width());
+    REQUIRE(bitmap.height() == expected.height());
+    int differences = 0;
+    for(int y = 0; y < bitmap.height(); ++y) {
+        for(int x = 0; x < bitmap.width(); ++x) {
+            if(pixel_at(bitmap, x, y) != pixel_at(expected, x, y)) {
+                ++differences;
+            }
+        }
+    }
+
+    CHECK(differences == 0);
+    CHECK(pixel_at(bitmap, 20, 10) == 0xff800000);
+    CHECK(pixel_at(bitmap, 55, 10) == 0xff0000ff);
+    CHECK(pixel_at(bitmap, 90, 90) == 0xff00ff00);
+
+    // Snapshots read from an unaligned buffer decode the same way.
+    std::string shifted = " " + snapshot;
+    CHECK(novasvg::Document::loadFromBinary(shifted.data() + 1, snapshot.size()) != nullptr);
+
+    CHECK(novasvg::Document::loadFromBinary("") == nullptr);
+    CHECK(novasvg::Document::loadFromBinary(snapshot.data(), snapshot.size() - 1) == nullptr);
+    CHECK(novasvg::Document::loadFromBinary(snapshot + '\0') == nullptr);
+    std::string corrupted = snapshot;
+    corrupted[8] ^= 0xff;
+    CHECK(novasvg::Document::loadFromBinary(corrupted) == nullptr);
+}
+
+TEST_CASE("Binary snapshots reject out-of-range enums, bools and lengths") {
+    auto source = novasvg::Document::loadFromData(
+        "<svg xmlns='http://www.w3.org/2000/svg' width='100' height='100' viewBox='0 0 100 100'>"
+        "<linearGradient id='grad' gradientUnits='userSpaceOnUse'/>"
+        "<text text-anchor='middle' fill='currentColor' stroke-width='3.5' baseline-shift='super'>A</text>"
+        "<rect width='17.25' height='10'/>"
+        "</svg>");
+    REQUIRE(source != nullptr);
+    auto snapshot = source->serialize();
+    REQUIRE(novasvg::Document::loadFromBinary(snapshot) != nullptr);
+
+    // Payloads follow the attribute text and the payload flags byte.
+    auto payloadOffset = [&](const std::string& text) {
+        auto position = snapshot.find(text);
+        REQUIRE(position != std::string::npos);
+        return position + text.size() + 1;
+    };
+
+    auto corrupt = [&](size_t offset, const void* data, size_t length) {
+        std::string corrupted = snapshot;
+        std::memcpy(&corrupted[offset], data, length);
+        return novasvg::Document::loadFromBinary(corrupted);
+    };
+
+    // Presentation values start with a uint32 color, a bool and a float before the enumeration.
+    const uint8_t byte = 0x70;
+    CHECK(corrupt(payloadOffset("currentColor") + 4, &byte, 1) == nullptr);
+    CHECK(corrupt(payloadOffset("middle") + 9, &byte, 1) == nullptr);
+    const uint8_t end = 2;
+    CHECK(corrupt(payloadOffset("middle") + 9, &end, 1) != nullptr);
+    const uint8_t badEnd = 3;
+    CHECK(corrupt(payloadOffset("middle") + 9, &badEnd, 1) == nullptr);
+
+    CHECK(corrupt(payloadOffset("userSpaceOnUse"), &byte, 1) == nullptr);
+    const float width = -100.f;
+    CHECK(corrupt(payloadOffset("0 0 100 100") + 8, &width, sizeof(width)) == nullptr);
+
+    // Lengths are a float and a units byte; the presentation length follows the enumeration and
+    // the baseline shift type follows it and the empty length list.
+    CHECK(corrupt(payloadOffset("3.5") + 10, &width, sizeof(width)) == nullptr);
+    CHECK(corrupt(payloadOffset("3.5") + 14, &byte, 1) == nullptr);
+    const float dashOffset = 3.5f;
+    CHECK(corrupt(payloadOffset("3.5") + 10, &dashOffset, sizeof(dashOffset)) != nullptr);
+    CHECK(corrupt(payloadOffset("super") + 19, &byte, 1) == nullptr);
+    const float shift = -4.f;
+    CHECK(corrupt(payloadOffset("super") + 20, &shift, sizeof(shift)) != nullptr);
+    const float rectWidth = 20.f;
+    CHECK(corrupt(payloadOffset("17.25"), &rectWidth, sizeof(rectWidth)) != nullptr);
+    CHECK(corrupt(payloadOffset("17.25"), &width, sizeof(width)) == nullptr);
+    CHECK(corrupt(payloadOffset("17.25") + 4, &byte, 1) == nullptr);
+}
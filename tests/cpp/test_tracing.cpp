@@ -0,0 +1,92 @@
+#include "doctest.h"
+
+#include <set>
+#include <string>
+#include <thread>
+
+#include <novasvg/novasvg.h>
+
+TEST_CASE("Tracing records parse, layout and render events") {
+    const std::string content =
+        "<svg xmlns='http://www.w3.org/2000/svg' width='64' height='32'>"
+        "<g id='group\"1'><rect id='box' width='20' height='20' fill='red'/></g>"
+        "</svg>";
+
+    auto untraced = novasvg::Document::loadFromData(content);
+    REQUIRE(untraced != nullptr);
+    untraced->renderToBitmap();
+
+    REQUIRE(novasvg::startTracing());
+    CHECK(novasvg::isTracing());
+    auto document = novasvg::Document::loadFromData(content);
+    REQUIRE(document != nullptr);
+    document->renderToBitmap();
+    novasvg::stopTracing();
+    CHECK(!novasvg::isTracing());
+
+    // Nothing recorded after stopping shows up in the trace.
+    untraced->renderToBitmap();
+
+    auto json = novasvg::traceToJson();
+    CHECK(json.find("\"traceEvents\"") != std::string::npos);
+    CHECK(json.find("\"name\":\"parse\"") != std::string::npos);
+    CHECK(json.find("\"name\":\"layout\"") != std::string::npos);
+    CHECK(json.find("\"name\":\"render\",\"cat\":\"novasvg\",\"ph\":\"X\"") != std::string::npos);
+    CHECK(json.find("\"size\":2048") != std::string::npos);
+    CHECK(json.find("\"id\":\"box\"") != std::string::npos);
+    CHECK(json.find("\"id\":\"group\\\"1\"") != std::string::npos);
+    CHECK(json.find("\"name\":\"fillPath\"") != std::string::npos);
+
+    size_t renders = 0;
+    for(auto pos = json.find("\"name\":\"render\""); pos != std::string::npos; pos = json.find("\"name\":\"render\"", pos + 1))
+        ++renders;
+    CHECK(renders == 1);
+
+    // A new session drops the events of the previous one.
+    novasvg::startTracing();
+    novasvg::stopTracing();
+    CHECK(novasvg::traceToJson().find("\"name\":\"parse\"") == std::string::npos);
+}
+
+TEST_CASE("Threads that exit hand their trace buffer to later threads") {
+    const std::string content = "<svg xmlns='http://www.w3.org/2000/svg' width='8' height='8'/>";
+
+    REQUIRE(novasvg::startTracing());
+    for(int index = 0; index < 4; ++index) {
+        std::thread([&] { novasvg::Document::loadFromData(content); }).join();
+    }
+
+    novasvg::stopTracing();
+
+    // Every parse is kept, and all of them were recorded into the one reused buffer.
+    auto json = novasvg::traceToJson();
+    std::set<std::string> threadIds;
+    size_t parses = 0;
+    for(auto pos = json.find("\"name\":\"parse\""); pos != std::string::npos; pos = json.find("\"name\":\"parse\"", pos + 1)) {
+        auto tid = json.find("\"tid\":", pos) + 6;
+        threadIds.insert(json.substr(tid, json.find(',', tid) - tid));
+        ++parses;
+    }
+
+    CHECK(parses == 4);
+    CHECK(threadIds.size() == 1);
+}
+
+TEST_CASE("Long trace details are cut between UTF-8 characters") {
+    // 46 ASCII bytes and a two-byte character straddle the 47-byte detail limit.
+    const std::string id = std::string(46, 'a') + "\xc3\xa9";
+    const std::string content =
+        "<svg xmlns='http://www.w3.org/2000/svg' width='8' height='8'>"
+        "<g id='" + id + "'><rect width='4' height='4'/></g>"
+        "</svg>";
+
+    REQUIRE(novasvg::startTracing());
+    auto document = novasvg::Document::loadFromData(content);
+    REQUIRE(document != nullptr);
+    document->renderToBitmap();
+    novasvg::stopTracing();
+
+    auto json = novasvg::traceToJson();
+    CHECK(json.find("\"id\":\"" + std::string(46, 'a') + "\"") != std::string::npos);
+    CHECK(json.find("\xc3\"") == std::string::npos);
+}
@@ -0,0 +1,106 @@
+import numpy as np
+import pytest
+
+import novasvg
+
+SVG = """
+<svg xmlns="http://www.w3.org/2000/svg" width="20" height="10">
+    <rect width="10" height="10" fill="#ff0000"/>
+    <rect x="10" width="10" height="10" fill="#0000ff" fill-opacity="0.5"/>
+</svg>
+"""
+
+
+def test_render_into_fills_caller_array():
+    doc = novasvg.Document.load_from_data(SVG)
+    out = np.full((10, 20, 4), 7, dtype=np.uint8)
+    assert novasvg.render_svg(doc, out=out) is out
+    assert out[5, 5].tolist() == [255, 0, 0, 255]
+    assert out[5, 15, 2] == 255
+    assert out[5, 15, 3] in (127, 128)
+
+
+def test_render_into_strided_rows_and_channel_orders():
+    doc = novasvg.Document.load_from_data(SVG)
+    padded = np.zeros((10, 24, 4), dtype=np.uint8)
+    doc.render_into(padded[:, :20], channel_order="bgra")
+    assert padded[5, 5].tolist() == [0, 0, 255, 255]
+    assert not padded[:, 20:].any()
+
+    native = doc.render_to_array(channel_order="bgra_premultiplied")
+    assert native.shape == (10, 20, 4)
+    assert native[5, 15, 0] == native[5, 15, 3]
+
+    with pytest.raises(ValueError):
+        doc.render_into(np.zeros((10, 20, 4), dtype=np.uint8), channel_order="argb")
+
+
+def test_bitmap_view_shares_memory():
+    bitmap = novasvg.Bitmap(4, 3)
+    view = bitmap.view()
+    assert view.shape == (3, 4, 4)
+    bitmap.clear(0x00FF00FF)
+    assert view[1, 2].tolist() == [0, 255, 0, 255]
+    assert np.shares_memory(np.asarray(bitmap), view)
+
+
+def test_render_batch_formats_and_failures():
+    sources = [SVG, SVG.encode(), SVG]
+    images = novasvg.render_batch(sources, (20, 10), threads=2)
+    assert images.shape == (3, 10, 20, 4)
+    assert images.dtype == np.uint8
+    assert all(images[i, 5, 5].tolist() == [255, 0, 0, 255] for i in range(3))
+
+    alpha = novasvg.render_batch(sources, (20, 10), channel_order="a8", dtype="float32")
+    assert alpha.shape == (3, 10, 20, 1)
+    assert alpha[0, 5, 5, 0] == pytest.approx(1.0)
+    assert alpha[0, 5, 15, 0] == pytest.approx(0.5, abs=0.01)
+
+    out = np.full((2, 10, 20, 1), 9, dtype=np.uint8)
+    assert novasvg.render_batch([SVG, "<svg"], (20, 10), out=out, channel_order="gray", skip_invalid=True) is out
+    assert out[0, 5, 5, 0] == 77
+    assert not out[1].any()
+
+    with pytest.raises(ValueError, match="indices: 1"):
+        novasvg.render_batch([SVG, "<svg"], (20, 10))
+
+
+def test_render_status_and_options():
+    doc = novasvg.Document.load_from_data(SVG)
+    bitmap = novasvg.Bitmap(20, 10)
+    assert doc.render(bitmap) == novasvg.RenderStatus.Complete
+
+    options = novasvg.RenderOptions()
+    assert options.stats is None
+    assert options.cancel is None
+    assert options.deadline is None
+
+    stats = novasvg.RenderStats()
+    options.stats = stats
+    options.memory_budget = 1 << 20
+    assert doc.render(bitmap, options=options) == novasvg.RenderStatus.Complete
+    assert options.stats is stats
+    assert stats.fills == 2
+    assert stats.total_pixels_blended() == sum(stats.pixels_blended)
+    assert len(stats.pixels_blended) == 12
+
+    with pytest.raises(ValueError, match="threads=1"):
+        novasvg.render_batch([SVG, SVG], (20, 10), threads=2, options=options)
+    options.stats = None
+
+    token = novasvg.CancelToken()
+    options.cancel = token
+    token.cancel()
+    assert token.cancelled
+    bitmap.clear(0)
+    assert doc.render(bitmap, options=options) == novasvg.RenderStatus.Cancelled
+    assert not np.asarray(bitmap).any()
+
+    token.reset()
+    options.deadline = -1.0
+    assert options.deadline < 0
+    assert doc.render(bitmap, options=options) == novasvg.RenderStatus.DeadlineExceeded
+    options.deadline = 3600.0
+    assert doc.render(bitmap, options=options) == novasvg.RenderStatus.Complete
+    options.deadline = None
+    assert options.deadline is None